@@ -0,0 +1,356 @@
+/**
+ * @Author: running-code-pp
+ * @Date: 2026-10-21 14:36:50
+ * @LastEditors: running-code-pp
+ * @LastEditTime: 2026-10-21 14:36:50
+ * @FilePath: \plib\benchmarks\allocator_benchmark.cpp
+ * @Description: plib各内存池与glibc malloc、std::pmr池的对比：单线程分配/释放、跨线程释放、随机大小的反复分配、峰值过后的碎片与常驻内存
+ * @Copyright: Copyright (c) 2026 by running-code-pp 3320996652@qq.com, All Rights Reserved.
+ */
+#include "memory/concurrent_memorypool.hpp"
+#include "memory/memorypool.hpp"
+#include "memory/slab_allocator.hpp"
+#include "utils/object_pool.hpp"
+#include "utils/safe_memorypool.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+using namespace plib::core;
+
+namespace
+{
+    // 定长池的对象，一个缓存行；构造函数不清零，与malloc的未初始化内存对等比较
+    struct Object
+    {
+        Object() {}
+        std::uint64_t data[8];
+    };
+    constexpr std::size_t kObjectSize = sizeof(Object);
+
+    // 当前进程的常驻内存(KB)，非Linux平台返回0
+    double rss_kb()
+    {
+#if defined(__linux__)
+        std::ifstream statm("/proc/self/statm");
+        std::size_t size = 0, resident = 0;
+        statm >> size >> resident;
+        return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / 1024.0;
+#else
+        return 0.0;
+#endif
+    }
+
+    // 以下适配器统一成 allocate(bytes)/deallocate(p, bytes)/trim()，定长池忽略bytes
+    // kThreadSafe: 可以在其他线程释放；kVariableSize: 支持任意大小
+
+    struct Malloc
+    {
+        static constexpr bool kThreadSafe = true;
+        static constexpr bool kVariableSize = true;
+        void *allocate(std::size_t bytes) { return std::malloc(bytes); }
+        void deallocate(void *p, std::size_t) { std::free(p); }
+        void trim()
+        {
+#if defined(__GLIBC__)
+            malloc_trim(0);
+#endif
+        }
+    };
+
+    struct PmrUnsynchronizedPool
+    {
+        static constexpr bool kThreadSafe = false;
+        static constexpr bool kVariableSize = true;
+        std::pmr::unsynchronized_pool_resource resource;
+        void *allocate(std::size_t bytes) { return resource.allocate(bytes); }
+        void deallocate(void *p, std::size_t bytes) { resource.deallocate(p, bytes); }
+        void trim() {}
+    };
+
+    struct PmrSynchronizedPool
+    {
+        static constexpr bool kThreadSafe = true;
+        static constexpr bool kVariableSize = true;
+        std::pmr::synchronized_pool_resource resource;
+        void *allocate(std::size_t bytes) { return resource.allocate(bytes); }
+        void deallocate(void *p, std::size_t bytes) { resource.deallocate(p, bytes); }
+        void trim() {}
+    };
+
+    struct PlibSlabHeap
+    {
+        static constexpr bool kThreadSafe = true;
+        static constexpr bool kVariableSize = true;
+        memory::SlabHeap heap;
+        void *allocate(std::size_t bytes) { return heap.allocate(bytes); }
+        void deallocate(void *p, std::size_t bytes) { heap.deallocate(p, bytes); }
+        void trim() {}
+    };
+
+    // memory/memorypool.hpp：单线程空闲链表
+    struct PlibMemoryPool
+    {
+        static constexpr bool kThreadSafe = false;
+        static constexpr bool kVariableSize = false;
+        memory::MemoryPool<Object> pool;
+        void *allocate(std::size_t) { return pool.allocate(); }
+        void deallocate(void *p, std::size_t) { pool.deallocate(static_cast<Object *>(p)); }
+        void trim() {}
+    };
+
+    // utils/safe_memorypool.hpp：全局无锁空闲链表
+    struct PlibSafeMemoryPool
+    {
+        static constexpr bool kThreadSafe = true;
+        static constexpr bool kVariableSize = false;
+        ::MemoryPool<Object> pool;
+        void *allocate(std::size_t) { return pool.allocate(); }
+        void deallocate(void *p, std::size_t) { pool.deallocate(static_cast<Object *>(p)); }
+        void trim() {}
+    };
+
+    struct PlibConcurrentMemoryPool
+    {
+        static constexpr bool kThreadSafe = true;
+        static constexpr bool kVariableSize = false;
+        memory::ConcurrentMemoryPool<Object> pool;
+        void *allocate(std::size_t) { return pool.allocate(); }
+        void deallocate(void *p, std::size_t) { pool.deallocate(static_cast<Object *>(p)); }
+        void trim() {}
+    };
+
+    struct PlibObjectPool
+    {
+        static constexpr bool kThreadSafe = true;
+        static constexpr bool kVariableSize = false;
+        utils::ObjectPool<Object> pool;
+        void *allocate(std::size_t) { return pool.animate(); }
+        void deallocate(void *p, std::size_t) { pool.recycle(static_cast<Object *>(p)); }
+        void trim()
+        {
+            pool.flush_local_cache();
+            pool.trim(0);
+        }
+    };
+
+    // 单生产者单消费者的环形队列，本身不分配内存，不干扰被测的分配器
+    class SpscRing
+    {
+    public:
+        bool push(void *p) noexcept
+        {
+            auto tail = _tail.load(std::memory_order_relaxed);
+            if (tail - _head.load(std::memory_order_acquire) == kCapacity)
+                return false;
+            _slots[tail % kCapacity] = p;
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(void *&p) noexcept
+        {
+            auto head = _head.load(std::memory_order_relaxed);
+            if (head == _tail.load(std::memory_order_acquire))
+                return false;
+            p = _slots[head % kCapacity];
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        static constexpr std::size_t kCapacity = 1024;
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _head{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _tail{0};
+        void *_slots[kCapacity];
+    };
+
+    // 16B~1KB之间按对数均匀分布的大小，小对象更多，接近服务端的实际分布
+    std::vector<std::size_t> random_sizes(std::size_t n)
+    {
+        std::mt19937_64 rng(7);
+        std::uniform_real_distribution<double> lg(4.0, 10.0);
+        std::vector<std::size_t> sizes(n);
+        for (auto &s : sizes)
+            s = static_cast<std::size_t>(std::exp2(lg(rng)));
+        return sizes;
+    }
+}
+
+// 每一轮分配range(0)个对象再按分配顺序全部释放
+template <typename A>
+static void allocator_single_thread_BENCHMARK(benchmark::State &state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    A alloc;
+    std::vector<void *> objs(count);
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            objs[i] = alloc.allocate(kObjectSize);
+            static_cast<Object *>(objs[i])->data[0] = i;
+        }
+        for (void *p : objs)
+            alloc.deallocate(p, kObjectSize);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// 生产者线程分配，消费者线程释放(消息传递的典型模式)，统计生产者的吞吐
+// 队列满/空时让出CPU而不是自旋，核数少于两个的机器上也能得到有意义的结果
+template <typename A>
+static void allocator_producer_consumer_BENCHMARK(benchmark::State &state)
+{
+    static_assert(A::kThreadSafe);
+    const auto count = static_cast<std::size_t>(state.range(0));
+    A alloc;
+    SpscRing ring;
+    std::thread consumer([&]
+                         {
+        void *p;
+        for (;;) {
+            if (!ring.pop(p)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (p == nullptr)
+                break;
+            alloc.deallocate(p, kObjectSize);
+        } });
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            void *p = alloc.allocate(kObjectSize);
+            static_cast<Object *>(p)->data[0] = i;
+            while (!ring.push(p))
+                std::this_thread::yield();
+        }
+    }
+    while (!ring.push(nullptr))
+        std::this_thread::yield();
+    consumer.join();
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// range(0)个存活对象，每次随机替换其中一个为随机大小的新对象
+template <typename A>
+static void allocator_random_size_churn_BENCHMARK(benchmark::State &state)
+{
+    static_assert(A::kVariableSize);
+    const auto live = static_cast<std::size_t>(state.range(0));
+    constexpr std::size_t kOps = 1 << 16;
+    const auto sizes = random_sizes(kOps);
+    std::vector<std::uint32_t> victims(kOps);
+    std::mt19937 rng(11);
+    for (auto &v : victims)
+        v = static_cast<std::uint32_t>(rng() % live);
+
+    A alloc;
+    std::vector<void *> ptrs(live);
+    std::vector<std::size_t> lens(live);
+    for (std::size_t i = 0; i < live; ++i)
+    {
+        lens[i] = sizes[i % kOps];
+        ptrs[i] = alloc.allocate(lens[i]);
+    }
+    std::size_t op = 0;
+    for (auto _ : state)
+    {
+        const std::size_t v = victims[op];
+        alloc.deallocate(ptrs[v], lens[v]);
+        lens[v] = sizes[op];
+        ptrs[v] = alloc.allocate(lens[v]);
+        *static_cast<char *>(ptrs[v]) = 1;
+        op = (op + 1) % kOps;
+    }
+    for (std::size_t i = 0; i < live; ++i)
+        alloc.deallocate(ptrs[i], lens[i]);
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 分配range(0)个对象形成峰值，随机释放90%后测常驻内存，再调用trim(有的话)
+// 计数均为相对开始时的增量(KB)
+template <typename A>
+static void allocator_fragmentation_BENCHMARK(benchmark::State &state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    double spike = 0, after_free = 0, after_trim = 0;
+    // 幸存者均匀散布在所有块中，最坏情况下每个块都释放不掉
+    std::vector<std::size_t> order(count);
+    for (std::size_t i = 0; i < count; ++i)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(3));
+    std::vector<void *> objs(count, nullptr);
+    const std::size_t survivors = count / 10;
+    for (auto _ : state)
+    {
+        auto alloc = std::make_unique<A>();
+        // 之前的用例释放给malloc的内存先还给系统，避免被本次峰值复用而看不到增长
+        Malloc().trim();
+        const double base = rss_kb();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            objs[i] = alloc->allocate(kObjectSize);
+            static_cast<Object *>(objs[i])->data[0] = i;
+        }
+        spike = rss_kb() - base;
+
+        for (std::size_t i = survivors; i < count; ++i)
+            alloc->deallocate(objs[order[i]], kObjectSize);
+        after_free = rss_kb() - base;
+        alloc->trim();
+        after_trim = rss_kb() - base;
+
+        for (std::size_t i = 0; i < survivors; ++i)
+            alloc->deallocate(objs[order[i]], kObjectSize);
+    }
+    state.counters["rss_spike_kb"] = spike;
+    state.counters["rss_after_free_kb"] = after_free;
+    state.counters["rss_after_trim_kb"] = after_trim;
+}
+
+#define PLIB_ALLOCATOR_BENCHMARKS(Scenario, ...)                                   \
+    BENCHMARK_TEMPLATE(Scenario, Malloc)->__VA_ARGS__;                             \
+    BENCHMARK_TEMPLATE(Scenario, PmrSynchronizedPool)->__VA_ARGS__;                \
+    BENCHMARK_TEMPLATE(Scenario, PlibSlabHeap)->__VA_ARGS__;                       \
+    BENCHMARK_TEMPLATE(Scenario, PlibSafeMemoryPool)->__VA_ARGS__;                 \
+    BENCHMARK_TEMPLATE(Scenario, PlibConcurrentMemoryPool)->__VA_ARGS__;           \
+    BENCHMARK_TEMPLATE(Scenario, PlibObjectPool)->__VA_ARGS__
+
+// 单线程：所有分配器
+PLIB_ALLOCATOR_BENCHMARKS(allocator_single_thread_BENCHMARK, Arg(1)->Arg(4096));
+BENCHMARK_TEMPLATE(allocator_single_thread_BENCHMARK, PmrUnsynchronizedPool)->Arg(1)->Arg(4096);
+BENCHMARK_TEMPLATE(allocator_single_thread_BENCHMARK, PlibMemoryPool)->Arg(1)->Arg(4096);
+
+// 跨线程释放：只有线程安全的分配器
+PLIB_ALLOCATOR_BENCHMARKS(allocator_producer_consumer_BENCHMARK, Arg(1 << 16)->UseRealTime()->Unit(benchmark::kMicrosecond));
+
+// 随机大小：只有支持任意大小的分配器
+BENCHMARK_TEMPLATE(allocator_random_size_churn_BENCHMARK, Malloc)->Arg(8192);
+BENCHMARK_TEMPLATE(allocator_random_size_churn_BENCHMARK, PmrUnsynchronizedPool)->Arg(8192);
+BENCHMARK_TEMPLATE(allocator_random_size_churn_BENCHMARK, PmrSynchronizedPool)->Arg(8192);
+BENCHMARK_TEMPLATE(allocator_random_size_churn_BENCHMARK, PlibSlabHeap)->Arg(8192);
+
+// 峰值过后的碎片
+PLIB_ALLOCATOR_BENCHMARKS(allocator_fragmentation_BENCHMARK, Arg(1 << 20)->Iterations(1)->Unit(benchmark::kMillisecond));
+BENCHMARK_TEMPLATE(allocator_fragmentation_BENCHMARK, PmrUnsynchronizedPool)->Arg(1 << 20)->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(allocator_fragmentation_BENCHMARK, PlibMemoryPool)->Arg(1 << 20)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,130 @@
+/**
+ * @Author: running-code-pp
+ * @Date: 2026-10-20 19:48:30
+ * @LastEditors: running-code-pp
+ * @LastEditTime: 2026-10-20 19:48:30
+ * @FilePath: \plib\benchmarks\block_provider_benchmark.cpp
+ * @Description: 块来源的基准测试，按随机顺序遍历池化对象，比较普通页与大页下的TLB开销
+ * @Copyright: Copyright (c) 2026 by running-code-pp 3320996652@qq.com, All Rights Reserved.
+ */
+#include "memory/block_provider.hpp"
+#include "utils/object_pool.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+using namespace plib::core;
+
+namespace
+{
+    // 一个缓存行大小的节点，next串成随机顺序的环
+    struct Node
+    {
+        Node *next;
+        std::uint64_t payload[7];
+    };
+
+    // 当前进程由透明大页支撑的匿名内存(KB)，非Linux平台返回0
+    double anon_huge_kb()
+    {
+#if defined(__linux__)
+        std::ifstream smaps("/proc/self/smaps_rollup");
+        std::string key;
+        double value = 0;
+        while (smaps >> key)
+        {
+            if (key == "AnonHugePages:")
+            {
+                smaps >> value;
+                return value;
+            }
+        }
+#endif
+        return 0.0;
+    }
+
+    // 在pool中分配count个节点并按随机排列串成环，然后沿环做指针追逐
+    template <typename Pool>
+    void chase(benchmark::State &state, Pool &pool)
+    {
+        const auto count = static_cast<std::size_t>(state.range(0));
+        std::vector<Node *> nodes(count);
+        for (std::size_t i = 0; i < count; ++i)
+            nodes[i] = pool.animate(Node{nullptr, {i}});
+        std::vector<std::size_t> order(count);
+        std::iota(order.begin(), order.end(), std::size_t{0});
+        std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+        for (std::size_t i = 0; i < count; ++i)
+            nodes[order[i]]->next = nodes[order[(i + 1) % count]];
+
+        Node *cur = nodes[order[0]];
+        std::uint64_t sum = 0;
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                sum += cur->payload[0];
+                cur = cur->next;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+        state.counters["anon_huge_kb"] = anon_huge_kb();
+        for (Node *n : nodes)
+            pool.recycle(n);
+    }
+}
+
+// 默认块来源：全局堆，4KB页
+static void PLIB_block_provider_heap_random_chase_BENCHMARK(benchmark::State &state)
+{
+    utils::ObjectPool<Node> pool(1);
+    chase(state, pool);
+}
+
+static void PLIB_block_provider_mmap_random_chase_BENCHMARK(benchmark::State &state)
+{
+    memory::MmapBlockProvider::Options options;
+    options.huge_pages = memory::HugePagePolicy::NONE;
+    memory::MmapBlockProvider provider(options);
+    {
+        utils::ObjectPool<Node> pool(&provider, 1);
+        chase(state, pool);
+    }
+}
+
+static void PLIB_block_provider_thp_random_chase_BENCHMARK(benchmark::State &state)
+{
+    memory::MmapBlockProvider provider;
+    {
+        utils::ObjectPool<Node> pool(&provider, 1);
+        chase(state, pool);
+    }
+    state.counters["thp_mappings"] = static_cast<double>(provider.transparent_mappings());
+}
+
+// 先尝试MAP_HUGETLB并预取，没有预留大页时退回透明大页
+static void PLIB_block_provider_hugetlb_random_chase_BENCHMARK(benchmark::State &state)
+{
+    memory::MmapBlockProvider::Options options;
+    options.huge_pages = memory::HugePagePolicy::EXPLICIT;
+    options.populate = true;
+    memory::MmapBlockProvider provider(options);
+    {
+        utils::ObjectPool<Node> pool(&provider, 1);
+        chase(state, pool);
+    }
+    state.counters["hugetlb_mappings"] = static_cast<double>(provider.hugetlb_mappings());
+    state.counters["hugetlb_fallbacks"] = static_cast<double>(provider.hugetlb_fallbacks());
+}
+
+BENCHMARK(PLIB_block_provider_heap_random_chase_BENCHMARK)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(PLIB_block_provider_mmap_random_chase_BENCHMARK)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(PLIB_block_provider_thp_random_chase_BENCHMARK)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(PLIB_block_provider_hugetlb_random_chase_BENCHMARK)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
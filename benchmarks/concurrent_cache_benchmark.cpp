@@ -0,0 +1,129 @@
+/**
+ * @Author: running-code-pp
+ * @Date: 2026-10-21 23:02:45
+ * @LastEditors: running-code-pp
+ * @LastEditTime: 2026-10-21 23:02:45
+ * @FilePath: \plib\benchmarks\concurrent_cache_benchmark.cpp
+ * @Description: W-TinyLFU分片并发缓存与mutex保护的LruCache在Zipf分布和Zipf+一次性扫描负载下的命中率与吞吐对比
+ * @Copyright: Copyright (c) 2026 by running-code-pp 3320996652@qq.com, All Rights Reserved.
+ */
+#include "concurrent/concurrent_cache.hpp"
+#include "utils/lru.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <vector>
+using namespace plib::core;
+
+namespace
+{
+    constexpr std::size_t kUniverse = 1 << 20;
+    constexpr std::size_t kCapacity = 1 << 16;
+
+    // 1M个键上指数0.99的Zipf分布，预先采样好，排名打散成键，热键不会集中在同一个分片
+    const std::vector<std::uint64_t> &zipf_keys()
+    {
+        static const std::vector<std::uint64_t> keys = []
+        {
+            std::vector<double> cdf(kUniverse);
+            double sum = 0;
+            for (std::size_t i = 0; i < kUniverse; ++i)
+                cdf[i] = (sum += 1.0 / std::pow(static_cast<double>(i + 1), 0.99));
+            std::mt19937_64 rng(42);
+            std::uniform_real_distribution<double> dist(0, sum);
+            std::vector<std::uint64_t> result(1 << 22);
+            for (auto &k : result)
+            {
+                const auto rank = static_cast<std::uint64_t>(std::upper_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin());
+                k = rank * 0x9e3779b97f4a7c15ULL;
+            }
+            return result;
+        }();
+        return keys;
+    }
+
+    // 一把锁保护的LRU，对照组
+    struct MutexLru
+    {
+        MutexLru() : lru(kCapacity) {}
+
+        std::optional<std::uint64_t> get(std::uint64_t key)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (auto *v = lru.get(key))
+                return *v;
+            return std::nullopt;
+        }
+        void put(std::uint64_t key, std::uint64_t value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lru.put(key, value);
+        }
+
+        std::mutex mutex;
+        utils::LruCache<std::uint64_t, std::uint64_t> lru;
+    };
+
+    struct TinyLfu
+    {
+        TinyLfu() : cache(kCapacity) {}
+
+        std::optional<std::uint64_t> get(std::uint64_t key) { return cache.get(key); }
+        void put(std::uint64_t key, std::uint64_t value) { cache.put(key, value); }
+
+        concurrent::ConcurrentCache<std::uint64_t, std::uint64_t> cache;
+    };
+
+    // 每个工作负载各用一个缓存，多次运行之间保持预热状态
+    template <typename Cache, int ScanPercent>
+    Cache &shared_cache()
+    {
+        static Cache *cache = new Cache();
+        return *cache;
+    }
+
+    // 未命中时回填；ScanPercent%的访问是只出现一次的新键，模拟批处理扫描
+    template <typename Cache, int ScanPercent>
+    void get_or_put(benchmark::State &state)
+    {
+        Cache &cache = shared_cache<Cache, ScanPercent>();
+        const auto &keys = zipf_keys();
+        std::size_t i = static_cast<std::size_t>(state.thread_index()) * 7919;
+        std::uint64_t scan = (std::uint64_t(1) << 63) | (static_cast<std::uint64_t>(state.thread_index()) << 40);
+        std::uint64_t hits = 0;
+        std::uint64_t accesses = 0;
+        for (auto _ : state)
+        {
+            const std::uint64_t key = ScanPercent > 0 && (i % 100) < static_cast<std::size_t>(ScanPercent)
+                                          ? ++scan
+                                          : keys[i & (keys.size() - 1)];
+            ++i;
+            ++accesses;
+            if (auto v = cache.get(key))
+                hits += *v == key;
+            else
+                cache.put(key, key);
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["hit_ratio"] = benchmark::Counter(static_cast<double>(hits) / static_cast<double>(std::max<std::uint64_t>(accesses, 1)),
+                                                         benchmark::Counter::kAvgThreads);
+    }
+}
+
+static void PLIB_concurrent_cache_zipf_BENCHMARK(benchmark::State &state) { get_or_put<TinyLfu, 0>(state); }
+static void PLIB_mutex_lru_zipf_BENCHMARK(benchmark::State &state) { get_or_put<MutexLru, 0>(state); }
+static void PLIB_concurrent_cache_scan_BENCHMARK(benchmark::State &state) { get_or_put<TinyLfu, 30>(state); }
+static void PLIB_mutex_lru_scan_BENCHMARK(benchmark::State &state) { get_or_put<MutexLru, 30>(state); }
+
+// 缓存容量是键空间的1/16；线程数从1翻倍到32
+#define PLIB_CONCURRENT_CACHE_BENCH(name) BENCHMARK(name)->ThreadRange(1, 32)->UseRealTime()
+PLIB_CONCURRENT_CACHE_BENCH(PLIB_concurrent_cache_zipf_BENCHMARK);
+PLIB_CONCURRENT_CACHE_BENCH(PLIB_mutex_lru_zipf_BENCHMARK);
+PLIB_CONCURRENT_CACHE_BENCH(PLIB_concurrent_cache_scan_BENCHMARK);
+PLIB_CONCURRENT_CACHE_BENCH(PLIB_mutex_lru_scan_BENCHMARK);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,113 @@
+/**
+ * @Author: running-code-pp
+ * @Date: 2026-10-21 16:02:18
+ * @LastEditors: running-code-pp
+ * @LastEditTime: 2026-10-21 16:02:18
+ * @FilePath: \plib\benchmarks\concurrent_hash_map_benchmark.cpp
+ * @Description: 分片并发哈希表与LockedRW/mutex保护的std::unordered_map在多线程读为主负载下的吞吐对比
+ * @Copyright: Copyright (c) 2026 by running-code-pp 3320996652@qq.com, All Rights Reserved.
+ */
+#include "concurrent/concurrent_hash_map.hpp"
+#include "concurrent/rwlock.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+using namespace plib::core;
+
+namespace
+{
+    constexpr std::uint64_t kKeys = 1 << 16;
+
+    struct MutexMap
+    {
+        std::optional<std::uint64_t> find(std::uint64_t key)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = map.find(key);
+            if (it == map.end())
+                return std::nullopt;
+            return it->second;
+        }
+        void insert_or_assign(std::uint64_t key, std::uint64_t value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            map.insert_or_assign(key, value);
+        }
+        std::mutex mutex;
+        std::unordered_map<std::uint64_t, std::uint64_t> map;
+    };
+
+    struct RwMap
+    {
+        std::optional<std::uint64_t> find(std::uint64_t key)
+        {
+            return map.access_read([key](const auto &m) -> std::optional<std::uint64_t>
+                                   {
+                auto it = m.find(key);
+                if (it == m.end())
+                    return std::nullopt;
+                return it->second; });
+        }
+        void insert_or_assign(std::uint64_t key, std::uint64_t value)
+        {
+            map.access_write([=](auto &m)
+                             { m.insert_or_assign(key, value); });
+        }
+        concurrent::LockedRW<std::unordered_map<std::uint64_t, std::uint64_t>> map;
+    };
+
+    using ShardedMap = concurrent::ConcurrentHashMap<std::uint64_t, std::uint64_t>;
+
+    template <typename Map>
+    Map &shared_map()
+    {
+        static Map *map = []
+        {
+            auto *m = new Map();
+            for (std::uint64_t i = 0; i < kKeys; ++i)
+                m->insert_or_assign(i, i);
+            return m;
+        }();
+        return *map;
+    }
+
+    // 每个线程独立的随机键序列，WritePercent%的操作是覆盖写
+    template <typename Map, int WritePercent>
+    void mixed(benchmark::State &state)
+    {
+        Map &map = shared_map<Map>();
+        std::mt19937_64 rng(static_cast<std::uint64_t>(state.thread_index()) + 1);
+        std::uint64_t sum = 0;
+        for (auto _ : state)
+        {
+            const std::uint64_t r = rng();
+            const std::uint64_t key = r & (kKeys - 1);
+            if (WritePercent > 0 && (r >> 32) % 100 < static_cast<std::uint64_t>(WritePercent))
+                map.insert_or_assign(key, r);
+            else if (auto v = map.find(key))
+                sum += *v;
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+static void PLIB_concurrent_hash_map_read_BENCHMARK(benchmark::State &state) { mixed<ShardedMap, 0>(state); }
+static void PLIB_locked_rw_map_read_BENCHMARK(benchmark::State &state) { mixed<RwMap, 0>(state); }
+static void PLIB_mutex_map_read_BENCHMARK(benchmark::State &state) { mixed<MutexMap, 0>(state); }
+static void PLIB_concurrent_hash_map_read_mostly_BENCHMARK(benchmark::State &state) { mixed<ShardedMap, 5>(state); }
+static void PLIB_locked_rw_map_read_mostly_BENCHMARK(benchmark::State &state) { mixed<RwMap, 5>(state); }
+static void PLIB_mutex_map_read_mostly_BENCHMARK(benchmark::State &state) { mixed<MutexMap, 5>(state); }
+
+// 线程数从1翻倍到64，纯读时分片表的吞吐应随线程数线性增长
+#define PLIB_CONCURRENT_MAP_BENCH(name) BENCHMARK(name)->ThreadRange(1, 64)->UseRealTime()
+PLIB_CONCURRENT_MAP_BENCH(PLIB_concurrent_hash_map_read_BENCHMARK);
+PLIB_CONCURRENT_MAP_BENCH(PLIB_locked_rw_map_read_BENCHMARK);
+PLIB_CONCURRENT_MAP_BENCH(PLIB_mutex_map_read_BENCHMARK);
+PLIB_CONCURRENT_MAP_BENCH(PLIB_concurrent_hash_map_read_mostly_BENCHMARK);
+PLIB_CONCURRENT_MAP_BENCH(PLIB_locked_rw_map_read_mostly_BENCHMARK);
+PLIB_CONCURRENT_MAP_BENCH(PLIB_mutex_map_read_mostly_BENCHMARK);
+
+BENCHMARK_MAIN();
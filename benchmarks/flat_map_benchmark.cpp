@@ -0,0 +1,237 @@
+/**
+ * @Author: running-code-pp
+ * @Date: 2026-10-21 11:20:47
+ * @LastEditors: running-code-pp
+ * @LastEditTime: 2026-10-21 11:20:47
+ * @FilePath: \plib\benchmarks\flat_map_benchmark.cpp
+ * @Description: flat_map(键值交错存放)、flat_soa_map(键值分开存放)与frozen_flat_map(Eytzinger顺序)的查找与批量构建对比，以及可平凡重定位元素的中间插入/删除
+ * @Copyright: Copyright (c) 2026 by running-code-pp 3320996652@qq.com, All Rights Reserved.
+ */
+#include "type/flatmap.hpp"
+#include "type/flat_soa_map.hpp"
+#include "type/frozen_flat_map.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+using namespace plib::core;
+
+namespace
+{
+    template <std::size_t Size>
+    struct Value
+    {
+        std::uint64_t data[Size / sizeof(std::uint64_t)];
+    };
+
+    // 偶数键有序插入，查询一半命中一半不命中，随机顺序
+    std::vector<std::int32_t> make_queries(std::size_t count)
+    {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<std::int32_t> dist(0, static_cast<std::int32_t>(count * 2 - 1));
+        std::vector<std::int32_t> queries(1 << 16);
+        for (auto &q : queries)
+            q = dist(rng);
+        return queries;
+    }
+
+    template <typename Map>
+    void lookup(benchmark::State &state, const Map &map, std::size_t count)
+    {
+        const auto queries = make_queries(count);
+        std::size_t i = 0;
+        std::uint64_t sum = 0;
+        for (auto _ : state)
+        {
+            auto it = map.find(queries[i++ & (queries.size() - 1)]);
+            if (it != map.end())
+                sum += it->second.data[0];
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template <std::size_t Size>
+    void aos_lookup(benchmark::State &state)
+    {
+        using map_t = type::flat_map<std::int32_t, Value<Size>>;
+        const auto count = static_cast<std::size_t>(state.range(0));
+        std::vector<typename map_t::value_type> items;
+        items.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            items.emplace_back(static_cast<std::int32_t>(i * 2), Value<Size>{{i}});
+        map_t map(type::sorted_unique, items.begin(), items.end());
+        lookup(state, map, count);
+    }
+
+    template <std::size_t Size>
+    void soa_lookup(benchmark::State &state)
+    {
+        using map_t = type::flat_soa_map<std::int32_t, Value<Size>>;
+        const auto count = static_cast<std::size_t>(state.range(0));
+        std::vector<std::pair<std::int32_t, Value<Size>>> items;
+        items.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            items.emplace_back(static_cast<std::int32_t>(i * 2), Value<Size>{{i}});
+        map_t map(type::sorted_unique, items.begin(), items.end());
+        lookup(state, map, count);
+    }
+
+    // 大查找表：4字节键和值，表大小从L2内到远超LLC
+    template <typename Map>
+    void large_lookup(benchmark::State &state)
+    {
+        const auto count = static_cast<std::size_t>(state.range(0));
+        type::flat_map<std::int32_t, std::int32_t> source;
+        {
+            std::vector<typename type::flat_map<std::int32_t, std::int32_t>::value_type> items;
+            items.reserve(count);
+            for (std::size_t i = 0; i < count; ++i)
+                items.emplace_back(static_cast<std::int32_t>(i * 2), static_cast<std::int32_t>(i));
+            source = type::flat_map<std::int32_t, std::int32_t>(type::sorted_unique, items.begin(), items.end());
+        }
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<std::int32_t> dist(0, static_cast<std::int32_t>(count * 2 - 1));
+        std::vector<std::int32_t> queries(1 << 16);
+        for (auto &q : queries)
+            q = dist(rng);
+
+        const Map map(source);
+        std::size_t i = 0;
+        std::int64_t sum = 0;
+        for (auto _ : state)
+        {
+            auto it = map.find(queries[i++ & (queries.size() - 1)]);
+            if (it != map.end())
+                sum += it->second;
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // 与unique_ptr布局相同，但没有声明可平凡重定位，搬移时逐个移动构造/赋值
+    struct Boxed
+    {
+        Boxed() = default;
+        explicit Boxed(std::unique_ptr<int> p) : ptr(std::move(p)) {}
+        Boxed(Boxed &&other) noexcept : ptr(std::move(other.ptr)) {}
+        Boxed &operator=(Boxed &&other) noexcept
+        {
+            ptr = std::move(other.ptr);
+            return *this;
+        }
+        std::unique_ptr<int> ptr;
+    };
+
+    // 偶数键填满表，每次在正中间插入一个奇数键再删掉，表大小不变，每次都要搬动一半元素
+    template <typename Key, typename Value, typename MakeKey>
+    void middle_insert_erase(benchmark::State &state, MakeKey make_key)
+    {
+        using map_t = type::flat_map<Key, Value>;
+        const auto count = static_cast<std::size_t>(state.range(0));
+        map_t map;
+        map.reserve(count + 1);
+        for (std::size_t i = 0; i < count; ++i)
+            map.try_emplace(make_key(i * 2), Value());
+        const Key middle = make_key(count + 1);
+        for (auto _ : state)
+        {
+            auto it = map.try_emplace(middle, Value()).first;
+            map.erase(it);
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // 定长补零，字典序与数值序一致；长度超过短字符串缓冲区，元素搬移只交换堆指针
+    std::string string_key(std::size_t i)
+    {
+        auto digits = std::to_string(i);
+        return "key-" + std::string(20 - digits.size(), '0') + digits;
+    }
+
+    std::uint64_t integer_key(std::size_t i)
+    {
+        return i;
+    }
+
+    // 从乱序输入批量构建
+    template <typename Map, typename Item>
+    void bulk_build(benchmark::State &state)
+    {
+        const auto count = static_cast<std::size_t>(state.range(0));
+        std::vector<Item> items;
+        items.reserve(count);
+        std::mt19937 rng(7);
+        for (std::size_t i = 0; i < count; ++i)
+            items.emplace_back(static_cast<std::int32_t>(rng()), typename Item::second_type{});
+        for (auto _ : state)
+        {
+            Map map;
+            map.insert(items.begin(), items.end());
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+    }
+}
+
+static void PLIB_flat_map_aos_lookup_64B_BENCHMARK(benchmark::State &state) { aos_lookup<64>(state); }
+static void PLIB_flat_map_soa_lookup_64B_BENCHMARK(benchmark::State &state) { soa_lookup<64>(state); }
+static void PLIB_flat_map_aos_lookup_128B_BENCHMARK(benchmark::State &state) { aos_lookup<128>(state); }
+static void PLIB_flat_map_soa_lookup_128B_BENCHMARK(benchmark::State &state) { soa_lookup<128>(state); }
+static void PLIB_flat_map_aos_lookup_256B_BENCHMARK(benchmark::State &state) { aos_lookup<256>(state); }
+static void PLIB_flat_map_soa_lookup_256B_BENCHMARK(benchmark::State &state) { soa_lookup<256>(state); }
+
+static void PLIB_flat_map_aos_bulk_build_64B_BENCHMARK(benchmark::State &state)
+{
+    using map_t = type::flat_map<std::int32_t, Value<64>>;
+    bulk_build<map_t, typename map_t::value_type>(state);
+}
+static void PLIB_flat_map_soa_bulk_build_64B_BENCHMARK(benchmark::State &state)
+{
+    using map_t = type::flat_soa_map<std::int32_t, Value<64>>;
+    bulk_build<map_t, std::pair<std::int32_t, Value<64>>>(state);
+}
+
+static void PLIB_flat_map_large_lookup_BENCHMARK(benchmark::State &state)
+{
+    large_lookup<type::flat_map<std::int32_t, std::int32_t>>(state);
+}
+static void PLIB_frozen_flat_map_large_lookup_BENCHMARK(benchmark::State &state)
+{
+    large_lookup<type::frozen_flat_map<std::int32_t, std::int32_t>>(state);
+}
+
+static void PLIB_flat_map_middle_insert_string_BENCHMARK(benchmark::State &state)
+{
+    middle_insert_erase<std::string, int>(state, string_key);
+}
+static void PLIB_flat_map_middle_insert_unique_ptr_BENCHMARK(benchmark::State &state)
+{
+    middle_insert_erase<std::uint64_t, std::unique_ptr<int>>(state, integer_key);
+}
+static void PLIB_flat_map_middle_insert_boxed_BENCHMARK(benchmark::State &state)
+{
+    middle_insert_erase<std::uint64_t, Boxed>(state, integer_key);
+}
+
+// 1K个元素能放进L1/L2，256K个元素时大值版本远超LLC
+#define PLIB_FLAT_MAP_LOOKUP(name) BENCHMARK(name)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 18)
+PLIB_FLAT_MAP_LOOKUP(PLIB_flat_map_aos_lookup_64B_BENCHMARK);
+PLIB_FLAT_MAP_LOOKUP(PLIB_flat_map_soa_lookup_64B_BENCHMARK);
+PLIB_FLAT_MAP_LOOKUP(PLIB_flat_map_aos_lookup_128B_BENCHMARK);
+PLIB_FLAT_MAP_LOOKUP(PLIB_flat_map_soa_lookup_128B_BENCHMARK);
+PLIB_FLAT_MAP_LOOKUP(PLIB_flat_map_aos_lookup_256B_BENCHMARK);
+PLIB_FLAT_MAP_LOOKUP(PLIB_flat_map_soa_lookup_256B_BENCHMARK);
+BENCHMARK(PLIB_flat_map_large_lookup_BENCHMARK)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 24);
+BENCHMARK(PLIB_frozen_flat_map_large_lookup_BENCHMARK)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 24);
+// 10万个元素的表，unique_ptr按字节搬移，Boxed逐个移动，std::string只有libc++下按字节搬移
+BENCHMARK(PLIB_flat_map_middle_insert_string_BENCHMARK)->Arg(100000);
+BENCHMARK(PLIB_flat_map_middle_insert_unique_ptr_BENCHMARK)->Arg(100000);
+BENCHMARK(PLIB_flat_map_middle_insert_boxed_BENCHMARK)->Arg(100000);
+BENCHMARK(PLIB_flat_map_aos_bulk_build_64B_BENCHMARK)->Arg(1 << 16)->Unit(benchmark::kMillisecond);
+BENCHMARK(PLIB_flat_map_soa_bulk_build_64B_BENCHMARK)->Arg(1 << 16)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
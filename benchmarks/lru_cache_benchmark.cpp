@@ -0,0 +1,104 @@
+/**
+ * @Author: running-code-pp
+ * @Date: 2026-10-21 20:36:12
+ * @LastEditors: running-code-pp
+ * @LastEditTime: 2026-10-21 20:36:12
+ * @FilePath: \plib\benchmarks\lru_cache_benchmark.cpp
+ * @Description: slab节点+开放寻址索引的LruCache与std::list+std::unordered_map实现的LRU在高换出率负载下的对比
+ * @Copyright: Copyright (c) 2026 by running-code-pp 3320996652@qq.com, All Rights Reserved.
+ */
+#include "utils/lru.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <vector>
+using namespace plib::core;
+
+namespace
+{
+    // 常见写法：链表保存顺序和值，哈希表保存链表迭代器，每个新条目两次节点分配
+    class ListLru
+    {
+    public:
+        explicit ListLru(std::size_t capacity) : _capacity(capacity) { _map.reserve(capacity); }
+
+        std::uint64_t *get(std::uint64_t key)
+        {
+            auto it = _map.find(key);
+            if (it == _map.end())
+                return nullptr;
+            _list.splice(_list.begin(), _list, it->second);
+            return &it->second->second;
+        }
+
+        void put(std::uint64_t key, std::uint64_t value)
+        {
+            auto it = _map.find(key);
+            if (it != _map.end())
+            {
+                it->second->second = value;
+                _list.splice(_list.begin(), _list, it->second);
+                return;
+            }
+            if (_list.size() == _capacity)
+            {
+                _map.erase(_list.back().first);
+                _list.pop_back();
+            }
+            _list.emplace_front(key, value);
+            _map.emplace(key, _list.begin());
+        }
+
+    private:
+        std::size_t _capacity;
+        std::list<std::pair<std::uint64_t, std::uint64_t>> _list;
+        std::unordered_map<std::uint64_t, std::list<std::pair<std::uint64_t, std::uint64_t>>::iterator> _map;
+    };
+
+    // 键空间是容量的KeysPerSlot倍，未命中时回填，命中率约为1/KeysPerSlot
+    template <typename Cache, int KeysPerSlot>
+    void get_or_put(benchmark::State &state)
+    {
+        const auto capacity = static_cast<std::size_t>(state.range(0));
+        Cache cache(capacity);
+        // 键是随机的64位整数，避免小整数在恒等哈希下恰好一个桶一个元素
+        std::mt19937_64 rng(42);
+        std::vector<std::uint64_t> universe(capacity * KeysPerSlot);
+        for (auto &k : universe)
+            k = rng();
+        std::vector<std::uint64_t> keys(1 << 20);
+        for (auto &k : keys)
+            k = universe[rng() % universe.size()];
+        // 先填满，计时部分一开始就处于稳定的换出状态
+        for (std::size_t k = 0; k < capacity; ++k)
+            cache.put(universe[k], universe[k]);
+        std::size_t i = 0;
+        std::uint64_t sum = 0;
+        for (auto _ : state)
+        {
+            const auto key = keys[i++ & (keys.size() - 1)];
+            if (auto *v = cache.get(key))
+                sum += *v;
+            else
+                cache.put(key, key);
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    using SlabLru = utils::LruCache<std::uint64_t, std::uint64_t>;
+}
+
+static void PLIB_lru_cache_mostly_hit_BENCHMARK(benchmark::State &state) { get_or_put<SlabLru, 1>(state); }
+static void STD_list_lru_mostly_hit_BENCHMARK(benchmark::State &state) { get_or_put<ListLru, 1>(state); }
+static void PLIB_lru_cache_churn_BENCHMARK(benchmark::State &state) { get_or_put<SlabLru, 4>(state); }
+static void STD_list_lru_churn_BENCHMARK(benchmark::State &state) { get_or_put<ListLru, 4>(state); }
+
+BENCHMARK(PLIB_lru_cache_mostly_hit_BENCHMARK)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK(STD_list_lru_mostly_hit_BENCHMARK)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK(PLIB_lru_cache_churn_BENCHMARK)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK(STD_list_lru_churn_BENCHMARK)->Arg(1 << 12)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,129 @@
+/**
+ * @Author: running-code-pp
+ * @Date: 2026-10-20 14:05:12
+ * @LastEditors: running-code-pp
+ * @LastEditTime: 2026-10-20 14:05:12
+ * @FilePath: \plib\benchmarks\object_pool_benchmark.cpp
+ * @Description: 对象池的基准测试，测试线程缓存快速路径的分配/回收速度，以及流量峰值过后trim前后的常驻内存
+ * @Copyright: Copyright (c) 2026 by running-code-pp 3320996652@qq.com, All Rights Reserved.
+ */
+#include "utils/object_pool.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+using namespace plib::core::utils;
+
+namespace
+{
+    struct Message
+    {
+        std::uint64_t id;
+        double values[7];
+    };
+
+    // 当前进程的常驻内存(KB)，非Linux平台返回0
+    double rss_kb()
+    {
+#if defined(__linux__)
+        std::ifstream statm("/proc/self/statm");
+        std::size_t size = 0, resident = 0;
+        statm >> size >> resident;
+        return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / 1024.0;
+#else
+        return 0.0;
+#endif
+    }
+}
+
+// 同一线程成对的animate/recycle，只经过线程私有的弹匣
+static void PLIB_object_pool_animate_recycle_BENCHMARK(benchmark::State &state)
+{
+    ObjectPool<Message> pool;
+    for (auto _ : state)
+    {
+        auto *m = pool.animate(Message{1, {}});
+        benchmark::DoNotOptimize(m);
+        pool.recycle(m);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void Other_new_delete_BENCHMARK(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        auto *m = new Message{1, {}};
+        benchmark::DoNotOptimize(m);
+        delete m;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 每一轮创建并回收range(0)个对象，逐个调用与批量接口对比
+static void PLIB_object_pool_tick_single_BENCHMARK(benchmark::State &state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    ObjectPool<Message> pool(1);
+    std::vector<Message *> objs(count);
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            objs[i] = pool.animate(Message{i, {}});
+        for (auto *m : objs)
+            pool.recycle(m);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void PLIB_object_pool_tick_bulk_BENCHMARK(benchmark::State &state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    ObjectPool<Message> pool(1);
+    std::vector<Message *> objs(count);
+    for (auto _ : state)
+    {
+        pool.animate_n(count, objs.data(), Message{1, {}});
+        pool.recycle_n(objs.data(), count);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// 分配range(0)个对象后全部回收，比较trim前后的常驻内存
+static void PLIB_object_pool_trim_rss_BENCHMARK(benchmark::State &state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    double peak = 0, before = 0, after = 0;
+    for (auto _ : state)
+    {
+        ObjectPool<Message> pool;
+        // 保留全部空块，模拟没有回收策略时的表现
+        pool.set_retained_blocks(static_cast<std::size_t>(-1));
+        std::vector<Message *> objs;
+        objs.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            objs.push_back(pool.animate(Message{i, {}}));
+        peak = rss_kb();
+        for (auto *m : objs)
+            pool.recycle(m);
+        pool.flush_local_cache();
+        before = rss_kb();
+        pool.trim(0);
+        after = rss_kb();
+        benchmark::DoNotOptimize(pool.num_blocks());
+    }
+    state.counters["rss_peak_kb"] = peak;
+    state.counters["rss_before_trim_kb"] = before;
+    state.counters["rss_after_trim_kb"] = after;
+}
+
+BENCHMARK(PLIB_object_pool_animate_recycle_BENCHMARK);
+BENCHMARK(PLIB_object_pool_tick_single_BENCHMARK)->Arg(10000);
+BENCHMARK(PLIB_object_pool_tick_bulk_BENCHMARK)->Arg(10000);
+BENCHMARK(Other_new_delete_BENCHMARK);
+BENCHMARK(PLIB_object_pool_trim_rss_BENCHMARK)->Arg(1 << 20)->Iterations(3)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,114 @@
+/**
+ * @Author: running-code-pp
+ * @Date: 2026-10-21 18:04:51
+ * @LastEditors: running-code-pp
+ * @LastEditTime: 2026-10-21 18:04:51
+ * @FilePath: \plib\benchmarks\ordered_set_benchmark.cpp
+ * @Description: B+树OrderedSet与std::set在大量插入、lower_bound查找和区间扫描上的对比
+ * @Copyright: Copyright (c) 2026 by running-code-pp 3320996652@qq.com, All Rights Reserved.
+ */
+#include "type/orderedset.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+using namespace plib::core;
+
+namespace
+{
+    std::vector<std::uint64_t> random_keys(std::size_t count)
+    {
+        std::mt19937_64 rng(42);
+        std::vector<std::uint64_t> keys(count);
+        for (auto &k : keys)
+            k = rng();
+        return keys;
+    }
+
+    template <typename Set>
+    void random_insert(benchmark::State &state)
+    {
+        const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            Set set;
+            for (auto k : keys)
+                set.insert(k);
+            benchmark::DoNotOptimize(set.size());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename Set>
+    void sequential_insert(benchmark::State &state)
+    {
+        const auto count = static_cast<std::uint64_t>(state.range(0));
+        for (auto _ : state)
+        {
+            Set set;
+            for (std::uint64_t k = 0; k < count; ++k)
+                set.insert(k);
+            benchmark::DoNotOptimize(set.size());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename Set>
+    void lookup(benchmark::State &state)
+    {
+        const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+        const Set set(keys.begin(), keys.end());
+        std::mt19937_64 rng(7);
+        std::uint64_t sum = 0;
+        for (auto _ : state)
+        {
+            auto it = set.lower_bound(rng());
+            if (it != set.end())
+                sum += *it;
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // 从随机位置开始顺序扫描1000个元素
+    template <typename Set>
+    void range_scan(benchmark::State &state)
+    {
+        const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+        const Set set(keys.begin(), keys.end());
+        std::mt19937_64 rng(7);
+        std::uint64_t sum = 0;
+        for (auto _ : state)
+        {
+            auto it = set.lower_bound(rng());
+            for (int i = 0; i < 1000 && it != set.end(); ++i, ++it)
+                sum += *it;
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * 1000);
+    }
+
+    using BTreeSet = type::OrderedSet<std::uint64_t>;
+    using RbTreeSet = std::set<std::uint64_t>;
+}
+
+static void PLIB_ordered_set_random_insert_BENCHMARK(benchmark::State &state) { random_insert<BTreeSet>(state); }
+static void STD_set_random_insert_BENCHMARK(benchmark::State &state) { random_insert<RbTreeSet>(state); }
+static void PLIB_ordered_set_sequential_insert_BENCHMARK(benchmark::State &state) { sequential_insert<BTreeSet>(state); }
+static void STD_set_sequential_insert_BENCHMARK(benchmark::State &state) { sequential_insert<RbTreeSet>(state); }
+static void PLIB_ordered_set_lookup_BENCHMARK(benchmark::State &state) { lookup<BTreeSet>(state); }
+static void STD_set_lookup_BENCHMARK(benchmark::State &state) { lookup<RbTreeSet>(state); }
+static void PLIB_ordered_set_range_scan_BENCHMARK(benchmark::State &state) { range_scan<BTreeSet>(state); }
+static void STD_set_range_scan_BENCHMARK(benchmark::State &state) { range_scan<RbTreeSet>(state); }
+
+BENCHMARK(PLIB_ordered_set_random_insert_BENCHMARK)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(STD_set_random_insert_BENCHMARK)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(PLIB_ordered_set_sequential_insert_BENCHMARK)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(STD_set_sequential_insert_BENCHMARK)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(PLIB_ordered_set_lookup_BENCHMARK)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK(STD_set_lookup_BENCHMARK)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK(PLIB_ordered_set_range_scan_BENCHMARK)->Arg(1 << 22);
+BENCHMARK(STD_set_range_scan_BENCHMARK)->Arg(1 << 22);
+
+BENCHMARK_MAIN();
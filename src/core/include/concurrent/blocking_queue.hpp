@@ -0,0 +1,94 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-19 17:05:33
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-19 17:05:33
+ * @FilePath: \plib\src\core\include\concurrent\blocking_queue.hpp
+ * @Description: 无锁队列 + 事件计数器组成的阻塞队列，接口与type::ThreadSafeQueue一致，可直接替换
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_BLOCKING_QUEUE_HPP_
+#define PLIB_CORE_CONCURRENT_BLOCKING_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include "concurrent/eventcount.hpp"
+#include "concurrent/lockfree_queue.hpp"
+
+namespace plib::core::concurrent
+{
+    /**
+     * @brief: 多生产者多消费者阻塞队列
+     * 入队/出队都不持有互斥量，只有队列为空时消费者才通过EventCount睡眠在futex上，
+     * 生产者在没有消费者睡眠时不会进入内核。
+     */
+    template <typename T>
+    class BlockingQueue
+    {
+    public:
+        BlockingQueue() = default;
+        BlockingQueue(const BlockingQueue &) = delete;
+        BlockingQueue &operator=(const BlockingQueue &) = delete;
+
+        // 无锁队列的入队不会失败，保留该接口以兼容ThreadSafeQueue
+        bool try_push(T &&value)
+        {
+            push(std::move(value));
+            return true;
+        }
+
+        void push(T &&value)
+        {
+            _queue.push(std::move(value));
+            _size.fetch_add(1, std::memory_order_relaxed);
+            _event.notify();
+        }
+
+        void push(const T &value)
+        {
+            _queue.push(value);
+            _size.fetch_add(1, std::memory_order_relaxed);
+            _event.notify();
+        }
+
+        bool try_pop(T &value)
+        {
+            if (!_queue.try_pop(value))
+                return false;
+            _size.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief: 阻塞直到取到元素或队列被stop，被stop时value保持不变
+         */
+        void pop(T &value)
+        {
+            _event.await([&]
+                         { return try_pop(value) || _stop.load(std::memory_order_acquire); });
+        }
+
+        // 近似大小，并发修改时仅供参考
+        std::size_t size() const
+        {
+            auto n = _size.load(std::memory_order_relaxed);
+            return n < 0 ? 0 : static_cast<std::size_t>(n);
+        }
+
+        // 停止队列，唤醒所有等待的线程
+        void stop()
+        {
+            _stop.store(true, std::memory_order_release);
+            _event.notify_all();
+        }
+
+    private:
+        LockFreeQueue<T> _queue;
+        EventCount _event;
+        std::atomic<std::ptrdiff_t> _size{0};
+        std::atomic<bool> _stop{false};
+    };
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_BLOCKING_QUEUE_HPP_
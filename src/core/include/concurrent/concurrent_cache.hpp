@@ -0,0 +1,719 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-21 22:10:37
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-21 22:10:37
+ * @FilePath: \plib\src\core\include\concurrent\concurrent_cache.hpp
+ * @Description: 分片并发缓存：数据放在无锁读的ConcurrentHashMap里，淘汰策略是W-TinyLFU，读命中先记进条带缓冲再批量应用
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_CONCURRENT_CACHE_HPP_
+#define PLIB_CORE_CONCURRENT_CONCURRENT_CACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "plib_macros.hpp"
+#include "concurrent/concurrent_hash_map.hpp"
+#include "concurrent/epoch.hpp"
+#include "memory/thread_cache.hpp"
+
+namespace plib::core::concurrent
+{
+    namespace detail
+    {
+        /**
+         * @brief: 4行的Count-Min Sketch，每个计数器4位，16个计数器打包在一个uint64里
+         * 一个键的4个计数器落在同一个64字节块(8个uint64)里，每次增减只碰一条缓存行
+         * 总增量达到sample_size后所有计数器减半，让旧的热度逐渐衰减
+         */
+        class FrequencySketch
+        {
+        public:
+            explicit FrequencySketch(std::size_t capacity = 1)
+            {
+                const std::size_t words = std::bit_ceil(std::max<std::size_t>(capacity, 8));
+                _table.assign(words, 0);
+                _block_mask = words / 8 - 1;
+                _sample_size = std::max<std::size_t>(capacity, 8) * 10;
+            }
+
+            void increment(std::uint32_t hash)
+            {
+                const std::uint64_t h = spread(hash);
+                std::uint64_t *block = block_of(h);
+                bool added = false;
+                for (unsigned row = 0; row < 4; ++row)
+                {
+                    const auto [word, shift] = locate(h, row);
+                    if (((block[word] >> shift) & 0xf) != 0xf)
+                    {
+                        block[word] += std::uint64_t(1) << shift;
+                        added = true;
+                    }
+                }
+                if (added && ++_additions >= _sample_size)
+                    age();
+            }
+
+            unsigned frequency(std::uint32_t hash) const
+            {
+                const std::uint64_t h = spread(hash);
+                const std::uint64_t *block = const_cast<FrequencySketch *>(this)->block_of(h);
+                unsigned result = 0xf;
+                for (unsigned row = 0; row < 4; ++row)
+                {
+                    const auto [word, shift] = locate(h, row);
+                    result = std::min(result, static_cast<unsigned>((block[word] >> shift) & 0xf));
+                }
+                return result;
+            }
+
+        private:
+            static std::uint64_t spread(std::uint32_t hash)
+            {
+                std::uint64_t h = (std::uint64_t(hash) + 0x9e3779b97f4a7c15ULL) * 0xbf58476d1ce4e5b9ULL;
+                return h ^ (h >> 31);
+            }
+
+            std::uint64_t *block_of(std::uint64_t h)
+            {
+                return _table.data() + ((h >> 40) & _block_mask) * 8;
+            }
+
+            // 每行在块内各取一个uint64(行0、1在前半块，行2、3在后半块)，再在其中属于该行的4个计数器里选一个
+            static std::pair<unsigned, unsigned> locate(std::uint64_t h, unsigned row)
+            {
+                const unsigned bits = static_cast<unsigned>(h >> (row * 8));
+                const unsigned word = (row & 2) * 2 + (bits & 3);
+                const unsigned counter = (row & 1) * 8 + ((bits >> 2) & 7);
+                return {word, counter * 4};
+            }
+
+            void age()
+            {
+                for (auto &word : _table)
+                    word = (word >> 1) & 0x7777777777777777ULL;
+                _additions /= 2;
+            }
+
+            std::vector<std::uint64_t> _table;
+            std::size_t _block_mask = 0;
+            std::size_t _sample_size = 0;
+            std::size_t _additions = 0;
+        };
+    } // namespace detail
+
+    /**
+     * @brief: 替换mutex+LRU的进程内缓存，适合读远多于写、访问分布倾斜的场景
+     * 键值存在ConcurrentHashMap里，get不加锁；淘汰顺序按键哈希分片维护，写者持分片锁。
+     * 读命中只往分片里本线程对应的条带缓冲记一笔，缓冲攒到一半时try_lock分片批量应用，抢不到锁就留给下一次，
+     * 缓冲满了直接丢弃记录——淘汰顺序是近似的，但读路径上没有锁等待。
+     * 淘汰策略是W-TinyLFU：新条目先进1%的窗口LRU，挤出窗口的候选者要比主区(SLRU)的淘汰对象访问频率更高才能留下，
+     * 频率由Count-Min Sketch估计(未命中也计数)，一次性扫描的键频率低，进不了主区，不会冲掉热数据。
+     * 每个条目可以带TTL，过期的条目在被读到时才删除。
+     */
+    template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class ConcurrentCache
+    {
+        static constexpr std::uint32_t kNil = UINT32_MAX;
+
+        // 哈希表中的值，node/gen指向策略节点，读者靠它们记录命中
+        struct Entry
+        {
+            Value value;
+            std::int64_t expire_at; // steady_clock纳秒，0表示不过期
+            std::uint32_t node;
+            std::uint32_t gen;
+        };
+
+        enum class Queue : std::uint8_t
+        {
+            Free,
+            Window,
+            Probation,
+            Protected
+        };
+
+        struct PolicyNode
+        {
+            std::optional<Key> key;
+            std::uint32_t hash = 0;
+            std::uint32_t prev = kNil;
+            std::uint32_t next = kNil;
+            std::uint32_t gen = 0; // 节点每次释放都加一，过时的读记录对不上就丢弃
+            Queue queue = Queue::Free;
+        };
+
+        struct List
+        {
+            std::uint32_t head = kNil;
+            std::uint32_t tail = kNil;
+            std::size_t size = 0;
+        };
+
+        // 读记录：命中为(node << 32 | gen)，未命中为(kNil << 32 | 31位哈希)，全1表示空槽
+        static constexpr std::uint64_t kEmptyRecord = UINT64_MAX;
+        static constexpr std::size_t kStripes = 8;
+        static constexpr std::size_t kBufferSize = 32;
+
+        /**
+         * @brief: 多生产者单消费者的有损环形缓冲，生产者CAS抢尾部，失败或满了就丢弃
+         * 消费者只在持分片锁时运行
+         */
+        struct alignas(CACHE_LINE_SIZE) ReadBuffer
+        {
+            ReadBuffer()
+            {
+                for (auto &slot : slots)
+                    slot.store(kEmptyRecord, std::memory_order_relaxed);
+            }
+
+            // 返回写入后缓冲中的记录数，0表示丢弃了
+            std::size_t offer(std::uint64_t record)
+            {
+                std::uint32_t t = tail.load(std::memory_order_relaxed);
+                const std::uint32_t h = head.load(std::memory_order_acquire);
+                if (t - h >= kBufferSize)
+                    return 0;
+                if (!tail.compare_exchange_weak(t, t + 1, std::memory_order_relaxed))
+                    return 0;
+                slots[t % kBufferSize].store(record, std::memory_order_release);
+                return t + 1 - h;
+            }
+
+            template <typename Func>
+            void drain(Func &&apply)
+            {
+                std::uint32_t h = head.load(std::memory_order_relaxed);
+                const std::uint32_t t = tail.load(std::memory_order_acquire);
+                for (; h != t; ++h)
+                {
+                    // 生产者已占位但还没写入，停在这里，下次再取；槽位在head越过之前只会被占位的那个生产者写一次
+                    auto &slot = slots[h % kBufferSize];
+                    const std::uint64_t record = slot.load(std::memory_order_acquire);
+                    if (record == kEmptyRecord)
+                        break;
+                    slot.store(kEmptyRecord, std::memory_order_relaxed);
+                    apply(record);
+                }
+                head.store(h, std::memory_order_release);
+            }
+
+            std::atomic<std::uint32_t> tail{0};
+            std::atomic<std::uint32_t> head{0};
+            std::atomic<std::uint64_t> slots[kBufferSize];
+        };
+
+        // 每个线程一份命中/未命中计数，只有所属线程写(读-加-写而不是RMW)，stats()并发读取
+        struct alignas(CACHE_LINE_SIZE) ReadCounters
+        {
+            std::atomic<std::uint64_t> hits{0};
+            std::atomic<std::uint64_t> misses{0};
+        };
+
+        struct alignas(CACHE_LINE_SIZE) Shard
+        {
+            std::mutex mutex;
+            std::unique_ptr<PolicyNode[]> nodes;
+            std::uint32_t free = kNil;
+            List window;
+            List probation;
+            List protect;
+            std::size_t window_capacity = 0;
+            std::size_t main_capacity = 0;
+            std::size_t protected_capacity = 0;
+            detail::FrequencySketch sketch;
+            std::atomic<std::uint64_t> evictions{0};
+            std::atomic<std::uint64_t> expirations{0};
+            ReadBuffer buffers[kStripes];
+        };
+
+    public:
+        struct Stats
+        {
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            std::uint64_t evictions = 0;
+            std::uint64_t expirations = 0;
+
+            double hit_ratio() const
+            {
+                const auto total = hits + misses;
+                return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+            }
+        };
+
+        /**
+         * @param capacity: 最多缓存的条目数，按分片均分
+         * @param shard_count: 分片数，向上取到2的幂但不超过capacity；为0时取硬件线程数的4倍，但保证每个分片至少64个条目
+         * @param domain: 底层哈希表的纪元回收域，生命周期需长于本缓存
+         */
+        explicit ConcurrentCache(std::size_t capacity,
+                                 std::size_t shard_count = 0,
+                                 EpochDomain &domain = EpochDomain::global(),
+                                 const Hash &hash = Hash(),
+                                 const KeyEqual &equal = KeyEqual())
+            : _map(pick_shard_count(capacity, shard_count), domain, hash, equal),
+              _id(memory::detail::ThreadCacheRegistry::instance().register_owner()), _hash(hash)
+        {
+            _capacity = std::max<std::size_t>(capacity, 1);
+            _shard_count = pick_shard_count(capacity, shard_count);
+            _shard_shift = static_cast<unsigned>(sizeof(std::uint64_t) * 8 - std::countr_zero(_shard_count));
+            _shards = std::make_unique<Shard[]>(_shard_count);
+            for (std::size_t i = 0; i < _shard_count; ++i)
+            {
+                // 余数分给前面的分片，总容量正好是capacity
+                const std::size_t per_shard = _capacity / _shard_count + (i < _capacity % _shard_count ? 1 : 0);
+                Shard &shard = _shards[i];
+                shard.window_capacity = std::max<std::size_t>(per_shard / 100, 1);
+                shard.main_capacity = per_shard - std::min(per_shard, shard.window_capacity);
+                shard.protected_capacity = shard.main_capacity * 4 / 5;
+                shard.sketch = detail::FrequencySketch(per_shard);
+                // 新节点先入窗口再挤出候选者，最多同时多占一个节点
+                shard.nodes = std::make_unique<PolicyNode[]>(per_shard + 1);
+                for (std::size_t n = 0; n < per_shard; ++n)
+                    shard.nodes[n].next = static_cast<std::uint32_t>(n + 1);
+                shard.free = 0;
+            }
+        }
+
+        ~ConcurrentCache()
+        {
+            // 注销后退出的线程不会再访问本缓存的计数
+            memory::detail::ThreadCacheRegistry::instance().unregister_owner(_id);
+        }
+
+        ConcurrentCache(const ConcurrentCache &) = delete;
+        ConcurrentCache &operator=(const ConcurrentCache &) = delete;
+
+        /**
+         * @brief: 无锁查找，命中时返回值的拷贝，过期的条目当作未命中并删除
+         */
+        std::optional<Value> get(const Key &key)
+        {
+            const std::uint64_t h = hash_of(key);
+            Shard &shard = shard_of(h);
+            std::optional<Value> result;
+            std::uint64_t record = 0;
+            bool expired = false;
+            _map.visit(key, [&](const Entry &entry)
+                       {
+                if (entry.expire_at != 0 && now() >= entry.expire_at) {
+                    expired = true;
+                    return;
+                }
+                result.emplace(entry.value);
+                record = (std::uint64_t(entry.node) << 32) | entry.gen; });
+
+            // 计数是线程私有的，不和其他读者争用缓存行
+            ReadCounters &counters = local_counters();
+            auto &counter = result ? counters.hits : counters.misses;
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (!result)
+            {
+                // 未命中也计入频率，候选者再被放进来时才能和淘汰对象比较
+                record = (std::uint64_t(kNil) << 32) | (static_cast<std::uint32_t>(h) & 0x7fffffffU);
+            }
+            ReadBuffer &buffer = shard.buffers[stripe()];
+            P_UNLIKELY if (expired)
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                remove_expired(shard, key);
+            }
+            if (buffer.offer(record) >= kBufferSize / 2 && shard.mutex.try_lock())
+            {
+                drain(shard);
+                shard.mutex.unlock();
+            }
+            return result;
+        }
+
+        /**
+         * @brief: 只判断是否存在且未过期，不影响淘汰顺序和统计
+         */
+        bool contains(const Key &key) const
+        {
+            bool alive = false;
+            _map.visit(key, [&](const Entry &entry)
+                       { alive = entry.expire_at == 0 || now() < entry.expire_at; });
+            return alive;
+        }
+
+        /**
+         * @brief: 插入或覆盖，ttl为0表示不过期；容量满时按W-TinyLFU淘汰
+         * @return: true表示新插入
+         */
+        template <typename V>
+        bool put(const Key &key, V &&value, std::chrono::nanoseconds ttl = std::chrono::nanoseconds::zero())
+        {
+            const std::uint64_t h = hash_of(key);
+            Shard &shard = shard_of(h);
+            const std::int64_t expire_at = ttl.count() > 0 ? now() + ttl.count() : 0;
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            drain(shard);
+
+            // 同一个键的写者都持这把锁，锁内看到的节点不会变
+            std::uint32_t node = kNil;
+            std::uint32_t gen = 0;
+            _map.visit(key, [&](const Entry &entry)
+                       {
+                node = entry.node;
+                gen = entry.gen; });
+            const auto hash = static_cast<std::uint32_t>(h) & 0x7fffffffU;
+            shard.sketch.increment(hash);
+            if (node != kNil)
+            {
+                _map.insert_or_assign(key, Entry{Value(std::forward<V>(value)), expire_at, node, gen});
+                on_access(shard, node);
+                return false;
+            }
+
+            // 先构造节点里的键再发布到_map，拷贝键或插入抛出时节点仍留在空闲链表上
+            node = shard.free;
+            PolicyNode &n = shard.nodes[node];
+            n.key.emplace(key);
+            try
+            {
+                _map.insert_or_assign(key, Entry{Value(std::forward<V>(value)), expire_at, node, n.gen});
+            }
+            catch (...)
+            {
+                n.key.reset();
+                throw;
+            }
+            shard.free = n.next;
+            n.hash = hash;
+            n.queue = Queue::Window;
+            push_front(shard, shard.window, node);
+            evict(shard);
+            return true;
+        }
+
+        /**
+         * @brief: 删除
+         * @return: 是否删除了条目
+         */
+        bool erase(const Key &key)
+        {
+            Shard &shard = shard_of(hash_of(key));
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            std::uint32_t node = kNil;
+            _map.visit(key, [&](const Entry &entry)
+                       { node = entry.node; });
+            if (node == kNil)
+                return false;
+            remove(shard, node);
+            return true;
+        }
+
+        void clear()
+        {
+            for (std::size_t i = 0; i < _shard_count; ++i)
+            {
+                Shard &shard = _shards[i];
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                drain(shard);
+                for (List *list : {&shard.window, &shard.probation, &shard.protect})
+                {
+                    while (list->tail != kNil)
+                        remove(shard, list->tail);
+                }
+            }
+        }
+
+        /**
+         * @brief: 把所有分片缓冲中的读记录应用到淘汰顺序上
+         */
+        void flush()
+        {
+            for (std::size_t i = 0; i < _shard_count; ++i)
+            {
+                std::lock_guard<std::mutex> lock(_shards[i].mutex);
+                drain(_shards[i]);
+            }
+        }
+
+        // 条目数，包括尚未被读到的过期条目
+        std::size_t size() const noexcept { return _map.size(); }
+        std::size_t capacity() const noexcept { return _capacity; }
+        std::size_t shard_count() const noexcept { return _shard_count; }
+
+        Stats stats() const
+        {
+            Stats result;
+            {
+                std::lock_guard<std::mutex> lock(_countersMutex);
+                for (const auto &counters : _counters)
+                {
+                    result.hits += counters->hits.load(std::memory_order_relaxed);
+                    result.misses += counters->misses.load(std::memory_order_relaxed);
+                }
+            }
+            for (std::size_t i = 0; i < _shard_count; ++i)
+            {
+                const Shard &shard = _shards[i];
+                result.evictions += shard.evictions.load(std::memory_order_relaxed);
+                result.expirations += shard.expirations.load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+
+    private:
+        static std::size_t pick_shard_count(std::size_t capacity, std::size_t shard_count)
+        {
+            if (shard_count == 0)
+            {
+                shard_count = std::bit_ceil(std::max<std::size_t>(std::thread::hardware_concurrency(), 1) * 4);
+                while (shard_count > 1 && capacity / shard_count < 64)
+                    shard_count /= 2;
+            }
+            // 每个分片至少要有一个条目，否则总容量会被抬高到分片数
+            return std::min(std::bit_ceil(shard_count), std::bit_floor(std::max<std::size_t>(capacity, 1)));
+        }
+
+        ReadCounters &local_counters()
+        {
+            void *counters = memory::detail::t_thread_caches.find(_id);
+            P_LIKELY if (counters != nullptr)
+            {
+                return *static_cast<ReadCounters *>(counters);
+            }
+            return local_counters_slow();
+        }
+
+        P_NOTINLINE ReadCounters &local_counters_slow()
+        {
+            ReadCounters *counters;
+            {
+                std::lock_guard<std::mutex> lock(_countersMutex);
+                if (!_idleCounters.empty())
+                {
+                    // 接着使用已退出线程的计数，累计值保持不变
+                    counters = _idleCounters.back();
+                    _idleCounters.pop_back();
+                }
+                else
+                {
+                    _counters.push_back(std::make_unique<ReadCounters>());
+                    counters = _counters.back().get();
+                }
+            }
+            memory::detail::t_thread_caches.add({_id, this, counters, &ConcurrentCache::release_counters});
+            return *counters;
+        }
+
+        // 线程退出时由登记表调用
+        static void release_counters(void *owner, void *counters)
+        {
+            auto *self = static_cast<ConcurrentCache *>(owner);
+            std::lock_guard<std::mutex> lock(self->_countersMutex);
+            self->_idleCounters.push_back(static_cast<ReadCounters *>(counters));
+        }
+
+        static std::int64_t now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        // 每个线程固定用一个条带，同一分片上不同线程的记录基本不会争同一个尾指针
+        static std::size_t stripe()
+        {
+            static std::atomic<std::size_t> next{0};
+            thread_local const std::size_t index = next.fetch_add(1, std::memory_order_relaxed) % kStripes;
+            return index;
+        }
+
+        // 与ConcurrentHashMap相同的fmix64，分片取高位，计数取低位
+        std::uint64_t hash_of(const Key &key) const
+        {
+            std::uint64_t h = static_cast<std::uint64_t>(_hash(key));
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        Shard &shard_of(std::uint64_t h) const noexcept
+        {
+            return _shards[_shard_count == 1 ? 0 : h >> _shard_shift];
+        }
+
+        void drain(Shard &shard)
+        {
+            for (auto &buffer : shard.buffers)
+            {
+                buffer.drain([&](std::uint64_t record)
+                             {
+                    const auto node = static_cast<std::uint32_t>(record >> 32);
+                    const auto low = static_cast<std::uint32_t>(record);
+                    if (node == kNil) {
+                        shard.sketch.increment(low);
+                        return;
+                    }
+                    // 节点已被淘汰或重用，这条记录作废
+                    PolicyNode &n = shard.nodes[node];
+                    if (n.gen != low || n.queue == Queue::Free)
+                        return;
+                    shard.sketch.increment(n.hash);
+                    on_access(shard, node); });
+            }
+        }
+
+        void on_access(Shard &shard, std::uint32_t node)
+        {
+            PolicyNode &n = shard.nodes[node];
+            switch (n.queue)
+            {
+            case Queue::Window:
+                unlink(shard, shard.window, node);
+                push_front(shard, shard.window, node);
+                break;
+            case Queue::Probation:
+                // 在主区被再次访问，升入保护区，保护区超额时把最久未用的降回试用区
+                unlink(shard, shard.probation, node);
+                n.queue = Queue::Protected;
+                push_front(shard, shard.protect, node);
+                if (shard.protect.size > shard.protected_capacity)
+                {
+                    const std::uint32_t demoted = shard.protect.tail;
+                    unlink(shard, shard.protect, demoted);
+                    shard.nodes[demoted].queue = Queue::Probation;
+                    push_front(shard, shard.probation, demoted);
+                }
+                break;
+            case Queue::Protected:
+                unlink(shard, shard.protect, node);
+                push_front(shard, shard.protect, node);
+                break;
+            case Queue::Free:
+                break;
+            }
+        }
+
+        // 窗口超额时，挤出的候选者与主区的淘汰对象比较频率，低者被淘汰
+        void evict(Shard &shard)
+        {
+            while (shard.window.size > shard.window_capacity)
+            {
+                const std::uint32_t candidate = shard.window.tail;
+                unlink(shard, shard.window, candidate);
+                if (shard.probation.size + shard.protect.size < shard.main_capacity)
+                {
+                    shard.nodes[candidate].queue = Queue::Probation;
+                    push_front(shard, shard.probation, candidate);
+                    continue;
+                }
+                const std::uint32_t victim = shard.probation.tail != kNil ? shard.probation.tail : shard.protect.tail;
+                if (victim != kNil &&
+                    shard.sketch.frequency(shard.nodes[candidate].hash) > shard.sketch.frequency(shard.nodes[victim].hash))
+                {
+                    remove(shard, victim);
+                    shard.nodes[candidate].queue = Queue::Probation;
+                    push_front(shard, shard.probation, candidate);
+                }
+                else
+                {
+                    // 候选者已经摘出窗口，不在任何队列里
+                    shard.nodes[candidate].queue = Queue::Free;
+                    remove(shard, candidate);
+                }
+                shard.evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void remove_expired(Shard &shard, const Key &key)
+        {
+            std::uint32_t node = kNil;
+            _map.visit(key, [&](const Entry &entry)
+                       {
+                if (entry.expire_at != 0 && now() >= entry.expire_at)
+                    node = entry.node; });
+            if (node == kNil)
+                return;
+            remove(shard, node);
+            shard.expirations.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // 从哈希表和所在队列中删除并回收节点
+        void remove(Shard &shard, std::uint32_t node)
+        {
+            PolicyNode &n = shard.nodes[node];
+            _map.erase(*n.key);
+            switch (n.queue)
+            {
+            case Queue::Window:
+                unlink(shard, shard.window, node);
+                break;
+            case Queue::Probation:
+                unlink(shard, shard.probation, node);
+                break;
+            case Queue::Protected:
+                unlink(shard, shard.protect, node);
+                break;
+            case Queue::Free:
+                break;
+            }
+            n.key.reset();
+            n.queue = Queue::Free;
+            ++n.gen;
+            n.next = shard.free;
+            shard.free = node;
+        }
+
+        void push_front(Shard &shard, List &list, std::uint32_t node)
+        {
+            PolicyNode &n = shard.nodes[node];
+            n.prev = kNil;
+            n.next = list.head;
+            if (list.head != kNil)
+                shard.nodes[list.head].prev = node;
+            else
+                list.tail = node;
+            list.head = node;
+            ++list.size;
+        }
+
+        void unlink(Shard &shard, List &list, std::uint32_t node)
+        {
+            PolicyNode &n = shard.nodes[node];
+            if (n.prev != kNil)
+                shard.nodes[n.prev].next = n.next;
+            else
+                list.head = n.next;
+            if (n.next != kNil)
+                shard.nodes[n.next].prev = n.prev;
+            else
+                list.tail = n.prev;
+            --list.size;
+        }
+
+        ConcurrentHashMap<Key, Entry, Hash, KeyEqual> _map;
+        std::unique_ptr<Shard[]> _shards;
+        std::size_t _shard_count = 1;
+        unsigned _shard_shift = 0;
+        std::size_t _capacity = 0;
+        const std::uint64_t _id; // 在线程缓存登记表中的id
+        mutable std::mutex _countersMutex; // 保护_counters和_idleCounters
+        std::vector<std::unique_ptr<ReadCounters>> _counters;
+        std::vector<ReadCounters *> _idleCounters;
+        Hash _hash;
+    };
+
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_CONCURRENT_CACHE_HPP_
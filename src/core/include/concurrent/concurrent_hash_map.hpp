@@ -0,0 +1,446 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-21 15:05:32
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-21 15:05:32
+ * @FilePath: \plib\src\core\include\concurrent\concurrent_hash_map.hpp
+ * @Description: 分片并发哈希表，每个分片是一张线性探测的开放寻址表，写者持分片锁，读者借助纪元回收无锁读取
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_CONCURRENT_HASH_MAP_HPP_
+#define PLIB_CORE_CONCURRENT_CONCURRENT_HASH_MAP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "plib_macros.hpp"
+#include "concurrent/epoch.hpp"
+
+namespace plib::core::concurrent
+{
+    /**
+     * @brief: 用来替换LockedRW<std::unordered_map>/mutex+unordered_map这类全局一把锁的哈希表
+     * 键按哈希高位分到2的幂个分片，每个分片独占缓存行，只有写同一分片的线程之间会竞争;
+     * 槽位里存的是不可变节点的原子指针，更新值时换一个新节点，旧节点和扩容后的旧表交给纪元回收域延迟释放，
+     * 所以读者不加锁、不写任何共享缓存行，读吞吐随线程数线性增长。
+     * 遍历是弱一致的：能看到遍历开始前已完成的写入，遍历期间的并发写入可能看到也可能看不到。
+     */
+    template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class ConcurrentHashMap
+    {
+        struct Node
+        {
+            template <typename K, typename... Args>
+            Node(std::size_t h, K &&k, Args &&...args)
+                : hash(h), key(std::forward<K>(k)), value(std::forward<Args>(args)...)
+            {
+            }
+
+            const std::size_t hash;
+            const Key key;
+            const Value value;
+        };
+
+        // 槽位表，只负责槽位数组本身，节点的生命周期由分片管理
+        struct Table
+        {
+            explicit Table(std::size_t capacity)
+                : mask(capacity - 1), slots(new std::atomic<Node *>[capacity])
+            {
+                for (std::size_t i = 0; i < capacity; ++i)
+                    slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+
+            std::size_t capacity() const noexcept { return mask + 1; }
+
+            const std::size_t mask;
+            std::unique_ptr<std::atomic<Node *>[]> slots;
+        };
+
+        struct alignas(CACHE_LINE_SIZE) Shard
+        {
+            std::atomic<Table *> table{nullptr};
+            std::mutex mutex;
+            std::atomic<std::size_t> size{0}; // 只在持锁时修改，size()无锁读取
+            std::size_t used = 0;             // 有效节点+墓碑，决定何时重建
+        };
+
+        static constexpr std::size_t kMinCapacity = 8;
+
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+        using size_type = std::size_t;
+
+        /**
+         * @param shard_count: 分片数，向上取到2的幂，为0时取硬件线程数的4倍
+         * @param domain: 回收被替换节点和旧表的纪元域，生命周期需长于本表
+         */
+        explicit ConcurrentHashMap(std::size_t shard_count = 0,
+                                   EpochDomain &domain = EpochDomain::global(),
+                                   const Hash &hash = Hash(),
+                                   const KeyEqual &equal = KeyEqual())
+            : _domain(&domain), _hash(hash), _equal(equal)
+        {
+            if (shard_count == 0)
+                shard_count = std::max<std::size_t>(std::thread::hardware_concurrency(), 1) * 4;
+            shard_count = std::bit_ceil(shard_count);
+            _shard_count = shard_count;
+            _shard_shift = static_cast<unsigned>(sizeof(std::size_t) * 8 - std::countr_zero(shard_count));
+            _shards = std::make_unique<Shard[]>(shard_count);
+            for (std::size_t i = 0; i < shard_count; ++i)
+                _shards[i].table.store(new Table(kMinCapacity), std::memory_order_relaxed);
+        }
+
+        // 析构时直接释放所有节点，调用者需保证已没有读者
+        ~ConcurrentHashMap()
+        {
+            for (std::size_t i = 0; i < _shard_count; ++i)
+            {
+                Table *table = _shards[i].table.load(std::memory_order_relaxed);
+                for (std::size_t j = 0; j < table->capacity(); ++j)
+                {
+                    Node *node = table->slots[j].load(std::memory_order_relaxed);
+                    if (is_live(node))
+                        delete node;
+                }
+                delete table;
+            }
+        }
+
+        ConcurrentHashMap(const ConcurrentHashMap &) = delete;
+        ConcurrentHashMap &operator=(const ConcurrentHashMap &) = delete;
+
+        /**
+         * @brief: 无锁查找，返回值的拷贝
+         */
+        std::optional<Value> find(const Key &key) const
+        {
+            std::optional<Value> result;
+            visit(key, [&result](const Value &value)
+                  { result.emplace(value); });
+            return result;
+        }
+
+        bool contains(const Key &key) const
+        {
+            return visit(key, [](const Value &) {});
+        }
+
+        /**
+         * @brief: 无锁查找，命中时在临界区内以const Value&调用func，避免拷贝大对象
+         * func中不能再对本表做写操作，也不能保留value的引用
+         * @return: 是否命中
+         */
+        template <typename Func>
+        bool visit(const Key &key, Func &&func) const
+        {
+            const std::size_t h = hash_of(key);
+            EpochDomain::Guard guard(*_domain);
+            const Node *node = lookup(shard_of(h).table.load(std::memory_order_acquire), h, key);
+            if (!node)
+                return false;
+            std::forward<Func>(func)(node->value);
+            return true;
+        }
+
+        /**
+         * @brief: 插入或覆盖
+         * @return: true表示新插入，false表示覆盖了已有的值
+         */
+        template <typename V>
+        bool insert_or_assign(const Key &key, V &&value)
+        {
+            const std::size_t h = hash_of(key);
+            Node *node = new Node(h, key, std::forward<V>(value));
+            Shard &shard = shard_of(h);
+            Node *old = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                old = publish(shard, node, true);
+            }
+            if (old)
+                _domain->retire(old);
+            return old == nullptr;
+        }
+
+        /**
+         * @brief: 键不存在时插入，已存在时不做任何事
+         * @return: 是否插入
+         */
+        template <typename... Args>
+        bool try_emplace(const Key &key, Args &&...args)
+        {
+            if (contains(key))
+                return false;
+            const std::size_t h = hash_of(key);
+            Shard &shard = shard_of(h);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (lookup(shard.table.load(std::memory_order_relaxed), h, key))
+                return false;
+            publish(shard, new Node(h, key, std::forward<Args>(args)...), false);
+            return true;
+        }
+
+        /**
+         * @brief: 键存在时直接返回当前值，不存在时在分片锁内调用factory()构造并插入
+         * 同一个键并发调用时factory只会被执行一次，但它会阻塞同分片上的其他写者，不宜过慢
+         */
+        template <typename Factory>
+        Value compute_if_absent(const Key &key, Factory &&factory)
+        {
+            if (auto existing = find(key))
+                return std::move(*existing);
+            const std::size_t h = hash_of(key);
+            Shard &shard = shard_of(h);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            // 持锁后节点不会被其他写者替换或释放，可以直接拷贝
+            if (const Node *node = lookup(shard.table.load(std::memory_order_relaxed), h, key))
+                return node->value;
+            Node *node = new Node(h, key, std::forward<Factory>(factory)());
+            publish(shard, node, false);
+            return node->value;
+        }
+
+        /**
+         * @brief: 删除
+         * @return: 是否删除了元素
+         */
+        bool erase(const Key &key)
+        {
+            const std::size_t h = hash_of(key);
+            Shard &shard = shard_of(h);
+            Node *old = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                Table *table = shard.table.load(std::memory_order_relaxed);
+                for (std::size_t i = h & table->mask;; i = (i + 1) & table->mask)
+                {
+                    Node *node = table->slots[i].load(std::memory_order_relaxed);
+                    if (!node)
+                        return false;
+                    if (node != tombstone() && node->hash == h && _equal(node->key, key))
+                    {
+                        // 墓碑保证探测链不断，读者会越过它继续向后找
+                        table->slots[i].store(tombstone(), std::memory_order_release);
+                        shard.size.store(shard.size.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+                        old = node;
+                        break;
+                    }
+                }
+            }
+            _domain->retire(old);
+            return true;
+        }
+
+        /**
+         * @brief: 清空所有分片，旧节点交给回收域
+         */
+        void clear()
+        {
+            for (std::size_t i = 0; i < _shard_count; ++i)
+            {
+                Shard &shard = _shards[i];
+                Table *old = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(shard.mutex);
+                    old = shard.table.exchange(new Table(kMinCapacity), std::memory_order_acq_rel);
+                    shard.size.store(0, std::memory_order_relaxed);
+                    shard.used = 0;
+                }
+                for (std::size_t j = 0; j < old->capacity(); ++j)
+                {
+                    Node *node = old->slots[j].load(std::memory_order_relaxed);
+                    if (is_live(node))
+                        _domain->retire(node);
+                }
+                _domain->retire(old);
+            }
+        }
+
+        /**
+         * @brief: 元素个数，并发写入时只是一个近似值
+         */
+        std::size_t size() const noexcept
+        {
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < _shard_count; ++i)
+                n += _shards[i].size.load(std::memory_order_relaxed);
+            return n;
+        }
+
+        bool empty() const noexcept { return size() == 0; }
+
+        std::size_t shard_count() const noexcept { return _shard_count; }
+
+        /**
+         * @brief: 逐个分片无锁遍历，对每个元素调用func(const Key&, const Value&)
+         */
+        template <typename Func>
+        void for_each(Func &&func) const
+        {
+            for (std::size_t i = 0; i < _shard_count; ++i)
+                for_each_in_shard(i, func);
+        }
+
+        /**
+         * @brief: 按分片切块交给线程池并行遍历，阻塞到全部完成，func会被多个线程同时调用
+         * pool需要提供submit_loop(first, last, loop)并返回可get()的结果，例如concurrent::thread_pool
+         */
+        template <typename Pool, typename Func>
+        void for_each(Pool &pool, Func &&func) const
+        {
+            pool.submit_loop(std::size_t{0}, _shard_count, [this, &func](std::size_t i)
+                             { for_each_in_shard(i, func); })
+                .get();
+        }
+
+    private:
+        // 用一个永不解引用的地址标记被删除的槽位
+        static Node *tombstone() noexcept
+        {
+            static constinit char marker = 0;
+            return reinterpret_cast<Node *>(&marker);
+        }
+
+        static bool is_live(const Node *node) noexcept
+        {
+            return node != nullptr && node != tombstone();
+        }
+
+        // 标准库的std::hash对整数是恒等映射，分片用高位、槽位用低位，两者都需要混合均匀
+        std::size_t hash_of(const Key &key) const
+        {
+            std::uint64_t h = static_cast<std::uint64_t>(_hash(key));
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return static_cast<std::size_t>(h);
+        }
+
+        Shard &shard_of(std::size_t h) const noexcept
+        {
+            return _shards[_shard_count == 1 ? 0 : h >> _shard_shift];
+        }
+
+        const Node *lookup(const Table *table, std::size_t h, const Key &key) const
+        {
+            for (std::size_t i = h & table->mask;; i = (i + 1) & table->mask)
+            {
+                const Node *node = table->slots[i].load(std::memory_order_acquire);
+                if (!node)
+                    return nullptr;
+                if (node != tombstone() && node->hash == h && _equal(node->key, key))
+                    return node;
+            }
+        }
+
+        template <typename Func>
+        void for_each_in_shard(std::size_t index, Func &func) const
+        {
+            EpochDomain::Guard guard(*_domain);
+            const Table *table = _shards[index].table.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < table->capacity(); ++i)
+            {
+                const Node *node = table->slots[i].load(std::memory_order_acquire);
+                if (is_live(node))
+                    func(node->key, node->value);
+            }
+        }
+
+        /**
+         * @brief: 持分片锁时把节点放进表里
+         * @param replace: 键已存在时是否替换，替换时返回旧节点；调用者已确认键不存在时传false
+         */
+        Node *publish(Shard &shard, Node *node, bool replace)
+        {
+            Table *table = shard.table.load(std::memory_order_relaxed);
+            std::atomic<Node *> *reuse = nullptr;
+            std::size_t i = node->hash & table->mask;
+            for (;; i = (i + 1) & table->mask)
+            {
+                Node *current = table->slots[i].load(std::memory_order_relaxed);
+                if (!current)
+                    break;
+                if (current == tombstone())
+                {
+                    if (!reuse)
+                        reuse = &table->slots[i];
+                    if (!replace)
+                        break;
+                }
+                else if (replace && current->hash == node->hash && _equal(current->key, node->key))
+                {
+                    table->slots[i].store(node, std::memory_order_release);
+                    return current;
+                }
+            }
+            if (reuse)
+            {
+                reuse->store(node, std::memory_order_release);
+            }
+            else
+            {
+                // 墓碑也占探测链，有效节点+墓碑超过3/4时重建
+                if ((shard.used + 1) * 4 > table->capacity() * 3)
+                {
+                    table = rebuild(shard, table);
+                    for (i = node->hash & table->mask; table->slots[i].load(std::memory_order_relaxed); i = (i + 1) & table->mask)
+                    {
+                    }
+                }
+                table->slots[i].store(node, std::memory_order_release);
+                ++shard.used;
+            }
+            shard.size.store(shard.size.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        // 按有效节点数重新分配并发布新表，墓碑较多时容量不变只做清理
+        Table *rebuild(Shard &shard, Table *old)
+        {
+            const std::size_t live = shard.size.load(std::memory_order_relaxed);
+            std::size_t capacity = old->capacity();
+            if ((live + 1) * 2 > capacity)
+                capacity *= 2;
+            Table *table = new Table(capacity);
+            for (std::size_t j = 0; j < old->capacity(); ++j)
+            {
+                Node *node = old->slots[j].load(std::memory_order_relaxed);
+                if (!is_live(node))
+                    continue;
+                std::size_t i = node->hash & table->mask;
+                while (table->slots[i].load(std::memory_order_relaxed))
+                    i = (i + 1) & table->mask;
+                table->slots[i].store(node, std::memory_order_relaxed);
+            }
+            shard.used = live;
+            // 新表内容在发布前已全部写好，release发布后读者看到的是完整的表
+            shard.table.store(table, std::memory_order_release);
+            _domain->retire(old);
+            return table;
+        }
+
+        EpochDomain *_domain;
+        std::unique_ptr<Shard[]> _shards;
+        std::size_t _shard_count = 0;
+        unsigned _shard_shift = 0;
+        PLIB_NO_UNIQUE_ADDRESS Hash _hash;
+        PLIB_NO_UNIQUE_ADDRESS KeyEqual _equal;
+    };
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_CONCURRENT_HASH_MAP_HPP_
@@ -0,0 +1,499 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-19 10:02:11
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-19 10:02:11
+ * @FilePath: \plib\src\core\include\concurrent\epoch.hpp
+ * @Description: 基于纪元(epoch)的内存回收域，读者进出临界区只需一次store+fence，
+ *               被摘除的对象按批次延迟释放，直到所有线程都越过了它被摘除时的纪元
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_EPOCH_HPP_
+#define PLIB_CORE_CONCURRENT_EPOCH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "plib_macros.hpp"
+
+namespace plib::core::concurrent
+{
+    class EpochDomain;
+
+    namespace detail
+    {
+        // 一个待回收的对象
+        struct EpochRetired
+        {
+            void *ptr;
+            void (*deleter)(void *);
+        };
+
+        // 线程在某个回收域中的记录，缓存行对齐避免不同线程的记录伪共享
+        struct alignas(CACHE_LINE_SIZE) EpochRecord
+        {
+            static constexpr uint64_t kInactive = ~uint64_t(0);
+
+            std::atomic<uint64_t> epoch{kInactive}; // 进入临界区时观察到的全局纪元，不在临界区时为kInactive
+            std::atomic<bool> in_use{false};        // 是否被某个线程占用，线程退出后记录可被复用
+            std::atomic<EpochRecord *> next{nullptr};
+            uint32_t nesting = 0;               // 临界区嵌套层数，仅拥有者线程访问
+            std::vector<EpochRetired> retired;  // 本线程尚未提交给域的待回收对象，仅拥有者线程访问
+        };
+
+        // 存活的回收域，线程退出时据此判断记录是否还能归还
+        struct EpochRegistry
+        {
+            std::mutex mutex;
+            std::unordered_set<uint64_t> live;
+            uint64_t next_id = 1;
+
+            static EpochRegistry &instance()
+            {
+                // 故意泄漏，保证晚于所有thread_local析构
+                static EpochRegistry *registry = new EpochRegistry();
+                return *registry;
+            }
+        };
+
+        // 线程私有的 域id -> 记录 映射，通常只有一两项
+        struct EpochThreadCache
+        {
+            struct Entry
+            {
+                uint64_t domain_id;
+                EpochDomain *domain;
+                EpochRecord *record;
+            };
+            std::vector<Entry> entries;
+
+            ~EpochThreadCache();
+        };
+
+        inline thread_local EpochThreadCache t_epoch_cache;
+    } // namespace detail
+
+    /**
+     * @brief: 纪元回收域
+     * 读者通过pin()/enter()进入临界区，在临界区内可以安全地访问共享指针;
+     * 写者把对象从共享结构中摘除后调用retire()，对象在全局纪元前进两次之后才会被释放。
+     * 每个线程先把retire的对象攒在本地缓冲，攒够batch_size个之后打包提交给域，
+     * 回收可以在写者线程上顺带完成，也可以通过reclaim_on()交给线程池中的线程执行。
+     */
+    class EpochDomain
+    {
+    public:
+        /**
+         * @brief: 临界区守卫，析构时离开临界区，只能在创建它的线程上析构
+         */
+        class Guard
+        {
+        public:
+            Guard() = default;
+            explicit Guard(EpochDomain &domain) : _domain(&domain), _record(domain._local())
+            {
+                _domain->_enter(_record);
+            }
+            Guard(Guard &&other) noexcept
+                : _domain(std::exchange(other._domain, nullptr)), _record(std::exchange(other._record, nullptr)) {}
+            Guard &operator=(Guard &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    release();
+                    _domain = std::exchange(other._domain, nullptr);
+                    _record = std::exchange(other._record, nullptr);
+                }
+                return *this;
+            }
+            Guard(const Guard &) = delete;
+            Guard &operator=(const Guard &) = delete;
+            ~Guard() { release(); }
+
+            // 提前离开临界区
+            void release()
+            {
+                if (_domain)
+                {
+                    _domain->_leave(_record);
+                    _domain = nullptr;
+                    _record = nullptr;
+                }
+            }
+
+        private:
+            EpochDomain *_domain = nullptr;
+            detail::EpochRecord *_record = nullptr;
+        };
+
+        /**
+         * @param batch_size: 每个线程本地攒够多少个待回收对象后提交一次
+         */
+        explicit EpochDomain(std::size_t batch_size = 64);
+
+        /**
+         * @brief: 析构时直接释放所有待回收对象，调用者需保证此时已没有读者
+         */
+        ~EpochDomain();
+
+        EpochDomain(const EpochDomain &) = delete;
+        EpochDomain &operator=(const EpochDomain &) = delete;
+
+        // 进程级默认回收域
+        static EpochDomain &global();
+
+        Guard pin() { return Guard(*this); }
+
+        // 手动进出临界区，可嵌套，必须成对调用
+        void enter() { _enter(_local()); }
+        void leave() { _leave(_local()); }
+        bool in_critical_section() { return _local()->nesting > 0; }
+
+        /**
+         * @brief: 延迟delete一个已经从共享结构中摘除的对象
+         */
+        template <typename T>
+        void retire(T *p)
+        {
+            retire(static_cast<void *>(p), [](void *q)
+                   { delete static_cast<T *>(q); });
+        }
+
+        /**
+         * @brief: 延迟调用deleter释放一个已经从共享结构中摘除的对象
+         */
+        void retire(void *p, void (*deleter)(void *));
+
+        // 把当前线程本地缓冲中的对象提交给域
+        void flush();
+
+        // 所有活跃线程都已观察到当前纪元时，把全局纪元加一
+        bool try_advance();
+
+        /**
+         * @brief: 释放所有已安全的批次
+         * @return: 本次释放的对象数
+         */
+        std::size_t reclaim();
+
+        /**
+         * @brief: 阻塞直到当前线程在调用前retire的对象全部被释放，不能在临界区内调用
+         */
+        void synchronize();
+
+        /**
+         * @brief: 设置回收执行器，设置后提交批次时不再在写者线程上回收，而是把回收任务交给执行器
+         */
+        void set_reclaim_executor(std::function<void(std::function<void()>)> executor);
+
+        /**
+         * @brief: 在plib线程池上执行回收，pool需要提供execute(std::function<void()>&&)，且生命周期长于本域
+         */
+        template <typename Pool>
+        void reclaim_on(Pool &pool)
+        {
+            set_reclaim_executor([&pool](std::function<void()> task)
+                                 { pool.execute(std::move(task)); });
+        }
+
+        uint64_t epoch() const { return _epoch.load(std::memory_order_acquire); }
+
+        // 已retire但尚未释放的对象数(包括各线程本地缓冲中的)
+        std::size_t pending() const { return _pending.load(std::memory_order_relaxed); }
+
+    private:
+        friend struct detail::EpochThreadCache;
+
+        struct Batch
+        {
+            uint64_t epoch; // 提交时的全局纪元，全局纪元 >= epoch + 2 时可以释放
+            std::vector<detail::EpochRetired> items;
+        };
+
+        detail::EpochRecord *_local();
+        detail::EpochRecord *_acquire_record();
+        void _release_record(detail::EpochRecord *record);
+        void _enter(detail::EpochRecord *record);
+        void _leave(detail::EpochRecord *record);
+        void _submit(std::vector<detail::EpochRetired> &&items);
+        void _schedule_reclaim();
+        static void _free(std::vector<detail::EpochRetired> &items);
+
+        const uint64_t _id;
+        const std::size_t _batch_size;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> _epoch{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<detail::EpochRecord *> _records{nullptr};
+        std::atomic<std::size_t> _pending{0};
+        mutable std::mutex _mutex; // 保护_batches和_executor
+        std::vector<Batch> _batches;
+        std::function<void(std::function<void()>)> _executor;
+        std::atomic<bool> _reclaim_scheduled{false};
+        std::atomic<std::size_t> _inflight{0}; // 执行器中尚未结束的回收任务数
+    };
+
+    inline EpochDomain::EpochDomain(std::size_t batch_size)
+        : _id([]
+              {
+                  auto &registry = detail::EpochRegistry::instance();
+                  std::lock_guard<std::mutex> lock(registry.mutex);
+                  uint64_t id = registry.next_id++;
+                  registry.live.insert(id);
+                  return id; }()),
+          _batch_size(batch_size == 0 ? 1 : batch_size)
+    {
+    }
+
+    inline EpochDomain::~EpochDomain()
+    {
+        // 等待执行器中的回收任务结束
+        while (_inflight.load(std::memory_order_acquire) != 0)
+            std::this_thread::yield();
+
+        {
+            auto &registry = detail::EpochRegistry::instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.live.erase(_id);
+        }
+
+        for (auto &batch : _batches)
+            _free(batch.items);
+        _batches.clear();
+
+        auto *record = _records.load(std::memory_order_acquire);
+        while (record != nullptr)
+        {
+            auto *next = record->next.load(std::memory_order_relaxed);
+            _free(record->retired);
+            delete record;
+            record = next;
+        }
+    }
+
+    inline EpochDomain &EpochDomain::global()
+    {
+        // 故意泄漏，避免与thread_local析构顺序冲突
+        static EpochDomain *domain = new EpochDomain();
+        return *domain;
+    }
+
+    inline detail::EpochRecord *EpochDomain::_local()
+    {
+        auto &cache = detail::t_epoch_cache;
+        for (auto &entry : cache.entries)
+        {
+            P_LIKELY if (entry.domain_id == _id)
+            {
+                return entry.record;
+            }
+        }
+        auto *record = _acquire_record();
+        cache.entries.push_back({_id, this, record});
+        return record;
+    }
+
+    inline detail::EpochRecord *EpochDomain::_acquire_record()
+    {
+        // 优先复用已退出线程留下的记录
+        for (auto *record = _records.load(std::memory_order_acquire); record != nullptr;
+             record = record->next.load(std::memory_order_acquire))
+        {
+            bool expected = false;
+            if (!record->in_use.load(std::memory_order_relaxed) &&
+                record->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+            {
+                return record;
+            }
+        }
+        // 记录只增不删，头插法无锁加入链表
+        auto *record = new detail::EpochRecord();
+        record->in_use.store(true, std::memory_order_relaxed);
+        auto *head = _records.load(std::memory_order_relaxed);
+        do
+        {
+            record->next.store(head, std::memory_order_relaxed);
+        } while (!_records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+        return record;
+    }
+
+    inline void EpochDomain::_release_record(detail::EpochRecord *record)
+    {
+        if (!record->retired.empty())
+            _submit(std::move(record->retired));
+        record->retired = {};
+        record->nesting = 0;
+        record->epoch.store(detail::EpochRecord::kInactive, std::memory_order_release);
+        record->in_use.store(false, std::memory_order_release);
+    }
+
+    P_FORCE_INLINE void EpochDomain::_enter(detail::EpochRecord *record)
+    {
+        if (record->nesting++ == 0)
+        {
+            record->epoch.store(_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            // 保证写者扫描记录时能看到本线程已进入临界区，之后再读取共享指针
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    P_FORCE_INLINE void EpochDomain::_leave(detail::EpochRecord *record)
+    {
+        assert(record->nesting > 0);
+        if (--record->nesting == 0)
+        {
+            record->epoch.store(detail::EpochRecord::kInactive, std::memory_order_release);
+        }
+    }
+
+    inline void EpochDomain::retire(void *p, void (*deleter)(void *))
+    {
+        if (p == nullptr)
+            return;
+        auto *record = _local();
+        record->retired.push_back({p, deleter});
+        _pending.fetch_add(1, std::memory_order_relaxed);
+        if (record->retired.size() >= _batch_size)
+            flush();
+    }
+
+    inline void EpochDomain::flush()
+    {
+        auto *record = _local();
+        if (record->retired.empty())
+            return;
+        std::vector<detail::EpochRetired> items;
+        items.swap(record->retired);
+        items.reserve(_batch_size);
+        record->retired.reserve(_batch_size);
+        _submit(std::move(items));
+    }
+
+    inline void EpochDomain::_submit(std::vector<detail::EpochRetired> &&items)
+    {
+        // 摘除操作先于读取纪元，批次的纪元不会早于其中任何一个对象被摘除时的纪元
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool has_executor;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _batches.push_back({_epoch.load(std::memory_order_acquire), std::move(items)});
+            has_executor = static_cast<bool>(_executor);
+        }
+        if (has_executor)
+            _schedule_reclaim();
+        else
+            reclaim();
+    }
+
+    inline bool EpochDomain::try_advance()
+    {
+        const uint64_t current = _epoch.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (auto *record = _records.load(std::memory_order_acquire); record != nullptr;
+             record = record->next.load(std::memory_order_acquire))
+        {
+            const uint64_t e = record->epoch.load(std::memory_order_acquire);
+            if (e != detail::EpochRecord::kInactive && e != current)
+                return false;
+        }
+        uint64_t expected = current;
+        return _epoch.compare_exchange_strong(expected, current + 1, std::memory_order_acq_rel) || expected > current;
+    }
+
+    inline std::size_t EpochDomain::reclaim()
+    {
+        std::vector<Batch> ready;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_batches.empty())
+                return 0;
+            // 一次回收最多推进两次纪元，刚提交的批次也有机会被释放
+            if (try_advance())
+                try_advance();
+            const uint64_t current = _epoch.load(std::memory_order_acquire);
+            auto it = std::partition(_batches.begin(), _batches.end(), [current](const Batch &batch)
+                                     { return batch.epoch + 2 > current; });
+            std::move(it, _batches.end(), std::back_inserter(ready));
+            _batches.erase(it, _batches.end());
+        }
+        std::size_t count = 0;
+        for (auto &batch : ready)
+        {
+            count += batch.items.size();
+            _free(batch.items);
+        }
+        _pending.fetch_sub(count, std::memory_order_relaxed);
+        return count;
+    }
+
+    inline void EpochDomain::synchronize()
+    {
+        assert(!in_critical_section() && "synchronize() inside a critical section would never return");
+        flush();
+        const uint64_t target = _epoch.load(std::memory_order_acquire) + 2;
+        while (_epoch.load(std::memory_order_acquire) < target)
+        {
+            if (!try_advance())
+                std::this_thread::yield();
+        }
+        reclaim();
+    }
+
+    inline void EpochDomain::set_reclaim_executor(std::function<void(std::function<void()>)> executor)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _executor = std::move(executor);
+    }
+
+    inline void EpochDomain::_schedule_reclaim()
+    {
+        // 同一时刻只挂一个回收任务，避免提交风暴
+        if (_reclaim_scheduled.exchange(true, std::memory_order_acq_rel))
+            return;
+        std::function<void(std::function<void()>)> executor;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            executor = _executor;
+        }
+        if (!executor)
+        {
+            _reclaim_scheduled.store(false, std::memory_order_release);
+            reclaim();
+            return;
+        }
+        _inflight.fetch_add(1, std::memory_order_acq_rel);
+        executor([this]
+                 {
+                     _reclaim_scheduled.store(false, std::memory_order_release);
+                     reclaim();
+                     _inflight.fetch_sub(1, std::memory_order_acq_rel); });
+    }
+
+    inline void EpochDomain::_free(std::vector<detail::EpochRetired> &items)
+    {
+        for (auto &item : items)
+            item.deleter(item.ptr);
+        items.clear();
+    }
+
+    inline detail::EpochThreadCache::~EpochThreadCache()
+    {
+        auto &registry = EpochRegistry::instance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (auto &entry : entries)
+        {
+            if (registry.live.count(entry.domain_id) != 0)
+                entry.domain->_release_record(entry.record);
+        }
+    }
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_EPOCH_HPP_
@@ -0,0 +1,138 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-19 16:18:25
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-19 16:18:25
+ * @FilePath: \plib\src\core\include\concurrent\eventcount.hpp
+ * @Description: 基于futex的事件计数器，让无锁结构的消费者在没有数据时睡眠，生产者在无人等待时只付出一次原子读
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_EVENTCOUNT_HPP_
+#define PLIB_CORE_CONCURRENT_EVENTCOUNT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include "plib_macros.hpp"
+#include "concurrent/futex.hpp"
+
+namespace plib::core::concurrent
+{
+    /**
+     * @brief: 事件计数器(eventcount)
+     * 等待方的标准用法:
+     *   for (;;) {
+     *       if (try_consume()) break;
+     *       auto key = ec.prepare_wait();
+     *       if (try_consume()) { ec.cancel_wait(); break; }
+     *       ec.commit_wait(key);
+     *   }
+     * 通知方在让条件成立(如入队)之后调用notify()。
+     * prepare_wait登记等待者并记下当前纪元，notify只在有等待者时推进纪元并执行futex唤醒，
+     * 因此二次检查与notify之间不会丢失唤醒。
+     */
+    class EventCount
+    {
+    public:
+        class Key
+        {
+            friend class EventCount;
+            explicit Key(std::uint32_t epoch) noexcept : _epoch(epoch) {}
+            std::uint32_t _epoch;
+        };
+
+        EventCount() = default;
+        EventCount(const EventCount &) = delete;
+        EventCount &operator=(const EventCount &) = delete;
+
+        /**
+         * @brief: 登记为等待者，之后必须调用commit_wait或cancel_wait之一
+         */
+        Key prepare_wait() noexcept
+        {
+            _waiters.fetch_add(1, std::memory_order_seq_cst);
+            return Key(_epoch.load(std::memory_order_seq_cst));
+        }
+
+        // 二次检查发现条件已满足，放弃等待
+        void cancel_wait() noexcept
+        {
+            _waiters.fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        // 睡眠直到prepare_wait之后有notify发生
+        void commit_wait(Key key) noexcept
+        {
+            while (_epoch.load(std::memory_order_acquire) == key._epoch)
+                futex_wait(&_epoch, key._epoch);
+            _waiters.fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        /**
+         * @brief: 带超时的commit_wait，超时返回false，被通知返回true
+         */
+        template <typename Rep, typename Period>
+        bool commit_wait_for(Key key, const std::chrono::duration<Rep, Period> &timeout) noexcept
+        {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            bool notified = true;
+            while (_epoch.load(std::memory_order_acquire) == key._epoch)
+            {
+                if (!futex_wait_until(&_epoch, key._epoch, deadline))
+                {
+                    notified = _epoch.load(std::memory_order_acquire) != key._epoch;
+                    break;
+                }
+            }
+            _waiters.fetch_sub(1, std::memory_order_seq_cst);
+            return notified;
+        }
+
+        // 唤醒一个等待者，无人等待时只有一次fence和原子读
+        void notify() noexcept { _notify(1); }
+        void notify_all() noexcept { _notify(-1); }
+
+        /**
+         * @brief: 阻塞直到pred()为真，pred需要是幂等的检查(若有副作用，成功时只能执行一次)
+         */
+        template <typename Pred>
+        void await(Pred &&pred)
+        {
+            for (;;)
+            {
+                if (pred())
+                    return;
+                auto key = prepare_wait();
+                if (pred())
+                {
+                    cancel_wait();
+                    return;
+                }
+                commit_wait(key);
+            }
+        }
+
+        std::size_t waiters() const noexcept { return _waiters.load(std::memory_order_relaxed); }
+
+    private:
+        void _notify(int count) noexcept
+        {
+            // 与prepare_wait中的seq_cst配对：要么这里看到等待者，要么等待者的二次检查看到新数据
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (_waiters.load(std::memory_order_seq_cst) == 0)
+                return;
+            _epoch.fetch_add(1, std::memory_order_release);
+            if (count < 0)
+                futex_wake_all(&_epoch);
+            else
+                futex_wake(&_epoch, count);
+        }
+
+        alignas(CACHE_LINE_SIZE) std::atomic<std::uint32_t> _epoch{0};
+        std::atomic<std::uint32_t> _waiters{0};
+    };
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_EVENTCOUNT_HPP_
@@ -0,0 +1,87 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-19 16:02:41
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-19 16:02:41
+ * @FilePath: \plib\src\core\include\concurrent\futex.hpp
+ * @Description: 32位原子变量上的等待/唤醒，Linux直接使用futex系统调用，其他平台退化为std::atomic::wait
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_FUTEX_HPP_
+#define PLIB_CORE_CONCURRENT_FUTEX_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace plib::core::concurrent
+{
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex word must be 32 bits");
+
+    /**
+     * @brief: 若*addr仍等于expected则睡眠，直到被唤醒(可能虚假唤醒)，调用者需在循环中重新检查条件
+     */
+    inline void futex_wait(std::atomic<std::uint32_t> *addr, std::uint32_t expected) noexcept
+    {
+#if defined(__linux__)
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(addr), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+        addr->wait(expected, std::memory_order_acquire);
+#endif
+    }
+
+    /**
+     * @brief: 带超时的等待，到达deadline返回false，其余情况(被唤醒、值已改变、虚假唤醒)返回true
+     */
+    template <typename Clock, typename Duration>
+    bool futex_wait_until(std::atomic<std::uint32_t> *addr, std::uint32_t expected,
+                          const std::chrono::time_point<Clock, Duration> &deadline) noexcept
+    {
+        auto remaining = deadline - Clock::now();
+        if (remaining <= Duration::zero())
+            return false;
+#if defined(__linux__)
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        // FUTEX_WAIT的超时是相对时间
+        long rc = ::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(addr), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+        return !(rc == -1 && errno == ETIMEDOUT);
+#else
+        // std::atomic::wait没有超时版本，短暂休眠后由调用者重新检查
+        if (addr->load(std::memory_order_acquire) == expected)
+            std::this_thread::sleep_for((std::min)(std::chrono::duration_cast<std::chrono::microseconds>(remaining),
+                                                   std::chrono::microseconds(500)));
+        return Clock::now() < deadline;
+#endif
+    }
+
+    // 唤醒至多count个等待在addr上的线程
+    inline void futex_wake(std::atomic<std::uint32_t> *addr, int count) noexcept
+    {
+#if defined(__linux__)
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(addr), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+        if (count == 1)
+            addr->notify_one();
+        else
+            addr->notify_all();
+#endif
+    }
+
+    inline void futex_wake_all(std::atomic<std::uint32_t> *addr) noexcept { futex_wake(addr, INT_MAX); }
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_FUTEX_HPP_
@@ -0,0 +1,434 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-19 13:20:45
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-19 13:20:45
+ * @FilePath: \plib\src\core\include\concurrent\hazard_pointer.hpp
+ * @Description: 风险指针(hazard pointer)安全内存回收域，供无锁栈/队列/链表等容器使用
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_HAZARD_POINTER_HPP_
+#define PLIB_CORE_CONCURRENT_HAZARD_POINTER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "plib_macros.hpp"
+
+namespace plib::core::concurrent
+{
+    class HazardPointerDomain;
+
+    namespace detail
+    {
+        struct HazardRetired
+        {
+            void *ptr;
+            void (*deleter)(void *);
+        };
+
+        // 每个线程一个记录: 固定数量的风险指针槽 + 本线程的待回收列表
+        struct alignas(CACHE_LINE_SIZE) HazardRecord
+        {
+            static constexpr uint32_t kSlots = 8;
+
+            std::atomic<const void *> slots[kSlots] = {};
+            std::atomic<bool> in_use{false};
+            std::atomic<HazardRecord *> next{nullptr};
+            uint32_t free_mask = (1u << kSlots) - 1; // 空闲槽位掩码，仅拥有者线程访问
+            std::vector<HazardRetired> retired;      // 仅拥有者线程访问
+            std::size_t scan_at = 0;                 // 待回收数达到它时扫描，0表示按当前阈值；仅拥有者线程访问
+        };
+
+        struct HazardRegistry
+        {
+            std::mutex mutex;
+            std::unordered_set<uint64_t> live;
+            uint64_t next_id = 1;
+
+            static HazardRegistry &instance()
+            {
+                // 故意泄漏，保证晚于所有thread_local析构
+                static HazardRegistry *registry = new HazardRegistry();
+                return *registry;
+            }
+        };
+
+        struct HazardThreadCache
+        {
+            struct Entry
+            {
+                uint64_t domain_id;
+                HazardPointerDomain *domain;
+                HazardRecord *record;
+            };
+            std::vector<Entry> entries;
+
+            ~HazardThreadCache();
+        };
+
+        inline thread_local HazardThreadCache t_hazard_cache;
+    } // namespace detail
+
+    /**
+     * @brief: 风险指针回收域
+     * 读者先把要访问的指针发布到自己的风险指针槽，再确认源指针未变;
+     * 写者摘除节点后retire，待回收列表超过阈值时扫描所有线程的风险指针，释放未被保护的节点。
+     * 阈值至少为全部槽位数的两倍，保证每次retire的均摊扫描开销为O(1)。
+     */
+    class HazardPointerDomain
+    {
+    public:
+        /**
+         * @brief: 占用一个风险指针槽，析构时归还，只能在创建它的线程上使用
+         */
+        class HazardPointer
+        {
+        public:
+            HazardPointer() = default;
+            HazardPointer(HazardPointer &&other) noexcept
+                : _record(std::exchange(other._record, nullptr)), _slot(other._slot) {}
+            HazardPointer &operator=(HazardPointer &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    _release();
+                    _record = std::exchange(other._record, nullptr);
+                    _slot = other._slot;
+                }
+                return *this;
+            }
+            HazardPointer(const HazardPointer &) = delete;
+            HazardPointer &operator=(const HazardPointer &) = delete;
+            ~HazardPointer() { _release(); }
+
+            bool empty() const noexcept { return _record == nullptr; }
+
+            /**
+             * @brief: 保护src当前指向的对象，返回受保护的指针(可能为空)
+             */
+            template <typename T>
+            T *protect(const std::atomic<T *> &src) noexcept
+            {
+                T *ptr = src.load(std::memory_order_relaxed);
+                while (!try_protect(ptr, src))
+                {
+                }
+                return ptr;
+            }
+
+            /**
+             * @brief: 尝试保护ptr，若src已不再指向ptr则把ptr更新为src的新值并返回false
+             */
+            template <typename T>
+            bool try_protect(T *&ptr, const std::atomic<T *> &src) noexcept
+            {
+                T *expected = ptr;
+                reset_protection(expected);
+                // 发布风险指针后再确认源未变，与scan中的fence配对
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                ptr = src.load(std::memory_order_acquire);
+                if (ptr != expected)
+                {
+                    reset_protection();
+                    return false;
+                }
+                return true;
+            }
+
+            template <typename T>
+            void reset_protection(const T *ptr) noexcept
+            {
+                _record->slots[_slot].store(ptr, std::memory_order_release);
+            }
+
+            void reset_protection(std::nullptr_t = nullptr) noexcept
+            {
+                _record->slots[_slot].store(nullptr, std::memory_order_release);
+            }
+
+        private:
+            friend class HazardPointerDomain;
+            HazardPointer(detail::HazardRecord *record, uint32_t slot) : _record(record), _slot(slot) {}
+
+            void _release() noexcept
+            {
+                if (_record)
+                {
+                    _record->slots[_slot].store(nullptr, std::memory_order_release);
+                    _record->free_mask |= (1u << _slot);
+                    _record = nullptr;
+                }
+            }
+
+            detail::HazardRecord *_record = nullptr;
+            uint32_t _slot = 0;
+        };
+
+#ifdef P_INTERNAL_USE_ASAN
+        // ASAN下尽快释放，让释放后使用尽早暴露
+        static constexpr std::size_t kDefaultRetireThreshold = 1;
+#else
+        static constexpr std::size_t kDefaultRetireThreshold = 1000;
+#endif
+
+        /**
+         * @param retire_threshold: 每个线程待回收列表的长度上限，超过后触发一次扫描
+         */
+        explicit HazardPointerDomain(std::size_t retire_threshold = kDefaultRetireThreshold);
+
+        /**
+         * @brief: 析构时直接释放所有待回收对象，调用者需保证此时已没有线程持有风险指针
+         */
+        ~HazardPointerDomain();
+
+        HazardPointerDomain(const HazardPointerDomain &) = delete;
+        HazardPointerDomain &operator=(const HazardPointerDomain &) = delete;
+
+        static HazardPointerDomain &global();
+
+        /**
+         * @brief: 获取一个风险指针，每个线程最多同时持有HazardRecord::kSlots个
+         */
+        HazardPointer make_hazard_pointer();
+
+        template <typename T>
+        void retire(T *p)
+        {
+            retire(static_cast<void *>(p), [](void *q)
+                   { delete static_cast<T *>(q); });
+        }
+
+        void retire(void *p, void (*deleter)(void *));
+
+        /**
+         * @brief: 扫描当前线程的待回收列表以及已退出线程遗留的对象，释放未被保护的部分
+         * @return: 本次释放的对象数
+         */
+        std::size_t scan();
+
+        // 已retire但尚未释放的对象数
+        std::size_t pending() const { return _pending.load(std::memory_order_relaxed); }
+
+    private:
+        friend struct detail::HazardThreadCache;
+
+        detail::HazardRecord *_local();
+        detail::HazardRecord *_acquire_record();
+        void _release_record(detail::HazardRecord *record);
+        std::size_t _threshold() const;
+        std::size_t _scan(std::vector<detail::HazardRetired> &retired);
+        // 把已退出线程遗留的对象并入retired
+        void _adopt_orphans(std::vector<detail::HazardRetired> &retired);
+
+        const uint64_t _id;
+        const std::size_t _retire_threshold;
+        std::atomic<detail::HazardRecord *> _records{nullptr};
+        std::atomic<std::size_t> _record_count{0};
+        std::atomic<std::size_t> _pending{0};
+        std::mutex _orphans_mutex; // 已退出线程遗留的仍被保护的对象
+        std::vector<detail::HazardRetired> _orphans;
+        std::atomic<bool> _has_orphans{false};
+    };
+
+    inline HazardPointerDomain::HazardPointerDomain(std::size_t retire_threshold)
+        : _id([]
+              {
+                  auto &registry = detail::HazardRegistry::instance();
+                  std::lock_guard<std::mutex> lock(registry.mutex);
+                  uint64_t id = registry.next_id++;
+                  registry.live.insert(id);
+                  return id; }()),
+          _retire_threshold(retire_threshold == 0 ? 1 : retire_threshold)
+    {
+    }
+
+    inline HazardPointerDomain::~HazardPointerDomain()
+    {
+        {
+            auto &registry = detail::HazardRegistry::instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.live.erase(_id);
+        }
+        for (auto &item : _orphans)
+            item.deleter(item.ptr);
+        auto *record = _records.load(std::memory_order_acquire);
+        while (record != nullptr)
+        {
+            auto *next = record->next.load(std::memory_order_relaxed);
+            for (auto &item : record->retired)
+                item.deleter(item.ptr);
+            delete record;
+            record = next;
+        }
+    }
+
+    inline HazardPointerDomain &HazardPointerDomain::global()
+    {
+        static HazardPointerDomain *domain = new HazardPointerDomain();
+        return *domain;
+    }
+
+    inline detail::HazardRecord *HazardPointerDomain::_local()
+    {
+        auto &cache = detail::t_hazard_cache;
+        for (auto &entry : cache.entries)
+        {
+            P_LIKELY if (entry.domain_id == _id)
+            {
+                return entry.record;
+            }
+        }
+        auto *record = _acquire_record();
+        cache.entries.push_back({_id, this, record});
+        return record;
+    }
+
+    inline detail::HazardRecord *HazardPointerDomain::_acquire_record()
+    {
+        for (auto *record = _records.load(std::memory_order_acquire); record != nullptr;
+             record = record->next.load(std::memory_order_acquire))
+        {
+            bool expected = false;
+            if (!record->in_use.load(std::memory_order_relaxed) &&
+                record->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+            {
+                return record;
+            }
+        }
+        auto *record = new detail::HazardRecord();
+        record->in_use.store(true, std::memory_order_relaxed);
+        auto *head = _records.load(std::memory_order_relaxed);
+        do
+        {
+            record->next.store(head, std::memory_order_relaxed);
+        } while (!_records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+        _record_count.fetch_add(1, std::memory_order_relaxed);
+        return record;
+    }
+
+    inline void HazardPointerDomain::_release_record(detail::HazardRecord *record)
+    {
+        for (auto &slot : record->slots)
+            slot.store(nullptr, std::memory_order_release);
+        record->free_mask = (1u << detail::HazardRecord::kSlots) - 1;
+        _scan(record->retired);
+        if (!record->retired.empty())
+        {
+            std::lock_guard<std::mutex> lock(_orphans_mutex);
+            _orphans.insert(_orphans.end(), record->retired.begin(), record->retired.end());
+            _has_orphans.store(true, std::memory_order_release);
+        }
+        record->retired = {};
+        record->scan_at = 0;
+        record->in_use.store(false, std::memory_order_release);
+    }
+
+    inline HazardPointerDomain::HazardPointer HazardPointerDomain::make_hazard_pointer()
+    {
+        auto *record = _local();
+        P_UNLIKELY if (record->free_mask == 0)
+        {
+            throw std::length_error("HazardPointerDomain: too many hazard pointers held by one thread");
+        }
+        // 取最低位的空闲槽
+        uint32_t slot = 0;
+        while (!(record->free_mask & (1u << slot)))
+            ++slot;
+        record->free_mask &= ~(1u << slot);
+        return HazardPointer(record, slot);
+    }
+
+    inline std::size_t HazardPointerDomain::_threshold() const
+    {
+#ifdef P_INTERNAL_USE_ASAN
+        return _retire_threshold;
+#else
+        const std::size_t slots = _record_count.load(std::memory_order_relaxed) * detail::HazardRecord::kSlots;
+        return (std::max)(_retire_threshold, 2 * slots);
+#endif
+    }
+
+    inline void HazardPointerDomain::retire(void *p, void (*deleter)(void *))
+    {
+        if (p == nullptr)
+            return;
+        auto *record = _local();
+        record->retired.push_back({p, deleter});
+        _pending.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t trigger = record->scan_at != 0 ? record->scan_at : _threshold();
+        if (record->retired.size() >= trigger)
+            scan();
+    }
+
+    inline std::size_t HazardPointerDomain::scan()
+    {
+        auto *record = _local();
+        _adopt_orphans(record->retired);
+        const std::size_t reclaimed = _scan(record->retired);
+        // 仍被保护的对象留在列表里，下一次至少再攒够一个阈值才扫描，保证retire的均摊开销
+        record->scan_at = record->retired.size() + _threshold();
+        return reclaimed;
+    }
+
+    inline void HazardPointerDomain::_adopt_orphans(std::vector<detail::HazardRetired> &retired)
+    {
+        if (!_has_orphans.load(std::memory_order_acquire))
+            return;
+        std::lock_guard<std::mutex> lock(_orphans_mutex);
+        retired.insert(retired.end(), _orphans.begin(), _orphans.end());
+        _orphans.clear();
+        _has_orphans.store(false, std::memory_order_relaxed);
+    }
+
+    inline std::size_t HazardPointerDomain::_scan(std::vector<detail::HazardRetired> &retired)
+    {
+        if (retired.empty())
+            return 0;
+        // 与try_protect中的fence配对: 节点已被摘除，之后发布的风险指针必然能在源上看到变化
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::vector<const void *> hazards;
+        hazards.reserve(_record_count.load(std::memory_order_relaxed) * detail::HazardRecord::kSlots);
+        for (auto *record = _records.load(std::memory_order_acquire); record != nullptr;
+             record = record->next.load(std::memory_order_acquire))
+        {
+            for (auto &slot : record->slots)
+            {
+                if (const void *p = slot.load(std::memory_order_acquire))
+                    hazards.push_back(p);
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+
+        auto keep = std::partition(retired.begin(), retired.end(), [&hazards](const detail::HazardRetired &item)
+                                   { return std::binary_search(hazards.begin(), hazards.end(), static_cast<const void *>(item.ptr)); });
+        // 先从列表中摘出再释放，deleter中允许再次retire
+        std::vector<detail::HazardRetired> reclaimable(keep, retired.end());
+        retired.erase(keep, retired.end());
+        for (auto &item : reclaimable)
+            item.deleter(item.ptr);
+        _pending.fetch_sub(reclaimable.size(), std::memory_order_relaxed);
+        return reclaimable.size();
+    }
+
+    inline detail::HazardThreadCache::~HazardThreadCache()
+    {
+        auto &registry = HazardRegistry::instance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (auto &entry : entries)
+        {
+            if (registry.live.count(entry.domain_id) != 0)
+                entry.domain->_release_record(entry.record);
+        }
+    }
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_HAZARD_POINTER_HPP_
@@ -0,0 +1,336 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-19 15:20:08
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-19 15:20:08
+ * @FilePath: \plib\src\core\include\concurrent\lock_profiler.hpp
+ * @Description: 锁竞争统计，编译期开关 PLIB_LOCK_PROFILING，关闭时探针为空类型，不产生任何开销
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_LOCK_PROFILER_HPP_
+#define PLIB_CORE_CONCURRENT_LOCK_PROFILER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <source_location>
+#include "plib_macros.hpp"
+
+#ifdef PLIB_LOCK_PROFILING
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace plib::core::concurrent
+{
+#ifdef PLIB_LOCK_PROFILING
+    inline constexpr bool kLockProfilingEnabled = true;
+
+    /**
+     * @brief: 读取时间戳计数器，x86为TSC，ARM64为虚拟计数器，其他平台退化为steady_clock纳秒
+     */
+    P_FORCE_INLINE std::uint64_t lock_profiler_cycles() noexcept
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        std::uint64_t v;
+        __asm__ volatile("mrs %0, cntvct_el0" : "=r"(v));
+        return v;
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+#endif
+    }
+
+    /**
+     * @brief: 一个统计点(同名或同一构造位置的锁实例共享)的计数器
+     */
+    struct LockStats
+    {
+        std::string name;
+        std::string file;
+        std::uint32_t line = 0;
+
+        std::atomic<std::uint64_t> acquisitions{0};
+        std::atomic<std::uint64_t> contended{0};
+        std::atomic<std::uint64_t> wait_cycles{0};
+        std::atomic<std::uint64_t> hold_cycles{0};
+        std::atomic<std::uint64_t> max_hold_cycles{0};
+
+        void record_hold(std::uint64_t cycles) noexcept
+        {
+            hold_cycles.fetch_add(cycles, std::memory_order_relaxed);
+            auto prev = max_hold_cycles.load(std::memory_order_relaxed);
+            while (prev < cycles && !max_hold_cycles.compare_exchange_weak(prev, cycles, std::memory_order_relaxed))
+            {
+            }
+        }
+    };
+
+    /**
+     * @brief: 某一时刻的统计快照
+     */
+    struct LockStatsSnapshot
+    {
+        std::string name;
+        std::string file;
+        std::uint32_t line;
+        std::uint64_t acquisitions;
+        std::uint64_t contended;
+        std::uint64_t wait_cycles;
+        std::uint64_t hold_cycles;
+        std::uint64_t max_hold_cycles;
+    };
+
+    /**
+     * @brief: 全局统计注册表，统计点只增不删，指针在进程生命周期内有效
+     */
+    class LockProfiler
+    {
+    public:
+        static LockProfiler &instance()
+        {
+            // 放在静态存储里且故意不析构，保证静态对象析构阶段使用锁依然安全，构造也不会分配内存
+            alignas(LockProfiler) static unsigned char storage[sizeof(LockProfiler)];
+            static LockProfiler *profiler = ::new (static_cast<void *>(storage)) LockProfiler();
+            return *profiler;
+        }
+
+        /**
+         * @brief: 默认构造的锁共用的统计点，不需要注册，报告中名为"<unnamed>"
+         */
+        LockStats *unnamed() noexcept { return &_unnamed; }
+
+        /**
+         * @brief: 获取统计点，name为空时以构造位置 file:line 作为键
+         */
+        LockStats *site(const char *name, const std::source_location &loc)
+        {
+            std::string key = (name && *name) ? std::string(name)
+                                              : std::string(loc.file_name()) + ":" + std::to_string(loc.line());
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _sites.find(key);
+            if (it == _sites.end())
+            {
+                auto *stats = new LockStats();
+                stats->name = key;
+                stats->file = loc.file_name();
+                stats->line = loc.line();
+                it = _sites.emplace(std::move(key), stats).first;
+            }
+            return it->second;
+        }
+
+        /**
+         * @brief: 按总等待时间降序返回所有统计点的快照
+         */
+        std::vector<LockStatsSnapshot> snapshot() const
+        {
+            std::vector<LockStatsSnapshot> result;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                result.reserve(_sites.size());
+                for (const auto &[key, s] : _sites)
+                {
+                    result.push_back(_snapshot_of(*s, s->name));
+                }
+                if (_unnamed.acquisitions.load(std::memory_order_relaxed) != 0)
+                    result.push_back(_snapshot_of(_unnamed, "<unnamed>"));
+            }
+            std::sort(result.begin(), result.end(), [](const auto &a, const auto &b)
+                      { return a.wait_cycles > b.wait_cycles; });
+            return result;
+        }
+
+        // 清零所有计数器，统计点保留
+        void reset()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto &[key, s] : _sites)
+                _reset(*s);
+            _reset(_unnamed);
+        }
+
+        std::string report_text() const
+        {
+            std::ostringstream os;
+            os << "name\tacquisitions\tcontended\twait_cycles\tavg_wait\tmax_hold_cycles\tsource\n";
+            for (const auto &s : snapshot())
+            {
+                os << s.name << '\t' << s.acquisitions << '\t' << s.contended << '\t' << s.wait_cycles << '\t'
+                   << (s.contended ? s.wait_cycles / s.contended : 0) << '\t' << s.max_hold_cycles << '\t'
+                   << s.file << ':' << s.line << '\n';
+            }
+            return os.str();
+        }
+
+        std::string report_json() const
+        {
+            std::ostringstream os;
+            os << "[";
+            bool first = true;
+            for (const auto &s : snapshot())
+            {
+                os << (first ? "" : ",") << "{\"name\":\"" << _escape(s.name) << "\",\"file\":\"" << _escape(s.file)
+                   << "\",\"line\":" << s.line << ",\"acquisitions\":" << s.acquisitions
+                   << ",\"contended\":" << s.contended << ",\"wait_cycles\":" << s.wait_cycles
+                   << ",\"hold_cycles\":" << s.hold_cycles << ",\"max_hold_cycles\":" << s.max_hold_cycles << "}";
+                first = false;
+            }
+            os << "]";
+            return os.str();
+        }
+
+    private:
+        LockProfiler() = default;
+
+        static LockStatsSnapshot _snapshot_of(const LockStats &s, const std::string &name)
+        {
+            return {name, s.file, s.line,
+                    s.acquisitions.load(std::memory_order_relaxed),
+                    s.contended.load(std::memory_order_relaxed),
+                    s.wait_cycles.load(std::memory_order_relaxed),
+                    s.hold_cycles.load(std::memory_order_relaxed),
+                    s.max_hold_cycles.load(std::memory_order_relaxed)};
+        }
+
+        static void _reset(LockStats &s) noexcept
+        {
+            s.acquisitions.store(0, std::memory_order_relaxed);
+            s.contended.store(0, std::memory_order_relaxed);
+            s.wait_cycles.store(0, std::memory_order_relaxed);
+            s.hold_cycles.store(0, std::memory_order_relaxed);
+            s.max_hold_cycles.store(0, std::memory_order_relaxed);
+        }
+
+        static std::string _escape(const std::string &in)
+        {
+            std::string out;
+            out.reserve(in.size());
+            for (char c : in)
+            {
+                if (c == '"' || c == '\\')
+                    out.push_back('\\');
+                out.push_back(c);
+            }
+            return out;
+        }
+
+        mutable std::mutex _mutex;
+        std::map<std::string, LockStats *> _sites;
+        LockStats _unnamed;
+    };
+
+    /**
+     * @brief: 嵌入到各锁类型中的探针，负责把一次加锁的等待/持有时间记到统计点上
+     * 持有时间的起点存放在探针中，只有持有独占锁的线程会读写它。
+     */
+    class LockProbe
+    {
+    public:
+        // 记到共用的"<unnamed>"统计点，不注册、不分配
+        LockProbe() noexcept : _stats(LockProfiler::instance().unnamed()) {}
+        LockProbe(const char *name, const std::source_location &loc)
+            : _stats(LockProfiler::instance().site(name, loc))
+        {
+        }
+
+        std::uint64_t begin_wait() const noexcept { return lock_profiler_cycles(); }
+
+        // 无竞争获取
+        void acquired() noexcept
+        {
+            _stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+            _hold_start = lock_profiler_cycles();
+        }
+
+        // 经过等待后获取
+        void acquired_after_wait(std::uint64_t wait_start) noexcept
+        {
+            _hold_start = lock_profiler_cycles();
+            _stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+            _stats->contended.fetch_add(1, std::memory_order_relaxed);
+            _stats->wait_cycles.fetch_add(_hold_start - wait_start, std::memory_order_relaxed);
+        }
+
+        void released() noexcept { _stats->record_hold(lock_profiler_cycles() - _hold_start); }
+
+        // 共享锁：每个读者自己保存持有起点
+        void shared_acquired(bool contended, std::uint64_t wait_start) noexcept
+        {
+            _stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+            if (contended)
+            {
+                _stats->contended.fetch_add(1, std::memory_order_relaxed);
+                _stats->wait_cycles.fetch_add(lock_profiler_cycles() - wait_start, std::memory_order_relaxed);
+            }
+        }
+        void shared_released(std::uint64_t hold_start) noexcept { _stats->record_hold(lock_profiler_cycles() - hold_start); }
+
+        LockStats *stats() const noexcept { return _stats; }
+
+    private:
+        LockStats *_stats;
+        std::uint64_t _hold_start = 0;
+    };
+
+    /**
+     * @brief: 作用域式加锁(如LockedRW)的持有时间统计，析构时记录
+     */
+    class LockHoldScope
+    {
+    public:
+        explicit LockHoldScope(LockProbe &probe) noexcept : _probe(probe), _start(lock_profiler_cycles()) {}
+        ~LockHoldScope() { _probe.shared_released(_start); }
+
+        LockHoldScope(const LockHoldScope &) = delete;
+        LockHoldScope &operator=(const LockHoldScope &) = delete;
+
+    private:
+        LockProbe &_probe;
+        std::uint64_t _start;
+    };
+#else
+    inline constexpr bool kLockProfilingEnabled = false;
+
+    P_FORCE_INLINE std::uint64_t lock_profiler_cycles() noexcept { return 0; }
+
+    // 关闭统计时的空探针，所有调用都会被内联消除
+    class LockProbe
+    {
+    public:
+        constexpr LockProbe() noexcept {}
+        constexpr LockProbe(const char *, const std::source_location &) noexcept {}
+
+        constexpr std::uint64_t begin_wait() const noexcept { return 0; }
+        constexpr void acquired() noexcept {}
+        constexpr void acquired_after_wait(std::uint64_t) noexcept {}
+        constexpr void released() noexcept {}
+        constexpr void shared_acquired(bool, std::uint64_t) noexcept {}
+        constexpr void shared_released(std::uint64_t) noexcept {}
+    };
+
+    class LockHoldScope
+    {
+    public:
+        constexpr explicit LockHoldScope(LockProbe &) noexcept {}
+    };
+#endif
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_LOCK_PROFILER_HPP_
@@ -0,0 +1,153 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-19 14:31:50
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-19 14:31:50
+ * @FilePath: \plib\src\core\include\concurrent\lockfree_queue.hpp
+ * @Description: Michael-Scott无锁队列，节点通过风险指针安全回收
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_LOCKFREE_QUEUE_HPP_
+#define PLIB_CORE_CONCURRENT_LOCKFREE_QUEUE_HPP_
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <utility>
+#include "concurrent/hazard_pointer.hpp"
+
+namespace plib::core::concurrent
+{
+    /**
+     * @brief: Michael-Scott无锁队列(多生产者多消费者)
+     * 队列始终有一个哨兵节点，head指向哨兵，真正的队首元素存放在哨兵的后继中;
+     * 出队成功后后继节点成为新的哨兵，其中的元素被移出并析构，旧哨兵交给风险指针域回收。
+     */
+    template <typename T>
+    class LockFreeQueue
+    {
+        struct Node
+        {
+            std::atomic<Node *> next{nullptr};
+            alignas(T) unsigned char storage[sizeof(T)];
+
+            T *value() noexcept { return std::launder(reinterpret_cast<T *>(storage)); }
+        };
+
+    public:
+        explicit LockFreeQueue(HazardPointerDomain &domain = HazardPointerDomain::global())
+            : _domain(&domain)
+        {
+            Node *dummy = new Node();
+            _head.store(dummy, std::memory_order_relaxed);
+            _tail.store(dummy, std::memory_order_relaxed);
+        }
+
+        // 析构时调用者需保证已没有其他线程在访问
+        ~LockFreeQueue()
+        {
+            Node *node = _head.load(std::memory_order_relaxed);
+            // 第一个节点是哨兵，不含元素
+            Node *next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            while (next != nullptr)
+            {
+                node = next;
+                next = node->next.load(std::memory_order_relaxed);
+                std::destroy_at(node->value());
+                delete node;
+            }
+        }
+
+        LockFreeQueue(const LockFreeQueue &) = delete;
+        LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+
+        void push(const T &value) { emplace(value); }
+        void push(T &&value) { emplace(std::move(value)); }
+
+        template <typename... Args>
+        void emplace(Args &&...args)
+        {
+            Node *node = new Node();
+            ::new (static_cast<void *>(node->storage)) T(std::forward<Args>(args)...);
+
+            auto hp = _domain->make_hazard_pointer();
+            for (;;)
+            {
+                Node *tail = hp.protect(_tail);
+                Node *next = tail->next.load(std::memory_order_acquire);
+                if (tail != _tail.load(std::memory_order_acquire))
+                    continue;
+                if (next != nullptr)
+                {
+                    // tail落后了，帮忙推进
+                    _tail.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                    continue;
+                }
+                Node *expected = nullptr;
+                if (tail->next.compare_exchange_weak(expected, node, std::memory_order_release, std::memory_order_relaxed))
+                {
+                    _tail.compare_exchange_strong(tail, node, std::memory_order_release, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+
+        std::optional<T> pop()
+        {
+            auto hp_head = _domain->make_hazard_pointer();
+            auto hp_next = _domain->make_hazard_pointer();
+            for (;;)
+            {
+                Node *head = hp_head.protect(_head);
+                Node *next = head->next.load(std::memory_order_acquire);
+                hp_next.reset_protection(next);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                // head未变说明next在被保护之前仍是head的后继，没有被回收
+                if (head != _head.load(std::memory_order_acquire))
+                    continue;
+                if (next == nullptr)
+                    return std::nullopt;
+                Node *tail = _tail.load(std::memory_order_acquire);
+                if (head == tail)
+                {
+                    _tail.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                    continue;
+                }
+                if (_head.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+                {
+                    // next成为新哨兵，只有赢得CAS的线程会触碰其中的元素
+                    std::optional<T> result(std::move(*next->value()));
+                    std::destroy_at(next->value());
+                    hp_head.reset_protection();
+                    hp_next.reset_protection();
+                    _domain->retire(head);
+                    return result;
+                }
+            }
+        }
+
+        bool try_pop(T &value)
+        {
+            auto result = pop();
+            if (!result)
+                return false;
+            value = std::move(*result);
+            return true;
+        }
+
+        bool empty() const
+        {
+            auto hp = _domain->make_hazard_pointer();
+            Node *head = hp.protect(_head);
+            return head->next.load(std::memory_order_acquire) == nullptr;
+        }
+
+    private:
+        HazardPointerDomain *_domain;
+        alignas(CACHE_LINE_SIZE) std::atomic<Node *> _head{nullptr};
+        alignas(CACHE_LINE_SIZE) std::atomic<Node *> _tail{nullptr};
+    };
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_LOCKFREE_QUEUE_HPP_
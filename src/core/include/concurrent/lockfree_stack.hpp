@@ -0,0 +1,107 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-19 14:05:12
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-19 14:05:12
+ * @FilePath: \plib\src\core\include\concurrent\lockfree_stack.hpp
+ * @Description: Treiber无锁栈，节点通过风险指针安全回收
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_LOCKFREE_STACK_HPP_
+#define PLIB_CORE_CONCURRENT_LOCKFREE_STACK_HPP_
+
+#include <atomic>
+#include <optional>
+#include <utility>
+#include "concurrent/hazard_pointer.hpp"
+
+namespace plib::core::concurrent
+{
+    /**
+     * @brief: Treiber无锁栈(多生产者多消费者)
+     * 弹出时用风险指针保护栈顶节点，被保护的节点不会被释放/复用，因此CAS不存在ABA问题。
+     */
+    template <typename T>
+    class LockFreeStack
+    {
+        struct Node
+        {
+            template <typename... Args>
+            explicit Node(Args &&...args) : value(std::forward<Args>(args)...) {}
+
+            T value;
+            Node *next = nullptr;
+        };
+
+    public:
+        explicit LockFreeStack(HazardPointerDomain &domain = HazardPointerDomain::global())
+            : _domain(&domain)
+        {
+        }
+
+        // 析构时调用者需保证已没有其他线程在访问
+        ~LockFreeStack()
+        {
+            Node *node = _head.load(std::memory_order_relaxed);
+            while (node != nullptr)
+            {
+                Node *next = node->next;
+                delete node;
+                node = next;
+            }
+        }
+
+        LockFreeStack(const LockFreeStack &) = delete;
+        LockFreeStack &operator=(const LockFreeStack &) = delete;
+
+        void push(const T &value) { emplace(value); }
+        void push(T &&value) { emplace(std::move(value)); }
+
+        template <typename... Args>
+        void emplace(Args &&...args)
+        {
+            Node *node = new Node(std::forward<Args>(args)...);
+            node->next = _head.load(std::memory_order_relaxed);
+            while (!_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        std::optional<T> pop()
+        {
+            auto hp = _domain->make_hazard_pointer();
+            for (;;)
+            {
+                Node *head = hp.protect(_head);
+                if (head == nullptr)
+                    return std::nullopt;
+                // head受保护，读取next是安全的
+                Node *next = head->next;
+                if (_head.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    std::optional<T> result(std::move(head->value));
+                    hp.reset_protection();
+                    _domain->retire(head);
+                    return result;
+                }
+            }
+        }
+
+        bool try_pop(T &value)
+        {
+            auto result = pop();
+            if (!result)
+                return false;
+            value = std::move(*result);
+            return true;
+        }
+
+        bool empty() const { return _head.load(std::memory_order_acquire) == nullptr; }
+
+    private:
+        HazardPointerDomain *_domain;
+        alignas(CACHE_LINE_SIZE) std::atomic<Node *> _head{nullptr};
+    };
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_LOCKFREE_STACK_HPP_
@@ -0,0 +1,216 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-19 16:40:12
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-19 16:40:12
+ * @FilePath: \plib\src\core\include\concurrent\parking_lot.hpp
+ * @Description: 全局的按地址挂起/唤醒(parking lot)，任意对象都可以用自身地址作为键让线程睡眠，而不必内嵌互斥量和条件变量
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_PARKING_LOT_HPP_
+#define PLIB_CORE_CONCURRENT_PARKING_LOT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include "plib_macros.hpp"
+#include "concurrent/futex.hpp"
+
+namespace plib::core::concurrent
+{
+    namespace detail
+    {
+        // 挂起中的线程，生命周期等于其所在线程，唤醒方写入state后线程才可能离开park
+        struct ParkedThread
+        {
+            const void *key = nullptr;
+            ParkedThread *next = nullptr;
+            std::atomic<std::uint32_t> state{0}; // 0:挂起 1:已被唤醒
+        };
+
+        struct alignas(CACHE_LINE_SIZE) ParkingBucket
+        {
+            std::mutex mutex;
+            ParkedThread *head = nullptr;
+            ParkedThread *tail = nullptr;
+
+            void append(ParkedThread *t) noexcept
+            {
+                t->next = nullptr;
+                if (tail)
+                    tail->next = t;
+                else
+                    head = t;
+                tail = t;
+            }
+
+            // 摘除并返回至多max个键为key的线程(按挂起顺序)，通过链表返回
+            ParkedThread *take(const void *key, std::size_t max) noexcept
+            {
+                ParkedThread *taken = nullptr, **taken_tail = &taken;
+                ParkedThread *prev = nullptr;
+                for (ParkedThread *cur = head; cur != nullptr && max != 0;)
+                {
+                    ParkedThread *next = cur->next;
+                    if (cur->key == key)
+                    {
+                        unlink(prev, cur);
+                        cur->next = nullptr;
+                        *taken_tail = cur;
+                        taken_tail = &cur->next;
+                        --max;
+                    }
+                    else
+                    {
+                        prev = cur;
+                    }
+                    cur = next;
+                }
+                return taken;
+            }
+
+            bool remove(ParkedThread *t) noexcept
+            {
+                ParkedThread *prev = nullptr;
+                for (ParkedThread *cur = head; cur != nullptr; prev = cur, cur = cur->next)
+                {
+                    if (cur == t)
+                    {
+                        unlink(prev, cur);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void unlink(ParkedThread *prev, ParkedThread *cur) noexcept
+            {
+                (prev ? prev->next : head) = cur->next;
+                if (tail == cur)
+                    tail = prev;
+            }
+        };
+    } // namespace detail
+
+    /**
+     * @brief: 按地址挂起线程
+     * park(key, validate)在桶锁下调用validate()，返回false则不挂起(与唤醒方的状态变化做了原子检查);
+     * unpark_one/unpark_all唤醒等待同一地址的线程。桶按地址哈希，不同地址之间基本没有争用。
+     */
+    class ParkingLot
+    {
+    public:
+        static constexpr std::size_t kBucketCount = 256;
+
+        static ParkingLot &global()
+        {
+            // 故意泄漏，允许在静态析构阶段使用
+            static ParkingLot *lot = new ParkingLot();
+            return *lot;
+        }
+
+        /**
+         * @brief: 挂起当前线程直到被unpark
+         * @param validate: 在桶锁内执行，返回false表示条件已变化，不再挂起
+         * @return: 是否真正挂起并被唤醒
+         */
+        template <typename Validate>
+        bool park(const void *key, Validate &&validate)
+        {
+            detail::ParkedThread &self = _self();
+            auto &bucket = _bucket(key);
+            {
+                std::lock_guard<std::mutex> lock(bucket.mutex);
+                if (!validate())
+                    return false;
+                self.key = key;
+                self.state.store(0, std::memory_order_relaxed);
+                bucket.append(&self);
+            }
+            while (self.state.load(std::memory_order_acquire) == 0)
+                futex_wait(&self.state, 0);
+            return true;
+        }
+
+        /**
+         * @brief: 带超时的park，超时返回false
+         */
+        template <typename Validate, typename Rep, typename Period>
+        bool park_for(const void *key, Validate &&validate, const std::chrono::duration<Rep, Period> &timeout)
+        {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            detail::ParkedThread &self = _self();
+            auto &bucket = _bucket(key);
+            {
+                std::lock_guard<std::mutex> lock(bucket.mutex);
+                if (!validate())
+                    return false;
+                self.key = key;
+                self.state.store(0, std::memory_order_relaxed);
+                bucket.append(&self);
+            }
+            while (self.state.load(std::memory_order_acquire) == 0)
+            {
+                if (!futex_wait_until(&self.state, 0, deadline))
+                {
+                    std::lock_guard<std::mutex> lock(bucket.mutex);
+                    if (bucket.remove(&self))
+                        return false;
+                    // 已被唤醒方摘除，state马上会被置位
+                }
+            }
+            return true;
+        }
+
+        // 唤醒一个等待key的线程，返回是否唤醒了线程
+        bool unpark_one(const void *key) { return _unpark(key, 1) != 0; }
+
+        // 唤醒所有等待key的线程，返回唤醒的数量
+        std::size_t unpark_all(const void *key) { return _unpark(key, static_cast<std::size_t>(-1)); }
+
+    private:
+        ParkingLot() = default;
+
+        std::size_t _unpark(const void *key, std::size_t max)
+        {
+            auto &bucket = _bucket(key);
+            detail::ParkedThread *list;
+            {
+                std::lock_guard<std::mutex> lock(bucket.mutex);
+                list = bucket.take(key, max);
+            }
+            std::size_t count = 0;
+            while (list != nullptr)
+            {
+                detail::ParkedThread *next = list->next;
+                list->state.store(1, std::memory_order_release);
+                futex_wake(&list->state, 1);
+                list = next;
+                ++count;
+            }
+            return count;
+        }
+
+        detail::ParkingBucket &_bucket(const void *key) noexcept
+        {
+            auto h = reinterpret_cast<std::uintptr_t>(key);
+            // 地址低位通常是0，先混合再取模
+            h ^= h >> 17;
+            h *= 0x9E3779B97F4A7C15ull;
+            return _buckets[(h >> 24) & (kBucketCount - 1)];
+        }
+
+        static detail::ParkedThread &_self() noexcept
+        {
+            thread_local detail::ParkedThread self;
+            return self;
+        }
+
+        detail::ParkingBucket _buckets[kBucketCount];
+    };
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_PARKING_LOT_HPP_
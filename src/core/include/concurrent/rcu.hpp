@@ -0,0 +1,140 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-19 10:40:37
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-19 10:40:37
+ * @FilePath: \plib\src\core\include\concurrent\rcu.hpp
+ * @Description: RCU风格的版本化快照，读者无锁读取，写者拷贝-修改-发布，旧版本交给纪元回收域延迟释放
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_CONCURRENT_RCU_HPP_
+#define PLIB_CORE_CONCURRENT_RCU_HPP_
+
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include "concurrent/epoch.hpp"
+
+namespace plib::core::concurrent
+{
+    /**
+     * @brief: 适合读多写少的大对象(配置、路由表、索引)的热替换
+     * 读者load()拿到一个快照指针，持有期间快照不会被释放;
+     * 写者update()复制当前版本、在副本上修改、再原子地发布新版本，写者之间用互斥锁串行。
+     */
+    template <typename T>
+    class RcuCell
+    {
+    public:
+        /**
+         * @brief: 读快照，持有期间当前线程处于临界区，只能在创建它的线程上析构
+         */
+        class ReadPtr
+        {
+        public:
+            ReadPtr() = default;
+            ReadPtr(ReadPtr &&) noexcept = default;
+            ReadPtr &operator=(ReadPtr &&) noexcept = default;
+
+            const T *get() const noexcept { return _ptr; }
+            const T &operator*() const noexcept { return *_ptr; }
+            const T *operator->() const noexcept { return _ptr; }
+            explicit operator bool() const noexcept { return _ptr != nullptr; }
+
+            // 提前结束读
+            void reset()
+            {
+                _ptr = nullptr;
+                _guard.release();
+            }
+
+        private:
+            friend class RcuCell;
+            ReadPtr(EpochDomain::Guard &&guard, const T *ptr) : _guard(std::move(guard)), _ptr(ptr) {}
+
+            EpochDomain::Guard _guard;
+            const T *_ptr = nullptr;
+        };
+
+        explicit RcuCell(T value = T(), EpochDomain &domain = EpochDomain::global())
+            : _domain(&domain), _current(new T(std::move(value)))
+        {
+        }
+
+        // 析构时直接释放当前版本，调用者需保证已没有读者
+        ~RcuCell()
+        {
+            delete _current.load(std::memory_order_relaxed);
+        }
+
+        RcuCell(const RcuCell &) = delete;
+        RcuCell &operator=(const RcuCell &) = delete;
+
+        /**
+         * @brief: 获取当前版本的快照
+         */
+        ReadPtr load() const
+        {
+            EpochDomain::Guard guard(*_domain);
+            return ReadPtr(std::move(guard), _current.load(std::memory_order_acquire));
+        }
+
+        /**
+         * @brief: 在临界区内对当前版本执行func，返回func的结果(按值)
+         */
+        template <typename Func>
+        auto read(Func &&func) const
+        {
+            EpochDomain::Guard guard(*_domain);
+            return std::forward<Func>(func)(*_current.load(std::memory_order_acquire));
+        }
+
+        /**
+         * @brief: 直接发布一个新版本
+         */
+        void store(T value)
+        {
+            T *next = new T(std::move(value));
+            T *prev;
+            {
+                std::lock_guard<std::mutex> lock(_write_mutex);
+                prev = _current.exchange(next, std::memory_order_acq_rel);
+            }
+            _domain->retire(prev);
+        }
+
+        /**
+         * @brief: 拷贝当前版本，在副本上执行func(T&)，然后发布副本
+         */
+        template <typename Func>
+        void update(Func &&func)
+        {
+            T *prev;
+            {
+                std::lock_guard<std::mutex> lock(_write_mutex);
+                T *next = new T(*_current.load(std::memory_order_relaxed));
+                try
+                {
+                    std::forward<Func>(func)(*next);
+                }
+                catch (...)
+                {
+                    delete next;
+                    throw;
+                }
+                prev = _current.exchange(next, std::memory_order_acq_rel);
+            }
+            _domain->retire(prev);
+        }
+
+        EpochDomain &domain() const noexcept { return *_domain; }
+
+    private:
+        EpochDomain *_domain;
+        std::atomic<T *> _current;
+        std::mutex _write_mutex;
+    };
+} // namespace plib::core::concurrent
+
+#endif // PLIB_CORE_CONCURRENT_RCU_HPP_
@@ -6,6 +6,9 @@
 #include <stdexcept>
 #include <iostream>
 #include <string>
+#include <source_location>
+#include "plib_macros.hpp"
+#include "concurrent/lock_profiler.hpp"
 
 namespace plib::core::concurrent{
 
@@ -13,13 +16,17 @@ namespace plib::core::concurrent{
     class LockedRW
     {
       public:
-      explicit LockedRW(T obj = T()) : data_(std::move(obj)) {}
+      explicit LockedRW(T obj = T(), const char *name = nullptr,
+                        std::source_location loc = std::source_location::current())
+          : data_(std::move(obj)), probe_(name, loc) {}
     
       // 读操作，返回func返回的类型
       template <typename Func>
       auto access_read(Func func) const
       {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+        lock_profiled(lock);
+        LockHoldScope hold(probe_);
         return func(data_);
       }
     
@@ -27,13 +34,37 @@ namespace plib::core::concurrent{
       template <typename Func>
       auto access_write(Func func)
       {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
+        std::unique_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+        lock_profiled(lock);
+        LockHoldScope hold(probe_);
         return func(data_);
       }
     
       private:
+      // 开启统计时先try_lock区分是否发生竞争
+      template <typename Lock>
+      void lock_profiled(Lock &lock) const
+      {
+        if constexpr (kLockProfilingEnabled)
+        {
+          if (lock.try_lock())
+          {
+            probe_.shared_acquired(false, 0);
+            return;
+          }
+          auto wait_start = probe_.begin_wait();
+          lock.lock();
+          probe_.shared_acquired(true, wait_start);
+        }
+        else
+        {
+          lock.lock();
+        }
+      }
+
       T data_;
       mutable std::shared_mutex mutex_;
+      PLIB_NO_UNIQUE_ADDRESS mutable LockProbe probe_;
     };
     
 
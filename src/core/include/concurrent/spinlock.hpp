@@ -14,10 +14,14 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <source_location>
 #include "plib_macros.hpp"
+#include "concurrent/lock_profiler.hpp"
 
 namespace plib::core::concurrent
 {
+    // 以下锁类型都可以传入名字或构造位置用于竞争统计(PLIB_LOCK_PROFILING)；
+    // 默认构造的锁统一记到"<unnamed>"，需要按位置区分时传入std::source_location::current()
 
     /**
      * @brief: 基于原子变量的简单自旋锁实现,适用于等待时间短，竞争小的场景
@@ -25,22 +29,36 @@ namespace plib::core::concurrent
     class Spinlock
     {
     public:
-        Spinlock() = default;
+        Spinlock() noexcept = default;
+        explicit Spinlock(const std::source_location &loc) : _probe(nullptr, loc) {}
+        explicit Spinlock(const char *name, std::source_location loc = std::source_location::current())
+            : _probe(name, loc)
+        {
+        }
 
         void lock()
         {
+            if (!flag.test_and_set(std::memory_order_acquire))
+            {
+                _probe.acquired();
+                return;
+            }
+            auto wait_start = _probe.begin_wait();
             while (flag.test_and_set(std::memory_order_acquire))
             {
             }
+            _probe.acquired_after_wait(wait_start);
         }
 
         void unlock()
         {
+            _probe.released();
             flag.clear(std::memory_order_release);
         }
 
     private:
         std::atomic_flag flag;
+        PLIB_NO_UNIQUE_ADDRESS LockProbe _probe;
     };
 
     /**
@@ -49,12 +67,23 @@ namespace plib::core::concurrent
     class FairSpinLock
     {
     public:
-        FairSpinLock() : _ticket(0), _next(0) {}
+        FairSpinLock() noexcept : _ticket(0), _next(0) {}
+        explicit FairSpinLock(const std::source_location &loc) : _ticket(0), _next(0), _probe(nullptr, loc) {}
+        explicit FairSpinLock(const char *name, std::source_location loc = std::source_location::current())
+            : _ticket(0), _next(0), _probe(name, loc)
+        {
+        }
 
         P_NOTINLINE unsigned int lock()
         {
             auto ticket = _ticket.fetch_add(1, std::memory_order_relaxed);
+            if (ticket == _next.load(std::memory_order_acquire))
+            {
+                _probe.acquired();
+                return ticket;
+            }
 
+            auto wait_start = _probe.begin_wait();
             for (;;)
             {
                 auto position = ticket - _next.load(std::memory_order_acquire);
@@ -67,16 +96,18 @@ namespace plib::core::concurrent
                     CPU_PAUSE();
                 } while (--position);
             }
+            _probe.acquired_after_wait(wait_start);
             return ticket;
         }
 
         void unlock()
         {
-            unlock(_next.load(std::memory_order_relaxed) + 1);
+            unlock(_next.load(std::memory_order_relaxed));
         }
 
         void unlock(unsigned int ticket)
         {
+            _probe.released();
             _next.store(ticket + 1, std::memory_order_release);
         }
 
@@ -84,6 +115,7 @@ namespace plib::core::concurrent
         // 缓存行对齐，避免伪共享
         alignas(CACHE_LINE_SIZE) std::atomic<unsigned int> _ticket;
         alignas(CACHE_LINE_SIZE) std::atomic<unsigned int> _next;
+        PLIB_NO_UNIQUE_ADDRESS LockProbe _probe;
     };
 
     /**
@@ -92,16 +124,29 @@ namespace plib::core::concurrent
     class UnfairSpinlock
     {
     public:
+        UnfairSpinlock() noexcept = default;
+        explicit UnfairSpinlock(const std::source_location &loc) : _probe(nullptr, loc) {}
+        explicit UnfairSpinlock(const char *name, std::source_location loc = std::source_location::current())
+            : _probe(name, loc)
+        {
+        }
         UnfairSpinlock(UnfairSpinlock &) = delete;
         UnfairSpinlock &operator=(UnfairSpinlock &) = delete;
 
         void lock()
         {
+            if (!_lock.exchange(1, std::memory_order_acquire))
+            {
+                _probe.acquired();
+                return;
+            }
+            auto wait_start = _probe.begin_wait();
             for (;;)
             {
                 if (!_lock.load(std::memory_order_relaxed) &&
                     !_lock.exchange(1, std::memory_order_acquire))
                 {
+                    _probe.acquired_after_wait(wait_start);
                     return;
                 }
                 CPU_PAUSE();
@@ -110,11 +155,13 @@ namespace plib::core::concurrent
 
         void unlock()
         {
+            _probe.released();
             _lock.store(0, std::memory_order_release);
         }
 
     private:
         std::atomic<unsigned int> _lock{0};
+        PLIB_NO_UNIQUE_ADDRESS LockProbe _probe;
     };
 
 } // namespace plib::core::concurrent
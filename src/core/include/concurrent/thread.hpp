@@ -26,6 +26,7 @@ namespace plib::core::concurrent {
 	using opt_t = std::uint8_t;
 	template <opt_t> class thread_pool;
 	using task_t = std::function<void()>;
+	template <typename S> using function_t = std::function<S>;
 	using thread_t = std::jthread;
 	using priority_t = std::int8_t;
 
@@ -97,6 +98,35 @@ namespace plib::core::concurrent {
 	template <typename T1, typename T2> struct common_index_type<T1, T2, std::enable_if_t<(std::is_signed_v<T1>&& std::is_unsigned_v<T2>) || (std::is_unsigned_v<T1> && std::is_signed_v<T2>)>> { using S = std::conditional_t<std::is_signed_v<T1>, T1, T2>; using U = std::conditional_t<std::is_unsigned_v<T1>, T1, T2>; static constexpr std::size_t larger_size = (sizeof(S) > sizeof(U)) ? sizeof(S) : sizeof(U); using type = std::conditional_t<larger_size <= 4, std::conditional_t<larger_size == 1 || (sizeof(S) == 2 && sizeof(U) == 1), std::int16_t, std::conditional_t<larger_size == 2 || (sizeof(S) == 4 && sizeof(U) < 4), std::int32_t, std::int64_t>>, std::conditional_t<sizeof(U) == 8, std::uint64_t, std::int64_t>>; };
 	template <typename T1, typename T2> using common_index_type_t = typename common_index_type<T1, T2>::type;
 
+	/**
+	 * @brief: 把[first, last)尽量均匀地切成num_blocks块，前remainder块各多分一个
+	 */
+	template <typename T>
+	class blocks {
+	public:
+		blocks(const T first_, const T last_, const std::size_t num_blocks_) : first(first_), last(last_), num_blocks(num_blocks_) {
+			if (last > first) {
+				const std::size_t total = static_cast<std::size_t>(last - first);
+				num_blocks = std::clamp<std::size_t>(num_blocks, 1, total);
+				block_size = total / num_blocks;
+				remainder = total % num_blocks;
+			}
+			else {
+				num_blocks = 0;
+			}
+		}
+		T start(const std::size_t blk) const { return first + static_cast<T>(blk * block_size) + static_cast<T>(blk < remainder ? blk : remainder); }
+		T end(const std::size_t blk) const { return (blk == num_blocks - 1) ? last : start(blk + 1); }
+		std::size_t get_num_blocks() const noexcept { return num_blocks; }
+
+	private:
+		T first;
+		T last;
+		std::size_t num_blocks = 0;
+		std::size_t block_size = 0;
+		std::size_t remainder = 0;
+	};
+
 	enum tp : opt_t {
 		none = 0,
 		priority = 1 << 0,
@@ -119,7 +149,8 @@ namespace plib::core::concurrent {
 
 		explicit thread_pool(std::size_t n) : thread_pool(n, [] {}) {}
 
-		template <typename F>
+		// 只接受可调用对象，避免thread_pool(4)这样的整数实参匹配到这里
+		template <typename F> requires std::is_invocable_v<F> || std::is_invocable_v<F, std::size_t>
 		explicit thread_pool(F&& init) : thread_pool(0, std::forward<F>(init)) {}
 
 		template <typename F>
@@ -176,7 +207,7 @@ namespace plib::core::concurrent {
 		multi_future<void> submit_loop(const T1 first, const T2 last, F&& loop, std::size_t n = 0, priority_t p = 0) {
 			if (static_cast<T>(last) > static_cast<T>(first)) {
 				auto loop_ptr = std::make_shared<std::decay_t<F>>(std::forward<F>(loop));
-				blocks blks(static_cast<T>(first), static_cast<T>(last), n ? n : thread_count);
+				blocks<T> blks(static_cast<T>(first), static_cast<T>(last), n ? n : thread_count);
 				multi_future<void> future; future.reserve(blks.get_num_blocks());
 				for (std::size_t blk = 0; blk < blks.get_num_blocks(); ++blk) {
 					future.push_back(submit_task([loop_ptr, start = blks.start(blk), end = blks.end(blk)] { for (T i = start; i < end; ++i) (*loop_ptr)(i); }, p));
@@ -237,7 +268,8 @@ namespace plib::core::concurrent {
 		void reset() { reset(0, [](std::size_t) {}); }
 		void reset(std::size_t n) { reset(n, [](std::size_t) {}); }
 
-		template <typename F> void reset(F&& init) {
+		template <typename F> requires std::is_invocable_v<F> || std::is_invocable_v<F, std::size_t>
+		void reset(F&& init) {
 			reset(0, std::forward<F>(init));
 		}
 
@@ -250,7 +282,7 @@ namespace plib::core::concurrent {
 
 		template <typename F> 
 		void create_threads(std::size_t n, F&& init) {
-			init_func = [init = std::forward<F>(init)](std::size_t i) { init(i); };
+			init_func = [init = std::forward<F>(init)](std::size_t i) { if constexpr (std::is_invocable_v<F, std::size_t>) init(i); else init(); };
 			thread_count = n > 0 ? n : (thread_t::hardware_concurrency() > 0 ? thread_t::hardware_concurrency() : 1);
 			threads = std::make_unique<thread_t[]>(thread_count);
 			{ std::scoped_lock l(tasks_mutex); tasks_running = thread_count; }
@@ -264,11 +296,30 @@ namespace plib::core::concurrent {
 			while (true) {
 				std::unique_lock l(tasks_mutex);
 				--tasks_running;
-				if (waiting && (tasks_running == 0) && (pause_enabled ? (paused || tasks.empty()) : tasks.empty())) tasks_done_cv.notify_all();
-				task_available_cv.wait(l, stop_token, [this] { return !(pause_enabled ? (paused || tasks.empty()) : tasks.empty()); });
+				if (waiting && (tasks_running == 0) && queue_idle()) tasks_done_cv.notify_all();
+				task_available_cv.wait(l, stop_token, [this] { return !queue_idle(); });
 				if (stop_token.stop_requested()) break;
 				{ task_t task = pop_task(); ++tasks_running; l.unlock(); try { task(); } catch (...) {} }
 			}
+			cleanup_func(idx);
+		}
+
+		void destroy_threads() {
+			for (std::size_t i = 0; i < thread_count; ++i) threads[i].request_stop();
+			for (std::size_t i = 0; i < thread_count; ++i) threads[i].join();
+		}
+
+		template <typename F>
+		void reset_pool(std::size_t n, F&& init) {
+			wait();
+			destroy_threads();
+			create_threads(n, std::forward<F>(init));
+		}
+
+		// 暂停时队列中的任务不会被取出，视为空闲
+		bool queue_idle() const {
+			if constexpr (pause_enabled) return paused || tasks.empty();
+			else return tasks.empty();
 		}
 
 		task_t pop_task() {
@@ -0,0 +1,297 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-20 16:32:08
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-20 16:32:08
+ * @FilePath: \plib\src\core\include\memory\arena.hpp
+ * @Description: 单调递增(bump-pointer)的内存区域，适合同生同灭的请求级对象：逐个分配只移动指针，整体释放只重置指针
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_MEMORY_ARENA_HPP_
+#define PLIB_CORE_MEMORY_ARENA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "plib_macros.hpp"
+
+namespace plib::core::memory
+{
+    /**
+     * @brief: 单调内存区域
+     * 内存按块(chunk)向上游申请，块内按指针递增分配，单个对象的释放是空操作(最后一次分配除外)。
+     * reset()运行登记的析构函数后把指针拨回第一个块，所有块保留下来给下一轮复用，不向上游归还;
+     * release()额外把所有块还给上游。
+     * 非线程安全，一个请求/一个线程使用一个Arena。
+     */
+    class Arena
+    {
+        struct Chunk
+        {
+            Chunk *next;
+            std::size_t size; // 数据区字节数，数据区紧跟在块头之后
+        };
+
+        // 登记的析构函数，节点本身也分配在Arena中
+        struct Finalizer
+        {
+            void (*destroy)(void *);
+            void *object;
+            Finalizer *next;
+        };
+
+        static constexpr std::size_t kHeaderSize = (sizeof(Chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+    public:
+        static constexpr std::size_t kDefaultChunkSize = 64 * 1024;
+
+        /**
+         * @param chunk_size: 每个块数据区的大小，超过该大小的分配会单独申请一个足够大的块
+         * @param upstream: 块的来源
+         */
+        explicit Arena(std::size_t chunk_size = kDefaultChunkSize,
+                       std::pmr::memory_resource *upstream = std::pmr::new_delete_resource()) noexcept
+            : _chunkSize(chunk_size), _upstream(upstream)
+        {
+        }
+
+        ~Arena() { release(); }
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+        {
+            std::uintptr_t p = (_ptr + alignment - 1) & ~(alignment - 1);
+            // p为0说明还没有块，0字节的分配也要走慢路径拿到有效地址；
+            // 比较剩余空间而不是p + bytes，bytes很大时加法会回绕
+            P_LIKELY if (p != 0 && p <= _end && bytes <= _end - p)
+            {
+                _ptr = p + bytes;
+                return reinterpret_cast<void *>(p);
+            }
+            return _allocate_slow(bytes, alignment);
+        }
+
+        // 只有最后一次分配可以真正回收，其余情况是空操作
+        void deallocate(void *p, std::size_t bytes) noexcept
+        {
+            if (reinterpret_cast<std::uintptr_t>(p) + bytes == _ptr)
+                _ptr = reinterpret_cast<std::uintptr_t>(p);
+        }
+
+        // 未初始化的T数组
+        template <typename T>
+        T *allocate_array(std::size_t n)
+        {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                throw std::bad_array_new_length();
+            return static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+        }
+
+        /**
+         * @brief: 在Arena中构造对象，非平凡析构的类型会登记析构函数，在reset()/release()时逆序调用
+         */
+        template <typename T, typename... Args>
+        T *create(Args &&...args)
+        {
+            void *mem = allocate(sizeof(T), alignof(T));
+            if constexpr (std::is_trivially_destructible_v<T>)
+            {
+                return ::new (mem) T(std::forward<Args>(args)...);
+            }
+            else
+            {
+                // 先分配登记节点，构造成功后不会再因内存不足而漏掉析构
+                auto *node = static_cast<Finalizer *>(allocate(sizeof(Finalizer), alignof(Finalizer)));
+                T *obj = ::new (mem) T(std::forward<Args>(args)...);
+                *node = {[](void *o)
+                         { static_cast<T *>(o)->~T(); },
+                         obj, _finalizers};
+                _finalizers = node;
+                return obj;
+            }
+        }
+
+        // 登记任意清理函数，reset()/release()时按登记的逆序调用
+        void register_destructor(void (*destroy)(void *), void *object)
+        {
+            auto *node = static_cast<Finalizer *>(allocate(sizeof(Finalizer), alignof(Finalizer)));
+            *node = {destroy, object, _finalizers};
+            _finalizers = node;
+        }
+
+        /**
+         * @brief: 运行登记的析构函数，指针回到第一个块，保留所有块
+         */
+        void reset() noexcept
+        {
+            _run_finalizers();
+            _current = _head;
+            _retired = 0;
+            if (_current != nullptr)
+                _enter(_current);
+            else
+                _ptr = _end = 0;
+        }
+
+        /**
+         * @brief: reset()并把所有块还给上游
+         */
+        void release() noexcept
+        {
+            _run_finalizers();
+            while (_head != nullptr)
+            {
+                Chunk *next = _head->next;
+                _upstream->deallocate(_head, kHeaderSize + _head->size, alignof(std::max_align_t));
+                _head = next;
+            }
+            _current = nullptr;
+            _ptr = _end = 0;
+            _retired = 0;
+            _reserved = 0;
+            _chunkCount = 0;
+        }
+
+        // 自上次reset以来分配出去的字节数(含对齐填充和块尾浪费)
+        std::size_t bytes_allocated() const noexcept
+        {
+            return _current == nullptr ? 0 : _retired + (_ptr - _data(_current));
+        }
+        // 持有的块数据区总字节数
+        std::size_t bytes_reserved() const noexcept { return _reserved; }
+        std::size_t chunk_count() const noexcept { return _chunkCount; }
+        std::pmr::memory_resource *upstream() const noexcept { return _upstream; }
+
+    private:
+        static std::uintptr_t _data(Chunk *chunk) noexcept
+        {
+            return reinterpret_cast<std::uintptr_t>(chunk) + kHeaderSize;
+        }
+
+        void _enter(Chunk *chunk) noexcept
+        {
+            _ptr = _data(chunk);
+            _end = _ptr + chunk->size;
+        }
+
+        P_NOTINLINE void *_allocate_slow(std::size_t bytes, std::size_t alignment)
+        {
+            // 最坏情况下需要alignment-1字节的填充，再加上块头
+            if (bytes > std::numeric_limits<std::size_t>::max() - alignment - kHeaderSize)
+                throw std::bad_alloc();
+            const std::size_t need = bytes + alignment - 1;
+            Chunk *next = _current != nullptr ? _current->next : _head;
+            // 优先复用reset之后保留的块，放不下时在当前块之后插入一个新块
+            if (next == nullptr || next->size < need)
+            {
+                std::size_t size = need > _chunkSize ? need : _chunkSize;
+                auto *chunk = static_cast<Chunk *>(_upstream->allocate(kHeaderSize + size, alignof(std::max_align_t)));
+                chunk->size = size;
+                chunk->next = next;
+                if (_current != nullptr)
+                    _current->next = chunk;
+                else
+                    _head = chunk;
+                _reserved += size;
+                ++_chunkCount;
+                next = chunk;
+            }
+            if (_current != nullptr)
+                _retired += _end - _data(_current);
+            _current = next;
+            _enter(_current);
+            std::uintptr_t p = (_ptr + alignment - 1) & ~(alignment - 1);
+            _ptr = p + bytes;
+            return reinterpret_cast<void *>(p);
+        }
+
+        void _run_finalizers() noexcept
+        {
+            while (_finalizers != nullptr)
+            {
+                Finalizer *node = _finalizers;
+                _finalizers = node->next;
+                node->destroy(node->object);
+            }
+        }
+
+        std::uintptr_t _ptr = 0;
+        std::uintptr_t _end = 0;
+        Chunk *_current = nullptr;
+        Chunk *_head = nullptr;
+        Finalizer *_finalizers = nullptr;
+        std::size_t _retired = 0;
+        std::size_t _reserved = 0;
+        std::size_t _chunkCount = 0;
+        std::size_t _chunkSize;
+        std::pmr::memory_resource *_upstream;
+    };
+
+    /**
+     * @brief: Arena的std::pmr::memory_resource适配器
+     * 用于std::pmr容器以及接受memory_resource/pmr分配器的plib容器(SmallVector、flat_map、flat_set)。
+     */
+    class ArenaResource : public std::pmr::memory_resource
+    {
+    public:
+        explicit ArenaResource(Arena &arena) noexcept : _arena(&arena) {}
+
+        Arena &arena() const noexcept { return *_arena; }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            return _arena->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, std::size_t) override
+        {
+            _arena->deallocate(p, bytes);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            auto *rhs = dynamic_cast<const ArenaResource *>(&other);
+            return rhs != nullptr && rhs->_arena == _arena;
+        }
+
+    private:
+        Arena *_arena;
+    };
+
+    /**
+     * @brief: Arena的标准分配器，不需要虚调用，适合固定使用Arena的容器
+     */
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        explicit ArenaAllocator(Arena &arena) noexcept : _arena(&arena) {}
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) noexcept : _arena(&other.arena()) {}
+
+        T *allocate(std::size_t n) { return _arena->allocate_array<T>(n); }
+        void deallocate(T *p, std::size_t n) noexcept { _arena->deallocate(p, n * sizeof(T)); }
+
+        Arena &arena() const noexcept { return *_arena; }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U> &other) const noexcept { return _arena == &other.arena(); }
+
+    private:
+        Arena *_arena;
+    };
+} // namespace plib::core::memory
+
+#endif // PLIB_CORE_MEMORY_ARENA_HPP_
@@ -0,0 +1,305 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-20 19:05:44
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-20 19:05:44
+ * @FilePath: \plib\src\core\include\memory\block_provider.hpp
+ * @Description: 内存池的大块内存来源：默认走全局堆，MmapBlockProvider直接mmap并尽量使用大页以减少TLB缺失
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_MEMORY_BLOCK_PROVIDER_HPP_
+#define PLIB_CORE_MEMORY_BLOCK_PROVIDER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <vector>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace plib::core::memory
+{
+    /**
+     * @brief: 内存池向外申请内存块的接口
+     * MemoryPool、ConcurrentMemoryPool、utils::ObjectPool以及utils/safe_memorypool.hpp中的池
+     * 都通过它申请/归还整块内存，申请时给出块大小和对齐，归还时给出相同的参数。
+     * 直接复用std::pmr::memory_resource，Arena等按memory_resource设计的组件也能把它当作上游。
+     */
+    using BlockProvider = std::pmr::memory_resource;
+
+    // 默认的块来源：::operator new/delete(带对齐)
+    inline BlockProvider *default_block_provider() noexcept
+    {
+        return std::pmr::new_delete_resource();
+    }
+
+    // MmapBlockProvider的大页策略
+    enum class HugePagePolicy
+    {
+        NONE,        // 普通页
+        TRANSPARENT, // 按大页对齐映射并madvise(MADV_HUGEPAGE)，由内核透明大页(THP)决定是否使用
+        EXPLICIT     // 先尝试MAP_HUGETLB(需要预留hugetlbfs页)，失败时退回TRANSPARENT
+    };
+
+    /**
+     * @brief: 基于mmap的块来源
+     * 小于区域(region)一半的块从按大页对齐的区域中切分，这样64KB这类小块也能共享同一个大页的TLB项；
+     * 更大的块单独映射。归还的小块按(大小,对齐)挂在空闲链表上给后续申请复用，区域在析构时统一解除映射，
+     * 因此它必须比使用它的池活得更久。线程安全，只在池的慢路径(申请新块)上被调用。
+     * 非Linux平台退化为::operator new。
+     */
+    class MmapBlockProvider : public std::pmr::memory_resource
+    {
+    public:
+        // x86-64和ARM64(4K基础页)上PMD级大页的大小
+        static constexpr std::size_t kHugePageSize = 2 * 1024 * 1024;
+
+        struct Options
+        {
+            HugePagePolicy huge_pages = HugePagePolicy::TRANSPARENT;
+            // 映射时立即分配物理页(MAP_POPULATE)，把缺页开销挪到启动阶段
+            bool populate = false;
+            // 切分小块的区域大小，向上取整到kHugePageSize
+            std::size_t region_size = kHugePageSize;
+        };
+
+        MmapBlockProvider() : MmapBlockProvider(Options()) {}
+        explicit MmapBlockProvider(const Options &options) noexcept
+            : _options(options)
+        {
+            _options.region_size = _round_up(options.region_size == 0 ? kHugePageSize : options.region_size, kHugePageSize);
+        }
+
+        ~MmapBlockProvider() override
+        {
+            for (const Mapping &m : _regions)
+                _unmap(m.addr, m.length, kHugePageSize);
+        }
+
+        MmapBlockProvider(const MmapBlockProvider &) = delete;
+        MmapBlockProvider &operator=(const MmapBlockProvider &) = delete;
+
+        const Options &options() const noexcept { return _options; }
+        // 当前映射的总字节数
+        std::size_t mapped_bytes() const noexcept { return _mappedBytes.load(std::memory_order_relaxed); }
+        // 成功使用MAP_HUGETLB的映射数
+        std::size_t hugetlb_mappings() const noexcept { return _hugetlbMappings.load(std::memory_order_relaxed); }
+        // MAP_HUGETLB失败后退回普通映射的次数
+        std::size_t hugetlb_fallbacks() const noexcept { return _hugetlbFallbacks.load(std::memory_order_relaxed); }
+        // madvise(MADV_HUGEPAGE)成功的映射数
+        std::size_t transparent_mappings() const noexcept { return _thpMappings.load(std::memory_order_relaxed); }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            if (_dedicated(bytes, alignment))
+                return _map(_dedicated_length(bytes), alignment);
+
+            _normalize(bytes, alignment);
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (FreeList &list : _freeLists)
+            {
+                if (list.bytes == bytes && list.alignment == alignment && list.head != nullptr)
+                {
+                    FreeNode *node = list.head;
+                    list.head = node->next;
+                    return node;
+                }
+            }
+            std::uintptr_t p = _round_up(_cursor, alignment);
+            if (_cursor == 0 || p + bytes > _limit)
+            {
+                // 先预留记录位置，映射之后的push_back不会再抛出，区域不会泄漏
+                if (_regions.size() == _regions.capacity())
+                    _regions.reserve(_regions.empty() ? 8 : _regions.size() * 2);
+                void *region = _map(_options.region_size, kHugePageSize);
+                _regions.push_back({region, _options.region_size});
+                _cursor = reinterpret_cast<std::uintptr_t>(region);
+                _limit = _cursor + _options.region_size;
+                p = _round_up(_cursor, alignment);
+            }
+            _cursor = p + bytes;
+            return reinterpret_cast<void *>(p);
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+        {
+            if (_dedicated(bytes, alignment))
+            {
+                _unmap(p, _dedicated_length(bytes), alignment);
+                return;
+            }
+            _normalize(bytes, alignment);
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto *node = static_cast<FreeNode *>(p);
+            for (FreeList &list : _freeLists)
+            {
+                if (list.bytes == bytes && list.alignment == alignment)
+                {
+                    node->next = list.head;
+                    list.head = node;
+                    return;
+                }
+            }
+            node->next = nullptr;
+            _freeLists.push_back({bytes, alignment, node});
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        struct Mapping
+        {
+            void *addr;
+            std::size_t length;
+        };
+
+        struct FreeNode
+        {
+            FreeNode *next;
+        };
+
+        struct FreeList
+        {
+            std::size_t bytes;
+            std::size_t alignment;
+            FreeNode *head;
+        };
+
+        static constexpr std::uintptr_t _round_up(std::uintptr_t v, std::size_t align) noexcept
+        {
+            return (v + align - 1) & ~static_cast<std::uintptr_t>(align - 1);
+        }
+
+        static std::size_t _page_size() noexcept
+        {
+#if defined(__linux__)
+            static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            return size;
+#else
+            return 4096;
+#endif
+        }
+
+        // @brief: 归还的小块要写入FreeNode，申请与归还都把尺寸和对齐抬到至少容纳一个FreeNode
+        static void _normalize(std::size_t &bytes, std::size_t &alignment) noexcept
+        {
+            if (alignment < alignof(FreeNode))
+                alignment = alignof(FreeNode);
+            bytes = _round_up(bytes < sizeof(FreeNode) ? sizeof(FreeNode) : bytes, alignof(FreeNode));
+        }
+
+        bool _dedicated(std::size_t bytes, std::size_t alignment) const noexcept
+        {
+            return bytes > _options.region_size / 2 || alignment > kHugePageSize;
+        }
+
+        std::size_t _dedicated_length(std::size_t bytes) const noexcept
+        {
+            // 申请与归还按相同规则取整，不需要额外记录映射长度
+            return _options.huge_pages == HugePagePolicy::NONE ? _round_up(bytes, _page_size())
+                                                                : _round_up(bytes, kHugePageSize);
+        }
+
+        void *_map(std::size_t length, std::size_t alignment)
+        {
+#if defined(__linux__)
+            const bool huge = _options.huge_pages != HugePagePolicy::NONE && length % kHugePageSize == 0;
+#if defined(MAP_HUGETLB)
+            if (huge && _options.huge_pages == HugePagePolicy::EXPLICIT && alignment <= kHugePageSize)
+            {
+                int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (_options.populate ? MAP_POPULATE : 0);
+                void *p = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+                if (p != MAP_FAILED)
+                {
+                    _hugetlbMappings.fetch_add(1, std::memory_order_relaxed);
+                    _mappedBytes.fetch_add(length, std::memory_order_relaxed);
+                    return p;
+                }
+                // 没有预留的hugetlbfs页时退回透明大页
+                _hugetlbFallbacks.fetch_add(1, std::memory_order_relaxed);
+            }
+#endif
+            if (huge && alignment < kHugePageSize)
+                alignment = kHugePageSize;
+            const std::size_t page = _page_size();
+            const std::size_t slack = alignment > page ? alignment - page : 0;
+            // 透明大页要在缺页之前madvise才生效，这种情况下不用MAP_POPULATE，改为madvise之后再预取
+            const bool populate_now = _options.populate && !huge;
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_POPULATE)
+            if (populate_now && slack == 0)
+                flags |= MAP_POPULATE;
+#endif
+            void *raw = mmap(nullptr, length + slack, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (raw == MAP_FAILED)
+                throw std::bad_alloc();
+            // 多映射slack字节后裁掉首尾，得到按alignment对齐的区间
+            std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(raw);
+            std::uintptr_t aligned = _round_up(begin, alignment);
+            if (aligned != begin)
+                munmap(raw, aligned - begin);
+            if (std::uintptr_t tail = begin + length + slack - (aligned + length); tail != 0)
+                munmap(reinterpret_cast<void *>(aligned + length), tail);
+            void *p = reinterpret_cast<void *>(aligned);
+#if defined(MADV_HUGEPAGE)
+            if (huge && madvise(p, length, MADV_HUGEPAGE) == 0)
+                _thpMappings.fetch_add(1, std::memory_order_relaxed);
+#endif
+            if (_options.populate && (huge || slack != 0))
+                _prefault(p, length);
+            _mappedBytes.fetch_add(length, std::memory_order_relaxed);
+            return p;
+#else
+            void *p = ::operator new(length, std::align_val_t(alignment));
+            _mappedBytes.fetch_add(length, std::memory_order_relaxed);
+            return p;
+#endif
+        }
+
+        void _unmap(void *p, std::size_t length, std::size_t alignment) noexcept
+        {
+#if defined(__linux__)
+            (void)alignment;
+            munmap(p, length);
+#else
+            ::operator delete(p, std::align_val_t(alignment));
+#endif
+            _mappedBytes.fetch_sub(length, std::memory_order_relaxed);
+        }
+
+        void _prefault(void *p, std::size_t length) noexcept
+        {
+#if defined(MADV_POPULATE_WRITE)
+            if (madvise(p, length, MADV_POPULATE_WRITE) == 0)
+                return;
+#endif
+            // 旧内核不支持MADV_POPULATE_WRITE，逐页写入触发缺页
+            const std::size_t page = _page_size();
+            auto *bytes = static_cast<volatile unsigned char *>(p);
+            for (std::size_t off = 0; off < length; off += page)
+                bytes[off] = 0;
+        }
+
+        Options _options;
+        std::mutex _mutex;
+        std::vector<Mapping> _regions;
+        std::vector<FreeList> _freeLists;
+        std::uintptr_t _cursor = 0;
+        std::uintptr_t _limit = 0;
+        std::atomic<std::size_t> _mappedBytes{0};
+        std::atomic<std::size_t> _hugetlbMappings{0};
+        std::atomic<std::size_t> _hugetlbFallbacks{0};
+        std::atomic<std::size_t> _thpMappings{0};
+    };
+} // namespace plib::core::memory
+
+#endif // PLIB_CORE_MEMORY_BLOCK_PROVIDER_HPP_
@@ -0,0 +1,391 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-20 09:40:18
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-20 09:40:18
+ * @FilePath: \plib\src\core\include\memory\concurrent_memorypool.hpp
+ * @Description: 无锁的线程安全定长内存池：线程私有弹匣(magazine) + 带版本号的全局空闲弹匣栈，只有申请新内存块时才加锁
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_MEMORY_CONCURRENT_MEMORYPOOL_HPP_
+#define PLIB_CORE_MEMORY_CONCURRENT_MEMORYPOOL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "plib_macros.hpp"
+#include "memory/block_provider.hpp"
+#include "memory/heap_profiler.hpp"
+#include "memory/thread_cache.hpp"
+
+namespace plib::core::memory
+{
+    /**
+     * @brief: 多线程定长对象池，适合在不同线程上分配/释放的小对象(如消息)
+     * 三层结构:
+     *   1. 每个线程两个弹匣(loaded/previous)，分配和释放只操作线程私有的链表，没有原子操作;
+     *   2. 弹匣满/空时与全局仓库(depot)整体交换，仓库是以 {版本号,描述符下标} 打包成64位的无锁栈，
+     *      只需要64位CAS，x86-64和ARM64上都是无锁的，版本号避免ABA;
+     *   3. 仓库也为空时进入慢路径，在互斥锁下申请新的内存块并切分成弹匣。
+     * 内存块在池析构时才释放，池析构时调用者需保证所有线程都已不再使用该池。
+     * @param BlockSize: 每次向系统申请的内存块字节数
+     * @param MagazineSize: 每个弹匣的槽位数，决定了与全局仓库交互的频率
+     */
+    template <typename T, std::size_t BlockSize = 64 * 1024, std::size_t MagazineSize = 64>
+    class ConcurrentMemoryPool
+    {
+        union Slot
+        {
+            Slot *next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        // 弹匣：一条由slot->next串起的链表
+        struct Magazine
+        {
+            Slot *head = nullptr;
+            std::uint32_t count = 0;
+        };
+
+        // 仓库中的弹匣描述符，由池持有，永远不会交给使用者，因此读取next不会与用户数据竞争
+        struct Descriptor
+        {
+            std::atomic<std::uint32_t> next{0};
+            Magazine magazine;
+        };
+
+        struct LocalCache
+        {
+            Magazine loaded;
+            Magazine previous;
+        };
+
+        static constexpr std::size_t kSlotsPerBlock = BlockSize / sizeof(Slot);
+        static constexpr std::uint32_t kDescriptorChunkShift = 10;
+        static constexpr std::uint32_t kDescriptorChunkSize = 1u << kDescriptorChunkShift;
+        static constexpr std::uint32_t kMaxDescriptorChunks = 1024;
+
+        static_assert(MagazineSize >= 1, "MagazineSize must be positive");
+        static_assert(kSlotsPerBlock >= MagazineSize, "BlockSize too small for one magazine");
+
+    public:
+        typedef T value_type;
+        typedef T *pointer;
+        typedef const T *const_pointer;
+        typedef std::size_t size_type;
+
+        // loc: 构造位置，开启PLIB_HEAP_PROFILING时作为统计点
+        explicit ConcurrentMemoryPool(std::source_location loc = std::source_location::current())
+            : ConcurrentMemoryPool(default_block_provider(), loc) {}
+        // 内存块从provider申请，provider必须比池活得更久
+        explicit ConcurrentMemoryPool(BlockProvider *provider, std::source_location loc = std::source_location::current())
+            : _id(detail::ThreadCacheRegistry::instance().register_owner()), _provider(provider),
+              _probe("ConcurrentMemoryPool", sizeof(T), loc) {}
+        ~ConcurrentMemoryPool();
+
+        ConcurrentMemoryPool(const ConcurrentMemoryPool &) = delete;
+        ConcurrentMemoryPool &operator=(const ConcurrentMemoryPool &) = delete;
+
+        // 一次只能分配一个对象，n被忽略
+        pointer allocate(size_type n = 1);
+        void deallocate(pointer p, size_type n = 1) noexcept;
+
+        template <class... Args>
+        pointer newElement(Args &&...args)
+        {
+            pointer result = allocate();
+            try
+            {
+                ::new (static_cast<void *>(result)) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                deallocate(result);
+                throw;
+            }
+            return result;
+        }
+
+        void deleteElement(pointer p) noexcept
+        {
+            if (p != nullptr)
+            {
+                p->~T();
+                deallocate(p);
+            }
+        }
+
+        // 已经从系统申请的槽位总数
+        size_type capacity() const noexcept { return _capacity.load(std::memory_order_relaxed); }
+        size_type block_count() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _blocks.size();
+        }
+        BlockProvider *block_provider() const noexcept { return _provider; }
+
+    private:
+        LocalCache *_local();
+        static void _release_local(void *owner, void *cache);
+
+        Magazine _take_magazine();
+        void _put_magazine(const Magazine &magazine);
+        Magazine _refill();
+
+        Descriptor &_descriptor(std::uint32_t index) const noexcept
+        {
+            return _descriptor_chunks[index >> kDescriptorChunkShift].load(std::memory_order_acquire)[index & (kDescriptorChunkSize - 1)];
+        }
+        bool _pop(std::atomic<std::uint64_t> &stack, std::uint32_t &index) noexcept;
+        void _push(std::atomic<std::uint64_t> &stack, std::uint32_t index) noexcept;
+        std::uint32_t _acquire_descriptor();
+        void _grow_descriptors_locked();
+
+        const std::uint64_t _id;
+        BlockProvider *const _provider;
+        PLIB_NO_UNIQUE_ADDRESS HeapProbe _probe;
+        // 两个栈: 低32位为 下标+1(0表示空)，高32位为版本号
+        alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> _full{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> _free_descriptors{0};
+        alignas(CACHE_LINE_SIZE) mutable std::mutex _mutex; // 慢路径：申请内存块/描述符
+        std::vector<void *> _blocks;
+        std::vector<std::unique_ptr<LocalCache>> _caches;
+        std::vector<LocalCache *> _idle_caches;
+        std::uint32_t _descriptor_count = 0;
+        std::atomic<std::size_t> _capacity{0};
+        std::atomic<Descriptor *> _descriptor_chunks[kMaxDescriptorChunks] = {};
+    };
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    ConcurrentMemoryPool<T, BlockSize, MagazineSize>::~ConcurrentMemoryPool()
+    {
+        // 注销之后退出的线程不会再把缓存还给本池
+        detail::ThreadCacheRegistry::instance().unregister_owner(_id);
+        for (void *block : _blocks)
+            _provider->deallocate(block, kSlotsPerBlock * sizeof(Slot), alignof(Slot));
+        for (auto &chunk : _descriptor_chunks)
+            delete[] chunk.load(std::memory_order_relaxed);
+    }
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    P_FORCE_INLINE typename ConcurrentMemoryPool<T, BlockSize, MagazineSize>::LocalCache *
+    ConcurrentMemoryPool<T, BlockSize, MagazineSize>::_local()
+    {
+        auto &list = detail::t_thread_caches;
+        if (void *cache = list.find(_id))
+            return static_cast<LocalCache *>(cache);
+        LocalCache *cache;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            // 优先复用已退出线程留下的缓存
+            if (!_idle_caches.empty())
+            {
+                cache = _idle_caches.back();
+                _idle_caches.pop_back();
+            }
+            else
+            {
+                cache = _caches.emplace_back(std::make_unique<LocalCache>()).get();
+            }
+        }
+        list.add({_id, this, cache, &_release_local});
+        return cache;
+    }
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    void ConcurrentMemoryPool<T, BlockSize, MagazineSize>::_release_local(void *owner, void *cache)
+    {
+        auto *pool = static_cast<ConcurrentMemoryPool *>(owner);
+        auto *local = static_cast<LocalCache *>(cache);
+        if (local->loaded.count != 0)
+            pool->_put_magazine(local->loaded);
+        if (local->previous.count != 0)
+            pool->_put_magazine(local->previous);
+        local->loaded = {};
+        local->previous = {};
+        std::lock_guard<std::mutex> lock(pool->_mutex);
+        pool->_idle_caches.push_back(local);
+    }
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    inline typename ConcurrentMemoryPool<T, BlockSize, MagazineSize>::pointer
+    ConcurrentMemoryPool<T, BlockSize, MagazineSize>::allocate(size_type)
+    {
+        LocalCache *local = _local();
+        if (local->loaded.count == 0)
+        {
+            if (local->previous.count != 0)
+                std::swap(local->loaded, local->previous);
+            else
+                local->loaded = _take_magazine();
+        }
+        Slot *slot = local->loaded.head;
+        local->loaded.head = slot->next;
+        --local->loaded.count;
+        _probe.allocated(slot, sizeof(T));
+        return reinterpret_cast<pointer>(slot);
+    }
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    inline void ConcurrentMemoryPool<T, BlockSize, MagazineSize>::deallocate(pointer p, size_type) noexcept
+    {
+        if (p == nullptr)
+            return;
+        _probe.freed(p, sizeof(T));
+        LocalCache *local = _local();
+        if (local->loaded.count == MagazineSize)
+        {
+            // 两个弹匣都满了才与仓库交互，避免在边界上来回抖动
+            if (local->previous.count == MagazineSize)
+                _put_magazine(local->previous);
+            else if (local->previous.count != 0)
+                std::swap(local->loaded, local->previous);
+            if (local->loaded.count == MagazineSize)
+            {
+                local->previous = local->loaded;
+                local->loaded = {};
+            }
+        }
+        Slot *slot = reinterpret_cast<Slot *>(p);
+        slot->next = local->loaded.head;
+        local->loaded.head = slot;
+        ++local->loaded.count;
+    }
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    typename ConcurrentMemoryPool<T, BlockSize, MagazineSize>::Magazine
+    ConcurrentMemoryPool<T, BlockSize, MagazineSize>::_take_magazine()
+    {
+        std::uint32_t index;
+        if (_pop(_full, index))
+        {
+            Descriptor &d = _descriptor(index);
+            Magazine magazine = d.magazine;
+            d.magazine = {};
+            _push(_free_descriptors, index);
+            return magazine;
+        }
+        return _refill();
+    }
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    void ConcurrentMemoryPool<T, BlockSize, MagazineSize>::_put_magazine(const Magazine &magazine)
+    {
+        std::uint32_t index = _acquire_descriptor();
+        _descriptor(index).magazine = magazine;
+        _push(_full, index);
+    }
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    typename ConcurrentMemoryPool<T, BlockSize, MagazineSize>::Magazine
+    ConcurrentMemoryPool<T, BlockSize, MagazineSize>::_refill()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // 等锁期间可能已有其他线程补充了仓库
+        std::uint32_t index;
+        if (_pop(_full, index))
+        {
+            Descriptor &d = _descriptor(index);
+            Magazine magazine = d.magazine;
+            d.magazine = {};
+            _push(_free_descriptors, index);
+            return magazine;
+        }
+
+        void *raw = _provider->allocate(kSlotsPerBlock * sizeof(Slot), alignof(Slot));
+        _blocks.push_back(raw);
+        Slot *slots = static_cast<Slot *>(raw);
+
+        // 切成若干弹匣，第一个直接返回，其余放进仓库
+        Magazine first;
+        for (std::size_t begin = 0; begin < kSlotsPerBlock; begin += MagazineSize)
+        {
+            std::size_t end = (std::min)(begin + MagazineSize, kSlotsPerBlock);
+            for (std::size_t i = begin; i + 1 < end; ++i)
+                slots[i].next = &slots[i + 1];
+            slots[end - 1].next = nullptr;
+            Magazine magazine{&slots[begin], static_cast<std::uint32_t>(end - begin)};
+            if (begin == 0)
+            {
+                first = magazine;
+                continue;
+            }
+            std::uint32_t d = 0;
+            while (!_pop(_free_descriptors, d))
+                _grow_descriptors_locked();
+            _descriptor(d).magazine = magazine;
+            _push(_full, d);
+        }
+        _capacity.fetch_add(kSlotsPerBlock, std::memory_order_relaxed);
+        return first;
+    }
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    std::uint32_t ConcurrentMemoryPool<T, BlockSize, MagazineSize>::_acquire_descriptor()
+    {
+        std::uint32_t index;
+        while (!_pop(_free_descriptors, index))
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (static_cast<std::uint32_t>(_free_descriptors.load(std::memory_order_acquire)) == 0)
+                _grow_descriptors_locked();
+        }
+        return index;
+    }
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    void ConcurrentMemoryPool<T, BlockSize, MagazineSize>::_grow_descriptors_locked()
+    {
+        std::uint32_t chunk = _descriptor_count >> kDescriptorChunkShift;
+        if (chunk >= kMaxDescriptorChunks)
+            throw std::bad_alloc();
+        _descriptor_chunks[chunk].store(new Descriptor[kDescriptorChunkSize], std::memory_order_release);
+        for (std::uint32_t i = 0; i < kDescriptorChunkSize; ++i)
+            _push(_free_descriptors, _descriptor_count + i);
+        _descriptor_count += kDescriptorChunkSize;
+    }
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    inline bool ConcurrentMemoryPool<T, BlockSize, MagazineSize>::_pop(std::atomic<std::uint64_t> &stack, std::uint32_t &index) noexcept
+    {
+        std::uint64_t head = stack.load(std::memory_order_acquire);
+        for (;;)
+        {
+            std::uint32_t top = static_cast<std::uint32_t>(head);
+            if (top == 0)
+                return false;
+            // 描述符不会被释放，即使top已被其他线程弹出，读取next也是安全的；版本号保证此时CAS失败
+            std::uint32_t next = _descriptor(top - 1).next.load(std::memory_order_relaxed);
+            std::uint64_t desired = ((head >> 32) + 1) << 32 | next;
+            if (stack.compare_exchange_weak(head, desired, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                index = top - 1;
+                return true;
+            }
+        }
+    }
+
+    template <typename T, std::size_t BlockSize, std::size_t MagazineSize>
+    inline void ConcurrentMemoryPool<T, BlockSize, MagazineSize>::_push(std::atomic<std::uint64_t> &stack, std::uint32_t index) noexcept
+    {
+        Descriptor &d = _descriptor(index);
+        std::uint64_t head = stack.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            d.next.store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+            std::uint64_t desired = ((head >> 32) + 1) << 32 | (index + 1);
+            if (stack.compare_exchange_weak(head, desired, std::memory_order_release, std::memory_order_relaxed))
+                return;
+        }
+    }
+} // namespace plib::core::memory
+
+#endif // PLIB_CORE_MEMORY_CONCURRENT_MEMORYPOOL_HPP_
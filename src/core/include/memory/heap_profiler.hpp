@@ -0,0 +1,570 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-21 10:12:36
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-21 10:12:36
+ * @FilePath: \plib\src\core\include\memory\heap_profiler.hpp
+ * @Description: 池分配统计与按字节采样的调用栈记录，编译期开关 PLIB_HEAP_PROFILING，关闭时探针为空类型，不产生任何开销
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_MEMORY_HEAP_PROFILER_HPP_
+#define PLIB_CORE_MEMORY_HEAP_PROFILER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <source_location>
+#include "plib_macros.hpp"
+
+#ifdef PLIB_HEAP_PROFILING
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define P_HEAP_PROFILER_BACKTRACE 1
+#endif
+#if __has_include(<dlfcn.h>) && __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#define P_HEAP_PROFILER_SYMBOLIZE 1
+#endif
+#endif
+
+namespace plib::core::memory
+{
+#ifdef PLIB_HEAP_PROFILING
+    inline constexpr bool kHeapProfilingEnabled = true;
+
+    /**
+     * @brief: 一个统计点(同一构造位置、同一对象大小的池共享)的计数器
+     */
+    struct HeapStats
+    {
+        std::string name;
+        std::string file;
+        std::uint32_t line = 0;
+        std::size_t object_size = 0; // 定长池的对象大小或slab的级别大小，0表示不定长
+
+        std::atomic<std::int64_t> live_bytes{0};
+        std::atomic<std::int64_t> peak_bytes{0};
+        std::atomic<std::uint64_t> allocs{0};
+        std::atomic<std::uint64_t> frees{0};
+        std::atomic<std::uint64_t> alloc_bytes{0};
+
+        void record_alloc(std::size_t bytes) noexcept
+        {
+            allocs.fetch_add(1, std::memory_order_relaxed);
+            alloc_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            auto live = live_bytes.fetch_add(static_cast<std::int64_t>(bytes), std::memory_order_relaxed) + static_cast<std::int64_t>(bytes);
+            auto prev = peak_bytes.load(std::memory_order_relaxed);
+            while (prev < live && !peak_bytes.compare_exchange_weak(prev, live, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        void record_free(std::size_t bytes) noexcept
+        {
+            frees.fetch_add(1, std::memory_order_relaxed);
+            live_bytes.fetch_sub(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * @brief: 某一时刻的统计快照，速率按上次reset以来的平均值计算
+     */
+    struct HeapStatsSnapshot
+    {
+        std::string name;
+        std::string file;
+        std::uint32_t line;
+        std::size_t object_size;
+        std::int64_t live_bytes;
+        std::int64_t peak_bytes;
+        std::uint64_t allocs;
+        std::uint64_t frees;
+        std::uint64_t alloc_bytes;
+        double allocs_per_sec;
+        double bytes_per_sec;
+    };
+
+    /**
+     * @brief: 一次采样：分配的大小、所属统计点和调用栈(frames[0]为最内层)
+     */
+    struct HeapSample
+    {
+        static constexpr std::size_t kMaxFrames = 32;
+
+        const HeapStats *site = nullptr;
+        const void *ptr = nullptr;
+        std::size_t bytes = 0;
+        bool live = false; // 对象尚未释放
+        std::uint32_t depth = 0;
+        void *frames[kMaxFrames];
+    };
+
+    /**
+     * @brief: 全局统计注册表与采样缓冲区，统计点只增不删，指针在进程生命周期内有效
+     * 计数和采样都可以在运行时开关；采样按分配字节数进行，平均每sample_interval()字节采一次，
+     * 间隔服从几何分布，避免与固定的分配模式同步。采样记录放在固定容量的环形缓冲区中，
+     * 可以导出为pprof(heap_v2文本格式)或折叠栈(flamegraph.pl/speedscope)文本。
+     */
+    class HeapProfiler
+    {
+    public:
+        static constexpr std::size_t kDefaultSampleInterval = 512 * 1024;
+        static constexpr std::size_t kDefaultSampleCapacity = 4096;
+
+        static HeapProfiler &instance()
+        {
+            // 故意泄漏，保证静态对象析构阶段池依然可以释放对象
+            static HeapProfiler *profiler = new HeapProfiler();
+            return *profiler;
+        }
+
+        /**
+         * @brief: 获取统计点，以 名字@file:line/对象大小 作为键
+         */
+        HeapStats *site(const char *name, std::size_t object_size, const std::source_location &loc)
+        {
+            std::string key = std::string(name) + "@" + loc.file_name() + ":" + std::to_string(loc.line()) + "/" + std::to_string(object_size);
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _sites.find(key);
+            if (it == _sites.end())
+            {
+                auto *stats = new HeapStats();
+                stats->name = name;
+                stats->file = loc.file_name();
+                stats->line = loc.line();
+                stats->object_size = object_size;
+                it = _sites.emplace(std::move(key), stats).first;
+            }
+            return it->second;
+        }
+
+        // 计数开关，关闭期间的分配和释放都不记录，重新打开后应调用reset()
+        void set_enabled(bool on) noexcept { _enabled.store(on, std::memory_order_relaxed); }
+        bool enabled() const noexcept { return _enabled.load(std::memory_order_relaxed); }
+
+        // 平均采样间隔(字节)，0表示关闭采样
+        void set_sample_interval(std::size_t bytes) noexcept { _interval.store(bytes, std::memory_order_relaxed); }
+        std::size_t sample_interval() const noexcept { return _interval.load(std::memory_order_relaxed); }
+
+        // 采样缓冲区容量，满了之后覆盖最早的记录；修改容量会清空已有采样
+        void set_sample_capacity(std::size_t n)
+        {
+            std::lock_guard<std::mutex> lock(_sampleMutex);
+            _clear_samples_locked();
+            _capacity = n == 0 ? 1 : n;
+            _samples.clear();
+            _samples.shrink_to_fit();
+        }
+
+        P_FORCE_INLINE void on_alloc(HeapStats *stats, const void *p, std::size_t bytes) noexcept
+        {
+            if (!_enabled.load(std::memory_order_relaxed))
+                return;
+            stats->record_alloc(bytes);
+            const std::size_t interval = _interval.load(std::memory_order_relaxed);
+            if (interval != 0)
+            {
+                ThreadState &t = _tls();
+                t.bytes_until_sample -= static_cast<std::int64_t>(bytes);
+                P_UNLIKELY if (t.bytes_until_sample < 0 || t.interval != interval)
+                {
+                    _sample(stats, p, bytes, interval);
+                }
+            }
+        }
+
+        P_FORCE_INLINE void on_free(HeapStats *stats, const void *p, std::size_t bytes) noexcept
+        {
+            if (!_enabled.load(std::memory_order_relaxed))
+                return;
+            stats->record_free(bytes);
+            // 先查过滤表，只有可能被采样过的地址才加锁
+            P_UNLIKELY if (_filter[_filter_slot(p)].load(std::memory_order_relaxed) != 0)
+            {
+                _unsample(p);
+            }
+        }
+
+        /**
+         * @brief: 按存活字节数降序返回所有统计点的快照
+         */
+        std::vector<HeapStatsSnapshot> snapshot() const
+        {
+            const double seconds = (std::max)(std::chrono::duration<double>(std::chrono::steady_clock::now() - _since.load(std::memory_order_relaxed)).count(), 1e-9);
+            std::vector<HeapStatsSnapshot> result;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                result.reserve(_sites.size());
+                for (const auto &[key, s] : _sites)
+                {
+                    auto allocs = s->allocs.load(std::memory_order_relaxed);
+                    auto bytes = s->alloc_bytes.load(std::memory_order_relaxed);
+                    result.push_back({s->name, s->file, s->line, s->object_size,
+                                      s->live_bytes.load(std::memory_order_relaxed),
+                                      s->peak_bytes.load(std::memory_order_relaxed),
+                                      allocs,
+                                      s->frees.load(std::memory_order_relaxed),
+                                      bytes,
+                                      static_cast<double>(allocs) / seconds,
+                                      static_cast<double>(bytes) / seconds});
+                }
+            }
+            std::sort(result.begin(), result.end(), [](const auto &a, const auto &b)
+                      { return a.live_bytes > b.live_bytes; });
+            return result;
+        }
+
+        // 当前采样缓冲区的拷贝，按采样先后排列
+        std::vector<HeapSample> samples() const
+        {
+            std::lock_guard<std::mutex> lock(_sampleMutex);
+            std::vector<HeapSample> result;
+            result.reserve(_count);
+            for (std::size_t i = 0; i < _count; ++i)
+                result.push_back(_samples[(_next + _capacity - _count + i) % _capacity]);
+            return result;
+        }
+
+        // 清零所有计数器和采样，统计点保留；峰值从当前存活量重新开始
+        void reset()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                for (auto &[key, s] : _sites)
+                {
+                    s->allocs.store(0, std::memory_order_relaxed);
+                    s->frees.store(0, std::memory_order_relaxed);
+                    s->alloc_bytes.store(0, std::memory_order_relaxed);
+                    s->peak_bytes.store(s->live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(_sampleMutex);
+                _clear_samples_locked();
+            }
+            _since.store(std::chrono::steady_clock::now(), std::memory_order_relaxed);
+        }
+
+        std::string report_text() const
+        {
+            std::ostringstream os;
+            os << "name\tobject_size\tlive_bytes\tpeak_bytes\tallocs\tfrees\tallocs_per_sec\tbytes_per_sec\tsource\n";
+            for (const auto &s : snapshot())
+            {
+                os << s.name << '\t' << s.object_size << '\t' << s.live_bytes << '\t' << s.peak_bytes << '\t'
+                   << s.allocs << '\t' << s.frees << '\t' << static_cast<std::uint64_t>(s.allocs_per_sec) << '\t'
+                   << static_cast<std::uint64_t>(s.bytes_per_sec) << '\t' << s.file << ':' << s.line << '\n';
+            }
+            return os.str();
+        }
+
+        /**
+         * @brief: gperftools/pprof的heap_v2文本格式，可直接交给 pprof <binary> <file>
+         * 每条记录为采样到的原始次数和字节数，由pprof按采样间隔换算为估计值
+         */
+        std::string report_pprof() const
+        {
+            struct Totals
+            {
+                std::uint64_t inuse_count = 0, inuse_bytes = 0, alloc_count = 0, alloc_bytes = 0;
+            };
+            std::map<std::vector<void *>, Totals> stacks;
+            Totals total;
+            for (const HeapSample &s : samples())
+            {
+                Totals &t = stacks[std::vector<void *>(s.frames, s.frames + s.depth)];
+                for (Totals *x : {&t, &total})
+                {
+                    x->alloc_count += 1;
+                    x->alloc_bytes += s.bytes;
+                    if (s.live)
+                    {
+                        x->inuse_count += 1;
+                        x->inuse_bytes += s.bytes;
+                    }
+                }
+            }
+            std::ostringstream os;
+            os << "heap profile: " << total.inuse_count << ": " << total.inuse_bytes << " [" << total.alloc_count
+               << ": " << total.alloc_bytes << "] @ heap_v2/" << (std::max)(sample_interval(), std::size_t(1)) << '\n';
+            for (const auto &[frames, t] : stacks)
+            {
+                os << t.inuse_count << ": " << t.inuse_bytes << " [" << t.alloc_count << ": " << t.alloc_bytes << "] @";
+                for (void *f : frames)
+                    os << " 0x" << std::hex << reinterpret_cast<std::uintptr_t>(f) << std::dec;
+                os << '\n';
+            }
+            // pprof按映射表把地址还原到具体的二进制
+            os << "\nMAPPED_LIBRARIES:\n";
+#if defined(__linux__)
+            std::ifstream maps("/proc/self/maps");
+            os << maps.rdbuf();
+#endif
+            return os.str();
+        }
+
+        /**
+         * @brief: 折叠栈文本，每行 "外层;...;内层;[统计点] 估计字节数"，可用flamegraph.pl或speedscope查看
+         * @param live_only: 只统计尚未释放的采样
+         */
+        std::string report_folded(bool live_only = false) const
+        {
+            const double interval = static_cast<double>((std::max)(sample_interval(), std::size_t(1)));
+            std::map<std::string, double> stacks;
+            std::unordered_map<void *, std::string> symbols;
+            for (const HeapSample &s : samples())
+            {
+                if (live_only && !s.live)
+                    continue;
+                std::string line;
+                for (std::uint32_t i = s.depth; i-- > 0;)
+                {
+                    auto it = symbols.find(s.frames[i]);
+                    if (it == symbols.end())
+                        it = symbols.emplace(s.frames[i], _symbolize(s.frames[i])).first;
+                    line += it->second;
+                    line += ';';
+                }
+                line += '[';
+                line += s.site->name;
+                line += ']';
+                // 大小为b的分配被采到的概率是1-exp(-b/interval)，按其倒数换算成无偏估计
+                const double b = static_cast<double>(s.bytes);
+                stacks[line] += b / (1.0 - std::exp(-b / interval));
+            }
+            std::ostringstream os;
+            for (const auto &[line, bytes] : stacks)
+                os << line << ' ' << static_cast<std::uint64_t>(bytes + 0.5) << '\n';
+            return os.str();
+        }
+
+    private:
+        static constexpr std::size_t kFilterSize = 4096;
+
+        struct ThreadState
+        {
+            std::int64_t bytes_until_sample = 0;
+            std::size_t interval = 0; // 倒计时所依据的采样间隔，与当前设置不同时重新开始
+            std::uint64_t rng = 0;
+        };
+
+        HeapProfiler() = default;
+
+        static ThreadState &_tls() noexcept
+        {
+            static thread_local ThreadState state;
+            return state;
+        }
+
+        static std::size_t _filter_slot(const void *p) noexcept
+        {
+            return static_cast<std::size_t>((reinterpret_cast<std::uintptr_t>(p) >> 4) * 0x9E3779B97F4A7C15ull >> 52) & (kFilterSize - 1);
+        }
+
+        // 下一次采样前的字节数，服从均值为interval的指数分布
+        static std::int64_t _next_interval(ThreadState &t, std::size_t interval) noexcept
+        {
+            if (t.rng == 0)
+                t.rng = reinterpret_cast<std::uintptr_t>(&t) | 1;
+            t.rng ^= t.rng << 13;
+            t.rng ^= t.rng >> 7;
+            t.rng ^= t.rng << 17;
+            const double u = (static_cast<double>(t.rng >> 11) + 1.0) * (1.0 / 9007199254740993.0);
+            return static_cast<std::int64_t>(-std::log(u) * static_cast<double>(interval)) + 1;
+        }
+
+        P_NOTINLINE void _sample(const HeapStats *stats, const void *p, std::size_t bytes, std::size_t interval) noexcept
+        {
+            ThreadState &t = _tls();
+            if (t.interval != interval)
+            {
+                // 线程首次采样或间隔被修改：倒计时从随机位置重新开始，而不是总采到这一次分配
+                t.interval = interval;
+                t.bytes_until_sample = _next_interval(t, interval) - static_cast<std::int64_t>(bytes);
+                if (t.bytes_until_sample >= 0)
+                    return;
+            }
+            do
+            {
+                t.bytes_until_sample += _next_interval(t, interval);
+            } while (t.bytes_until_sample < 0);
+
+            HeapSample sample;
+            sample.site = stats;
+            sample.ptr = p;
+            sample.bytes = bytes;
+            sample.live = true;
+#ifdef P_HEAP_PROFILER_BACKTRACE
+            void *frames[HeapSample::kMaxFrames + 1];
+            int depth = ::backtrace(frames, static_cast<int>(HeapSample::kMaxFrames + 1));
+            // 去掉_sample自身
+            for (int i = 1; i < depth; ++i)
+                sample.frames[i - 1] = frames[i];
+            sample.depth = depth > 1 ? static_cast<std::uint32_t>(depth - 1) : 0;
+#endif
+            std::lock_guard<std::mutex> lock(_sampleMutex);
+            try
+            {
+                if (_samples.size() < _capacity)
+                    _samples.resize(_capacity);
+                HeapSample &slot = _samples[_next];
+                if (_count == _capacity && slot.live)
+                    _forget_locked(slot);
+                // 同一地址上一次的采样没有等到释放(例如释放时计数被关闭)，以新的为准
+                if (auto it = _live.find(p); it != _live.end())
+                    _forget_locked(_samples[it->second]);
+                _live.emplace(p, _next);
+            }
+            catch (...)
+            {
+                // 采样是尽力而为的，内存不足时丢弃本次记录
+                return;
+            }
+            _samples[_next] = sample;
+            _filter[_filter_slot(p)].fetch_add(1, std::memory_order_relaxed);
+            _next = (_next + 1) % _capacity;
+            if (_count < _capacity)
+                ++_count;
+        }
+
+        P_NOTINLINE void _unsample(const void *p) noexcept
+        {
+            std::lock_guard<std::mutex> lock(_sampleMutex);
+            auto it = _live.find(p);
+            if (it == _live.end())
+                return;
+            _forget_locked(_samples[it->second]);
+        }
+
+        // 采样对应的对象已释放或记录被覆盖(持有_sampleMutex)
+        void _forget_locked(HeapSample &sample) noexcept
+        {
+            sample.live = false;
+            _live.erase(sample.ptr);
+            _filter[_filter_slot(sample.ptr)].fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        void _clear_samples_locked() noexcept
+        {
+            for (std::size_t i = 0; i < _samples.size(); ++i)
+                if (_samples[i].live)
+                    _forget_locked(_samples[i]);
+            _next = 0;
+            _count = 0;
+        }
+
+        static std::string _symbolize(void *addr)
+        {
+#ifdef P_HEAP_PROFILER_SYMBOLIZE
+            Dl_info info;
+            if (::dladdr(addr, &info) != 0 && info.dli_sname != nullptr)
+            {
+                int status = 0;
+                char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+                std::string name = status == 0 && demangled != nullptr ? demangled : info.dli_sname;
+                std::free(demangled);
+                // 折叠栈以';'分隔、以最后一个空格分隔计数，符号中的这两个字符需要替换
+                std::replace(name.begin(), name.end(), ';', ':');
+                std::replace(name.begin(), name.end(), ' ', '_');
+                return name;
+            }
+#endif
+            std::ostringstream os;
+            os << "0x" << std::hex << reinterpret_cast<std::uintptr_t>(addr);
+            return os.str();
+        }
+
+        std::atomic<bool> _enabled{true};
+        std::atomic<std::size_t> _interval{kDefaultSampleInterval};
+        std::atomic<std::chrono::steady_clock::time_point> _since{std::chrono::steady_clock::now()};
+
+        mutable std::mutex _mutex;
+        std::map<std::string, HeapStats *> _sites;
+
+        mutable std::mutex _sampleMutex; // 保护以下采样状态
+        std::vector<HeapSample> _samples;
+        std::size_t _capacity = kDefaultSampleCapacity;
+        std::size_t _next = 0;
+        std::size_t _count = 0;
+        std::unordered_map<const void *, std::size_t> _live; // 存活采样的地址 -> 缓冲区下标
+        std::atomic<std::uint32_t> _filter[kFilterSize] = {};
+    };
+
+    /**
+     * @brief: 嵌入到各内存池中的探针，把分配/释放记到统计点上
+     */
+    class HeapProbe
+    {
+    public:
+        // 登记统计点失败(内存不足)时不抛出，该探针之后的分配和释放都不计数
+        HeapProbe(const char *name, std::size_t object_size, const std::source_location &loc) noexcept
+            : _stats(_register(name, object_size, loc)), _loc(loc)
+        {
+        }
+
+        P_FORCE_INLINE void allocated(const void *p, std::size_t bytes) const noexcept
+        {
+            P_LIKELY if (_stats)
+            {
+                HeapProfiler::instance().on_alloc(_stats, p, bytes);
+            }
+        }
+
+        P_FORCE_INLINE void freed(const void *p, std::size_t bytes) const noexcept
+        {
+            P_LIKELY if (_stats)
+            {
+                HeapProfiler::instance().on_free(_stats, p, bytes);
+            }
+        }
+
+        HeapStats *stats() const noexcept { return _stats; }
+        // 统计点的构造位置，rebind出的分配器沿用它，统计仍归到用户代码
+        const std::source_location &location() const noexcept { return _loc; }
+
+    private:
+        static HeapStats *_register(const char *name, std::size_t object_size, const std::source_location &loc) noexcept
+        {
+            try
+            {
+                return HeapProfiler::instance().site(name, object_size, loc);
+            }
+            catch (...)
+            {
+                return nullptr;
+            }
+        }
+
+        HeapStats *_stats;
+        std::source_location _loc;
+    };
+#else
+    inline constexpr bool kHeapProfilingEnabled = false;
+
+    // 关闭统计时的空探针，所有调用都会被内联消除
+    class HeapProbe
+    {
+    public:
+        constexpr HeapProbe(const char *, std::size_t, const std::source_location &) noexcept {}
+
+        constexpr std::source_location location() const noexcept { return {}; }
+
+        constexpr void allocated(const void *, std::size_t) const noexcept {}
+        constexpr void freed(const void *, std::size_t) const noexcept {}
+    };
+#endif
+} // namespace plib::core::memory
+
+#endif // PLIB_CORE_MEMORY_HEAP_PROFILER_HPP_
@@ -8,6 +8,10 @@
 #include <new>
 #include <cstdint>
 #include <algorithm>
+#include <source_location>
+#include "plib_macros.hpp"
+#include "memory/block_provider.hpp"
+#include "memory/heap_profiler.hpp"
 
 namespace plib::core::memory {
 
@@ -32,9 +36,13 @@ public:
   };
 
   /* Member functions */
-  MemoryPool() noexcept;
+  // loc: 构造位置，开启PLIB_HEAP_PROFILING时作为统计点；作为分配器使用时默认构造和转换都不能抛出
+  MemoryPool(std::source_location loc = std::source_location::current()) noexcept;
+  // 内存块从provider申请，provider必须比池活得更久
+  explicit MemoryPool(BlockProvider* provider, std::source_location loc = std::source_location::current()) noexcept;
   MemoryPool(const MemoryPool& memoryPool) noexcept;
   MemoryPool(MemoryPool&& memoryPool) noexcept;
+  // rebind转换：沿用源分配器的块来源和统计位置
   template <class U> MemoryPool(const MemoryPool<U>& memoryPool) noexcept;
 
   ~MemoryPool() noexcept;
@@ -49,6 +57,11 @@ public:
   pointer allocate(size_type n = 1, const_pointer hint = 0);
   void deallocate(pointer p, size_type n = 1);
 
+  // 一次取出n个互不相邻的槽位写入out：先摘空闲链表，再从当前块整段切出
+  void allocate_bulk(size_type n, pointer* out);
+  // 把n个槽位先串成一条链，再整体接到空闲链表头，空指针会被跳过
+  void deallocate_bulk(pointer* p, size_type n);
+
   size_type max_size() const noexcept;
 
   template <class U, class... Args>
@@ -60,7 +73,11 @@ public:
   pointer newElement(Args&&... args);
   void deleteElement(pointer p);
 
+  BlockProvider* block_provider() const noexcept { return provider_; }
+
 private:
+  template <typename U, size_t B> friend class MemoryPool;
+
   union Slot_ {
     value_type element;
     Slot_* next;
@@ -74,6 +91,8 @@ private:
   slot_pointer_ currentSlot_;
   slot_pointer_ lastSlot_;
   slot_pointer_ freeSlots_;
+  BlockProvider* provider_;
+  PLIB_NO_UNIQUE_ADDRESS HeapProbe probe_;
 
   size_type padPointer(data_pointer_ p, size_type align) const noexcept;
   void allocateBlock();
@@ -90,30 +109,42 @@ MemoryPool<T, BlockSize>::padPointer(data_pointer_ p, size_type align) const noe
 }
 
 template <typename T, size_t BlockSize>
-MemoryPool<T, BlockSize>::MemoryPool() noexcept
-  : currentBlock_(nullptr), currentSlot_(nullptr), lastSlot_(nullptr), freeSlots_(nullptr) {}
+MemoryPool<T, BlockSize>::MemoryPool(std::source_location loc) noexcept
+  : MemoryPool(default_block_provider(), loc) {}
+
+template <typename T, size_t BlockSize>
+MemoryPool<T, BlockSize>::MemoryPool(BlockProvider* provider, std::source_location loc) noexcept
+  : currentBlock_(nullptr), currentSlot_(nullptr), lastSlot_(nullptr), freeSlots_(nullptr), provider_(provider),
+    probe_("MemoryPool", sizeof(T), loc) {}
 
 template <typename T, size_t BlockSize>
-MemoryPool<T, BlockSize>::MemoryPool(const MemoryPool& memoryPool) noexcept : MemoryPool() {}
+MemoryPool<T, BlockSize>::MemoryPool(const MemoryPool& memoryPool) noexcept
+  : currentBlock_(nullptr), currentSlot_(nullptr), lastSlot_(nullptr), freeSlots_(nullptr), provider_(memoryPool.provider_),
+    probe_(memoryPool.probe_) {}
 
 template <typename T, size_t BlockSize>
-MemoryPool<T, BlockSize>::MemoryPool(MemoryPool&& memoryPool) noexcept {
+MemoryPool<T, BlockSize>::MemoryPool(MemoryPool&& memoryPool) noexcept : probe_(memoryPool.probe_) {
   currentBlock_ = memoryPool.currentBlock_;
   memoryPool.currentBlock_ = nullptr;
   currentSlot_  = memoryPool.currentSlot_;
   lastSlot_     = memoryPool.lastSlot_;
   freeSlots_    = memoryPool.freeSlots_;
+  provider_     = memoryPool.provider_;
 }
 
 template <typename T, size_t BlockSize>
 template <class U>
-MemoryPool<T, BlockSize>::MemoryPool(const MemoryPool<U>& memoryPool) noexcept : MemoryPool() {}
+MemoryPool<T, BlockSize>::MemoryPool(const MemoryPool<U>& memoryPool) noexcept
+  : MemoryPool(memoryPool.provider_, memoryPool.probe_.location()) {}
 
 template <typename T, size_t BlockSize>
 MemoryPool<T, BlockSize>&
 MemoryPool<T, BlockSize>::operator=(MemoryPool&& memoryPool) noexcept {
   if (this != &memoryPool) {
+    // 块链表交换了归属，块的来源也要跟着交换
     std::swap(currentBlock_, memoryPool.currentBlock_);
+    std::swap(provider_, memoryPool.provider_);
+    std::swap(probe_, memoryPool.probe_);
     currentSlot_ = memoryPool.currentSlot_;
     lastSlot_ = memoryPool.lastSlot_;
     freeSlots_ = memoryPool.freeSlots_;
@@ -126,7 +157,7 @@ MemoryPool<T, BlockSize>::~MemoryPool() noexcept {
   slot_pointer_ curr = currentBlock_;
   while (curr != nullptr) {
     slot_pointer_ prev = curr->next;
-    operator delete(reinterpret_cast<void*>(curr));
+    provider_->deallocate(reinterpret_cast<void*>(curr), BlockSize, alignof(std::max_align_t));
     curr = prev;
   }
 }
@@ -145,7 +176,7 @@ MemoryPool<T, BlockSize>::address(const_reference x) const noexcept {
 
 template <typename T, size_t BlockSize>
 void MemoryPool<T, BlockSize>::allocateBlock() {
-  data_pointer_ newBlock = reinterpret_cast<data_pointer_>(operator new(BlockSize));
+  data_pointer_ newBlock = reinterpret_cast<data_pointer_>(provider_->allocate(BlockSize, alignof(std::max_align_t)));
   reinterpret_cast<slot_pointer_>(newBlock)->next = currentBlock_;
   currentBlock_ = reinterpret_cast<slot_pointer_>(newBlock);
   data_pointer_ body = newBlock + sizeof(slot_pointer_);
@@ -157,26 +188,69 @@ void MemoryPool<T, BlockSize>::allocateBlock() {
 template <typename T, size_t BlockSize>
 inline typename MemoryPool<T, BlockSize>::pointer
 MemoryPool<T, BlockSize>::allocate(size_type /*n*/, const_pointer /*hint*/) {
+  pointer result;
   if (freeSlots_ != nullptr) {
-    pointer result = reinterpret_cast<pointer>(freeSlots_);
+    result = reinterpret_cast<pointer>(freeSlots_);
     freeSlots_ = freeSlots_->next;
-    return result;
   }
   else {
     if (currentSlot_ >= lastSlot_)
       allocateBlock();
-    return reinterpret_cast<pointer>(currentSlot_++);
+    result = reinterpret_cast<pointer>(currentSlot_++);
   }
+  probe_.allocated(result, sizeof(T));
+  return result;
 }
 
 template <typename T, size_t BlockSize>
 inline void MemoryPool<T, BlockSize>::deallocate(pointer p, size_type /*n*/) {
   if (p != nullptr) {
+    probe_.freed(p, sizeof(T));
     reinterpret_cast<slot_pointer_>(p)->next = freeSlots_;
     freeSlots_ = reinterpret_cast<slot_pointer_>(p);
   }
 }
 
+template <typename T, size_t BlockSize>
+void MemoryPool<T, BlockSize>::allocate_bulk(size_type n, pointer* out) {
+  size_type i = 0;
+  while (i < n && freeSlots_ != nullptr) {
+    out[i++] = reinterpret_cast<pointer>(freeSlots_);
+    freeSlots_ = freeSlots_->next;
+  }
+  try {
+    while (i < n) {
+      if (currentSlot_ >= lastSlot_)
+        allocateBlock();
+      while (i < n && currentSlot_ < lastSlot_)
+        out[i++] = reinterpret_cast<pointer>(currentSlot_++);
+    }
+  }
+  catch (...) {
+    // 申请新块失败时已取出的槽位还回去(deallocate_bulk会按释放计数，先按分配记上)
+    for (size_type j = 0; j < i; ++j)
+      probe_.allocated(out[j], sizeof(T));
+    deallocate_bulk(out, i);
+    throw;
+  }
+  for (i = 0; i < n; ++i)
+    probe_.allocated(out[i], sizeof(T));
+}
+
+template <typename T, size_t BlockSize>
+void MemoryPool<T, BlockSize>::deallocate_bulk(pointer* p, size_type n) {
+  // 逆序链接，之后的分配按p[0], p[1]...的顺序取回
+  slot_pointer_ head = freeSlots_;
+  for (size_type i = n; i-- > 0;) {
+    if (p[i] != nullptr) {
+      probe_.freed(p[i], sizeof(T));
+      reinterpret_cast<slot_pointer_>(p[i])->next = head;
+      head = reinterpret_cast<slot_pointer_>(p[i]);
+    }
+  }
+  freeSlots_ = head;
+}
+
 template <typename T, size_t BlockSize>
 inline typename MemoryPool<T, BlockSize>::size_type
 MemoryPool<T, BlockSize>::max_size() const noexcept {
@@ -0,0 +1,269 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-20 21:14:05
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-20 21:14:05
+ * @FilePath: \plib\src\core\include\memory\pool_ptr.hpp
+ * @Description: 池化对象的智能指针：unique版本只带一个池指针(或无状态)的删除器，shared版本的引用计数和对象放在同一个池槽位里
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_MEMORY_POOL_PTR_HPP_
+#define PLIB_CORE_MEMORY_POOL_PTR_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "type_traits.hpp"
+
+namespace plib::core::memory
+{
+    namespace detail
+    {
+        // 统一各个池的构造/销毁接口：utils::ObjectPool(animate/recycle)、
+        // MemoryPool/ConcurrentMemoryPool(newElement/deleteElement)、safe_memorypool(new_element/delete_element)
+        template <typename Pool, typename... Args>
+        auto pool_create(Pool &pool, Args &&...args)
+        {
+            if constexpr (requires { pool.animate(std::forward<Args>(args)...); })
+                return pool.animate(std::forward<Args>(args)...);
+            else if constexpr (requires { pool.newElement(std::forward<Args>(args)...); })
+                return pool.newElement(std::forward<Args>(args)...);
+            else
+                return pool.new_element(std::forward<Args>(args)...);
+        }
+
+        template <typename Pool, typename U>
+        void pool_destroy(Pool &pool, U *p)
+        {
+            if constexpr (requires { pool.recycle(p); })
+                pool.recycle(p);
+            else if constexpr (requires { pool.deleteElement(p); })
+                pool.deleteElement(p);
+            else
+                pool.delete_element(p);
+        }
+    } // namespace detail
+
+    /**
+     * @brief: 把对象还给池的删除器，只保存池指针
+     */
+    template <typename Pool>
+    struct PoolDeleter
+    {
+        Pool *pool = nullptr;
+
+        template <typename U>
+        void operator()(U *p) const
+        {
+            detail::pool_destroy(*pool, p);
+        }
+    };
+
+    /**
+     * @brief: 池是静态存储期对象时使用的无状态删除器，unique_ptr与裸指针一样大
+     */
+    template <auto &P>
+    struct StaticPoolDeleter
+    {
+        template <typename U>
+        void operator()(U *p) const
+        {
+            detail::pool_destroy(P, p);
+        }
+    };
+
+    template <typename T, typename Pool>
+    using pool_unique_ptr = std::unique_ptr<T, PoolDeleter<Pool>>;
+
+    template <typename T, auto &P>
+    using static_pool_unique_ptr = std::unique_ptr<T, StaticPoolDeleter<P>>;
+
+    /**
+     * @brief: 从池中构造一个对象并交给pool_unique_ptr
+     * 池按RETURN_NULL策略耗尽时返回空指针
+     */
+    template <typename Pool, typename... Args>
+    pool_unique_ptr<typename Pool::value_type, Pool> make_pool_unique(Pool &pool, Args &&...args)
+    {
+        return pool_unique_ptr<typename Pool::value_type, Pool>(
+            detail::pool_create(pool, std::forward<Args>(args)...), PoolDeleter<Pool>{&pool});
+    }
+
+    template <auto &P, typename... Args>
+    static_pool_unique_ptr<typename std::remove_reference_t<decltype(P)>::value_type, P> make_static_pool_unique(Args &&...args)
+    {
+        return static_pool_unique_ptr<typename std::remove_reference_t<decltype(P)>::value_type, P>(
+            detail::pool_create(P, std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief: 池中引用计数对象的头部，与对象放在同一个槽位
+     * 计数归零时把整个槽位还给pool；池的具体类型由kind在每种池类型一个的销毁函数表里查到，
+     * 头部只有计数、下标和池指针，不超过std::make_shared的控制块
+     */
+    struct pool_shared_header
+    {
+        std::atomic<std::uint32_t> refs{1};
+        std::uint32_t kind = 0;
+        void *pool = nullptr;
+    };
+    static_assert(sizeof(pool_shared_header) <= 2 * sizeof(void *), "pool_shared_header must stay compact");
+
+    namespace detail
+    {
+        using pool_dispose_fn = void (*)(void *pool, pool_shared_header *header);
+
+        // 销毁函数表，常量初始化，任何静态对象的构造函数里都可以使用
+        inline constexpr std::size_t kMaxPoolKinds = 1024;
+        inline std::atomic<pool_dispose_fn> g_pool_disposers[kMaxPoolKinds] = {};
+        inline std::atomic<std::uint32_t> g_pool_kind_count{0};
+
+        inline std::uint32_t register_pool_kind(pool_dispose_fn fn)
+        {
+            const std::uint32_t kind = g_pool_kind_count.fetch_add(1, std::memory_order_relaxed);
+            if (kind >= kMaxPoolKinds)
+                throw std::length_error("pool_shared_ptr: too many pool types");
+            g_pool_disposers[kind].store(fn, std::memory_order_release);
+            return kind;
+        }
+
+        // 每种池类型第一次使用时登记一次
+        template <typename Pool>
+        std::uint32_t pool_kind()
+        {
+            static const std::uint32_t kind = register_pool_kind([](void *pool, pool_shared_header *h)
+                                                                 { pool_destroy(*static_cast<Pool *>(pool), static_cast<typename Pool::value_type *>(h)); });
+            return kind;
+        }
+
+        inline void pool_dispose(pool_shared_header *h) noexcept
+        {
+            g_pool_disposers[h->kind].load(std::memory_order_acquire)(h->pool, h);
+        }
+    } // namespace detail
+
+    /**
+     * @brief: pool_shared_ptr的池元素类型，池按它实例化，例如
+     *   utils::ObjectPool<memory::pool_shared_box<Session>> pool;
+     *   auto s = memory::allocate_pool_shared(pool, args...);
+     */
+    template <typename T>
+    struct pool_shared_box : pool_shared_header
+    {
+        template <typename... Args>
+        explicit pool_shared_box(std::in_place_t, Args &&...args)
+            : value(std::forward<Args>(args)...)
+        {
+        }
+
+        T value;
+    };
+
+    /**
+     * @brief: 侵入式计数的共享指针，只有一个指针大小
+     * 控制块就是槽位头部，不再单独分配；不支持weak引用和别名构造
+     */
+    template <typename T>
+    class pool_shared_ptr
+    {
+    public:
+        typedef T element_type;
+
+        constexpr pool_shared_ptr() noexcept = default;
+        constexpr pool_shared_ptr(std::nullptr_t) noexcept {}
+
+        pool_shared_ptr(const pool_shared_ptr &other) noexcept : _box(other._box)
+        {
+            if (_box != nullptr)
+                _box->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        pool_shared_ptr(pool_shared_ptr &&other) noexcept : _box(std::exchange(other._box, nullptr)) {}
+
+        ~pool_shared_ptr() { _release(); }
+
+        pool_shared_ptr &operator=(const pool_shared_ptr &other) noexcept
+        {
+            pool_shared_ptr(other).swap(*this);
+            return *this;
+        }
+
+        pool_shared_ptr &operator=(pool_shared_ptr &&other) noexcept
+        {
+            pool_shared_ptr(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        void reset() noexcept { pool_shared_ptr().swap(*this); }
+        void swap(pool_shared_ptr &other) noexcept { std::swap(_box, other._box); }
+
+        T *get() const noexcept { return _box != nullptr ? &_box->value : nullptr; }
+        T &operator*() const noexcept { return _box->value; }
+        T *operator->() const noexcept { return &_box->value; }
+        explicit operator bool() const noexcept { return _box != nullptr; }
+
+        std::uint32_t use_count() const noexcept
+        {
+            return _box != nullptr ? _box->refs.load(std::memory_order_relaxed) : 0;
+        }
+
+        friend bool operator==(const pool_shared_ptr &a, const pool_shared_ptr &b) noexcept { return a._box == b._box; }
+        friend bool operator==(const pool_shared_ptr &a, std::nullptr_t) noexcept { return a._box == nullptr; }
+
+    private:
+        template <typename U, typename Pool, typename... Args>
+        friend pool_shared_ptr<U> allocate_pool_shared(Pool &pool, Args &&...args);
+
+        explicit pool_shared_ptr(pool_shared_box<T> *box) noexcept : _box(box) {}
+
+        void _release() noexcept
+        {
+            // acq_rel递减：其他持有者对对象的写入在最后一个持有者销毁前可见
+            if (_box != nullptr && _box->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                detail::pool_dispose(_box);
+        }
+
+        pool_shared_box<T> *_box = nullptr;
+    };
+
+    /**
+     * @brief: allocate_shared风格的构造：对象与引用计数一起放进pool的一个槽位
+     * Pool的元素类型必须是pool_shared_box<T>，池按RETURN_NULL策略耗尽时返回空指针
+     */
+    template <typename T, typename Pool, typename... Args>
+    pool_shared_ptr<T> allocate_pool_shared(Pool &pool, Args &&...args)
+    {
+        static_assert(std::is_same_v<typename Pool::value_type, pool_shared_box<T>>,
+                      "pool must hold pool_shared_box<T>");
+        const std::uint32_t kind = detail::pool_kind<Pool>();
+        pool_shared_box<T> *box = detail::pool_create(pool, std::in_place, std::forward<Args>(args)...);
+        if (box == nullptr)
+            return pool_shared_ptr<T>();
+        box->kind = kind;
+        box->pool = &pool;
+        return pool_shared_ptr<T>(box);
+    }
+
+    // 由池的元素类型推导T
+    template <typename Pool, typename... Args>
+    auto allocate_pool_shared(Pool &pool, Args &&...args)
+        -> pool_shared_ptr<decltype(std::declval<typename Pool::value_type &>().value)>
+    {
+        return allocate_pool_shared<decltype(std::declval<typename Pool::value_type &>().value)>(pool, std::forward<Args>(args)...);
+    }
+} // namespace plib::core::memory
+
+namespace plib::core::type
+{
+    // 只有一个槽位指针，搬移时不需要碰引用计数
+    template <typename T>
+    struct is_trivially_relocatable<memory::pool_shared_ptr<T>> : std::true_type
+    {
+    };
+} // namespace plib::core::type
+
+#endif // PLIB_CORE_MEMORY_POOL_PTR_HPP_
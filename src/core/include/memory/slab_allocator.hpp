@@ -0,0 +1,414 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-20 15:20:36
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-20 15:20:36
+ * @FilePath: \plib\src\core\include\memory\slab_allocator.hpp
+ * @Description: 按尺寸分级的通用slab分配器(8B~32KB)：线程私有空闲链表 + 每级一个中心空闲链表 + 按页申请的span，提供pmr和标准分配器接口
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_MEMORY_SLAB_ALLOCATOR_HPP_
+#define PLIB_CORE_MEMORY_SLAB_ALLOCATOR_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <source_location>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "plib_macros.hpp"
+#include "memory/heap_profiler.hpp"
+#include "memory/thread_cache.hpp"
+
+namespace plib::core::memory
+{
+    /**
+     * @brief: 尺寸分级
+     * 8~128字节按8字节一级(16级)，之后每个2的幂区间再均分4级，最大32KB，共48级。
+     * 相邻两级的大小之比不超过1.25，内部碎片有上界。
+     */
+    struct SlabSizeClasses
+    {
+        static constexpr std::size_t kMaxSize = 32 * 1024;
+        static constexpr std::size_t kCount = 48;
+        static constexpr std::size_t kLarge = kCount; // 超过kMaxSize或对齐要求过大，直接交给operator new
+        static constexpr std::size_t kMaxAlignment = 4096; // span按页对齐，更大的对齐无法保证
+
+        static constexpr std::size_t size_of(std::size_t cls) noexcept
+        {
+            if (cls < 16)
+                return (cls + 1) * 8;
+            std::size_t base = std::size_t(128) << ((cls - 16) / 4);
+            return base + ((cls - 16) % 4 + 1) * (base / 4);
+        }
+
+        static constexpr std::size_t index_of(std::size_t bytes) noexcept
+        {
+            if (bytes <= 128)
+                return bytes == 0 ? 0 : (bytes - 1) / 8;
+            std::size_t lg = std::bit_width(bytes - 1) - 1; // 2^lg < bytes <= 2^(lg+1)
+            std::size_t step = (std::size_t(1) << lg) / 4;
+            return 16 + (lg - 7) * 4 + (bytes - (std::size_t(1) << lg) + step - 1) / step - 1;
+        }
+
+        /**
+         * @brief: 满足大小和对齐要求的级别，槽按级别大小紧密排列，级别大小是对齐的倍数时每个槽都对齐
+         * @return: kLarge表示不由slab分配
+         */
+        static constexpr std::size_t classify(std::size_t bytes, std::size_t alignment) noexcept
+        {
+            if (alignment > kMaxAlignment)
+                return kLarge;
+            if (alignment > 8)
+                bytes = (bytes + alignment - 1) & ~(alignment - 1);
+            if (bytes > kMaxSize)
+                return kLarge;
+            std::size_t cls = index_of(bytes);
+            while (cls < kCount && size_of(cls) % alignment != 0)
+                ++cls;
+            return cls;
+        }
+
+        // 线程缓存与中心链表之间每次搬运的对象数
+        static constexpr std::size_t batch_of(std::size_t cls) noexcept
+        {
+            return std::clamp<std::size_t>(64 * 1024 / size_of(cls), 2, 32);
+        }
+
+        // 每个span的字节数，至少容纳8个对象
+        static constexpr std::size_t span_bytes_of(std::size_t cls) noexcept
+        {
+            return (std::max)(std::size_t(64 * 1024), std::bit_ceil(size_of(cls) * 8));
+        }
+    };
+    static_assert(SlabSizeClasses::size_of(SlabSizeClasses::kCount - 1) == SlabSizeClasses::kMaxSize);
+
+    /**
+     * @brief: 多尺寸的线程安全分配器
+     * 三层结构:
+     *   1. 每个线程每级一条空闲链表，分配/释放不加锁也没有原子操作;
+     *   2. 线程链表为空/过长时与该级的中心链表成批交换，每级一把互斥锁，不同级别之间没有争用;
+     *   3. 中心链表也为空时申请一个按页对齐的span，切分后放入中心链表。
+     * 释放时需要给出与分配时相同的大小和对齐(pmr和标准分配器天然满足)，因此不需要逐对象的头部。
+     * span在分配器析构时才释放，析构时调用者需保证所有线程都已不再使用该分配器。
+     */
+    class SlabHeap
+    {
+        static constexpr std::size_t kPageSize = SlabSizeClasses::kMaxAlignment;
+
+        struct FreeList
+        {
+            void *head = nullptr;
+            std::uint32_t count = 0;
+        };
+
+        struct LocalCache
+        {
+            FreeList lists[SlabSizeClasses::kCount];
+        };
+
+        struct alignas(CACHE_LINE_SIZE) CentralList
+        {
+            std::mutex mutex;
+            void *head = nullptr;
+            std::size_t count = 0;
+        };
+
+#ifdef PLIB_HEAP_PROFILING
+        using ProbeTable = std::array<HeapProbe, SlabSizeClasses::kCount + 1>;
+#else
+        // 关闭统计时HeapProbe是空类型，但数组仍要占kCount+1字节，换成不占空间的占位类型
+        struct ProbeTable
+        {
+            const HeapProbe &operator[](std::size_t) const noexcept
+            {
+                static constexpr HeapProbe probe(nullptr, 0, std::source_location());
+                return probe;
+            }
+        };
+#endif
+
+    public:
+        // loc: 构造位置，开启PLIB_HEAP_PROFILING时每个级别(以及大对象)各有一个统计点
+        explicit SlabHeap(std::source_location loc = std::source_location::current())
+            : _id(detail::ThreadCacheRegistry::instance().register_owner()),
+              _probes(_make_probes(loc, std::make_index_sequence<SlabSizeClasses::kCount + 1>()))
+        {
+        }
+
+        ~SlabHeap()
+        {
+            // 注销之后退出的线程不会再把缓存还给本分配器
+            detail::ThreadCacheRegistry::instance().unregister_owner(_id);
+            for (void *span : _spans)
+                ::operator delete(span, std::align_val_t(kPageSize));
+        }
+
+        SlabHeap(const SlabHeap &) = delete;
+        SlabHeap &operator=(const SlabHeap &) = delete;
+
+        // 进程级的默认实例，故意泄漏，允许在静态析构阶段使用
+        static SlabHeap &global()
+        {
+            static SlabHeap *heap = new SlabHeap();
+            return *heap;
+        }
+
+        void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+        {
+            std::size_t cls = SlabSizeClasses::classify(bytes, alignment);
+            if (cls == SlabSizeClasses::kLarge)
+            {
+                void *p = ::operator new(bytes, std::align_val_t(alignment));
+                _probes[cls].allocated(p, bytes);
+                return p;
+            }
+            FreeList &list = _local()->lists[cls];
+            if (list.head == nullptr)
+                _fetch(cls, list);
+            void *p = list.head;
+            list.head = _next(p);
+            --list.count;
+            _probes[cls].allocated(p, SlabSizeClasses::size_of(cls));
+            return p;
+        }
+
+        void deallocate(void *p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) noexcept
+        {
+            if (p == nullptr)
+                return;
+            std::size_t cls = SlabSizeClasses::classify(bytes, alignment);
+            if (cls == SlabSizeClasses::kLarge)
+            {
+                _probes[cls].freed(p, bytes);
+                ::operator delete(p, std::align_val_t(alignment));
+                return;
+            }
+            _probes[cls].freed(p, SlabSizeClasses::size_of(cls));
+            FreeList &list = _local()->lists[cls];
+            _next(p) = list.head;
+            list.head = p;
+            // 线程链表超过两批时还一批给中心链表，限制单个线程囤积的内存
+            if (++list.count > 2 * SlabSizeClasses::batch_of(cls))
+                _release(cls, list, SlabSizeClasses::batch_of(cls));
+        }
+
+        // 已申请的span数量
+        std::size_t span_count() const
+        {
+            std::lock_guard<std::mutex> lock(_spanMutex);
+            return _spans.size();
+        }
+
+        // 已向系统申请的字节数
+        std::size_t reserved_bytes() const noexcept { return _reserved.load(std::memory_order_relaxed); }
+
+    private:
+        static void *&_next(void *p) noexcept { return *static_cast<void **>(p); }
+
+        template <std::size_t... I>
+        static ProbeTable _make_probes(const std::source_location &loc, std::index_sequence<I...>)
+        {
+            if constexpr (!kHeapProfilingEnabled)
+            {
+                (void)loc;
+                return {};
+            }
+            else
+            {
+                return {HeapProbe("SlabHeap", I < SlabSizeClasses::kCount ? SlabSizeClasses::size_of(I) : 0, loc)...};
+            }
+        }
+
+        LocalCache *_local()
+        {
+            auto &list = detail::t_thread_caches;
+            if (void *cache = list.find(_id))
+                return static_cast<LocalCache *>(cache);
+            LocalCache *cache;
+            {
+                std::lock_guard<std::mutex> lock(_spanMutex);
+                // 优先复用已退出线程留下的缓存
+                if (!_idleCaches.empty())
+                {
+                    cache = _idleCaches.back();
+                    _idleCaches.pop_back();
+                }
+                else
+                {
+                    cache = _caches.emplace_back(std::make_unique<LocalCache>()).get();
+                }
+            }
+            list.add({_id, this, cache, &_release_local});
+            return cache;
+        }
+
+        static void _release_local(void *owner, void *cache)
+        {
+            auto *heap = static_cast<SlabHeap *>(owner);
+            auto *local = static_cast<LocalCache *>(cache);
+            for (std::size_t cls = 0; cls < SlabSizeClasses::kCount; ++cls)
+            {
+                FreeList &list = local->lists[cls];
+                if (list.count != 0)
+                    heap->_release(cls, list, list.count);
+            }
+            std::lock_guard<std::mutex> lock(heap->_spanMutex);
+            heap->_idleCaches.push_back(local);
+        }
+
+        // 从中心链表取一批对象到线程链表(线程链表为空)
+        P_NOTINLINE void _fetch(std::size_t cls, FreeList &list)
+        {
+            CentralList &central = _central[cls];
+            std::lock_guard<std::mutex> lock(central.mutex);
+            if (central.head == nullptr)
+                _carve(cls, central);
+            std::size_t n = (std::min)(SlabSizeClasses::batch_of(cls), central.count);
+            void *first = central.head;
+            void *last = first;
+            for (std::size_t i = 1; i < n; ++i)
+                last = _next(last);
+            central.head = _next(last);
+            central.count -= n;
+            _next(last) = nullptr;
+            list.head = first;
+            list.count = static_cast<std::uint32_t>(n);
+        }
+
+        // 把线程链表头部的n个对象还给中心链表
+        P_NOTINLINE void _release(std::size_t cls, FreeList &list, std::size_t n) noexcept
+        {
+            void *first = list.head;
+            void *last = first;
+            for (std::size_t i = 1; i < n; ++i)
+                last = _next(last);
+            list.head = _next(last);
+            list.count -= static_cast<std::uint32_t>(n);
+
+            CentralList &central = _central[cls];
+            std::lock_guard<std::mutex> lock(central.mutex);
+            _next(last) = central.head;
+            central.head = first;
+            central.count += n;
+        }
+
+        // 申请一个span并切分到中心链表(持有central.mutex)
+        void _carve(std::size_t cls, CentralList &central)
+        {
+            const std::size_t bytes = SlabSizeClasses::span_bytes_of(cls);
+            const std::size_t size = SlabSizeClasses::size_of(cls);
+            char *span = static_cast<char *>(::operator new(bytes, std::align_val_t(kPageSize)));
+            {
+                std::lock_guard<std::mutex> lock(_spanMutex);
+                try
+                {
+                    _spans.push_back(span);
+                }
+                catch (...)
+                {
+                    ::operator delete(span, std::align_val_t(kPageSize));
+                    throw;
+                }
+            }
+            _reserved.fetch_add(bytes, std::memory_order_relaxed);
+
+            const std::size_t n = bytes / size;
+            for (std::size_t i = 0; i + 1 < n; ++i)
+                _next(span + i * size) = span + (i + 1) * size;
+            _next(span + (n - 1) * size) = central.head;
+            central.head = span;
+            central.count += n;
+        }
+
+        const std::uint64_t _id;
+        CentralList _central[SlabSizeClasses::kCount];
+        mutable std::mutex _spanMutex; // 保护span列表和线程缓存列表
+        std::vector<void *> _spans;
+        std::vector<std::unique_ptr<LocalCache>> _caches;
+        std::vector<LocalCache *> _idleCaches;
+        std::atomic<std::size_t> _reserved{0};
+        PLIB_NO_UNIQUE_ADDRESS ProbeTable _probes; // 按级别的分配统计，最后一个是大对象
+    };
+
+    /**
+     * @brief: SlabHeap的std::pmr::memory_resource适配器
+     * 可用于std::pmr::vector/string/unordered_map等容器。
+     */
+    class SlabMemoryResource : public std::pmr::memory_resource
+    {
+    public:
+        explicit SlabMemoryResource(SlabHeap &heap = SlabHeap::global()) noexcept : _heap(&heap) {}
+
+        SlabHeap &heap() const noexcept { return *_heap; }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            return _heap->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+        {
+            _heap->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            auto *rhs = dynamic_cast<const SlabMemoryResource *>(&other);
+            return rhs != nullptr && rhs->_heap == _heap;
+        }
+
+    private:
+        SlabHeap *_heap;
+    };
+
+    /**
+     * @brief: SlabHeap的标准分配器，默认使用SlabHeap::global()
+     */
+    template <typename T>
+    class SlabAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        SlabAllocator() noexcept : _heap(&SlabHeap::global()) {}
+        explicit SlabAllocator(SlabHeap &heap) noexcept : _heap(&heap) {}
+        template <typename U>
+        SlabAllocator(const SlabAllocator<U> &other) noexcept : _heap(&other.heap()) {}
+
+        T *allocate(std::size_t n)
+        {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                throw std::bad_array_new_length();
+            return static_cast<T *>(_heap->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *p, std::size_t n) noexcept
+        {
+            _heap->deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        SlabHeap &heap() const noexcept { return *_heap; }
+
+        template <typename U>
+        bool operator==(const SlabAllocator<U> &other) const noexcept { return _heap == &other.heap(); }
+
+    private:
+        SlabHeap *_heap;
+    };
+} // namespace plib::core::memory
+
+#endif // PLIB_CORE_MEMORY_SLAB_ALLOCATOR_HPP_
@@ -0,0 +1,101 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-20 09:12:40
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-20 09:12:40
+ * @FilePath: \plib\src\core\include\memory\thread_cache.hpp
+ * @Description: 内存池的线程私有缓存登记表，线程退出时把缓存归还给仍然存活的池
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_MEMORY_THREAD_CACHE_HPP_
+#define PLIB_CORE_MEMORY_THREAD_CACHE_HPP_
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+#include "plib_macros.hpp"
+
+namespace plib::core::memory::detail
+{
+    // 存活的池，线程退出时据此判断缓存是否还能归还
+    struct ThreadCacheRegistry
+    {
+        std::mutex mutex;
+        std::unordered_set<std::uint64_t> live;
+        std::uint64_t next_id = 1;
+
+        static ThreadCacheRegistry &instance()
+        {
+            // 故意泄漏，保证晚于所有thread_local析构
+            static ThreadCacheRegistry *registry = new ThreadCacheRegistry();
+            return *registry;
+        }
+
+        std::uint64_t register_owner()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::uint64_t id = next_id++;
+            live.insert(id);
+            return id;
+        }
+
+        // 池析构时调用，返回后不会再有线程通过登记表访问该池
+        void unregister_owner(std::uint64_t id)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            live.erase(id);
+        }
+    };
+
+    /**
+     * @brief: 线程私有的 池id -> 缓存 映射，通常只有几项
+     * 缓存对象由池分配并在池析构时统一释放，这里只保存指针。
+     */
+    struct ThreadCacheList
+    {
+        struct Entry
+        {
+            std::uint64_t owner_id;
+            void *owner;
+            void *cache;
+            void (*release)(void *owner, void *cache); // 线程退出时把缓存内容还给池
+        };
+        std::vector<Entry> entries;
+
+        P_FORCE_INLINE void *find(std::uint64_t owner_id) const noexcept
+        {
+            for (const auto &entry : entries)
+            {
+                if (entry.owner_id == owner_id)
+                    return entry.cache;
+            }
+            return nullptr;
+        }
+
+        // 登记新的缓存，同时清理已析构的池留下的条目
+        void add(const Entry &entry)
+        {
+            auto &registry = ThreadCacheRegistry::instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            std::erase_if(entries, [&](const Entry &e)
+                          { return registry.live.count(e.owner_id) == 0; });
+            entries.push_back(entry);
+        }
+
+        ~ThreadCacheList()
+        {
+            auto &registry = ThreadCacheRegistry::instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (auto &entry : entries)
+            {
+                if (registry.live.count(entry.owner_id) != 0)
+                    entry.release(entry.owner, entry.cache);
+            }
+        }
+    };
+
+    inline thread_local ThreadCacheList t_thread_caches;
+} // namespace plib::core::memory::detail
+
+#endif // PLIB_CORE_MEMORY_THREAD_CACHE_HPP_
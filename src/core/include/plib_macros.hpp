@@ -26,6 +26,13 @@
 #define P_NOTINLINE __attribute__((noinline))
 #endif
 
+// 空成员不占用空间，MSVC会忽略标准属性，需要用它自己的版本
+#if defined(_MSC_VER)
+#define PLIB_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define PLIB_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
 // 编译期内存泄露检测
 #ifdef __clang__
 #if __has_feature(address_sanitizer)
@@ -89,6 +96,15 @@
     #define CPU_PAUSE() std::this_thread::yield()
 #endif
 
+// 提前把addr所在的缓存行读入缓存，地址无效时也不会出错
+#if defined(__GNUC__) || defined(__clang__)
+    #define P_PREFETCH(addr) __builtin_prefetch(addr)
+#elif defined(_M_X64) || defined(_M_IX86)
+    #define P_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char *>(addr), _MM_HINT_T0)
+#else
+    #define P_PREFETCH(addr) ((void)(addr))
+#endif
+
 // 标记未使用的变量，避免编译器警告
 #define UNUSED(x) (void)(x)
 
@@ -0,0 +1,145 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-21 17:25:06
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-21 17:25:06
+ * @FilePath: \plib\src\core\include\type\flat_hash_map.hpp
+ * @Description: 开放寻址的哈希映射：flat_hash_map元素直接放在槽位里，node_hash_map元素单独分配、rehash后引用仍然有效
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_TYPE_FLAT_HASH_MAP_HPP_
+#define PLIB_CORE_TYPE_FLAT_HASH_MAP_HPP_
+
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include "type/raw_hash_table.hpp"
+
+namespace plib::core::type {
+
+	namespace detail::swiss {
+
+		/**
+		 * @brief: 在公共哈希表上加映射特有的接口
+		 */
+		template <typename Policy, typename Hash, typename Eq, typename Allocator>
+		class raw_hash_map : public raw_hash_table<Policy, Hash, Eq, Allocator> {
+			using base = raw_hash_table<Policy, Hash, Eq, Allocator>;
+
+		public:
+			using typename base::key_type;
+			using typename base::value_type;
+			using typename base::iterator;
+			using typename base::const_iterator;
+			using mapped_type = typename value_type::second_type;
+
+			using base::base;
+
+			// 键不存在时才构造值；键和比较器透明时直接用传入的键类型查找，否则先转换成key_type
+			template <typename K, typename... Args>
+			std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+				if constexpr (is_transparent_v<Hash, Eq> || std::is_same_v<std::remove_cvref_t<K>, key_type>) {
+					return this->emplace_key(
+						key,
+						std::piecewise_construct,
+						std::forward_as_tuple(std::forward<K>(key)),
+						std::forward_as_tuple(std::forward<Args>(args)...));
+				} else {
+					return try_emplace(key_type(std::forward<K>(key)), std::forward<Args>(args)...);
+				}
+			}
+
+			template <typename K, typename M>
+			std::pair<iterator, bool> insert_or_assign(K&& key, M&& value) {
+				auto result = try_emplace(std::forward<K>(key), std::forward<M>(value));
+				if (!result.second) {
+					result.first->second = std::forward<M>(value);
+				}
+				return result;
+			}
+
+			template <typename K>
+			mapped_type& operator[](K&& key) {
+				return try_emplace(std::forward<K>(key)).first->second;
+			}
+
+			template <typename K = key_type>
+			mapped_type& at(const typename base::template key_arg<K>& key) {
+				auto it = this->find(key);
+				if (it == this->end()) {
+					throw std::out_of_range("plib::core::type hash map: key not found");
+				}
+				return it->second;
+			}
+			template <typename K = key_type>
+			const mapped_type& at(const typename base::template key_arg<K>& key) const {
+				return const_cast<raw_hash_map*>(this)->at(key);
+			}
+
+		};
+
+	} // namespace detail::swiss
+
+	/**
+	 * @brief: 元素直接存放在槽位数组里的哈希映射，查找一般只访问一行控制字节和一个槽位
+	 * rehash会移动元素，之前拿到的引用和迭代器失效；需要稳定引用时用node_hash_map
+	 */
+	template <
+		typename Key,
+		typename Type,
+		typename Hash = std::hash<Key>,
+		typename Eq = std::equal_to<Key>,
+		typename Allocator = std::allocator<std::pair<const Key, Type>>>
+	class flat_hash_map : public detail::swiss::raw_hash_map<
+		detail::swiss::flat_policy<Key, std::pair<const Key, Type>>, Hash, Eq, Allocator> {
+		using base = detail::swiss::raw_hash_map<
+			detail::swiss::flat_policy<Key, std::pair<const Key, Type>>, Hash, Eq, Allocator>;
+
+	public:
+		using base::base;
+
+	};
+
+	/**
+	 * @brief: 槽位只存元素指针的哈希映射，元素地址在rehash后保持不变
+	 */
+	template <
+		typename Key,
+		typename Type,
+		typename Hash = std::hash<Key>,
+		typename Eq = std::equal_to<Key>,
+		typename Allocator = std::allocator<std::pair<const Key, Type>>>
+	class node_hash_map : public detail::swiss::raw_hash_map<
+		detail::swiss::node_policy<Key, std::pair<const Key, Type>>, Hash, Eq, Allocator> {
+		using base = detail::swiss::raw_hash_map<
+			detail::swiss::node_policy<Key, std::pair<const Key, Type>>, Hash, Eq, Allocator>;
+
+	public:
+		using base::base;
+
+	};
+
+	namespace pmr {
+		template <typename Key, typename Type, typename Hash = std::hash<Key>, typename Eq = std::equal_to<Key>>
+		using flat_hash_map = type::flat_hash_map<
+			Key,
+			Type,
+			Hash,
+			Eq,
+			std::pmr::polymorphic_allocator<std::pair<const Key, Type>>>;
+
+		template <typename Key, typename Type, typename Hash = std::hash<Key>, typename Eq = std::equal_to<Key>>
+		using node_hash_map = type::node_hash_map<
+			Key,
+			Type,
+			Hash,
+			Eq,
+			std::pmr::polymorphic_allocator<std::pair<const Key, Type>>>;
+	} // namespace pmr
+
+} // namespace plib::core::type
+
+#endif // PLIB_CORE_TYPE_FLAT_HASH_MAP_HPP_
@@ -0,0 +1,66 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-21 17:25:06
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-21 17:25:06
+ * @FilePath: \plib\src\core\include\type\flat_hash_set.hpp
+ * @Description: 开放寻址的哈希集合：flat_hash_set元素直接放在槽位里，node_hash_set元素单独分配、rehash后引用仍然有效
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_TYPE_FLAT_HASH_SET_HPP_
+#define PLIB_CORE_TYPE_FLAT_HASH_SET_HPP_
+
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include "type/raw_hash_table.hpp"
+
+namespace plib::core::type {
+
+	/**
+	 * @brief: 元素直接存放在槽位数组里的哈希集合，rehash会移动元素
+	 */
+	template <
+		typename Key,
+		typename Hash = std::hash<Key>,
+		typename Eq = std::equal_to<Key>,
+		typename Allocator = std::allocator<Key>>
+	class flat_hash_set : public detail::swiss::raw_hash_table<
+		detail::swiss::flat_policy<Key, Key>, Hash, Eq, Allocator> {
+		using base = detail::swiss::raw_hash_table<
+			detail::swiss::flat_policy<Key, Key>, Hash, Eq, Allocator>;
+
+	public:
+		using base::base;
+
+	};
+
+	/**
+	 * @brief: 槽位只存元素指针的哈希集合，元素地址在rehash后保持不变
+	 */
+	template <
+		typename Key,
+		typename Hash = std::hash<Key>,
+		typename Eq = std::equal_to<Key>,
+		typename Allocator = std::allocator<Key>>
+	class node_hash_set : public detail::swiss::raw_hash_table<
+		detail::swiss::node_policy<Key, Key>, Hash, Eq, Allocator> {
+		using base = detail::swiss::raw_hash_table<
+			detail::swiss::node_policy<Key, Key>, Hash, Eq, Allocator>;
+
+	public:
+		using base::base;
+
+	};
+
+	namespace pmr {
+		template <typename Key, typename Hash = std::hash<Key>, typename Eq = std::equal_to<Key>>
+		using flat_hash_set = type::flat_hash_set<Key, Hash, Eq, std::pmr::polymorphic_allocator<Key>>;
+
+		template <typename Key, typename Hash = std::hash<Key>, typename Eq = std::equal_to<Key>>
+		using node_hash_set = type::node_hash_set<Key, Hash, Eq, std::pmr::polymorphic_allocator<Key>>;
+	} // namespace pmr
+
+} // namespace plib::core::type
+
+#endif // PLIB_CORE_TYPE_FLAT_HASH_SET_HPP_
@@ -0,0 +1,586 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-21 10:36:12
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-21 10:36:12
+ * @FilePath: \plib\src\core\include\type\flat_soa_map.hpp
+ * @Description: 键和值分开存放(struct of arrays)的flat_map，查找只访问紧凑的键数组，算术键走SIMD友好的无分支查找
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_TYPE_FLAT_SOA_MAP_HPP_
+#define PLIB_CORE_TYPE_FLAT_SOA_MAP_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "plib_macros.hpp"
+#include "type/flat_sorted.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace plib::core::type {
+
+	template <
+		typename Key,
+		typename Type,
+		typename Compare = std::less<>,
+		typename Allocator = std::allocator<std::pair<Key, Type>>>
+		class flat_soa_map;
+
+	namespace detail {
+
+		// 标准的小于比较器才能把比较换成内建的 <
+		template <typename Key, typename Compare>
+		inline constexpr bool flat_soa_builtin_less =
+			std::is_arithmetic_v<Key> && !std::is_same_v<Key, bool>
+			&& (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<Key>>);
+
+		// 剩余区间不超过这么多个键时改为整段计数
+		inline constexpr std::size_t kFlatSoaLinearWindow = 16;
+
+		/**
+		 * @brief: 有序数组中第一个不小于key的位置
+		 * 先做无分支二分(条件传送，没有难预测的跳转)，区间缩小到一个窗口后统计窗口内小于key的个数，
+		 * 计数循环没有提前退出，32位整数在SSE2下一次比较4个键
+		 */
+		template <typename Key>
+		P_FORCE_INLINE std::size_t flat_soa_lower_bound(const Key* keys, std::size_t size, Key key) noexcept {
+			const Key* base = keys;
+			std::size_t len = size;
+			while (len > kFlatSoaLinearWindow) {
+				const std::size_t half = len / 2;
+				base = (base[half - 1] < key) ? base + half : base;
+				len -= half;
+			}
+			std::size_t count = 0;
+			std::size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+			if constexpr (std::is_same_v<Key, std::int32_t>) {
+				const __m128i needle = _mm_set1_epi32(key);
+				for (; i + 4 <= len; i += 4) {
+					const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i));
+					const int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(chunk, needle)));
+					count += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(mask)));
+				}
+			}
+#endif
+			for (; i < len; ++i) {
+				count += (base[i] < key) ? 1 : 0;
+			}
+			return static_cast<std::size_t>(base - keys) + count;
+		}
+
+	} // namespace detail
+
+	/**
+	 * @brief: flat_soa_map元素的引用，两个成员都是引用，可以 it->first / it->second，也可以结构化绑定
+	 */
+	template <typename Key, typename Value>
+	struct flat_soa_map_reference {
+		const Key& first;
+		Value& second;
+	};
+
+	/**
+	 * @brief: 同时指向键数组和值数组的随机访问迭代器，解引用得到代理引用
+	 */
+	template <typename Key, typename Value>
+	class flat_soa_map_iterator {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::pair<Key, std::remove_const_t<Value>>;
+		using difference_type = std::ptrdiff_t;
+		using reference = flat_soa_map_reference<Key, Value>;
+
+		// operator->返回的临时对象，保存一份代理引用
+		struct pointer {
+			reference ref;
+			reference* operator->() noexcept {
+				return &ref;
+			}
+		};
+
+		flat_soa_map_iterator() = default;
+		flat_soa_map_iterator(const Key* key, Value* value) noexcept
+			: _key(key)
+			, _value(value) {
+		}
+
+		// iterator可以隐式转换成const_iterator
+		template <
+			typename OtherValue,
+			typename = std::enable_if_t<
+			std::is_same_v<const OtherValue, Value> && !std::is_same_v<OtherValue, Value>>>
+		flat_soa_map_iterator(const flat_soa_map_iterator<Key, OtherValue>& other) noexcept
+			: _key(other._key)
+			, _value(other._value) {
+		}
+
+		reference operator*() const noexcept {
+			return { *_key, *_value };
+		}
+		pointer operator->() const noexcept {
+			return { **this };
+		}
+		reference operator[](difference_type offset) const noexcept {
+			return { _key[offset], _value[offset] };
+		}
+
+		flat_soa_map_iterator& operator++() noexcept {
+			++_key;
+			++_value;
+			return *this;
+		}
+		flat_soa_map_iterator operator++(int) noexcept {
+			auto result = *this;
+			++*this;
+			return result;
+		}
+		flat_soa_map_iterator& operator--() noexcept {
+			--_key;
+			--_value;
+			return *this;
+		}
+		flat_soa_map_iterator operator--(int) noexcept {
+			auto result = *this;
+			--*this;
+			return result;
+		}
+		flat_soa_map_iterator& operator+=(difference_type offset) noexcept {
+			_key += offset;
+			_value += offset;
+			return *this;
+		}
+		flat_soa_map_iterator& operator-=(difference_type offset) noexcept {
+			return *this += -offset;
+		}
+		friend flat_soa_map_iterator operator+(flat_soa_map_iterator it, difference_type offset) noexcept {
+			return it += offset;
+		}
+		friend flat_soa_map_iterator operator+(difference_type offset, flat_soa_map_iterator it) noexcept {
+			return it += offset;
+		}
+		friend flat_soa_map_iterator operator-(flat_soa_map_iterator it, difference_type offset) noexcept {
+			return it -= offset;
+		}
+		friend difference_type operator-(const flat_soa_map_iterator& a, const flat_soa_map_iterator& b) noexcept {
+			return a._key - b._key;
+		}
+		friend bool operator==(const flat_soa_map_iterator& a, const flat_soa_map_iterator& b) noexcept {
+			return a._key == b._key;
+		}
+		friend std::strong_ordering operator<=>(const flat_soa_map_iterator& a, const flat_soa_map_iterator& b) noexcept {
+			return a._key <=> b._key;
+		}
+
+	private:
+		template <typename, typename>
+		friend class flat_soa_map_iterator;
+
+		const Key* _key = nullptr;
+		Value* _value = nullptr;
+
+	};
+
+	/**
+	 * @brief: 接口与flat_map一致的有序关联容器，但键和值分别存放在两个vector里
+	 * 二分查找只读取键数组，值很大(几十上百字节)时查找的缓存占用与值的大小无关；
+	 * 代价是迭代器解引用得到的是代理引用而不是真正的pair
+	 */
+	template <typename Key, typename Type, typename Compare, typename Allocator>
+	class flat_soa_map {
+		using key_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Key>;
+		using mapped_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Type>;
+		using keys_t = std::vector<Key, key_allocator>;
+		using values_t = std::vector<Type, mapped_allocator>;
+
+	public:
+		using key_type = Key;
+		using mapped_type = Type;
+		using value_type = std::pair<Key, Type>;
+		using key_compare = Compare;
+		using allocator_type = Allocator;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using iterator = flat_soa_map_iterator<Key, Type>;
+		using const_iterator = flat_soa_map_iterator<Key, const Type>;
+		using reference = typename iterator::reference;
+		using const_reference = typename const_iterator::reference;
+
+		flat_soa_map() = default;
+
+		explicit flat_soa_map(const allocator_type& alloc)
+			: _keys(key_allocator(alloc))
+			, _values(mapped_allocator(alloc)) {
+		}
+
+		// 范围构造：等价键保留输入中的第一个
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		flat_soa_map(Iterator first, Iterator last, const allocator_type& alloc = allocator_type())
+			: flat_soa_map(alloc) {
+			insert(first, last);
+		}
+
+		flat_soa_map(std::initializer_list<value_type> list, const allocator_type& alloc = allocator_type())
+			: flat_soa_map(list.begin(), list.end(), alloc) {
+		}
+
+		// 输入已经有序且键唯一，直接拷贝
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		flat_soa_map(sorted_unique_t, Iterator first, Iterator last, const allocator_type& alloc = allocator_type())
+			: flat_soa_map(alloc) {
+			for (; first != last; ++first) {
+				_keys.push_back(first->first);
+				_values.push_back(first->second);
+			}
+		}
+
+		// 直接接管已经有序且键唯一的两个数组
+		flat_soa_map(sorted_unique_t, keys_t keys, values_t values)
+			: _keys(std::move(keys))
+			, _values(std::move(values)) {
+		}
+
+		allocator_type get_allocator() const {
+			return allocator_type(_keys.get_allocator());
+		}
+
+		size_type size() const noexcept {
+			return _keys.size();
+		}
+		bool empty() const noexcept {
+			return _keys.empty();
+		}
+		void clear() noexcept {
+			_keys.clear();
+			_values.clear();
+		}
+		void reserve(size_type size) {
+			_keys.reserve(size);
+			_values.reserve(size);
+		}
+		void shrink_to_fit() {
+			_keys.shrink_to_fit();
+			_values.shrink_to_fit();
+		}
+
+		// 只读的键数组与值数组，可以直接交给向量化代码处理
+		const keys_t& keys() const noexcept {
+			return _keys;
+		}
+		const values_t& values() const noexcept {
+			return _values;
+		}
+
+		iterator begin() noexcept {
+			return at(0);
+		}
+		iterator end() noexcept {
+			return at(size());
+		}
+		const_iterator begin() const noexcept {
+			return at(0);
+		}
+		const_iterator end() const noexcept {
+			return at(size());
+		}
+		const_iterator cbegin() const noexcept {
+			return begin();
+		}
+		const_iterator cend() const noexcept {
+			return end();
+		}
+
+		reference front() {
+			return *begin();
+		}
+		const_reference front() const {
+			return *begin();
+		}
+		reference back() {
+			return *(end() - 1);
+		}
+		const_reference back() const {
+			return *(end() - 1);
+		}
+
+		template <typename OtherKey>
+		iterator lower_bound(const OtherKey& key) {
+			return at(lowerIndex(key));
+		}
+		template <typename OtherKey>
+		const_iterator lower_bound(const OtherKey& key) const {
+			return at(lowerIndex(key));
+		}
+		template <typename OtherKey>
+		iterator upper_bound(const OtherKey& key) {
+			return at(upperIndex(key));
+		}
+		template <typename OtherKey>
+		const_iterator upper_bound(const OtherKey& key) const {
+			return at(upperIndex(key));
+		}
+
+		template <typename OtherKey>
+		iterator find(const OtherKey& key) {
+			return at(findIndex(key));
+		}
+		template <typename OtherKey>
+		const_iterator find(const OtherKey& key) const {
+			return at(findIndex(key));
+		}
+		iterator find(const Key& key) {
+			return find<Key>(key);
+		}
+		const_iterator find(const Key& key) const {
+			return find<Key>(key);
+		}
+
+		template <typename OtherKey>
+		bool contains(const OtherKey& key) const {
+			return findIndex(key) != size();
+		}
+		bool contains(const Key& key) const {
+			return contains<Key>(key);
+		}
+		template <typename OtherKey>
+		size_type count(const OtherKey& key) const {
+			return contains(key) ? 1 : 0;
+		}
+
+		std::pair<iterator, bool> insert(const value_type& value) {
+			return try_emplace(value.first, value.second);
+		}
+		std::pair<iterator, bool> insert(value_type&& value) {
+			return try_emplace(std::move(value.first), std::move(value.second));
+		}
+		template <typename OtherKey, typename... Args>
+		std::pair<iterator, bool> emplace(OtherKey&& key, Args&&... args) {
+			return try_emplace(std::forward<OtherKey>(key), std::forward<Args>(args)...);
+		}
+		template <typename OtherKey, typename... Args>
+		std::pair<iterator, bool> try_emplace(OtherKey&& key, Args&&... args) {
+			const auto index = lowerIndex(key);
+			if (index != size() && !compare()(key, _keys[index])) {
+				return { at(index), false };
+			}
+			return { insertAt(index, std::forward<OtherKey>(key), std::forward<Args>(args)...), true };
+		}
+		template <typename OtherKey, typename OtherType>
+		std::pair<iterator, bool> insert_or_assign(OtherKey&& key, OtherType&& value) {
+			const auto index = lowerIndex(key);
+			if (index != size() && !compare()(key, _keys[index])) {
+				_values[index] = std::forward<OtherType>(value);
+				return { at(index), false };
+			}
+			return { insertAt(index, std::forward<OtherKey>(key), std::forward<OtherType>(value)), true };
+		}
+
+		// 批量插入，键已存在时保留原值，批次内重复的键取第一个
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert(Iterator first, Iterator last) {
+			insertRange<false>(first, last, false);
+		}
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert(sorted_unique_t, Iterator first, Iterator last) {
+			insertRange<false>(first, last, true);
+		}
+		void insert(std::initializer_list<value_type> list) {
+			insert(list.begin(), list.end());
+		}
+		// 批量插入或覆盖，批次内重复的键取最后一个
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert_or_assign(Iterator first, Iterator last) {
+			insertRange<true>(first, last, false);
+		}
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert_or_assign(sorted_unique_t, Iterator first, Iterator last) {
+			insertRange<true>(first, last, true);
+		}
+
+		Type& operator[](const Key& key) {
+			return try_emplace(key).first->second;
+		}
+
+		iterator erase(const_iterator where) {
+			return erase(where, where + 1);
+		}
+		iterator erase(const_iterator from, const_iterator till) {
+			const auto first = static_cast<difference_type>(from - cbegin());
+			const auto last = static_cast<difference_type>(till - cbegin());
+			_keys.erase(_keys.begin() + first, _keys.begin() + last);
+			_values.erase(_values.begin() + first, _values.begin() + last);
+			return at(static_cast<size_type>(first));
+		}
+		bool remove(const Key& key) {
+			const auto index = findIndex(key);
+			if (index == size()) {
+				return false;
+			}
+			erase(at(index));
+			return true;
+		}
+
+		std::optional<Type> take(const Key& key) {
+			const auto index = findIndex(key);
+			if (index == size()) {
+				return std::nullopt;
+			}
+			auto result = std::move(_values[index]);
+			erase(at(index));
+			return result;
+		}
+
+		friend bool operator==(const flat_soa_map& a, const flat_soa_map& b) {
+			return a._keys == b._keys && a._values == b._values;
+		}
+
+	private:
+		iterator at(size_type index) noexcept {
+			return iterator(_keys.data() + index, _values.data() + index);
+		}
+		const_iterator at(size_type index) const noexcept {
+			return const_iterator(_keys.data() + index, _values.data() + index);
+		}
+
+		const Compare& compare() const noexcept {
+			return _compare;
+		}
+
+		template <typename OtherKey>
+		size_type lowerIndex(const OtherKey& key) const {
+			if constexpr (detail::flat_soa_builtin_less<Key, Compare> && std::is_same_v<OtherKey, Key>) {
+				return detail::flat_soa_lower_bound(_keys.data(), _keys.size(), key);
+			} else {
+				return static_cast<size_type>(
+					std::lower_bound(_keys.begin(), _keys.end(), key, compare()) - _keys.begin());
+			}
+		}
+		template <typename OtherKey>
+		size_type upperIndex(const OtherKey& key) const {
+			return static_cast<size_type>(
+				std::upper_bound(_keys.begin(), _keys.end(), key, compare()) - _keys.begin());
+		}
+		template <typename OtherKey>
+		size_type findIndex(const OtherKey& key) const {
+			const auto index = lowerIndex(key);
+			return (index != size() && !compare()(key, _keys[index])) ? index : size();
+		}
+
+		template <typename OtherKey, typename... Args>
+		iterator insertAt(size_type index, OtherKey&& key, Args&&... args) {
+			_keys.insert(_keys.begin() + index, Key(std::forward<OtherKey>(key)));
+			try {
+				_values.insert(_values.begin() + index, Type(std::forward<Args>(args)...));
+			} catch (...) {
+				_keys.erase(_keys.begin() + index);
+				throw;
+			}
+			return at(index);
+		}
+
+		/**
+		 * @brief: 批次先转成pair排序去重，再和原有的两个数组做一次线性归并写入新数组
+		 */
+		template <bool LastWins, typename Iterator>
+		void insertRange(Iterator first, Iterator last, bool sorted) {
+			std::vector<value_type> batch;
+			detail::flat_append(batch, first, last);
+			if (batch.empty()) {
+				return;
+			}
+			const auto byKey = [&](const value_type& a, const value_type& b) {
+				return compare()(a.first, b.first);
+			};
+			detail::flat_merge_unique<LastWins>(batch, 0, byKey, sorted, [](auto&, auto&&) {});
+
+			// 新批次整体排在已有键之后时直接追加
+			if (empty() || compare()(_keys.back(), batch.front().first)) {
+				reserve(size() + batch.size());
+				for (auto& item : batch) {
+					_keys.push_back(std::move(item.first));
+					_values.push_back(std::move(item.second));
+				}
+				return;
+			}
+
+			keys_t keys(_keys.get_allocator());
+			values_t values(_values.get_allocator());
+			keys.reserve(size() + batch.size());
+			values.reserve(size() + batch.size());
+			size_type i = 0;
+			auto j = batch.begin();
+			while (i != size() && j != batch.end()) {
+				if (compare()(j->first, _keys[i])) {
+					keys.push_back(std::move(j->first));
+					values.push_back(std::move(j->second));
+					++j;
+				} else {
+					const bool same = !compare()(_keys[i], j->first);
+					keys.push_back(std::move(_keys[i]));
+					if (same && LastWins) {
+						values.push_back(std::move(j->second));
+					} else {
+						values.push_back(std::move(_values[i]));
+					}
+					++i;
+					if (same) {
+						++j;
+					}
+				}
+			}
+			for (; i != size(); ++i) {
+				keys.push_back(std::move(_keys[i]));
+				values.push_back(std::move(_values[i]));
+			}
+			for (; j != batch.end(); ++j) {
+				keys.push_back(std::move(j->first));
+				values.push_back(std::move(j->second));
+			}
+			_keys.swap(keys);
+			_values.swap(values);
+		}
+
+		PLIB_NO_UNIQUE_ADDRESS Compare _compare;
+		keys_t _keys;
+		values_t _values;
+
+	};
+
+	namespace pmr {
+		template <typename Key, typename Type, typename Compare = std::less<>>
+		using flat_soa_map = type::flat_soa_map<
+			Key,
+			Type,
+			Compare,
+			std::pmr::polymorphic_allocator<std::pair<Key, Type>>>;
+	} // namespace pmr
+
+} // namespace plib::core::type
+
+#endif // PLIB_CORE_TYPE_FLAT_SOA_MAP_HPP_
@@ -0,0 +1,204 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-21 09:12:40
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-21 09:12:40
+ * @FilePath: \plib\src\core\include\type\flat_sorted.hpp
+ * @Description: flat容器共用的有序标签与批量归并：只排序新追加的一批元素，再与原有数据做一次线性归并
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_TYPE_FLAT_SORTED_HPP_
+#define PLIB_CORE_TYPE_FLAT_SORTED_HPP_
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "type_traits.hpp"
+
+namespace plib::core::type {
+
+	/**
+	 * @brief: 输入已按比较器升序且没有等价键，构造/插入时跳过排序
+	 */
+	struct sorted_unique_t {
+		explicit sorted_unique_t() = default;
+	};
+	inline constexpr sorted_unique_t sorted_unique{};
+
+	/**
+	 * @brief: 输入已按比较器升序，可以有等价键
+	 */
+	struct sorted_equivalent_t {
+		explicit sorted_equivalent_t() = default;
+	};
+	inline constexpr sorted_equivalent_t sorted_equivalent{};
+
+	namespace detail {
+
+		/**
+		 * @brief: 把[first, last)追加到v末尾
+		 * 不用vector::insert，它会实例化拷贝赋值，而flat_map的pair因为const键删除了拷贝赋值
+		 */
+		template <typename Vector, typename Iterator>
+		void flat_append(Vector& v, Iterator first, Iterator last) {
+			using category = typename std::iterator_traits<Iterator>::iterator_category;
+			if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+				// 按倍数扩容，反复小批量插入时不会退化成每次重新分配
+				const auto need = v.size() + static_cast<typename Vector::size_type>(std::distance(first, last));
+				if (need > v.capacity()) {
+					v.reserve(std::max(need, v.capacity() * 2));
+				}
+			}
+			for (; first != last; ++first) {
+				v.emplace_back(*first);
+			}
+		}
+
+		/**
+		 * @brief: 在where处插入一个元素
+		 * 元素可平凡重定位时先追加到末尾，再把它按字节换到where，尾部整体memmove一次
+		 * 否则退回vector::insert，逐个移动赋值
+		 */
+		template <typename Vector, typename Value>
+		typename Vector::iterator flat_insert(
+			Vector& v,
+			typename Vector::const_iterator where,
+			Value&& value) {
+			using T = typename Vector::value_type;
+			if constexpr (is_trivially_relocatable_v<T>) {
+				const auto index = where - v.cbegin();
+				// emplace_back负责扩容，value引用的是v中的元素时也安全
+				v.emplace_back(std::forward<Value>(value));
+				T* const pos = v.data() + index;
+				T* const last = v.data() + (v.size() - 1);
+				if (pos != last) {
+					alignas(T) unsigned char slot[sizeof(T)];
+					std::memcpy(slot, static_cast<void*>(last), sizeof(T));
+					std::memmove(
+						static_cast<void*>(pos + 1),
+						static_cast<void*>(pos),
+						(last - pos) * sizeof(T));
+					std::memcpy(static_cast<void*>(pos), slot, sizeof(T));
+				}
+				return v.begin() + index;
+			} else {
+				return v.insert(where, std::forward<Value>(value));
+			}
+		}
+
+		/**
+		 * @brief: 删除[first, last)
+		 * 元素可平凡重定位时把待删区间按字节换到末尾，再从末尾析构，尾部只搬一次
+		 */
+		template <typename Vector>
+		typename Vector::iterator flat_erase(
+			Vector& v,
+			typename Vector::const_iterator first,
+			typename Vector::const_iterator last) {
+			using T = typename Vector::value_type;
+			if constexpr (is_trivially_relocatable_v<T>) {
+				const auto index = first - v.cbegin();
+				const auto count = static_cast<std::size_t>(last - first);
+				const auto tail = static_cast<std::size_t>(v.cend() - last);
+				if (count != 0 && tail != 0) {
+					const auto bytes = count * sizeof(T);
+					unsigned char local[256];
+					std::unique_ptr<unsigned char[]> heap;
+					unsigned char* buffer = local;
+					if (bytes > sizeof(local)) {
+						heap.reset(new unsigned char[bytes]);
+						buffer = heap.get();
+					}
+					auto* const from = static_cast<void*>(v.data() + index);
+					std::memcpy(buffer, from, bytes);
+					std::memmove(from, static_cast<void*>(v.data() + index + count), tail * sizeof(T));
+					std::memcpy(static_cast<void*>(v.data() + index + tail), buffer, bytes);
+				}
+				v.erase(v.end() - count, v.end());
+				return v.begin() + index;
+			} else {
+				return v.erase(first, last);
+			}
+		}
+
+		template <typename Vector>
+		typename Vector::iterator flat_erase(Vector& v, typename Vector::const_iterator where) {
+			return flat_erase(v, where, where + 1);
+		}
+
+		/**
+		 * @brief: [0, mid)是原有的有序数据，[mid, size)是刚追加的一批
+		 * 稳定排序新批次后原地归并，等价元素中原有的在前、批次内保持输入顺序
+		 * 复杂度O(m*log(m) + n + m)，不再逐个二分插入搬动整个vector
+		 */
+		template <typename Vector, typename Compare>
+		void flat_merge_equivalent(
+			Vector& v,
+			typename Vector::size_type mid,
+			const Compare& comp,
+			bool sorted) {
+			const auto first = v.begin();
+			const auto middle = first + mid;
+			const auto last = v.end();
+			if (!sorted) {
+				std::stable_sort(middle, last, comp);
+			}
+			// 新批次整体排在原有数据之后时只是追加
+			if (middle != first && middle != last && comp(*middle, *(middle - 1))) {
+				std::inplace_merge(first, middle, last, comp);
+			}
+		}
+
+		/**
+		 * @brief: 同上，但结果中每个键只保留一个元素
+		 * LastWins为false时先到者保留：原有元素优先，批次内取第一个
+		 * LastWins为true时后到者覆盖：批次内取最后一个，与原有键相同时调用assign(原有, 新值)
+		 */
+		template <bool LastWins, typename Vector, typename Compare, typename Assign>
+		void flat_merge_unique(
+			Vector& v,
+			typename Vector::size_type mid,
+			const Compare& comp,
+			bool sorted,
+			Assign&& assign) {
+			const auto first = v.begin();
+			const auto middle = first + mid;
+			if (!sorted) {
+				std::stable_sort(middle, v.end(), comp);
+			}
+
+			// 批次内去重，同时剔除原有数据里已经存在的键，幸存者向前压紧
+			auto out = middle;
+			auto hint = first;
+			for (auto it = middle, last = v.end(); it != last;) {
+				auto keep = it;
+				while (++it != last && !comp(*keep, *it)) {
+					if constexpr (LastWins) {
+						keep = it;
+					}
+				}
+				// 批次有序，原有数据中的查找位置只会前进
+				hint = std::lower_bound(hint, middle, *keep, comp);
+				if (hint != middle && !comp(*keep, *hint)) {
+					if constexpr (LastWins) {
+						assign(*hint, std::move(*keep));
+					}
+					continue;
+				}
+				if (out != keep) {
+					*out = std::move(*keep);
+				}
+				++out;
+			}
+			v.erase(out, v.end());
+			flat_merge_equivalent(v, mid, comp, true);
+		}
+
+	} // namespace detail
+
+} // namespace plib::core::type
+
+#endif // PLIB_CORE_TYPE_FLAT_SORTED_HPP_
@@ -2,22 +2,32 @@
 #define PLIB_CORE_TYPE_FLATMAP_HPP
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include "type/flat_sorted.hpp"
 
 namespace plib::core::type {
 
 	using std::begin;
 	using std::end;
 
+	template <typename Key, typename Value>
+	struct flat_multi_map_pair_type;
+
+	// Allocator可以是任意元素类型的分配器，内部会rebind到存储的pair类型
 	template <
 		typename Key,
 		typename Type,
-		typename Compare = std::less<>>
+		typename Compare = std::less<>,
+		typename Allocator = std::allocator<flat_multi_map_pair_type<Key, Type>>>
 		class flat_map;
 
 	template <
 		typename Key,
 		typename Type,
-		typename Compare = std::less<>>
+		typename Compare = std::less<>,
+		typename Allocator = std::allocator<flat_multi_map_pair_type<Key, Type>>>
 		class flat_multi_map;
 
 	template <
@@ -78,6 +88,12 @@ namespace plib::core::type {
 
 	};
 
+	// 键和值都能按字节搬时，flat_map中间插入/删除直接memmove
+	template <typename Key, typename Value>
+	struct is_trivially_relocatable<flat_multi_map_pair_type<Key, Value>>
+		: std::bool_constant<is_trivially_relocatable_v<Key> && is_trivially_relocatable_v<Value>> {
+	};
+
 	template <
 		typename Me,
 		typename Key,
@@ -204,7 +220,8 @@ namespace plib::core::type {
 		template <
 			typename OtherKey,
 			typename OtherType,
-			typename OtherCompare>
+			typename OtherCompare,
+			typename OtherAllocator>
 		friend class flat_multi_map;
 
 		template <
@@ -218,7 +235,7 @@ namespace plib::core::type {
 
 	};
 
-	template <typename Key, typename Type, typename Compare>
+	template <typename Key, typename Type, typename Compare, typename Allocator>
 	class flat_multi_map {
 	public:
 		class iterator;
@@ -228,7 +245,8 @@ namespace plib::core::type {
 
 	private:
 		using pair_type = flat_multi_map_pair_type<Key, Type>;
-		using impl_t = std::vector<pair_type>;
+		using impl_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<pair_type>;
+		using impl_t = std::vector<pair_type, impl_allocator>;
 
 		using iterator_base = flat_multi_map_iterator_base_impl<
 			iterator,
@@ -261,6 +279,7 @@ namespace plib::core::type {
 
 	public:
 		using value_type = pair_type;
+		using allocator_type = impl_allocator;
 		using size_type = typename impl_t::size_type;
 		using difference_type = typename impl_t::difference_type;
 		using pointer = pair_type*;
@@ -321,13 +340,49 @@ namespace plib::core::type {
 			typename = typename std::iterator_traits<Iterator>::iterator_category>
 		flat_multi_map(Iterator first, Iterator last)
 			: _data(first, last) {
-			std::sort(std::begin(impl()), std::end(impl()), compare());
+			std::stable_sort(std::begin(impl()), std::end(impl()), compare());
+		}
+
+		// 输入已经有序，直接拷贝不再排序
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		flat_multi_map(sorted_equivalent_t, Iterator first, Iterator last)
+			: _data(first, last) {
 		}
 
 		flat_multi_map(std::initializer_list<pair_type> iter)
 			: flat_multi_map(iter.begin(), iter.end()) {
 		}
 
+		// 元素存储由alloc分配，例如传入memory::ArenaResource*构造pmr分配器
+		explicit flat_multi_map(const allocator_type& alloc)
+			: _data(alloc) {
+		}
+
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		flat_multi_map(Iterator first, Iterator last, const allocator_type& alloc)
+			: _data(first, last, alloc) {
+			std::stable_sort(std::begin(impl()), std::end(impl()), compare());
+		}
+
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		flat_multi_map(sorted_equivalent_t, Iterator first, Iterator last, const allocator_type& alloc)
+			: _data(first, last, alloc) {
+		}
+
+		flat_multi_map(std::initializer_list<pair_type> iter, const allocator_type& alloc)
+			: flat_multi_map(iter.begin(), iter.end(), alloc) {
+		}
+
+		allocator_type get_allocator() const {
+			return impl().get_allocator();
+		}
+
 		size_type size() const {
 			return impl().size();
 		}
@@ -397,7 +452,7 @@ namespace plib::core::type {
 				return (end() - 1);
 			}
 			auto where = getUpperBound(value.first);
-			return impl().insert(where, value);
+			return detail::flat_insert(impl(), where, value);
 		}
 		iterator insert(value_type&& value) {
 			if (empty() || !compare()(value.first, back().first)) {
@@ -405,13 +460,34 @@ namespace plib::core::type {
 				return (end() - 1);
 			}
 			auto where = getUpperBound(value.first);
-			return impl().insert(where, std::move(value));
+			return detail::flat_insert(impl(), where, std::move(value));
 		}
 		template <typename... Args>
 		iterator emplace(Args&&... args) {
 			return insert(value_type(std::forward<Args>(args)...));
 		}
 
+		// 批量插入：只排序新元素再线性归并，等价键的新元素排在原有元素之后
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert(Iterator first, Iterator last) {
+			const auto mid = size();
+			detail::flat_append(impl(), first, last);
+			detail::flat_merge_equivalent(impl(), mid, compare(), false);
+		}
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert(sorted_equivalent_t, Iterator first, Iterator last) {
+			const auto mid = size();
+			detail::flat_append(impl(), first, last);
+			detail::flat_merge_equivalent(impl(), mid, compare(), true);
+		}
+		void insert(std::initializer_list<pair_type> list) {
+			insert(list.begin(), list.end());
+		}
+
 		bool removeOne(const Key& key) {
 			if (empty()
 				|| compare()(key, front().first)
@@ -422,7 +498,7 @@ namespace plib::core::type {
 			if (compare()(key, where->first)) {
 				return false;
 			}
-			impl().erase(where);
+			detail::flat_erase(impl(), where);
 			return true;
 		}
 		int removeAll(const Key& key) {
@@ -436,7 +512,7 @@ namespace plib::core::type {
 				return 0;
 			}
 			const auto result = (range.second - range.first);
-			impl().erase(range.first, range.second);
+			detail::flat_erase(impl(), range.first, range.second);
 			return result;
 		}
 		bool remove(const Key& key, const Type& value) {
@@ -450,7 +526,7 @@ namespace plib::core::type {
 				(where != e) && !compare()(key, where->first);
 				++where) {
 				if (where->second == value) {
-					impl().erase(where);
+					detail::flat_erase(impl(), where);
 					return true;
 				}
 			}
@@ -458,10 +534,10 @@ namespace plib::core::type {
 		}
 
 		iterator erase(const_iterator where) {
-			return impl().erase(where._impl);
+			return detail::flat_erase(impl(), where._impl);
 		}
 		iterator erase(const_iterator from, const_iterator till) {
-			return impl().erase(from._impl, till._impl);
+			return detail::flat_erase(impl(), from._impl, till._impl);
 		}
 		int erase(const Key& key) {
 			return removeAll(key);
@@ -523,7 +599,7 @@ namespace plib::core::type {
 		}
 
 	private:
-		friend class flat_map<Key, Type, Compare>;
+		friend class flat_map<Key, Type, Compare, Allocator>;
 
 		struct transparent_compare : Compare {
 			inline constexpr const Compare& initial() const noexcept {
@@ -650,13 +726,14 @@ namespace plib::core::type {
 
 	};
 
-	template <typename Key, typename Type, typename Compare>
-	class flat_map : private flat_multi_map<Key, Type, Compare> {
-		using parent = flat_multi_map<Key, Type, Compare>;
+	template <typename Key, typename Type, typename Compare, typename Allocator>
+	class flat_map : private flat_multi_map<Key, Type, Compare, Allocator> {
+		using parent = flat_multi_map<Key, Type, Compare, Allocator>;
 		using pair_type = typename parent::pair_type;
 
 	public:
 		using value_type = typename parent::value_type;
+		using allocator_type = typename parent::allocator_type;
 		using size_type = typename parent::size_type;
 		using difference_type = typename parent::difference_type;
 		using pointer = typename parent::pointer;
@@ -682,6 +759,53 @@ namespace plib::core::type {
 			finalize();
 		}
 
+		explicit flat_map(const allocator_type& alloc) : parent(alloc) {
+		}
+
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category
+		>
+		flat_map(Iterator first, Iterator last, const allocator_type& alloc) : parent(first, last, alloc) {
+			finalize();
+		}
+
+		flat_map(std::initializer_list<pair_type> iter, const allocator_type& alloc) : parent(iter.begin(), iter.end(), alloc) {
+			finalize();
+		}
+
+		// 输入已经有序且键唯一，直接拷贝，不排序也不去重
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category
+		>
+		flat_map(sorted_unique_t, Iterator first, Iterator last) : parent(sorted_equivalent, first, last) {
+		}
+
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category
+		>
+		flat_map(sorted_unique_t, Iterator first, Iterator last, const allocator_type& alloc) : parent(sorted_equivalent, first, last, alloc) {
+		}
+
+		// 输入有序但可能有重复键，只做一次线性去重
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category
+		>
+		flat_map(sorted_equivalent_t, Iterator first, Iterator last) : parent(sorted_equivalent, first, last) {
+			finalize();
+		}
+
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category
+		>
+		flat_map(sorted_equivalent_t, Iterator first, Iterator last, const allocator_type& alloc) : parent(sorted_equivalent, first, last, alloc) {
+			finalize();
+		}
+
 		using parent::parent;
 		using parent::size;
 		using parent::empty;
@@ -699,6 +823,7 @@ namespace plib::core::type {
 		using parent::back;
 		using parent::erase;
 		using parent::contains;
+		using parent::get_allocator;
 
 		std::pair<iterator, bool> insert(const value_type& value) {
 			if (this->empty() || this->compare()(this->back().first, value.first)) {
@@ -707,7 +832,7 @@ namespace plib::core::type {
 			}
 			auto where = this->getLowerBound(value.first);
 			if (this->compare()(value.first, where->first)) {
-				return { this->impl().insert(where, value), true };
+				return { detail::flat_insert(this->impl(), where, value), true };
 			}
 			return { where, false };
 		}
@@ -718,7 +843,7 @@ namespace plib::core::type {
 			}
 			auto where = this->getLowerBound(value.first);
 			if (this->compare()(value.first, where->first)) {
-				return { this->impl().insert(where, std::move(value)), true };
+				return { detail::flat_insert(this->impl(), where, std::move(value)), true };
 			}
 			return { where, false };
 		}
@@ -731,7 +856,7 @@ namespace plib::core::type {
 			}
 			auto where = this->getLowerBound(key);
 			if (this->compare()(key, where->first)) {
-				return { this->impl().insert(where, value_type(key, value)), true };
+				return { detail::flat_insert(this->impl(), where, value_type(key, value)), true };
 			}
 			where->second = value;
 			return { where, false };
@@ -745,11 +870,40 @@ namespace plib::core::type {
 			}
 			auto where = this->getLowerBound(key);
 			if (this->compare()(key, where->first)) {
-				return { this->impl().insert(where, value_type(key, std::move(value))), true };
+				return { detail::flat_insert(this->impl(), where, value_type(key, std::move(value))), true };
 			}
 			where->second = std::move(value);
 			return { where, false };
 		}
+		// 批量插入，键已存在时保留原值(与insert一致)，批次内重复的键取第一个
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert(Iterator first, Iterator last) {
+			insertRange<false>(first, last, false);
+		}
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert(sorted_unique_t, Iterator first, Iterator last) {
+			insertRange<false>(first, last, true);
+		}
+		void insert(std::initializer_list<pair_type> list) {
+			insert(list.begin(), list.end());
+		}
+		// 批量插入或覆盖，键已存在时用新值覆盖(与insert_or_assign一致)，批次内重复的键取最后一个
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert_or_assign(Iterator first, Iterator last) {
+			insertRange<true>(first, last, false);
+		}
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert_or_assign(sorted_unique_t, Iterator first, Iterator last) {
+			insertRange<true>(first, last, true);
+		}
 		template <typename OtherKey, typename... Args>
 		std::pair<iterator, bool> emplace(
 			OtherKey&& key,
@@ -779,7 +933,7 @@ namespace plib::core::type {
 			auto where = this->getLowerBound(key);
 			if (this->compare()(key, where->first)) {
 				return {
-					this->impl().insert(
+					detail::flat_insert(this->impl(),
 						where,
 						value_type(
 							key,
@@ -816,7 +970,7 @@ namespace plib::core::type {
 			}
 			auto where = this->getLowerBound(key);
 			if (this->compare()(key, where->first)) {
-				return this->impl().insert(where, { key, Type() })->second;
+				return detail::flat_insert(this->impl(), where, value_type(key, Type()))->second;
 			}
 			return where->second;
 		}
@@ -832,6 +986,21 @@ namespace plib::core::type {
 		}
 
 	private:
+		template <bool LastWins, typename Iterator>
+		void insertRange(Iterator first, Iterator last, bool sorted) {
+			const auto mid = this->size();
+			detail::flat_append(this->impl(), first, last);
+			detail::flat_merge_unique<LastWins>(
+				this->impl(),
+				mid,
+				this->compare(),
+				sorted,
+				[](pair_type& existing, pair_type&& incoming) {
+					existing.second = std::move(incoming.second);
+				});
+		}
+
+		// 范围构造时稳定排序，等价键保留输入中的第一个
 		void finalize() {
 			this->impl().erase(
 				std::unique(
@@ -846,6 +1015,23 @@ namespace plib::core::type {
 
 	};
 
+	namespace pmr {
+		// 与std::pmr一致的别名，元素存储来自memory_resource
+		template <typename Key, typename Type, typename Compare = std::less<>>
+		using flat_map = type::flat_map<
+			Key,
+			Type,
+			Compare,
+			std::pmr::polymorphic_allocator<flat_multi_map_pair_type<Key, Type>>>;
+
+		template <typename Key, typename Type, typename Compare = std::less<>>
+		using flat_multi_map = type::flat_multi_map<
+			Key,
+			Type,
+			Compare,
+			std::pmr::polymorphic_allocator<flat_multi_map_pair_type<Key, Type>>>;
+	} // namespace pmr
+
 } // namespace plib::core::type
 
 // Structured bindings support.
@@ -2,16 +2,20 @@
 #define PLIB_CORE_TYPE_FLATSET_HPP
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include "type/flat_sorted.hpp"
 
 namespace plib::core::type {
 
 using std::begin;
 using std::end;
 
-template <typename Type, typename Compare = std::less<>>
+// Allocator可以是任意元素类型的分配器，内部会rebind到存储的包装类型
+template <typename Type, typename Compare = std::less<>, typename Allocator = std::allocator<Type>>
 class flat_set;
 
-template <typename Type, typename Compare = std::less<>>
+template <typename Type, typename Compare = std::less<>, typename Allocator = std::allocator<Type>>
 class flat_multi_set;
 
 template <typename Type, typename iterator_impl>
@@ -113,10 +117,10 @@ public:
 private:
 	iterator_impl _impl;
 
-	template <typename OtherType, typename OtherCompare>
+	template <typename OtherType, typename OtherCompare, typename OtherAllocator>
 	friend class flat_multi_set;
 
-	template <typename OtherType, typename OtherCompare>
+	template <typename OtherType, typename OtherCompare, typename OtherAllocator>
 	friend class flat_set;
 
 	template <
@@ -182,13 +186,20 @@ private:
 
 };
 
-template <typename Type, typename Compare>
+template <typename Type>
+struct is_trivially_relocatable<flat_multi_set_const_wrap<Type>>
+	: is_trivially_relocatable<Type> {
+};
+
+template <typename Type, typename Compare, typename Allocator>
 class flat_multi_set {
 	using const_wrap = flat_multi_set_const_wrap<Type>;
-	using impl_t = std::vector<const_wrap>;
+	using impl_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<const_wrap>;
+	using impl_t = std::vector<const_wrap, impl_allocator>;
 
 public:
 	using value_type = Type;
+	using allocator_type = impl_allocator;
 	using size_type = typename impl_t::size_type;
 	using difference_type = typename impl_t::difference_type;
 	using pointer = const Type*;
@@ -214,13 +225,49 @@ public:
 		typename = typename std::iterator_traits<Iterator>::iterator_category>
 	constexpr flat_multi_set(Iterator first, Iterator last) noexcept
 	: _data(first, last) {
-		std::sort(std::begin(impl()), std::end(impl()), compare());
+		std::stable_sort(std::begin(impl()), std::end(impl()), compare());
+	}
+
+	// 输入已经有序，直接拷贝不再排序
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category>
+	constexpr flat_multi_set(sorted_equivalent_t, Iterator first, Iterator last) noexcept
+	: _data(first, last) {
 	}
 
 	constexpr flat_multi_set(std::initializer_list<Type> iter) noexcept
 	: flat_multi_set(iter.begin(), iter.end()) {
 	}
 
+	// 元素存储由alloc分配，例如传入memory::ArenaResource*构造pmr分配器
+	constexpr explicit flat_multi_set(const allocator_type &alloc) noexcept
+	: _data(alloc) {
+	}
+
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category>
+	constexpr flat_multi_set(Iterator first, Iterator last, const allocator_type &alloc) noexcept
+	: _data(first, last, alloc) {
+		std::stable_sort(std::begin(impl()), std::end(impl()), compare());
+	}
+
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category>
+	constexpr flat_multi_set(sorted_equivalent_t, Iterator first, Iterator last, const allocator_type &alloc) noexcept
+	: _data(first, last, alloc) {
+	}
+
+	constexpr flat_multi_set(std::initializer_list<Type> iter, const allocator_type &alloc) noexcept
+	: flat_multi_set(iter.begin(), iter.end(), alloc) {
+	}
+
+	constexpr allocator_type get_allocator() const noexcept {
+		return impl().get_allocator();
+	}
+
 	constexpr size_type size() const noexcept {
 		return impl().size();
 	}
@@ -287,7 +334,7 @@ public:
 			return (end() - 1);
 		}
 		auto where = getUpperBound(value);
-		return impl().insert(where, value);
+		return detail::flat_insert(impl(), where, value);
 	}
 	constexpr iterator insert(Type &&value) noexcept {
 		if (empty() || !compare()(value, back())) {
@@ -295,7 +342,7 @@ public:
 			return (end() - 1);
 		}
 		auto where = getUpperBound(value);
-		return impl().insert(where, std::move(value));
+		return detail::flat_insert(impl(), where, std::move(value));
 	}
 	template <typename... Args>
 	constexpr iterator emplace(Args&&... args) noexcept {
@@ -313,7 +360,7 @@ public:
 		if (compare()(value, *where)) {
 			return false;
 		}
-		impl().erase(where);
+		detail::flat_erase(impl(), where);
 		return true;
 	}
 	constexpr bool removeOne(const Type &value) noexcept {
@@ -331,7 +378,7 @@ public:
 			return 0;
 		}
 		const auto result = (range.second - range.first);
-		impl().erase(range.first, range.second);
+		detail::flat_erase(impl(), range.first, range.second);
 		return result;
 	}
 	constexpr int removeAll(const Type &value) noexcept {
@@ -339,12 +386,12 @@ public:
 	}
 
 	constexpr iterator erase(const_iterator where) noexcept {
-		return impl().erase(where._impl);
+		return detail::flat_erase(impl(), where._impl);
 	}
 	constexpr iterator erase(
 			const_iterator from,
 			const_iterator till) noexcept {
-		return impl().erase(from._impl, till._impl);
+		return detail::flat_erase(impl(), from._impl, till._impl);
 	}
 	constexpr int erase(const Type &value) noexcept {
 		return removeAll(value);
@@ -455,13 +502,24 @@ public:
 		typename Iterator,
 		typename = typename std::iterator_traits<Iterator>::iterator_category>
 	constexpr void merge(Iterator first, Iterator last) noexcept {
-		impl().insert(impl().end(), first, last);
-		std::sort(std::begin(impl()), std::end(impl()), compare());
+		const auto mid = size();
+		detail::flat_append(impl(), first, last);
+		detail::flat_merge_equivalent(impl(), mid, compare(), false);
+	}
+
+	// 输入已经有序，只做一次线性归并
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category>
+	constexpr void merge(sorted_equivalent_t, Iterator first, Iterator last) noexcept {
+		const auto mid = size();
+		detail::flat_append(impl(), first, last);
+		detail::flat_merge_equivalent(impl(), mid, compare(), true);
 	}
 
 	constexpr void merge(
 			const flat_multi_set<Type, Compare> &other) noexcept {
-		merge(other.begin(), other.end());
+		merge(sorted_equivalent, other.begin(), other.end());
 	}
 
 	constexpr void merge(std::initializer_list<Type> list) noexcept {
@@ -500,7 +558,7 @@ public:
 	}
 
 private:
-	friend class flat_set<Type, Compare>;
+	friend class flat_set<Type, Compare, Allocator>;
 
 	struct transparent_compare : Compare {
 		constexpr const Compare &initial() const noexcept {
@@ -638,9 +696,9 @@ private:
 
 };
 
-template <typename Type, typename Compare>
-class flat_set : private flat_multi_set<Type, Compare> {
-	using parent = flat_multi_set<Type, Compare>;
+template <typename Type, typename Compare, typename Allocator>
+class flat_set : private flat_multi_set<Type, Compare, Allocator> {
+	using parent = flat_multi_set<Type, Compare, Allocator>;
 
 public:
 	using iterator = typename parent::iterator;
@@ -648,6 +706,7 @@ public:
 	using reverse_iterator = typename parent::reverse_iterator;
 	using const_reverse_iterator = typename parent::const_reverse_iterator;
 	using value_type = typename parent::value_type;
+	using allocator_type = typename parent::allocator_type;
 	using size_type = typename parent::size_type;
 	using difference_type = typename parent::difference_type;
 	using pointer = typename parent::pointer;
@@ -669,6 +728,60 @@ public:
 		finalize();
 	}
 
+	constexpr explicit flat_set(const allocator_type &alloc) noexcept
+	: parent(alloc) {
+	}
+
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category
+	>
+	constexpr flat_set(Iterator first, Iterator last, const allocator_type &alloc) noexcept
+	: parent(first, last, alloc) {
+		finalize();
+	}
+
+	constexpr flat_set(std::initializer_list<Type> iter, const allocator_type &alloc) noexcept
+	: parent(iter.begin(), iter.end(), alloc) {
+		finalize();
+	}
+
+	// 输入已经有序且没有重复，直接拷贝，不排序也不去重
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category
+	>
+	constexpr flat_set(sorted_unique_t, Iterator first, Iterator last) noexcept
+	: parent(sorted_equivalent, first, last) {
+	}
+
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category
+	>
+	constexpr flat_set(sorted_unique_t, Iterator first, Iterator last, const allocator_type &alloc) noexcept
+	: parent(sorted_equivalent, first, last, alloc) {
+	}
+
+	// 输入有序但可能有重复，只做一次线性去重
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category
+	>
+	constexpr flat_set(sorted_equivalent_t, Iterator first, Iterator last) noexcept
+	: parent(sorted_equivalent, first, last) {
+		finalize();
+	}
+
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category
+	>
+	constexpr flat_set(sorted_equivalent_t, Iterator first, Iterator last, const allocator_type &alloc) noexcept
+	: parent(sorted_equivalent, first, last, alloc) {
+		finalize();
+	}
+
 	using parent::parent;
 	using parent::size;
 	using parent::empty;
@@ -690,6 +803,7 @@ public:
 	using parent::lower_bound;
 	using parent::upper_bound;
 	using parent::equal_range;
+	using parent::get_allocator;
 
 	constexpr std::pair<iterator, bool> insert(const Type &value) noexcept {
 		if (this->empty() || this->compare()(this->back(), value)) {
@@ -698,7 +812,7 @@ public:
 		}
 		auto where = this->getLowerBound(value);
 		if (this->compare()(value, *where)) {
-			return std::make_pair(this->impl().insert(where, value), true);
+			return std::make_pair(detail::flat_insert(this->impl(), where, value), true);
 		}
 		return std::make_pair(where, false);
 	}
@@ -710,7 +824,7 @@ public:
 		auto where = this->getLowerBound(value);
 		if (this->compare()(value, *where)) {
 			return std::make_pair(
-				this->impl().insert(where, std::move(value)),
+				detail::flat_insert(this->impl(), where, std::move(value)),
 				true);
 		}
 		return std::make_pair(where, false);
@@ -773,13 +887,20 @@ public:
 		typename Iterator,
 		typename = typename std::iterator_traits<Iterator>::iterator_category>
 	constexpr void merge(Iterator first, Iterator last) noexcept {
-		parent::merge(first, last);
-		finalize();
+		mergeRange(first, last, false);
+	}
+
+	// 已有的元素优先保留，输入已经有序且没有重复时跳过排序
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category>
+	constexpr void merge(sorted_unique_t, Iterator first, Iterator last) noexcept {
+		mergeRange(first, last, true);
 	}
 
 	constexpr void merge(
 			const flat_multi_set<Type, Compare> &other) noexcept {
-		merge(other.begin(), other.end());
+		mergeRange(other.begin(), other.end(), true);
 	}
 
 	constexpr void merge(std::initializer_list<Type> list) noexcept {
@@ -818,6 +939,18 @@ public:
 	}
 
 private:
+	template <typename Iterator>
+	constexpr void mergeRange(Iterator first, Iterator last, bool sorted) noexcept {
+		const auto mid = this->size();
+		detail::flat_append(this->impl(), first, last);
+		detail::flat_merge_unique<false>(
+			this->impl(),
+			mid,
+			this->compare(),
+			sorted,
+			[](auto &, auto &&) {});
+	}
+
 	constexpr void finalize() noexcept {
 		this->impl().erase(
 			std::unique(
@@ -831,5 +964,14 @@ private:
 	}
 
 };
+
+namespace pmr {
+// 与std::pmr一致的别名，元素存储来自memory_resource
+template <typename Type, typename Compare = std::less<>>
+using flat_set = type::flat_set<Type, Compare, std::pmr::polymorphic_allocator<Type>>;
+
+template <typename Type, typename Compare = std::less<>>
+using flat_multi_set = type::flat_multi_set<Type, Compare, std::pmr::polymorphic_allocator<Type>>;
+} // namespace pmr
 } // namespace plib::core::type
 #endif // PLIB_CORE_TYPE_FLATSET_HPP
\ No newline at end of file
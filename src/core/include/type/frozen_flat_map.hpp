@@ -0,0 +1,412 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-21 14:02:55
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-21 14:02:55
+ * @FilePath: \plib\src\core\include\type\frozen_flat_map.hpp
+ * @Description: 构建后只读的flat_map，键按Eytzinger(BFS)顺序存放，查找无分支并提前预取后代所在的缓存行
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_TYPE_FROZEN_FLAT_MAP_HPP_
+#define PLIB_CORE_TYPE_FROZEN_FLAT_MAP_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "plib_macros.hpp"
+#include "type/flat_soa_map.hpp"
+#include "type/flat_sorted.hpp"
+#include "type/flatmap.hpp"
+
+namespace plib::core::type {
+
+	template <
+		typename Key,
+		typename Type,
+		typename Compare = std::less<>,
+		typename Allocator = std::allocator<std::pair<Key, Type>>>
+		class frozen_flat_map;
+
+	namespace detail {
+
+		// 键数组按缓存行对齐，预取的一行正好是某个节点往下第四层(4字节键时)的全部后代
+		template <typename T>
+		struct cache_aligned_allocator {
+			using value_type = T;
+
+			cache_aligned_allocator() = default;
+			template <typename U>
+			cache_aligned_allocator(const cache_aligned_allocator<U>&) noexcept {
+			}
+
+			T* allocate(std::size_t n) {
+				return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(CACHE_LINE_SIZE)));
+			}
+			void deallocate(T* p, std::size_t) noexcept {
+				::operator delete(p, std::align_val_t(CACHE_LINE_SIZE));
+			}
+
+			template <typename U>
+			bool operator==(const cache_aligned_allocator<U>&) const noexcept {
+				return true;
+			}
+		};
+
+		// 1起始的Eytzinger下标(k的子节点是2k和2k+1)上的中序后继，没有后继时返回0
+		inline std::size_t eytzinger_next(std::size_t k, std::size_t n) noexcept {
+			if (2 * k + 1 <= n) {
+				k = 2 * k + 1;
+				while (2 * k <= n) {
+					k = 2 * k;
+				}
+				return k;
+			}
+			// 沿着右孩子一路向上，再上一层就是后继
+			return k >> (std::countr_one(k) + 1);
+		}
+
+		// 中序前驱，k为0表示end，返回最后一个节点
+		inline std::size_t eytzinger_prev(std::size_t k, std::size_t n) noexcept {
+			if (k == 0) {
+				k = n != 0 ? 1 : 0;
+				while (k != 0 && 2 * k + 1 <= n) {
+					k = 2 * k + 1;
+				}
+				return k;
+			}
+			if (2 * k <= n) {
+				k = 2 * k;
+				while (2 * k + 1 <= n) {
+					k = 2 * k + 1;
+				}
+				return k;
+			}
+			return k >> (std::countr_zero(k) + 1);
+		}
+
+		inline std::size_t eytzinger_first(std::size_t n) noexcept {
+			std::size_t k = n != 0 ? 1 : 0;
+			while (k != 0 && 2 * k <= n) {
+				k = 2 * k;
+			}
+			return k;
+		}
+
+	} // namespace detail
+
+	/**
+	 * @brief: frozen_flat_map的双向迭代器，按键的顺序(中序)遍历Eytzinger数组
+	 */
+	template <typename Key, typename Type>
+	class frozen_flat_map_iterator {
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = std::pair<Key, Type>;
+		using difference_type = std::ptrdiff_t;
+		using reference = flat_soa_map_reference<Key, const Type>;
+		using pointer = typename flat_soa_map_iterator<Key, const Type>::pointer;
+
+		frozen_flat_map_iterator() = default;
+		frozen_flat_map_iterator(const Key* keys, const Type* values, std::size_t size, std::size_t index) noexcept
+			: _keys(keys)
+			, _values(values)
+			, _size(size)
+			, _index(index) {
+		}
+
+		reference operator*() const noexcept {
+			return { _keys[_index], _values[_index - 1] };
+		}
+		pointer operator->() const noexcept {
+			return { **this };
+		}
+
+		frozen_flat_map_iterator& operator++() noexcept {
+			_index = detail::eytzinger_next(_index, _size);
+			return *this;
+		}
+		frozen_flat_map_iterator operator++(int) noexcept {
+			auto result = *this;
+			++*this;
+			return result;
+		}
+		frozen_flat_map_iterator& operator--() noexcept {
+			_index = detail::eytzinger_prev(_index, _size);
+			return *this;
+		}
+		frozen_flat_map_iterator operator--(int) noexcept {
+			auto result = *this;
+			--*this;
+			return result;
+		}
+
+		friend bool operator==(const frozen_flat_map_iterator& a, const frozen_flat_map_iterator& b) noexcept {
+			return a._index == b._index && a._keys == b._keys;
+		}
+
+	private:
+		const Key* _keys = nullptr;
+		const Type* _values = nullptr;
+		std::size_t _size = 0;
+		// Eytzinger下标，0表示end
+		std::size_t _index = 0;
+
+	};
+
+	/**
+	 * @brief: 一次构建、之后只读的有序映射，用于大查找表
+	 * 键按Eytzinger顺序放在缓存行对齐的数组里，值单独存放；查找时每层只做一次比较和下标计算(无分支)，
+	 * 并预取四层之后(4字节键时)的后代，大于L2/LLC的表上比std::lower_bound少很多缓存未命中。
+	 * 接口是flat_map只读部分的子集，迭代按键的顺序进行，但不是随机访问迭代器
+	 */
+	template <typename Key, typename Type, typename Compare, typename Allocator>
+	class frozen_flat_map {
+		using keys_t = std::vector<Key, detail::cache_aligned_allocator<Key>>;
+		using values_t = std::vector<Type, typename std::allocator_traits<Allocator>::template rebind_alloc<Type>>;
+
+	public:
+		using key_type = Key;
+		using mapped_type = Type;
+		using value_type = std::pair<Key, Type>;
+		using key_compare = Compare;
+		using allocator_type = Allocator;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using iterator = frozen_flat_map_iterator<Key, Type>;
+		using const_iterator = iterator;
+		using reference = typename iterator::reference;
+		using const_reference = reference;
+
+		frozen_flat_map() = default;
+
+		explicit frozen_flat_map(const allocator_type& alloc)
+			: _values(alloc) {
+		}
+
+		template <typename OtherAllocator>
+		explicit frozen_flat_map(const flat_map<Key, Type, Compare, OtherAllocator>& map, const allocator_type& alloc = allocator_type())
+			: frozen_flat_map(alloc) {
+			build<false>(map.begin(), map.size());
+		}
+
+		// 值从map中移走，map之后只剩键
+		template <typename OtherAllocator>
+		explicit frozen_flat_map(flat_map<Key, Type, Compare, OtherAllocator>&& map, const allocator_type& alloc = allocator_type())
+			: frozen_flat_map(alloc) {
+			build<true>(map.begin(), map.size());
+		}
+
+		template <typename OtherAllocator>
+		explicit frozen_flat_map(const flat_soa_map<Key, Type, Compare, OtherAllocator>& map, const allocator_type& alloc = allocator_type())
+			: frozen_flat_map(alloc) {
+			build<false>(map.begin(), map.size());
+		}
+
+		// 乱序输入，等价键保留第一个
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		frozen_flat_map(Iterator first, Iterator last, const allocator_type& alloc = allocator_type())
+			: frozen_flat_map(alloc) {
+			auto items = collect(first, last);
+			detail::flat_merge_unique<false>(items, 0, byKey(), false, [](auto&, auto&&) {});
+			build<true>(items.begin(), items.size());
+		}
+
+		frozen_flat_map(std::initializer_list<value_type> list, const allocator_type& alloc = allocator_type())
+			: frozen_flat_map(list.begin(), list.end(), alloc) {
+		}
+
+		// 输入已经有序且键唯一
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		frozen_flat_map(sorted_unique_t, Iterator first, Iterator last, const allocator_type& alloc = allocator_type())
+			: frozen_flat_map(alloc) {
+			using category = typename std::iterator_traits<Iterator>::iterator_category;
+			if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category>) {
+				build<false>(first, static_cast<size_type>(last - first));
+			} else {
+				auto items = collect(first, last);
+				build<true>(items.begin(), items.size());
+			}
+		}
+
+		allocator_type get_allocator() const {
+			return allocator_type(_values.get_allocator());
+		}
+
+		size_type size() const noexcept {
+			return _values.size();
+		}
+		bool empty() const noexcept {
+			return _values.empty();
+		}
+
+		const_iterator begin() const noexcept {
+			return at(detail::eytzinger_first(size()));
+		}
+		const_iterator end() const noexcept {
+			return at(0);
+		}
+		const_iterator cbegin() const noexcept {
+			return begin();
+		}
+		const_iterator cend() const noexcept {
+			return end();
+		}
+
+		template <typename OtherKey>
+		const_iterator lower_bound(const OtherKey& key) const {
+			return at(lowerIndex(key));
+		}
+		template <typename OtherKey>
+		const_iterator upper_bound(const OtherKey& key) const {
+			return at(upperIndex(key));
+		}
+		template <typename OtherKey>
+		const_iterator find(const OtherKey& key) const {
+			return at(findIndex(key));
+		}
+		const_iterator find(const Key& key) const {
+			return find<Key>(key);
+		}
+		template <typename OtherKey>
+		bool contains(const OtherKey& key) const {
+			return findIndex(key) != 0;
+		}
+		bool contains(const Key& key) const {
+			return contains<Key>(key);
+		}
+		template <typename OtherKey>
+		size_type count(const OtherKey& key) const {
+			return contains(key) ? 1 : 0;
+		}
+
+		// 查找值，不存在时返回nullptr，省去迭代器的构造
+		template <typename OtherKey>
+		const Type* get(const OtherKey& key) const {
+			const auto index = findIndex(key);
+			return index != 0 ? &_values[index - 1] : nullptr;
+		}
+
+	private:
+		// 每个缓存行能放下的键数，预取k*kPrefetchStride即第log2(kPrefetchStride)层后代的起点
+		static constexpr size_type kPrefetchStride =
+			CACHE_LINE_SIZE / sizeof(Key) != 0 ? CACHE_LINE_SIZE / sizeof(Key) : 1;
+
+		// 靠近叶子时k*kPrefetchStride会越过数组末尾，指针越界运算是未定义行为，按整数算地址；
+		// 预取无效地址不会出错，循环里也不用多一个分支
+		static void prefetchDescendants(const Key* keys, size_type k) noexcept {
+			P_PREFETCH(reinterpret_cast<const void*>(reinterpret_cast<std::uintptr_t>(keys) + k * kPrefetchStride * sizeof(Key)));
+		}
+
+		const_iterator at(size_type index) const noexcept {
+			return const_iterator(_keys.data(), _values.data(), size(), index);
+		}
+
+		const Compare& compare() const noexcept {
+			return _compare;
+		}
+
+		auto byKey() const {
+			return [this](const value_type& a, const value_type& b) {
+				return compare()(a.first, b.first);
+			};
+		}
+
+		template <typename Iterator>
+		static std::vector<value_type> collect(Iterator first, Iterator last) {
+			std::vector<value_type> items;
+			for (; first != last; ++first) {
+				items.emplace_back(first->first, first->second);
+			}
+			return items;
+		}
+
+		/**
+		 * @brief: 每层下标 k = 2k + (keys[k] < key)，走到叶子以下后去掉末尾连续的右转就是答案
+		 * 返回Eytzinger下标，0表示所有键都小于key
+		 */
+		template <typename OtherKey>
+		size_type lowerIndex(const OtherKey& key) const {
+			const Key* keys = _keys.data();
+			const size_type n = size();
+			size_type k = 1;
+			while (k <= n) {
+				prefetchDescendants(keys, k);
+				k = 2 * k + static_cast<size_type>(compare()(keys[k], key));
+			}
+			return k >> (std::countr_one(k) + 1);
+		}
+		template <typename OtherKey>
+		size_type upperIndex(const OtherKey& key) const {
+			const Key* keys = _keys.data();
+			const size_type n = size();
+			size_type k = 1;
+			while (k <= n) {
+				prefetchDescendants(keys, k);
+				k = 2 * k + static_cast<size_type>(!compare()(key, keys[k]));
+			}
+			return k >> (std::countr_one(k) + 1);
+		}
+		template <typename OtherKey>
+		size_type findIndex(const OtherKey& key) const {
+			const auto index = lowerIndex(key);
+			return (index != 0 && !compare()(key, _keys[index])) ? index : 0;
+		}
+
+		/**
+		 * @brief: sorted[0, n)是按键有序且唯一的元素，按中序把第r个元素放到Eytzinger下标上
+		 * keys[0]只是占位，使子节点下标是2k/2k+1；值数组不需要占位，下标减一
+		 */
+		template <bool Move, typename Iterator>
+		void build(Iterator sorted, size_type n) {
+			if (n == 0) {
+				return;
+			}
+			std::vector<size_type> rank(n + 1);
+			for (size_type r = 0, k = detail::eytzinger_first(n); r != n; ++r, k = detail::eytzinger_next(k, n)) {
+				rank[k] = r;
+			}
+			_keys.reserve(n + 1);
+			_values.reserve(n);
+			_keys.push_back(sorted[0].first);
+			for (size_type k = 1; k <= n; ++k) {
+				auto&& item = sorted[static_cast<difference_type>(rank[k])];
+				_keys.push_back(item.first);
+				if constexpr (Move) {
+					_values.push_back(std::move(item.second));
+				} else {
+					_values.push_back(item.second);
+				}
+			}
+		}
+
+		PLIB_NO_UNIQUE_ADDRESS Compare _compare;
+		keys_t _keys;
+		values_t _values;
+
+	};
+
+	namespace pmr {
+		template <typename Key, typename Type, typename Compare = std::less<>>
+		using frozen_flat_map = type::frozen_flat_map<
+			Key,
+			Type,
+			Compare,
+			std::pmr::polymorphic_allocator<std::pair<Key, Type>>>;
+	} // namespace pmr
+
+} // namespace plib::core::type
+
+#endif // PLIB_CORE_TYPE_FROZEN_FLAT_MAP_HPP_
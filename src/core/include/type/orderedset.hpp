@@ -1,150 +1,938 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-21 17:10:26
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-21 17:10:26
+ * @FilePath: \plib\src\core\include\type\orderedset.hpp
+ * @Description: 基于内存B+树的有序集合，节点宽达数个缓存行，叶子按顺序双向链接，支持有序输入批量构建与区间查询
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
 #ifndef PLIB_CORE_TYPE_ORDERED_SET_HPP
 #define PLIB_CORE_TYPE_ORDERED_SET_HPP
 
-#include<map>
-#include<list>
-namespace plib::core::type{
-// ordered set template based on QMap
-template <typename T>
-class OrderedSet {
-	struct NullType {
-	};
-	using Self = OrderedSet<T>;
-	using Impl = ::std::map<T, NullType>;
-	using IteratorImpl = typename Impl::iterator;
-	using ConstIteratorImpl = typename Impl::const_iterator;
-	Impl impl_;
-
-public:
-	OrderedSet() = default;
-	OrderedSet(const OrderedSet& other) = default;
-	OrderedSet(OrderedSet&& other) = default;
-	OrderedSet& operator=(const OrderedSet& other) = default;
-	OrderedSet& operator=(OrderedSet&& other) = default;
-	~OrderedSet() = default;
-
-	inline bool operator==(const Self& other) const { return impl_ == other.impl_; }
-	inline bool operator!=(const Self& other) const { return impl_ != other.impl_; }
-	inline int size() const { return impl_.size(); }
-	inline bool isEmpty() const { return impl_.isEmpty(); }
-	inline void detach() { return impl_.detach(); }
-	inline bool isDetached() const { return impl_.isDetached(); }
-	inline void clear() { return impl_.clear(); }
-	inline list<T> values() const { return impl_.keys(); }
-	inline const T& first() const { return impl_.firstKey(); }
-	inline const T& last() const { return impl_.lastKey(); }
-
-	class const_iterator;
-	class iterator {
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "plib_macros.hpp"
+#include "type/flat_sorted.hpp"
+
+namespace plib::core::type {
+
+	/**
+	 * @brief: 有序集合，接口与std::set相近
+	 * 红黑树每个元素一次分配、查找和遍历都在指针间跳转;这里每个节点连续存放几百字节的键，
+	 * 查找时每层只碰一个节点，遍历沿着叶子链表顺序扫描，插入和区间扫描都比std::set快数倍。
+	 * 内部节点保存的分隔键是叶子中键的拷贝，因此Type需要可拷贝。
+	 * 与std::set不同，插入和删除会在叶子之间搬动元素，使所有迭代器和元素引用失效。
+	 */
+	template <typename Type, typename Compare = std::less<>, typename Allocator = std::allocator<Type>>
+	class OrderedSet {
+		// 叶子约512字节的键，内部节点约256字节的分隔键，计数用uint16_t
+		static constexpr std::size_t kLeafSlots = std::clamp<std::size_t>(512 / sizeof(Type), 8, 256);
+		static constexpr std::size_t kInnerSlots = std::clamp<std::size_t>(256 / sizeof(Type), 8, 256);
+		// 非根节点的最少元素数，合并后不超过容量
+		static constexpr std::size_t kLeafMin = kLeafSlots / 2;
+		static constexpr std::size_t kInnerMin = kInnerSlots / 2;
+		// 每个节点至少有kInnerMin+1个孩子，2^64个元素的树也远低于这个高度
+		static constexpr std::size_t kMaxHeight = 48;
+
+		template <std::size_t N>
+		struct key_storage {
+			Type* keys() noexcept {
+				return std::launder(reinterpret_cast<Type*>(raw));
+			}
+			const Type* keys() const noexcept {
+				return std::launder(reinterpret_cast<const Type*>(raw));
+			}
+			alignas(Type) unsigned char raw[sizeof(Type) * N];
+		};
+
+		struct node_base {
+			std::uint16_t count = 0;
+		};
+
+		struct leaf_node : node_base, key_storage<kLeafSlots> {
+			leaf_node* prev = nullptr;
+			leaf_node* next = nullptr;
+		};
+
+		// keys[i]是children[i + 1]子树中键的下界，children[i]子树中的键都小于keys[i]
+		struct inner_node : node_base, key_storage<kInnerSlots> {
+			node_base* children[kInnerSlots + 1];
+		};
+
+		using alloc_traits = std::allocator_traits<Allocator>;
+		using leaf_allocator = typename alloc_traits::template rebind_alloc<leaf_node>;
+		using inner_allocator = typename alloc_traits::template rebind_alloc<inner_node>;
+
+		// 从根到叶子的路径，index是每层走到的孩子下标
+		struct path_entry {
+			inner_node* node;
+			std::size_t index;
+		};
+
 	public:
-		typedef typename IteratorImpl::iterator_category iterator_category;
-		typedef typename IteratorImpl::difference_type difference_type;
-		typedef T value_type;
-		typedef T* pointer;
-		typedef T& reference;
-
-		iterator() = default;
-		iterator(const iterator& other) = default;
-		iterator& operator=(const iterator& other) = default;
-		inline const T& operator*() const { return impl_.key(); }
-		inline const T* operator->() const { return &impl_.key(); }
-		inline bool operator==(const iterator& other) const { return impl_ == other.impl_; }
-		inline bool operator!=(const iterator& other) const { return impl_ != other.impl_; }
-		inline iterator& operator++() { ++impl_; return *this; }
-		inline iterator operator++(int) { return iterator(impl_++); }
-		inline iterator& operator--() { --impl_; return *this; }
-		inline iterator operator--(int) { return iterator(impl_--); }
-		inline iterator operator+(int j) const { return iterator(impl_ + j); }
-		inline iterator operator-(int j) const { return iterator(impl_ - j); }
-		inline iterator& operator+=(int j) { impl_ += j; return *this; }
-		inline iterator& operator-=(int j) { impl_ -= j; return *this; }
-
-		friend class const_iterator;
-		inline bool operator==(const const_iterator& other) const { return impl_ == other.impl_; }
-		inline bool operator!=(const const_iterator& other) const { return impl_ != other.impl_; }
+		using key_type = Type;
+		using value_type = Type;
+		using key_compare = Compare;
+		using value_compare = Compare;
+		using allocator_type = Allocator;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference = const Type&;
+		using const_reference = const Type&;
 
-	private:
-		explicit iterator(const IteratorImpl& impl) : impl_(impl) {
+		/**
+		 * @brief: 指向叶子中一个槽位的双向迭代器，end()是最后一个叶子的count位置
+		 */
+		class const_iterator {
+		public:
+			using iterator_category = std::bidirectional_iterator_tag;
+			using value_type = Type;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const Type*;
+			using reference = const Type&;
+
+			const_iterator() = default;
+
+			reference operator*() const noexcept {
+				return _leaf->keys()[_pos];
+			}
+			pointer operator->() const noexcept {
+				return _leaf->keys() + _pos;
+			}
+			const_iterator& operator++() noexcept {
+				if (++_pos == _leaf->count && _leaf->next) {
+					_leaf = _leaf->next;
+					_pos = 0;
+				}
+				return *this;
+			}
+			const_iterator operator++(int) noexcept {
+				auto result = *this;
+				++*this;
+				return result;
+			}
+			const_iterator& operator--() noexcept {
+				if (_pos == 0) {
+					_leaf = _leaf->prev;
+					_pos = _leaf->count;
+				}
+				--_pos;
+				return *this;
+			}
+			const_iterator operator--(int) noexcept {
+				auto result = *this;
+				--*this;
+				return result;
+			}
+			friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept {
+				return a._leaf == b._leaf && a._pos == b._pos;
+			}
+
+		private:
+			friend class OrderedSet;
+			const_iterator(const leaf_node* leaf, std::size_t pos) noexcept
+			: _leaf(leaf), _pos(pos) {
+			}
+
+			const leaf_node* _leaf = nullptr;
+			std::size_t _pos = 0;
+		};
+		using iterator = const_iterator;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		OrderedSet() = default;
+		explicit OrderedSet(const Compare& comp, const Allocator& alloc = Allocator())
+		: _comp(comp), _leafAlloc(alloc), _innerAlloc(alloc) {
+		}
+		explicit OrderedSet(const Allocator& alloc)
+		: _leafAlloc(alloc), _innerAlloc(alloc) {
 		}
-		IteratorImpl impl_;
-		friend class OrderedSet<T>;
 
-	};
-	friend class iterator;
+		/**
+		 * @brief: 任意顺序的输入先排序去重(等价键保留第一个)，再批量构建
+		 */
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		OrderedSet(Iterator first, Iterator last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+		: OrderedSet(comp, alloc) {
+			insert(first, last);
+		}
+		OrderedSet(std::initializer_list<Type> list, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+		: OrderedSet(list.begin(), list.end(), comp, alloc) {
+		}
 
-	class const_iterator {
-	public:
-		typedef typename IteratorImpl::iterator_category iterator_category;
-		typedef typename IteratorImpl::difference_type difference_type;
-		typedef T value_type;
-		typedef T* pointer;
-		typedef T& reference;
-
-		const_iterator() = default;
-		const_iterator(const const_iterator& other) = default;
-		const_iterator& operator=(const const_iterator& other) = default;
-		const_iterator(const iterator& other) : impl_(other.impl_) {
-		}
-		const_iterator& operator=(const iterator& other) {
-			impl_ = other.impl_;
+		/**
+		 * @brief: 输入已严格升序，自底向上一次性建树，O(n)
+		 */
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		OrderedSet(sorted_unique_t, Iterator first, Iterator last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+		: OrderedSet(comp, alloc) {
+			bulkLoad(first, last);
+		}
+		OrderedSet(sorted_unique_t, std::initializer_list<Type> list, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+		: OrderedSet(sorted_unique, list.begin(), list.end(), comp, alloc) {
+		}
+
+		OrderedSet(const OrderedSet& other)
+		: _comp(other._comp)
+		, _leafAlloc(alloc_traits::select_on_container_copy_construction(other.get_allocator()))
+		, _innerAlloc(_leafAlloc) {
+			bulkLoad(other.begin(), other.end());
+		}
+		OrderedSet(OrderedSet&& other) noexcept
+		: _comp(std::move(other._comp))
+		, _leafAlloc(std::move(other._leafAlloc))
+		, _innerAlloc(std::move(other._innerAlloc)) {
+			steal(other);
+		}
+		OrderedSet& operator=(const OrderedSet& other) {
+			if (this != &other) {
+				clear();
+				if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+					_leafAlloc = other._leafAlloc;
+					_innerAlloc = other._innerAlloc;
+				}
+				_comp = other._comp;
+				bulkLoad(other.begin(), other.end());
+			}
+			return *this;
+		}
+		OrderedSet& operator=(OrderedSet&& other) noexcept(
+			alloc_traits::propagate_on_container_move_assignment::value
+			|| alloc_traits::is_always_equal::value) {
+			if (this == &other) {
+				return *this;
+			}
+			clear();
+			_comp = std::move(other._comp);
+			if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+				_leafAlloc = std::move(other._leafAlloc);
+				_innerAlloc = std::move(other._innerAlloc);
+				steal(other);
+			} else if (alloc_traits::is_always_equal::value || _leafAlloc == other._leafAlloc) {
+				steal(other);
+			} else {
+				// 分配器不同，只能逐个搬过来
+				std::vector<Type> items;
+				items.reserve(other.size());
+				for (auto& item : other) {
+					items.push_back(std::move(const_cast<Type&>(item)));
+				}
+				other.clear();
+				bulkLoad(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+			}
+			return *this;
+		}
+		OrderedSet& operator=(std::initializer_list<Type> list) {
+			clear();
+			insert(list.begin(), list.end());
+			return *this;
+		}
+		~OrderedSet() {
+			clear();
+		}
+
+		allocator_type get_allocator() const noexcept {
+			return allocator_type(_leafAlloc);
+		}
+		key_compare key_comp() const {
+			return _comp;
+		}
+		value_compare value_comp() const {
+			return _comp;
+		}
+
+		size_type size() const noexcept {
+			return _size;
+		}
+		bool empty() const noexcept {
+			return _size == 0;
+		}
+		bool isEmpty() const noexcept {
+			return empty();
+		}
+		size_type max_size() const noexcept {
+			return static_cast<size_type>(std::numeric_limits<difference_type>::max());
+		}
+
+		const_iterator begin() const noexcept {
+			return const_iterator(_head, 0);
+		}
+		const_iterator cbegin() const noexcept {
+			return begin();
+		}
+		const_iterator end() const noexcept {
+			return const_iterator(_tail, _tail ? _tail->count : 0);
+		}
+		const_iterator cend() const noexcept {
+			return end();
+		}
+		const_reverse_iterator rbegin() const noexcept {
+			return const_reverse_iterator(end());
+		}
+		const_reverse_iterator rend() const noexcept {
+			return const_reverse_iterator(begin());
+		}
+
+		const Type& first() const {
+			return *begin();
+		}
+		const Type& last() const {
+			return _tail->keys()[_tail->count - 1];
+		}
+
+		// 按顺序拷贝出所有元素
+		std::vector<Type> values() const {
+			std::vector<Type> result;
+			result.reserve(_size);
+			for (auto leaf = _head; leaf; leaf = leaf->next) {
+				result.insert(result.end(), leaf->keys(), leaf->keys() + leaf->count);
+			}
+			return result;
+		}
+
+		const_iterator find(const Type& value) const {
+			const auto it = lower_bound(value);
+			return (it != end() && !_comp(value, *it)) ? it : end();
+		}
+		bool contains(const Type& value) const {
+			return find(value) != end();
+		}
+		size_type count(const Type& value) const {
+			return contains(value) ? 1 : 0;
+		}
+
+		const_iterator lower_bound(const Type& value) const {
+			if (!_root) {
+				return end();
+			}
+			const leaf_node* leaf = descend(value, nullptr);
+			const auto keys = leaf->keys();
+			const auto pos = std::lower_bound(keys, keys + leaf->count, value, _comp) - keys;
+			return normalize(leaf, static_cast<std::size_t>(pos));
+		}
+		const_iterator upper_bound(const Type& value) const {
+			if (!_root) {
+				return end();
+			}
+			const leaf_node* leaf = descend(value, nullptr);
+			const auto keys = leaf->keys();
+			const auto pos = std::upper_bound(keys, keys + leaf->count, value, _comp) - keys;
+			return normalize(leaf, static_cast<std::size_t>(pos));
+		}
+		std::pair<const_iterator, const_iterator> equal_range(const Type& value) const {
+			const auto first = lower_bound(value);
+			auto last = first;
+			if (last != end() && !_comp(value, *last)) {
+				++last;
+			}
+			return { first, last };
+		}
+
+		/**
+		 * @brief: 区间查询[from, to)，返回可直接用于范围for的视图，扫描沿叶子链表顺序进行
+		 */
+		std::ranges::subrange<const_iterator> range(const Type& from, const Type& to) const {
+			auto first = lower_bound(from);
+			if (!_comp(from, to)) {
+				return { first, first };
+			}
+			return { first, lower_bound(to) };
+		}
+
+		/**
+		 * @brief: 插入一个元素
+		 * @return: 指向该元素的迭代器，以及是否新插入
+		 */
+		std::pair<iterator, bool> insert(const Type& value) {
+			return emplaceImpl(value);
+		}
+		std::pair<iterator, bool> insert(Type&& value) {
+			return emplaceImpl(std::move(value));
+		}
+		// 提示位置只是为了与std::set接口兼容，B+树从根查找的代价已经很低
+		iterator insert(const_iterator, const Type& value) {
+			return insert(value).first;
+		}
+		iterator insert(const_iterator, Type&& value) {
+			return insert(std::move(value)).first;
+		}
+		template <typename... Args>
+		std::pair<iterator, bool> emplace(Args&&... args) {
+			return emplaceImpl(Type(std::forward<Args>(args)...));
+		}
+
+		/**
+		 * @brief: 批量插入，空集合时排序去重后直接批量构建，否则逐个插入
+		 */
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert(Iterator first, Iterator last) {
+			if (!empty()) {
+				for (; first != last; ++first) {
+					insert(*first);
+				}
+				return;
+			}
+			std::vector<Type> items(first, last);
+			std::stable_sort(items.begin(), items.end(), _comp);
+			items.erase(std::unique(items.begin(), items.end(), [this](const Type& a, const Type& b) {
+				return !_comp(a, b);
+			}), items.end());
+			bulkLoad(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+		}
+		void insert(std::initializer_list<Type> list) {
+			insert(list.begin(), list.end());
+		}
+
+		/**
+		 * @brief: 输入已严格升序，集合为空时O(n)建树
+		 */
+		template <
+			typename Iterator,
+			typename = typename std::iterator_traits<Iterator>::iterator_category>
+		void insert(sorted_unique_t, Iterator first, Iterator last) {
+			if (empty()) {
+				bulkLoad(first, last);
+				return;
+			}
+			for (; first != last; ++first) {
+				insert(*first);
+			}
+		}
+
+		// 合并另一个集合，已有的元素保持不变
+		OrderedSet& unite(const OrderedSet& other) {
+			if (empty()) {
+				return *this = other;
+			}
+			for (const auto& value : other) {
+				insert(value);
+			}
 			return *this;
 		}
-		inline const T& operator*() const { return impl_.key(); }
-		inline const T* operator->() const { return &impl_.key(); }
-		inline bool operator==(const const_iterator& other) const { return impl_ == other.impl_; }
-		inline bool operator!=(const const_iterator& other) const { return impl_ != other.impl_; }
-		inline const_iterator& operator++() { ++impl_; return *this; }
-		inline const_iterator operator++(int) { return const_iterator(impl_++); }
-		inline const_iterator& operator--() { --impl_; return *this; }
-		inline const_iterator operator--(int) { return const_iterator(impl_--); }
-		inline const_iterator operator+(int j) const { return const_iterator(impl_ + j); }
-		inline const_iterator operator-(int j) const { return const_iterator(impl_ - j); }
-		inline const_iterator& operator+=(int j) { impl_ += j; return *this; }
-		inline const_iterator& operator-=(int j) { impl_ -= j; return *this; }
-
-		friend class iterator;
-		inline bool operator==(const iterator& other) const { return impl_ == other.impl_; }
-		inline bool operator!=(const iterator& other) const { return impl_ != other.impl_; }
+
+		/**
+		 * @brief: 删除值等价于value的元素
+		 * @return: 删除的元素个数
+		 */
+		size_type erase(const Type& value) {
+			if (!_root) {
+				return 0;
+			}
+			path_entry path[kMaxHeight];
+			leaf_node* leaf = descend(value, path);
+			const auto keys = leaf->keys();
+			const auto pos = static_cast<std::size_t>(std::lower_bound(keys, keys + leaf->count, value, _comp) - keys);
+			if (pos == leaf->count || _comp(value, keys[pos])) {
+				return 0;
+			}
+			eraseAt(leaf, pos, path);
+			return 1;
+		}
+		size_type remove(const Type& value) {
+			return erase(value);
+		}
+
+		/**
+		 * @brief: 删除迭代器指向的元素，返回指向下一个元素的迭代器
+		 */
+		iterator erase(const_iterator it) {
+			auto leaf = const_cast<leaf_node*>(it._leaf);
+			if (leaf == _root ? leaf->count > 1 : leaf->count > kLeafMin) {
+				// 不需要重新平衡，元素只在叶子内部左移
+				destroyShift(leaf, it._pos);
+				--_size;
+				return normalize(leaf, it._pos);
+			}
+			auto next = std::next(it);
+			if (next == end()) {
+				erase(*it);
+				return end();
+			}
+			// 重新平衡会搬动元素，记下后继元素的值删除后重新定位
+			Type successor = *next;
+			erase(*it);
+			return lower_bound(successor);
+		}
+		iterator erase(const_iterator first, const_iterator last) {
+			if (last == end()) {
+				while (first != end()) {
+					first = erase(first);
+				}
+				return first;
+			}
+			// 删除会使last失效，改用它指向的值作为上界
+			const Type bound = *last;
+			while (_comp(*first, bound)) {
+				first = erase(first);
+			}
+			return first;
+		}
+
+		void clear() noexcept {
+			if (_root) {
+				destroyNode(_root, _height);
+			}
+			_root = nullptr;
+			_head = _tail = nullptr;
+			_height = 0;
+			_size = 0;
+		}
+
+		void swap(OrderedSet& other) noexcept {
+			using std::swap;
+			swap(_comp, other._comp);
+			if constexpr (alloc_traits::propagate_on_container_swap::value) {
+				swap(_leafAlloc, other._leafAlloc);
+				swap(_innerAlloc, other._innerAlloc);
+			}
+			swap(_root, other._root);
+			swap(_head, other._head);
+			swap(_tail, other._tail);
+			swap(_height, other._height);
+			swap(_size, other._size);
+		}
+		friend void swap(OrderedSet& a, OrderedSet& b) noexcept {
+			a.swap(b);
+		}
+
+		friend bool operator==(const OrderedSet& a, const OrderedSet& b) {
+			return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+		}
+		friend auto operator<=>(const OrderedSet& a, const OrderedSet& b)
+			requires std::three_way_comparable<Type> {
+			return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end());
+		}
 
 	private:
-		explicit const_iterator(const ConstIteratorImpl& impl) : impl_(impl) {
+		static leaf_node* asLeaf(node_base* node) noexcept {
+			return static_cast<leaf_node*>(node);
+		}
+		static inner_node* asInner(node_base* node) noexcept {
+			return static_cast<inner_node*>(node);
+		}
+
+		// 槽位在叶子末尾时挪到下一个叶子开头，保证除end()外迭代器都指向有效元素
+		static const_iterator normalize(const leaf_node* leaf, std::size_t pos) noexcept {
+			if (pos == leaf->count && leaf->next) {
+				return const_iterator(leaf->next, 0);
+			}
+			return const_iterator(leaf, pos);
+		}
+
+		// 从根走到可能包含value的叶子，path不为空时记下沿途的内部节点
+		leaf_node* descend(const Type& value, path_entry* path) const {
+			node_base* node = _root;
+			for (std::size_t level = _height; level > 0; --level) {
+				inner_node* inner = asInner(node);
+				const auto keys = inner->keys();
+				const auto index = static_cast<std::size_t>(std::upper_bound(keys, keys + inner->count, value, _comp) - keys);
+				if (path) {
+					path[_height - level] = { inner, index };
+				}
+				node = inner->children[index];
+			}
+			return asLeaf(node);
 		}
-		ConstIteratorImpl impl_;
-		friend class OrderedSet<T>;
 
+		leaf_node* newLeaf() {
+			leaf_node* leaf = std::allocator_traits<leaf_allocator>::allocate(_leafAlloc, 1);
+			return ::new (static_cast<void*>(leaf)) leaf_node;
+		}
+		inner_node* newInner() {
+			inner_node* inner = std::allocator_traits<inner_allocator>::allocate(_innerAlloc, 1);
+			return ::new (static_cast<void*>(inner)) inner_node;
+		}
+		void freeLeaf(leaf_node* leaf) noexcept {
+			std::destroy_n(leaf->keys(), leaf->count);
+			leaf->~leaf_node();
+			std::allocator_traits<leaf_allocator>::deallocate(_leafAlloc, leaf, 1);
+		}
+		void freeInner(inner_node* inner) noexcept {
+			std::destroy_n(inner->keys(), inner->count);
+			inner->~inner_node();
+			std::allocator_traits<inner_allocator>::deallocate(_innerAlloc, inner, 1);
+		}
+		void destroyNode(node_base* node, std::size_t level) noexcept {
+			if (level == 0) {
+				freeLeaf(asLeaf(node));
+				return;
+			}
+			inner_node* inner = asInner(node);
+			for (std::size_t i = 0; i <= inner->count; ++i) {
+				destroyNode(inner->children[i], level - 1);
+			}
+			freeInner(inner);
+		}
+
+		void steal(OrderedSet& other) noexcept {
+			_root = std::exchange(other._root, nullptr);
+			_head = std::exchange(other._head, nullptr);
+			_tail = std::exchange(other._tail, nullptr);
+			_height = std::exchange(other._height, 0);
+			_size = std::exchange(other._size, 0);
+		}
+
+		// 在已构造count个元素的数组pos处腾出位置并放入value
+		template <typename Value>
+		static void insertShift(Type* keys, std::size_t count, std::size_t pos, Value&& value) {
+			if (pos == count) {
+				::new (static_cast<void*>(keys + count)) Type(std::forward<Value>(value));
+				return;
+			}
+			::new (static_cast<void*>(keys + count)) Type(std::move(keys[count - 1]));
+			std::move_backward(keys + pos, keys + count - 1, keys + count);
+			keys[pos] = std::forward<Value>(value);
+		}
+		// 删除pos处的元素，后面的元素左移
+		static void eraseShift(Type* keys, std::size_t count, std::size_t pos) {
+			std::move(keys + pos + 1, keys + count, keys + pos);
+			std::destroy_at(keys + count - 1);
+		}
+		// 把src中[from, from+n)移动构造到dst的未初始化区域并析构原对象
+		static void relocate(Type* src, std::size_t n, Type* dst) {
+			std::uninitialized_move_n(src, n, dst);
+			std::destroy_n(src, n);
+		}
+		void destroyShift(leaf_node* leaf, std::size_t pos) {
+			eraseShift(leaf->keys(), leaf->count, pos);
+			--leaf->count;
+		}
+
+		template <typename Value>
+		std::pair<iterator, bool> emplaceImpl(Value&& value) {
+			if (!_root) {
+				leaf_node* leaf = newLeaf();
+				::new (static_cast<void*>(leaf->keys())) Type(std::forward<Value>(value));
+				leaf->count = 1;
+				_root = _head = _tail = leaf;
+				_size = 1;
+				return { iterator(leaf, 0), true };
+			}
+			path_entry path[kMaxHeight];
+			leaf_node* leaf = descend(value, path);
+			auto keys = leaf->keys();
+			auto pos = static_cast<std::size_t>(std::lower_bound(keys, keys + leaf->count, value, _comp) - keys);
+			if (pos < leaf->count && !_comp(value, keys[pos])) {
+				return { iterator(leaf, pos), false };
+			}
+			if (leaf->count < kLeafSlots) {
+				insertShift(keys, leaf->count, pos, std::forward<Value>(value));
+				++leaf->count;
+				++_size;
+				return { iterator(leaf, pos), true };
+			}
+
+			// 叶子已满，分裂出右兄弟;在最右叶子末尾追加时左边保持满载，顺序插入的填充率接近100%
+			leaf_node* right = newLeaf();
+			const std::size_t split = (pos == kLeafSlots && !leaf->next) ? kLeafSlots : kLeafSlots / 2;
+			relocate(keys + split, kLeafSlots - split, right->keys());
+			right->count = static_cast<std::uint16_t>(kLeafSlots - split);
+			leaf->count = static_cast<std::uint16_t>(split);
+			right->prev = leaf;
+			right->next = leaf->next;
+			(leaf->next ? leaf->next->prev : _tail) = right;
+			leaf->next = right;
+
+			leaf_node* target = leaf;
+			if (pos >= split) {
+				target = right;
+				pos -= split;
+			}
+			insertShift(target->keys(), target->count, pos, std::forward<Value>(value));
+			++target->count;
+			++_size;
+			insertIntoParent(path, _height, leaf, Type(right->keys()[0]), right);
+			return { iterator(target, pos), true };
+		}
+
+		/**
+		 * @brief: left分裂出了right，把分隔键separator和right挂到父节点上，必要时逐层向上分裂
+		 * @param depth: left所在层在path中的深度，0表示left是根
+		 */
+		void insertIntoParent(path_entry* path, std::size_t depth, node_base* left, Type&& separator, node_base* right) {
+			while (depth > 0) {
+				auto [parent, index] = path[depth - 1];
+				if (parent->count < kInnerSlots) {
+					insertChild(parent, index, std::move(separator), right);
+					return;
+				}
+				// 父节点也满了：中间的键上移，右半部分放进新节点
+				inner_node* sibling = newInner();
+				constexpr std::size_t mid = kInnerSlots / 2;
+				auto keys = parent->keys();
+				Type up(std::move(keys[mid]));
+				relocate(keys + mid + 1, kInnerSlots - mid - 1, sibling->keys());
+				std::copy_n(parent->children + mid + 1, kInnerSlots - mid, sibling->children);
+				std::destroy_at(keys + mid);
+				sibling->count = static_cast<std::uint16_t>(kInnerSlots - mid - 1);
+				parent->count = static_cast<std::uint16_t>(mid);
+				if (index <= mid) {
+					insertChild(parent, index, std::move(separator), right);
+				} else {
+					insertChild(sibling, index - mid - 1, std::move(separator), right);
+				}
+				left = parent;
+				right = sibling;
+				separator = std::move(up);
+				--depth;
+			}
+			// 根分裂，树长高一层
+			inner_node* root = newInner();
+			::new (static_cast<void*>(root->keys())) Type(std::move(separator));
+			root->children[0] = left;
+			root->children[1] = right;
+			root->count = 1;
+			_root = root;
+			++_height;
+		}
+
+		// children[index]分裂出right，在其后插入
+		static void insertChild(inner_node* node, std::size_t index, Type&& separator, node_base* right) {
+			insertShift(node->keys(), node->count, index, std::move(separator));
+			std::copy_backward(node->children + index + 1, node->children + node->count + 1, node->children + node->count + 2);
+			node->children[index + 1] = right;
+			++node->count;
+		}
+
+		// 删除父节点中的keys[index]和children[index + 1]
+		static void removeChild(inner_node* node, std::size_t index) {
+			eraseShift(node->keys(), node->count, index);
+			std::copy(node->children + index + 2, node->children + node->count + 1, node->children + index + 1);
+			--node->count;
+		}
+
+		void eraseAt(leaf_node* leaf, std::size_t pos, path_entry* path) {
+			destroyShift(leaf, pos);
+			--_size;
+			if (_height == 0) {
+				if (leaf->count == 0) {
+					freeLeaf(leaf);
+					_root = nullptr;
+					_head = _tail = nullptr;
+				}
+				return;
+			}
+			// 删掉的键可能仍作为分隔键留在内部节点里，它依然是合法的上下界，不必更新
+			if (leaf->count >= kLeafMin) {
+				return;
+			}
+			auto [parent, index] = path[_height - 1];
+			if (index > 0) {
+				leaf_node* left = asLeaf(parent->children[index - 1]);
+				if (left->count > kLeafMin) {
+					// 从左兄弟借最后一个
+					insertShift(leaf->keys(), leaf->count, 0, std::move(left->keys()[left->count - 1]));
+					++leaf->count;
+					std::destroy_at(left->keys() + --left->count);
+					parent->keys()[index - 1] = leaf->keys()[0];
+					return;
+				}
+				mergeLeaves(left, leaf);
+				removeChild(parent, index - 1);
+			} else {
+				leaf_node* right = asLeaf(parent->children[1]);
+				if (right->count > kLeafMin) {
+					// 从右兄弟借第一个
+					::new (static_cast<void*>(leaf->keys() + leaf->count)) Type(std::move(right->keys()[0]));
+					++leaf->count;
+					destroyShift(right, 0);
+					parent->keys()[0] = right->keys()[0];
+					return;
+				}
+				mergeLeaves(leaf, right);
+				removeChild(parent, 0);
+			}
+			rebalanceInner(path, _height - 1);
+		}
+
+		// right整体并入left并释放
+		void mergeLeaves(leaf_node* left, leaf_node* right) {
+			relocate(right->keys(), right->count, left->keys() + left->count);
+			left->count = static_cast<std::uint16_t>(left->count + right->count);
+			right->count = 0;
+			left->next = right->next;
+			(right->next ? right->next->prev : _tail) = left;
+			freeLeaf(right);
+		}
+
+		// path[depth]处的内部节点刚失去一个孩子，必要时向兄弟借或与兄弟合并，并继续向上检查
+		void rebalanceInner(path_entry* path, std::size_t depth) {
+			while (true) {
+				inner_node* node = path[depth].node;
+				if (depth == 0) {
+					// 根只剩一个孩子时树降低一层
+					if (node->count == 0) {
+						_root = node->children[0];
+						freeInner(node);
+						--_height;
+					}
+					return;
+				}
+				if (node->count >= kInnerMin) {
+					return;
+				}
+				auto [parent, index] = path[depth - 1];
+				auto parentKeys = parent->keys();
+				if (index > 0) {
+					inner_node* left = asInner(parent->children[index - 1]);
+					if (left->count > kInnerMin) {
+						// 父节点的分隔键下移到node开头，左兄弟的最后一个键上移
+						insertShift(node->keys(), node->count, 0, std::move(parentKeys[index - 1]));
+						std::copy_backward(node->children, node->children + node->count + 1, node->children + node->count + 2);
+						node->children[0] = left->children[left->count];
+						++node->count;
+						parentKeys[index - 1] = std::move(left->keys()[left->count - 1]);
+						std::destroy_at(left->keys() + --left->count);
+						return;
+					}
+					mergeInner(left, std::move(parentKeys[index - 1]), node);
+					removeChild(parent, index - 1);
+				} else {
+					inner_node* right = asInner(parent->children[1]);
+					if (right->count > kInnerMin) {
+						::new (static_cast<void*>(node->keys() + node->count)) Type(std::move(parentKeys[0]));
+						node->children[node->count + 1] = right->children[0];
+						++node->count;
+						parentKeys[0] = std::move(right->keys()[0]);
+						eraseShift(right->keys(), right->count, 0);
+						std::copy(right->children + 1, right->children + right->count + 1, right->children);
+						--right->count;
+						return;
+					}
+					mergeInner(node, std::move(parentKeys[0]), right);
+					removeChild(parent, 0);
+				}
+				--depth;
+			}
+		}
+
+		// 父节点的分隔键下移，right整体并入left并释放
+		void mergeInner(inner_node* left, Type&& separator, inner_node* right) {
+			auto keys = left->keys();
+			::new (static_cast<void*>(keys + left->count)) Type(std::move(separator));
+			relocate(right->keys(), right->count, keys + left->count + 1);
+			std::copy_n(right->children, right->count + 1, left->children + left->count + 1);
+			left->count = static_cast<std::uint16_t>(left->count + 1 + right->count);
+			right->count = 0;
+			freeInner(right);
+		}
+
+		/**
+		 * @brief: 从严格升序的输入自底向上建树，调用前集合必须为空
+		 * 每层的元素均匀分到最少数量的节点里，保证非根节点都不低于最小填充
+		 */
+		template <typename Iterator>
+		void bulkLoad(Iterator first, Iterator last) {
+			std::vector<Type> buffer;
+			if constexpr (!std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>) {
+				buffer.assign(first, last);
+				bulkLoad(std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
+				return;
+			} else {
+				const auto n = static_cast<std::size_t>(std::distance(first, last));
+				if (n == 0) {
+					return;
+				}
+				// 每个节点记下它子树中最小的键，作为上一层的分隔键
+				std::vector<std::pair<node_base*, const Type*>> level;
+				std::vector<inner_node*> inners;
+				try {
+					const std::size_t leaves = (n + kLeafSlots - 1) / kLeafSlots;
+					level.reserve(leaves);
+					leaf_node* prev = nullptr;
+					for (std::size_t i = 0; i < leaves; ++i) {
+						const std::size_t take = n / leaves + (i < n % leaves ? 1 : 0);
+						leaf_node* leaf = newLeaf();
+						leaf->prev = prev;
+						(prev ? prev->next : _head) = leaf;
+						prev = _tail = leaf;
+						_root = leaf;
+						for (std::size_t j = 0; j < take; ++j, ++first) {
+							::new (static_cast<void*>(leaf->keys() + j)) Type(*first);
+							++leaf->count;
+							++_size;
+						}
+						level.emplace_back(leaf, leaf->keys());
+					}
+					while (level.size() > 1) {
+						const std::size_t nodes = (level.size() + kInnerSlots) / (kInnerSlots + 1);
+						std::vector<std::pair<node_base*, const Type*>> upper;
+						upper.reserve(nodes);
+						std::size_t next = 0;
+						for (std::size_t i = 0; i < nodes; ++i) {
+							const std::size_t take = level.size() / nodes + (i < level.size() % nodes ? 1 : 0);
+							inners.push_back(nullptr);
+							inner_node* inner = newInner();
+							inners.back() = inner;
+							inner->children[0] = level[next].first;
+							for (std::size_t j = 1; j < take; ++j) {
+								::new (static_cast<void*>(inner->keys() + j - 1)) Type(*level[next + j].second);
+								inner->children[j] = level[next + j].first;
+								++inner->count;
+							}
+							upper.emplace_back(inner, level[next].second);
+							next += take;
+						}
+						level = std::move(upper);
+						_root = level.front().first;
+						++_height;
+					}
+				} catch (...) {
+					// 叶子都挂在链表上，内部节点都记在inners里，逐个释放即可
+					for (auto inner : inners) {
+						if (inner) {
+							freeInner(inner);
+						}
+					}
+					for (leaf_node* leaf = _head; leaf;) {
+						leaf_node* next = leaf->next;
+						freeLeaf(leaf);
+						leaf = next;
+					}
+					_root = nullptr;
+					_head = _tail = nullptr;
+					_height = 0;
+					_size = 0;
+					throw;
+				}
+			}
+		}
+
+		node_base* _root = nullptr;
+		leaf_node* _head = nullptr;
+		leaf_node* _tail = nullptr;
+		std::size_t _height = 0; // 根到叶子的内部节点层数，0表示根就是叶子
+		std::size_t _size = 0;
+		PLIB_NO_UNIQUE_ADDRESS Compare _comp;
+		PLIB_NO_UNIQUE_ADDRESS leaf_allocator _leafAlloc;
+		PLIB_NO_UNIQUE_ADDRESS inner_allocator _innerAlloc;
 	};
-	friend class const_iterator;
-
-	// STL style
-	inline iterator begin() { return iterator(impl_.begin()); }
-	inline const_iterator begin() const { return const_iterator(impl_.cbegin()); }
-	inline const_iterator constBegin() const { return const_iterator(impl_.cbegin()); }
-	inline const_iterator cbegin() const { return const_iterator(impl_.cbegin()); }
-	inline iterator end() { detach(); return iterator(impl_.end()); }
-	inline const_iterator end() const { return const_iterator(impl_.cend()); }
-	inline const_iterator constEnd() const { return const_iterator(impl_.cend()); }
-	inline const_iterator cend() const { return const_iterator(impl_.cend()); }
-	inline iterator erase(iterator it) { return iterator(impl_.erase(it.impl_)); }
-
-	inline iterator insert(const T& value) { return iterator(impl_.insert(value, NullType())); }
-	inline iterator insert(const_iterator pos, const T& value) { return iterator(impl_.insert(pos.impl_, value, NullType())); }
-	inline int remove(const T& value) { return impl_.remove(value); }
-	inline bool contains(const T& value) const { return impl_.contains(value); }
-
-	// more Qt
-	typedef iterator Iterator;
-	typedef const_iterator ConstIterator;
-	inline int count() const { return impl_.count(); }
-	inline iterator find(const T& value) { return iterator(impl_.find(value)); }
-	inline const_iterator find(const T& value) const { return const_iterator(impl_.constFind(value)); }
-	inline const_iterator constFind(const T& value) const { return const_iterator(impl_.constFind(value)); }
-	inline Self& unite(const Self& other) { impl_.unite(other.impl_); return *this; }
-
-	// STL compatibility
-	typedef typename Impl::difference_type difference_type;
-	typedef typename Impl::size_type size_type;
-	inline bool empty() const { return impl_.empty(); }
-
-};
+
+	namespace pmr {
+		template <typename Type, typename Compare = std::less<>>
+		using OrderedSet = type::OrderedSet<Type, Compare, std::pmr::polymorphic_allocator<Type>>;
+	} // namespace pmr
+
 } // namespace plib::core::type
-#endif // PLIB_CORE_TYPE_ORDERED_SET_HPP
\ No newline at end of file
+#endif // PLIB_CORE_TYPE_ORDERED_SET_HPP
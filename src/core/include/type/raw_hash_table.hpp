@@ -0,0 +1,928 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-21 16:40:18
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-21 16:40:18
+ * @FilePath: \plib\src\core\include\type\raw_hash_table.hpp
+ * @Description: 开放寻址哈希表的公共实现(Swiss table)：每16个槽位一组控制字节，SSE2/NEON一次比较整组
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_TYPE_RAW_HASH_TABLE_HPP_
+#define PLIB_CORE_TYPE_RAW_HASH_TABLE_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "plib_macros.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PLIB_SWISS_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define PLIB_SWISS_NEON 1
+#endif
+
+namespace plib::core::type {
+
+	/**
+	 * @brief: 支持异构查找的字符串哈希，配合std::equal_to<>使用，
+	 * 例如 flat_hash_map<std::string, int, string_hash, std::equal_to<>> 可以直接用string_view/const char*查找
+	 */
+	struct string_hash {
+		using is_transparent = void;
+
+		std::size_t operator()(std::string_view value) const noexcept {
+			return std::hash<std::string_view>()(value);
+		}
+		std::size_t operator()(const std::string& value) const noexcept {
+			return std::hash<std::string_view>()(value);
+		}
+		std::size_t operator()(const char* value) const noexcept {
+			return std::hash<std::string_view>()(value);
+		}
+	};
+
+	namespace detail::swiss {
+
+		// 控制字节：最高位为1表示空或已删除，否则低7位是哈希值的H2
+		using ctrl_t = std::int8_t;
+		inline constexpr ctrl_t kEmpty = -128;
+		inline constexpr ctrl_t kDeleted = -2;
+		inline constexpr std::size_t kGroupWidth = 16;
+
+		// 7/8的最大负载
+		inline constexpr std::size_t max_growth(std::size_t capacity) noexcept {
+			return capacity - capacity / 8;
+		}
+
+		// 容纳size个元素所需的容量，2的幂且不小于一组
+		inline std::size_t capacity_for(std::size_t size) noexcept {
+			if (size == 0) {
+				return 0;
+			}
+			const std::size_t want = size + (size + 6) / 7;
+			return std::max(kGroupWidth, std::bit_ceil(want));
+		}
+
+		/**
+		 * @brief: 标准库的std::hash对整数是恒等映射，低位分布很差，统一再混合一次
+		 */
+		inline std::size_t mix(std::size_t hash) noexcept {
+			std::uint64_t h = static_cast<std::uint64_t>(hash);
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdULL;
+			h ^= h >> 33;
+			return static_cast<std::size_t>(h);
+		}
+		inline std::size_t h1(std::size_t hash) noexcept {
+			return hash >> 7;
+		}
+		inline ctrl_t h2(std::size_t hash) noexcept {
+			return static_cast<ctrl_t>(hash & 0x7f);
+		}
+
+		/**
+		 * @brief: 组内匹配结果，每个命中的槽位对应若干位，Shift把位序号换算成槽位序号
+		 */
+		template <typename Mask, int Shift>
+		class bit_mask {
+		public:
+			explicit bit_mask(Mask mask) noexcept
+				: _mask(mask) {
+			}
+
+			explicit operator bool() const noexcept {
+				return _mask != 0;
+			}
+			std::size_t lowest() const noexcept {
+				return static_cast<std::size_t>(std::countr_zero(_mask)) >> Shift;
+			}
+
+			bit_mask& operator++() noexcept {
+				_mask &= _mask - 1;
+				return *this;
+			}
+			std::size_t operator*() const noexcept {
+				return lowest();
+			}
+			bit_mask begin() const noexcept {
+				return *this;
+			}
+			bit_mask end() const noexcept {
+				return bit_mask(0);
+			}
+			friend bool operator==(const bit_mask& a, const bit_mask& b) noexcept {
+				return a._mask == b._mask;
+			}
+
+		private:
+			Mask _mask;
+
+		};
+
+#if defined(PLIB_SWISS_SSE2)
+		// 一条比较指令匹配16个控制字节
+		class group {
+		public:
+			using mask = bit_mask<std::uint32_t, 0>;
+
+			explicit group(const ctrl_t* ctrl) noexcept
+				: _ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl))) {
+			}
+
+			mask match(ctrl_t hash) const noexcept {
+				return mask(static_cast<std::uint32_t>(
+					_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(hash), _ctrl))));
+			}
+			mask match_empty() const noexcept {
+				return match(kEmpty);
+			}
+			// 空和已删除的最高位都是1
+			mask match_empty_or_deleted() const noexcept {
+				return mask(static_cast<std::uint32_t>(_mm_movemask_epi8(_ctrl)));
+			}
+
+		private:
+			__m128i _ctrl;
+
+		};
+#elif defined(PLIB_SWISS_NEON)
+		// NEON没有movemask，比较结果按16位右移窄化成64位，每个槽位占4位，只保留其中一位
+		class group {
+		public:
+			using mask = bit_mask<std::uint64_t, 2>;
+
+			explicit group(const ctrl_t* ctrl) noexcept
+				: _ctrl(vld1q_s8(ctrl)) {
+			}
+
+			mask match(ctrl_t hash) const noexcept {
+				return to_mask(vceqq_s8(vdupq_n_s8(hash), _ctrl));
+			}
+			mask match_empty() const noexcept {
+				return match(kEmpty);
+			}
+			mask match_empty_or_deleted() const noexcept {
+				return to_mask(vcltq_s8(_ctrl, vdupq_n_s8(0)));
+			}
+
+		private:
+			static mask to_mask(uint8x16_t cmp) noexcept {
+				const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+				return mask(vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ULL);
+			}
+
+			int8x16_t _ctrl;
+
+		};
+#else
+		// 没有SIMD时逐字节比较，语义与上面一致
+		class group {
+		public:
+			using mask = bit_mask<std::uint32_t, 0>;
+
+			explicit group(const ctrl_t* ctrl) noexcept {
+				std::memcpy(_ctrl, ctrl, kGroupWidth);
+			}
+
+			mask match(ctrl_t hash) const noexcept {
+				std::uint32_t result = 0;
+				for (std::size_t i = 0; i != kGroupWidth; ++i) {
+					result |= static_cast<std::uint32_t>(_ctrl[i] == hash) << i;
+				}
+				return mask(result);
+			}
+			mask match_empty() const noexcept {
+				return match(kEmpty);
+			}
+			mask match_empty_or_deleted() const noexcept {
+				std::uint32_t result = 0;
+				for (std::size_t i = 0; i != kGroupWidth; ++i) {
+					result |= static_cast<std::uint32_t>(_ctrl[i] < 0) << i;
+				}
+				return mask(result);
+			}
+
+		private:
+			ctrl_t _ctrl[kGroupWidth];
+
+		};
+#endif
+
+		// 哈希和比较器都声明了is_transparent时，查找接口接受任意可比较的键类型
+		template <typename Hash, typename Eq>
+		inline constexpr bool is_transparent_v =
+			requires { typename Hash::is_transparent; typename Eq::is_transparent; };
+
+		template <bool Transparent>
+		struct key_arg {
+			template <typename K, typename Key>
+			using type = Key;
+		};
+		template <>
+		struct key_arg<true> {
+			template <typename K, typename Key>
+			using type = K;
+		};
+
+		/**
+		 * @brief: 从元素取键，集合的元素就是键，映射的元素是pair<const Key, T>
+		 * 按Key与Value是否相同区分，而不是看元素有没有first，集合的元素本身也可能是pair
+		 */
+		template <typename Key, typename Value>
+		struct policy_key {
+			static constexpr bool is_map = !std::is_same_v<Key, Value>;
+
+			static const Key& key(const Value& value) noexcept {
+				if constexpr (is_map) {
+					return value.first;
+				} else {
+					return value;
+				}
+			}
+		};
+
+		/**
+		 * @brief: 槽位里直接存放元素，rehash时元素会移动
+		 */
+		template <typename Key, typename Value>
+		struct flat_policy : policy_key<Key, Value> {
+			using key_type = Key;
+			using value_type = Value;
+			using slot_type = Value;
+
+			static Value& element(slot_type* slot) noexcept {
+				return *slot;
+			}
+			template <typename Alloc, typename... Args>
+			static void construct(Alloc& alloc, slot_type* slot, Args&&... args) {
+				std::allocator_traits<Alloc>::construct(alloc, slot, std::forward<Args>(args)...);
+			}
+			template <typename Alloc>
+			static void destroy(Alloc& alloc, slot_type* slot) noexcept {
+				std::allocator_traits<Alloc>::destroy(alloc, slot);
+			}
+			// 与flat_multi_map_pair_type一样，const键在搬家时也是移动而不是拷贝
+			template <typename Alloc>
+			static void transfer(Alloc& alloc, slot_type* to, slot_type* from) {
+				if constexpr (policy_key<Key, Value>::is_map) {
+					std::allocator_traits<Alloc>::construct(
+						alloc,
+						to,
+						std::move(const_cast<std::remove_const_t<decltype(from->first)>&>(from->first)),
+						std::move(from->second));
+				} else {
+					std::allocator_traits<Alloc>::construct(alloc, to, std::move(*from));
+				}
+				destroy(alloc, from);
+			}
+		};
+
+		/**
+		 * @brief: 元素单独分配，槽位只存指针，rehash不移动元素，引用和指针一直有效
+		 */
+		template <typename Key, typename Value>
+		struct node_policy : policy_key<Key, Value> {
+			using key_type = Key;
+			using value_type = Value;
+			using slot_type = Value*;
+
+			static Value& element(slot_type* slot) noexcept {
+				return **slot;
+			}
+			template <typename Alloc, typename... Args>
+			static void construct(Alloc& alloc, slot_type* slot, Args&&... args) {
+				Value* node = std::allocator_traits<Alloc>::allocate(alloc, 1);
+				try {
+					std::allocator_traits<Alloc>::construct(alloc, node, std::forward<Args>(args)...);
+				} catch (...) {
+					std::allocator_traits<Alloc>::deallocate(alloc, node, 1);
+					throw;
+				}
+				::new (static_cast<void*>(slot)) slot_type(node);
+			}
+			template <typename Alloc>
+			static void destroy(Alloc& alloc, slot_type* slot) noexcept {
+				std::allocator_traits<Alloc>::destroy(alloc, *slot);
+				std::allocator_traits<Alloc>::deallocate(alloc, *slot, 1);
+			}
+			template <typename Alloc>
+			static void transfer(Alloc&, slot_type* to, slot_type* from) noexcept {
+				::new (static_cast<void*>(to)) slot_type(*from);
+			}
+		};
+
+		/**
+		 * @brief: 集合与映射共用的开放寻址表
+		 * 内存是一整块：capacity个控制字节在前，槽位在后；容量是2的幂，按16个槽位分组，
+		 * 探测时以组为单位做三角数跳跃，组内用一条SIMD比较找出H2相同的候选槽位，
+		 * 遇到含空槽位的组即可确定键不存在。负载上限7/8，删除时组里还有空位就直接置空，否则留下墓碑
+		 */
+		template <typename Policy, typename Hash, typename Eq, typename Allocator>
+		class raw_hash_table {
+		protected:
+			using slot_type = typename Policy::slot_type;
+			using alloc_traits = std::allocator_traits<Allocator>;
+
+			template <typename K>
+			using key_arg = typename swiss::key_arg<is_transparent_v<Hash, Eq>>::template type<K, typename Policy::key_type>;
+
+			// 控制字节和槽位共用一次分配，按组宽和槽位对齐中较大者对齐
+			struct alignas(std::max(kGroupWidth, alignof(slot_type))) chunk {
+				unsigned char bytes[std::max(kGroupWidth, alignof(slot_type))];
+			};
+			using chunk_allocator = typename alloc_traits::template rebind_alloc<chunk>;
+
+		public:
+			using key_type = typename Policy::key_type;
+			using value_type = typename Policy::value_type;
+			using size_type = std::size_t;
+			using difference_type = std::ptrdiff_t;
+			using hasher = Hash;
+			using key_equal = Eq;
+			using allocator_type = Allocator;
+			using reference = value_type&;
+			using const_reference = const value_type&;
+
+			template <bool Const>
+			class basic_iterator {
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = typename Policy::value_type;
+				using difference_type = std::ptrdiff_t;
+				using reference = std::conditional_t<Const, const value_type&, value_type&>;
+				using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+				basic_iterator() = default;
+				// iterator可以隐式转换成const_iterator
+				template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+				basic_iterator(const basic_iterator<OtherConst>& other) noexcept
+					: _ctrl(other._ctrl)
+					, _slot(other._slot)
+					, _end(other._end) {
+				}
+
+				reference operator*() const noexcept {
+					return Policy::element(_slot);
+				}
+				pointer operator->() const noexcept {
+					return &Policy::element(_slot);
+				}
+				basic_iterator& operator++() noexcept {
+					++_ctrl;
+					++_slot;
+					skip_empty();
+					return *this;
+				}
+				basic_iterator operator++(int) noexcept {
+					auto result = *this;
+					++*this;
+					return result;
+				}
+				friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept {
+					return a._ctrl == b._ctrl;
+				}
+
+			private:
+				friend class raw_hash_table;
+				template <bool>
+				friend class basic_iterator;
+
+				basic_iterator(ctrl_t* ctrl, slot_type* slot, ctrl_t* end) noexcept
+					: _ctrl(ctrl)
+					, _slot(slot)
+					, _end(end) {
+				}
+
+				void skip_empty() noexcept {
+					while (_ctrl != _end && *_ctrl < 0) {
+						++_ctrl;
+						++_slot;
+					}
+				}
+
+				ctrl_t* _ctrl = nullptr;
+				slot_type* _slot = nullptr;
+				ctrl_t* _end = nullptr;
+
+			};
+			using iterator = basic_iterator<false>;
+			using const_iterator = basic_iterator<true>;
+
+			raw_hash_table() = default;
+
+			explicit raw_hash_table(
+				size_type bucket_count,
+				const Hash& hash = Hash(),
+				const Eq& eq = Eq(),
+				const Allocator& alloc = Allocator())
+				: _hash(hash)
+				, _eq(eq)
+				, _alloc(alloc) {
+				reserve(bucket_count);
+			}
+
+			explicit raw_hash_table(const Allocator& alloc)
+				: _alloc(alloc) {
+			}
+
+			template <
+				typename Iterator,
+				typename = typename std::iterator_traits<Iterator>::iterator_category>
+			raw_hash_table(
+				Iterator first,
+				Iterator last,
+				size_type bucket_count = 0,
+				const Hash& hash = Hash(),
+				const Eq& eq = Eq(),
+				const Allocator& alloc = Allocator())
+				: raw_hash_table(bucket_count, hash, eq, alloc) {
+				insert(first, last);
+			}
+
+			raw_hash_table(
+				std::initializer_list<value_type> list,
+				size_type bucket_count = 0,
+				const Hash& hash = Hash(),
+				const Eq& eq = Eq(),
+				const Allocator& alloc = Allocator())
+				: raw_hash_table(list.begin(), list.end(), bucket_count, hash, eq, alloc) {
+			}
+
+			raw_hash_table(const raw_hash_table& other)
+				: raw_hash_table(other, alloc_traits::select_on_container_copy_construction(other._alloc)) {
+			}
+
+			raw_hash_table(const raw_hash_table& other, const Allocator& alloc)
+				: _hash(other._hash)
+				, _eq(other._eq)
+				, _alloc(alloc) {
+				reserve(other.size());
+				for (const auto& value : other) {
+					emplace_unique_at(find_insert_slot(hash_of(key_of(value))), value);
+				}
+			}
+
+			raw_hash_table(raw_hash_table&& other) noexcept
+				: _ctrl(std::exchange(other._ctrl, nullptr))
+				, _slots(std::exchange(other._slots, nullptr))
+				, _capacity(std::exchange(other._capacity, 0))
+				, _size(std::exchange(other._size, 0))
+				, _growth_left(std::exchange(other._growth_left, 0))
+				, _hash(std::move(other._hash))
+				, _eq(std::move(other._eq))
+				, _alloc(std::move(other._alloc)) {
+			}
+
+			raw_hash_table& operator=(const raw_hash_table& other) {
+				if (this != &other) {
+					if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+						destroy_all();
+						_alloc = other._alloc;
+					} else {
+						clear();
+					}
+					_hash = other._hash;
+					_eq = other._eq;
+					reserve(other.size());
+					for (const auto& value : other) {
+						emplace_unique_at(find_insert_slot(hash_of(key_of(value))), value);
+					}
+				}
+				return *this;
+			}
+
+			raw_hash_table& operator=(raw_hash_table&& other) noexcept(
+				alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
+				if (this == &other) {
+					return *this;
+				}
+				if constexpr (alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
+					steal(other);
+				} else if (_alloc == other._alloc) {
+					steal(other);
+				} else {
+					// 分配器不同(例如两个不同的memory_resource)时只能逐个移动元素
+					clear();
+					_hash = other._hash;
+					_eq = other._eq;
+					reserve(other.size());
+					for (auto& value : other) {
+						emplace_unique_at(find_insert_slot(hash_of(key_of(value))), std::move(value));
+					}
+					other.clear();
+				}
+				return *this;
+			}
+
+			~raw_hash_table() {
+				destroy_all();
+			}
+
+			allocator_type get_allocator() const {
+				return _alloc;
+			}
+			hasher hash_function() const {
+				return _hash;
+			}
+			key_equal key_eq() const {
+				return _eq;
+			}
+
+			iterator begin() noexcept {
+				auto it = iterator_at(0);
+				it.skip_empty();
+				return it;
+			}
+			iterator end() noexcept {
+				return iterator_at(_capacity);
+			}
+			const_iterator begin() const noexcept {
+				return const_cast<raw_hash_table*>(this)->begin();
+			}
+			const_iterator end() const noexcept {
+				return const_cast<raw_hash_table*>(this)->end();
+			}
+			const_iterator cbegin() const noexcept {
+				return begin();
+			}
+			const_iterator cend() const noexcept {
+				return end();
+			}
+
+			size_type size() const noexcept {
+				return _size;
+			}
+			bool empty() const noexcept {
+				return _size == 0;
+			}
+			size_type capacity() const noexcept {
+				return _capacity;
+			}
+			float load_factor() const noexcept {
+				return _capacity != 0 ? static_cast<float>(_size) / static_cast<float>(_capacity) : 0.0f;
+			}
+			float max_load_factor() const noexcept {
+				return 0.875f;
+			}
+
+			void clear() noexcept {
+				if (_capacity == 0) {
+					return;
+				}
+				for (size_type i = 0; i != _capacity; ++i) {
+					if (_ctrl[i] >= 0) {
+						Policy::destroy(_alloc, _slots + i);
+					}
+				}
+				std::memset(_ctrl, static_cast<unsigned char>(kEmpty), _capacity);
+				_size = 0;
+				_growth_left = max_growth(_capacity);
+			}
+
+			// 预留至少count个元素的空间，之后插入不会再rehash
+			void reserve(size_type count) {
+				if (count > _size + _growth_left) {
+					resize(capacity_for(count));
+				}
+			}
+			// 按元素个数重新分配并清理墓碑，count为0时收缩到刚好放下现有元素
+			void rehash(size_type count) {
+				const auto target = capacity_for(std::max(count, _size));
+				if (target != _capacity || _growth_left != max_growth(_capacity) - _size) {
+					resize(target);
+				}
+			}
+
+			std::pair<iterator, bool> insert(const value_type& value) {
+				return emplace_key(key_of(value), value);
+			}
+			std::pair<iterator, bool> insert(value_type&& value) {
+				return emplace_key(key_of(value), std::move(value));
+			}
+			template <
+				typename Iterator,
+				typename = typename std::iterator_traits<Iterator>::iterator_category>
+			void insert(Iterator first, Iterator last) {
+				using category = typename std::iterator_traits<Iterator>::iterator_category;
+				if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+					reserve(_size + static_cast<size_type>(std::distance(first, last)));
+				}
+				for (; first != last; ++first) {
+					emplace(*first);
+				}
+			}
+			void insert(std::initializer_list<value_type> list) {
+				insert(list.begin(), list.end());
+			}
+
+			// 参数就是一个元素时直接按它的键查找，否则先构造出元素再取键
+			template <typename... Args>
+			std::pair<iterator, bool> emplace(Args&&... args) {
+				if constexpr (sizeof...(Args) == 1
+					&& (std::is_same_v<std::remove_cvref_t<Args>, value_type> && ...)) {
+					return emplace_key(key_of(args...), std::forward<Args>(args)...);
+				} else {
+					value_type value(std::forward<Args>(args)...);
+					return emplace_key(key_of(value), std::move(value));
+				}
+			}
+
+			template <typename K = key_type>
+			iterator find(const key_arg<K>& key) {
+				const auto index = find_index(key, hash_of(key));
+				return index != _capacity ? iterator_at(index) : end();
+			}
+			template <typename K = key_type>
+			const_iterator find(const key_arg<K>& key) const {
+				return const_cast<raw_hash_table*>(this)->find(key);
+			}
+			template <typename K = key_type>
+			bool contains(const key_arg<K>& key) const {
+				return find_index(key, hash_of(key)) != _capacity;
+			}
+			template <typename K = key_type>
+			size_type count(const key_arg<K>& key) const {
+				return contains(key) ? 1 : 0;
+			}
+
+			template <typename K = key_type>
+			size_type erase(const key_arg<K>& key) {
+				const auto index = find_index(key, hash_of(key));
+				if (index == _capacity) {
+					return 0;
+				}
+				erase_at(index);
+				return 1;
+			}
+			iterator erase(const_iterator where) {
+				const auto index = static_cast<size_type>(where._ctrl - _ctrl);
+				erase_at(index);
+				auto it = iterator_at(index);
+				it.skip_empty();
+				return it;
+			}
+			iterator erase(iterator where) {
+				return erase(const_iterator(where));
+			}
+
+			void swap(raw_hash_table& other) noexcept {
+				using std::swap;
+				swap(_ctrl, other._ctrl);
+				swap(_slots, other._slots);
+				swap(_capacity, other._capacity);
+				swap(_size, other._size);
+				swap(_growth_left, other._growth_left);
+				swap(_hash, other._hash);
+				swap(_eq, other._eq);
+				if constexpr (alloc_traits::propagate_on_container_swap::value) {
+					swap(_alloc, other._alloc);
+				}
+			}
+			friend void swap(raw_hash_table& a, raw_hash_table& b) noexcept {
+				a.swap(b);
+			}
+
+			// 元素个数相同且每个元素都能在对方找到相等的，与顺序无关
+			friend bool operator==(const raw_hash_table& a, const raw_hash_table& b) {
+				if (a.size() != b.size()) {
+					return false;
+				}
+				for (const auto& value : a) {
+					const auto& key = key_of(value);
+					const auto index = b.find_index(key, b.hash_of(key));
+					if (index == b._capacity || !(Policy::element(b._slots + index) == value)) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+		protected:
+			template <typename K>
+			size_type hash_of(const K& key) const {
+				return mix(_hash(key));
+			}
+
+			static const key_type& key_of(const value_type& value) noexcept {
+				return Policy::key(value);
+			}
+
+			iterator iterator_at(size_type index) noexcept {
+				return iterator(_ctrl + index, _slots + index, _ctrl + _capacity);
+			}
+
+			/**
+			 * @brief: 返回键所在的槽位，不存在时返回capacity
+			 */
+			template <typename K>
+			size_type find_index(const K& key, size_type hash) const {
+				if (_capacity == 0) {
+					return _capacity;
+				}
+				const size_type groups_mask = _capacity / kGroupWidth - 1;
+				const ctrl_t tag = h2(hash);
+				size_type g = h1(hash) & groups_mask;
+				for (size_type step = 1;; ++step) {
+					const ctrl_t* ctrl = _ctrl + g * kGroupWidth;
+					const group candidates(ctrl);
+					for (auto i : candidates.match(tag)) {
+						const size_type index = g * kGroupWidth + i;
+						if (_eq(key_of(Policy::element(_slots + index)), key)) {
+							return index;
+						}
+					}
+					if (candidates.match_empty() || step > groups_mask) {
+						return _capacity;
+					}
+					// 三角数步长，2的幂个组时能走遍所有组
+					g = (g + step) & groups_mask;
+				}
+			}
+
+			// 沿同一探测序列找第一个空或已删除的槽位，调用前保证至少有一个
+			size_type find_insert_slot(size_type hash) const noexcept {
+				const size_type groups_mask = _capacity / kGroupWidth - 1;
+				size_type g = h1(hash) & groups_mask;
+				for (size_type step = 1;; ++step) {
+					const auto free = group(_ctrl + g * kGroupWidth).match_empty_or_deleted();
+					if (free) {
+						return g * kGroupWidth + free.lowest();
+					}
+					g = (g + step) & groups_mask;
+				}
+			}
+
+			/**
+			 * @brief: 键不存在时占下一个槽位(只写控制字节)，second为true时调用者负责构造元素
+			 */
+			template <typename K>
+			std::pair<size_type, bool> find_or_prepare_insert(const K& key) {
+				const auto hash = hash_of(key);
+				const auto found = find_index(key, hash);
+				if (found != _capacity) {
+					return { found, false };
+				}
+				if (_growth_left == 0) {
+					grow();
+				}
+				const auto index = find_insert_slot(hash);
+				if (_ctrl[index] == kEmpty) {
+					--_growth_left;
+				}
+				_ctrl[index] = h2(hash);
+				++_size;
+				return { index, true };
+			}
+
+			template <typename K, typename... Args>
+			std::pair<iterator, bool> emplace_key(const K& key, Args&&... args) {
+				const auto [index, inserted] = find_or_prepare_insert(key);
+				if (inserted) {
+					try {
+						Policy::construct(_alloc, _slots + index, std::forward<Args>(args)...);
+					} catch (...) {
+						erase_meta(index);
+						throw;
+					}
+				}
+				return { iterator_at(index), inserted };
+			}
+
+			// 已知键不存在且有空位(拷贝/rehash时)，直接构造
+			template <typename... Args>
+			void emplace_unique_at(size_type index, Args&&... args) {
+				Policy::construct(_alloc, _slots + index, std::forward<Args>(args)...);
+				if (_ctrl[index] == kEmpty) {
+					--_growth_left;
+				}
+				_ctrl[index] = h2(hash_of(key_of(Policy::element(_slots + index))));
+				++_size;
+			}
+
+			void erase_at(size_type index) noexcept {
+				Policy::destroy(_alloc, _slots + index);
+				erase_meta(index);
+			}
+
+			// 同组里还有空位说明从未有探测越过这一组，可以直接置空，否则留下墓碑
+			void erase_meta(size_type index) noexcept {
+				--_size;
+				const ctrl_t* ctrl = _ctrl + (index & ~(kGroupWidth - 1));
+				if (group(ctrl).match_empty()) {
+					_ctrl[index] = kEmpty;
+					++_growth_left;
+				} else {
+					_ctrl[index] = kDeleted;
+				}
+			}
+
+			// 墓碑占了一半以上的可用空间时原容量重建，否则容量翻倍
+			void grow() {
+				if (_capacity != 0 && _size <= max_growth(_capacity) / 2) {
+					resize(_capacity);
+				} else {
+					resize(_capacity == 0 ? kGroupWidth : _capacity * 2);
+				}
+			}
+
+			void resize(size_type new_capacity) {
+				ctrl_t* old_ctrl = _ctrl;
+				slot_type* old_slots = _slots;
+				const size_type old_capacity = _capacity;
+
+				allocate(new_capacity);
+				for (size_type i = 0; i != old_capacity; ++i) {
+					if (old_ctrl[i] >= 0) {
+						const auto hash = hash_of(key_of(Policy::element(old_slots + i)));
+						const auto index = find_insert_slot(hash);
+						_ctrl[index] = h2(hash);
+						Policy::transfer(_alloc, _slots + index, old_slots + i);
+					}
+				}
+				_growth_left = max_growth(_capacity) - _size;
+				deallocate(old_ctrl, old_capacity);
+			}
+
+			static size_type slots_offset(size_type capacity) noexcept {
+				return (capacity + alignof(slot_type) - 1) / alignof(slot_type) * alignof(slot_type);
+			}
+			static size_type chunk_count(size_type capacity) noexcept {
+				const auto bytes = slots_offset(capacity) + capacity * sizeof(slot_type);
+				return (bytes + sizeof(chunk) - 1) / sizeof(chunk);
+			}
+
+			void allocate(size_type capacity) {
+				chunk_allocator chunks(_alloc);
+				auto* memory = reinterpret_cast<unsigned char*>(
+					std::allocator_traits<chunk_allocator>::allocate(chunks, chunk_count(capacity)));
+				_ctrl = reinterpret_cast<ctrl_t*>(memory);
+				_slots = reinterpret_cast<slot_type*>(memory + slots_offset(capacity));
+				_capacity = capacity;
+				std::memset(_ctrl, static_cast<unsigned char>(kEmpty), capacity);
+				_growth_left = max_growth(capacity);
+			}
+
+			void deallocate(ctrl_t* ctrl, size_type capacity) noexcept {
+				if (ctrl == nullptr) {
+					return;
+				}
+				chunk_allocator chunks(_alloc);
+				std::allocator_traits<chunk_allocator>::deallocate(
+					chunks,
+					reinterpret_cast<chunk*>(ctrl),
+					chunk_count(capacity));
+			}
+
+			void destroy_all() noexcept {
+				clear();
+				deallocate(_ctrl, _capacity);
+				_ctrl = nullptr;
+				_slots = nullptr;
+				_capacity = 0;
+				_growth_left = 0;
+			}
+
+			void steal(raw_hash_table& other) noexcept {
+				destroy_all();
+				_ctrl = std::exchange(other._ctrl, nullptr);
+				_slots = std::exchange(other._slots, nullptr);
+				_capacity = std::exchange(other._capacity, 0);
+				_size = std::exchange(other._size, 0);
+				_growth_left = std::exchange(other._growth_left, 0);
+				_hash = std::move(other._hash);
+				_eq = std::move(other._eq);
+				if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+					_alloc = std::move(other._alloc);
+				}
+			}
+
+			ctrl_t* _ctrl = nullptr;
+			slot_type* _slots = nullptr;
+			size_type _capacity = 0;
+			size_type _size = 0;
+			size_type _growth_left = 0;
+			PLIB_NO_UNIQUE_ADDRESS Hash _hash;
+			PLIB_NO_UNIQUE_ADDRESS Eq _eq;
+			PLIB_NO_UNIQUE_ADDRESS Allocator _alloc;
+
+		};
+
+	} // namespace detail::swiss
+
+} // namespace plib::core::type
+
+#endif // PLIB_CORE_TYPE_RAW_HASH_TABLE_HPP_
@@ -1,77 +1,124 @@
 ﻿#ifndef PPCORE_LOGSTREAM_HPP
 #define PPCORE_LOGSTREAM_HPP
+#include <charconv>
+#include <cstdint>
+#include <memory_resource>
 #include <sstream>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 #include <list>
 #include <map>
 #include <unordered_map>
 #include <type_traits>
+#include "utils/small_string.hpp"
 
 namespace plib::core::type{
-        class StringStream {
+        /**
+         * @brief: 输出格式与std::stringstream的默认格式一致(浮点数6位有效数字)，
+         * 但直接写进内联容量为N的utils::small_string，不超过N个字符时格式化全程不分配堆内存
+         */
+        template <unsigned N = 256>
+        class BasicStringStream {
         public:
-            StringStream() = default;
-            inline StringStream& operator<<(char t) { _ss << t; return *this; }
-            inline StringStream& operator<<(bool t) { _ss << (t ? "true" : "false");return *this;}
-            inline StringStream& operator<<(const void* t) { _ss << t; return *this; }
-            inline StringStream& operator<<(const char* t) { _ss << t; return *this; }
-            inline StringStream& operator<<(const std::string& t) { _ss << t; return *this; }
-            inline StringStream& operator<<(const std::string_view& t) { _ss << t; return *this; }
-            inline StringStream& operator<<(const std::thread::id& t) { _ss << t; return *this; }
+            using string_type = utils::small_string<N>;
+
+            BasicStringStream() = default;
+            explicit BasicStringStream(std::pmr::memory_resource* resource) : _buf(resource) {}
+
+            inline BasicStringStream& operator<<(char t) { _buf += t; return *this; }
+            inline BasicStringStream& operator<<(bool t) { _buf += (t ? "true" : "false");return *this;}
+            inline BasicStringStream& operator<<(const void* t) {
+                if (!t) {
+                    _buf += '0';
+                    return *this;
+                }
+                char tmp[2 + sizeof(void*) * 2];
+                tmp[0] = '0';
+                tmp[1] = 'x';
+                auto res = std::to_chars(tmp + 2, tmp + sizeof(tmp), reinterpret_cast<std::uintptr_t>(t), 16);
+                _buf.append(tmp, static_cast<std::size_t>(res.ptr - tmp));
+                return *this;
+            }
+            inline BasicStringStream& operator<<(const char* t) { if (t) _buf += t; return *this; }
+            inline BasicStringStream& operator<<(const std::string& t) { _buf += t; return *this; }
+            inline BasicStringStream& operator<<(const std::string_view& t) { _buf += t; return *this; }
+            // thread::id只提供了operator<<，很少出现在热路径上
+            inline BasicStringStream& operator<<(const std::thread::id& t) { std::ostringstream ss; ss << t; _buf += ss.str(); return *this; }
+            template <unsigned M>
+            inline BasicStringStream& operator<<(const utils::small_string<M>& t) { _buf += t.view(); return *this; }
 
             template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>>>
-            StringStream& operator<<(T t) {
-                _ss << t;
+            BasicStringStream& operator<<(T t) {
+                if constexpr (std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>) {
+                    // 与ostream一样按字符输出
+                    _buf += static_cast<char>(t);
+                } else {
+                    char tmp[64];
+                    std::to_chars_result res;
+                    if constexpr (std::is_floating_point_v<T>) {
+                        res = std::to_chars(tmp, tmp + sizeof(tmp), t, std::chars_format::general, 6);
+                    } else {
+                        res = std::to_chars(tmp, tmp + sizeof(tmp), t);
+                    }
+                    _buf.append(tmp, static_cast<std::size_t>(res.ptr - tmp));
+                }
                 return *this;
             }
 
             template<typename T>
-            inline StringStream& operator<<(const std::vector<T>& t)
+            inline BasicStringStream& operator<<(const std::vector<T>& t)
             {
-                _ss << '[';
+                _buf += '[';
                 for (size_t i = 0; i < t.size(); ++i) {
                     *this << t.at(i);
                     if (i < t.size() - 1) {
-                        _ss << ',';
+                        _buf += ',';
                     }
                 }
-                _ss << ']';
+                _buf += ']';
                 return *this;
             }
 
 
             template<typename Container,
-                typename = std::enable_if_t<!std::is_same_v<StringStream&, decltype(std::declval<Container>().begin())>>,
+                typename = std::enable_if_t<!std::is_same_v<BasicStringStream&, decltype(std::declval<Container>().begin())>>,
                 typename = std::void_t<decltype(std::declval<Container>().begin(), std::declval<Container>().end())>>
-                inline StringStream& operator<<(const Container& container) {
-                _ss << '[';
+                inline BasicStringStream& operator<<(const Container& container) {
+                _buf += '[';
                 bool first = true;
                 for (const auto& elem : container) {
                     if (!first) {
-                        _ss << ',';
+                        _buf += ',';
                     }
                     *this << elem;
                     first = false;
                 }
-                _ss << ']';
+                _buf += ']';
                 return *this;
             }
 
             template<typename T1, typename T2>
-            inline StringStream& operator<<(const std::pair<T1, T2>& p) {
-                _ss << '(';
+            inline BasicStringStream& operator<<(const std::pair<T1, T2>& p) {
+                _buf += '(';
                 *this << p.first;
-                _ss << ", ";
+                _buf += ", ";
                 *this << p.second;
-                _ss << ')';
+                _buf += ')';
                 return *this;
             }
 
-            inline std::string str() const { return _ss.str(); }
+            inline std::string str() const { return _buf.str(); }
+            inline std::string_view view() const noexcept { return _buf.view(); }
+            // 取走内部缓冲，短结果不经过堆
+            inline string_type take() { return std::move(_buf); }
+            inline void clear() noexcept { _buf.clear(); }
 
         private:
-            std::stringstream _ss;
+            string_type _buf;
         };
+
+        using StringStream = BasicStringStream<>;
     } // namespace plib::core::type
 #endif
\ No newline at end of file
@@ -11,7 +11,9 @@
 #define PLIB_CORE_TYPE_TRAITS_HPP_
 #include <type_traits>
 #include <typeindex>
+#include <memory>
 #include <string>
+#include <utility>
 
 // 辅助 trait：检测是否有 key_type
 template <typename T, typename = void>
@@ -102,4 +104,60 @@ struct is_pair<T, std::void_t<
 {
 };
 
+namespace plib::core::type
+{
+    /**
+     * @brief: 可平凡重定位：把对象按字节搬到新地址、且不再析构旧地址，等价于移动构造+析构旧对象
+     * 容器扩容和中间插入/删除时可以直接memmove，不必逐个移动构造再析构
+     * 默认只认可平凡可拷贝类型；其他类型需要显式特化为true_type(对象内部不能有指向自身的指针)
+     */
+    template <typename T>
+    struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>>
+    {
+    };
+
+    template <typename T>
+    struct is_trivially_relocatable<const T> : is_trivially_relocatable<T>
+    {
+    };
+
+    template <typename T, std::size_t N>
+    struct is_trivially_relocatable<T[N]> : is_trivially_relocatable<T>
+    {
+    };
+
+    template <typename T, typename D>
+    struct is_trivially_relocatable<std::unique_ptr<T, D>> : is_trivially_relocatable<D>
+    {
+    };
+
+    template <typename T>
+    struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type
+    {
+    };
+
+    template <typename A, typename B>
+    struct is_trivially_relocatable<std::pair<A, B>>
+        : std::bool_constant<is_trivially_relocatable<A>::value && is_trivially_relocatable<B>::value>
+    {
+    };
+
+#if defined(_LIBCPP_VERSION)
+    // libc++的短字符串缓冲区用size区分，不保存指向自身的指针
+    // libstdc++的_M_p在短字符串时指向对象内部，MSVC调试迭代器有反向代理指针，都不能按字节搬
+    template <typename C, typename Tr>
+    struct is_trivially_relocatable<std::basic_string<C, Tr, std::allocator<C>>> : std::true_type
+    {
+    };
+#endif
+
+    template <typename T>
+    inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+} // namespace plib::core::type
+
 #endif // PLIB_CORE_TYPE_TRAITS_HPP_
\ No newline at end of file
@@ -68,7 +68,7 @@ bool is_hyper_threading_enabled() {
             break;
         }
     }
-    file.close();
+    cpuinfo.close();
     if(physical_cores == 0 || logical_cores == 0){
         return false;
     }
@@ -1,8 +1,18 @@
 #ifndef PLIB_CORE_UTILS_LRU_HPP
 #define PLIB_CORE_UTILS_LRU_HPP
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <list>
-#include <unordered_map>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "plib_macros.hpp"
+#include "type/flat_hash_map.hpp"
 
 namespace plib::core::utils {
 
@@ -17,7 +27,7 @@ public:
 
 private:
 	std::list<Entry> _queue;
-	std::unordered_map<Entry, typename std::list<Entry>::iterator> _map;
+	type::flat_hash_map<Entry, typename std::list<Entry>::iterator> _map;
 
 };
 
@@ -27,7 +37,7 @@ void LRU<Entry>::up(Entry entry) {
 		return;
 	}
 	const auto i = _map.find(entry);
-	if (i != end(_map)) {
+	if (i != _map.end()) {
 		_queue.splice(end(_queue), _queue, i->second);
 	} else {
 		_map.emplace(entry, _queue.insert(end(_queue), entry));
@@ -37,7 +47,7 @@ void LRU<Entry>::up(Entry entry) {
 template <typename Entry>
 void LRU<Entry>::remove(Entry entry) {
 	const auto i = _map.find(entry);
-	if (i != end(_map)) {
+	if (i != _map.end()) {
 		_queue.erase(i->second);
 		_map.erase(i);
 	}
@@ -60,6 +70,355 @@ Entry LRU<Entry>::take_lowest() {
 	return result;
 }
 
+/**
+ * @brief: 固定容量的LRU缓存，键值都存在缓存里
+ * 节点在构造时一次性分配成slab，用下标串成双向链表，空闲节点串成单链表
+ * 索引是线性探测的开放寻址表(负载不超过1/2)，槽位里带32位哈希，探测时不必访问节点；删除时后移回填，不留墓碑
+ * 构造之后get/put/erase都是O(1)，缓存自身不再分配内存
+ */
+template <
+	typename Key,
+	typename Value,
+	typename Hash = std::hash<Key>,
+	typename KeyEqual = std::equal_to<Key>>
+class LruCache {
+public:
+	using key_type = Key;
+	using mapped_type = Value;
+	using size_type = std::size_t;
+	// 容量已满时淘汰最久未使用的条目，在条目销毁之前调用，不能抛异常
+	using evict_callback = std::function<void(const Key&, Value&)>;
+
+	struct Stats {
+		std::uint64_t hits = 0;
+		std::uint64_t misses = 0;
+		std::uint64_t evictions = 0;
+	};
+
+	// 容量限制在[1, 2^31]
+	explicit LruCache(
+		size_type capacity,
+		evict_callback on_evict = {},
+		const Hash& hash = Hash(),
+		const KeyEqual& equal = KeyEqual());
+	~LruCache() {
+		destroy_all();
+	}
+
+	LruCache(const LruCache&) = delete;
+	LruCache& operator=(const LruCache&) = delete;
+
+	// 命中时提为最近使用并计入hits，未命中计入misses
+	Value* get(const Key& key);
+	// 只查看，不改变淘汰顺序也不计数
+	const Value* peek(const Key& key) const;
+	bool contains(const Key& key) const {
+		return peek(key) != nullptr;
+	}
+
+	// 插入或覆盖并提为最近使用，新插入返回true；满了先淘汰最久未使用的条目
+	template <typename K, typename V>
+	bool put(K&& key, V&& value);
+	bool erase(const Key& key);
+	void clear();
+
+	size_type size() const {
+		return _size;
+	}
+	size_type capacity() const {
+		return _capacity;
+	}
+	bool empty() const {
+		return _size == 0;
+	}
+
+	Stats stats() const {
+		return _stats;
+	}
+	void reset_stats() {
+		_stats = Stats();
+	}
+
+	// 从最近使用到最久未使用依次调用f(key, value)
+	template <typename F>
+	void for_each(F&& f) const {
+		for (auto n = _head; n != kNil; n = _nodes[n].next) {
+			f(static_cast<const Key&>(_nodes[n].key), static_cast<const Value&>(_nodes[n].value));
+		}
+	}
+
+private:
+	static constexpr std::uint32_t kNil = UINT32_MAX;
+
+	// 键值放在匿名union里，只有在用的节点才构造
+	struct Node {
+		Node() noexcept {
+		}
+		~Node() {
+		}
+		union {
+			Key key;
+		};
+		union {
+			Value value;
+		};
+		std::uint32_t prev = kNil;
+		std::uint32_t next = kNil;
+	};
+
+	// 槽位的理想位置就是hash & _mask，回填时不用重新计算键的哈希
+	struct Slot {
+		std::uint32_t node = kNil;
+		std::uint32_t hash = 0;
+	};
+
+	std::uint32_t hash_of(const Key& key) const {
+		return static_cast<std::uint32_t>(type::detail::swiss::mix(_hash(key)));
+	}
+	// 返回key所在的索引槽位，不存在时返回应插入的空槽位
+	std::pair<std::size_t, bool> probe(const Key& key, std::uint32_t hash) const;
+	std::size_t slot_of(std::uint32_t n, std::uint32_t hash) const;
+	void unindex(std::size_t pos);
+	void unlink(std::uint32_t n);
+	void link_front(std::uint32_t n);
+	void release(std::uint32_t n);
+	void evict_lru();
+	void destroy_all();
+	// 在空闲节点上构造键值并挂到索引槽位pos，调用前必须还有空闲节点
+	template <typename K, typename V>
+	void emplace_at(std::size_t pos, std::uint32_t hash, K&& key, V&& value);
+
+	std::unique_ptr<Node[]> _nodes;
+	std::unique_ptr<Slot[]> _index;
+	std::size_t _mask = 0;
+	size_type _capacity = 0;
+	size_type _size = 0;
+	std::uint32_t _head = kNil;
+	std::uint32_t _tail = kNil;
+	std::uint32_t _free = kNil;
+	Stats _stats;
+	evict_callback _on_evict;
+	PLIB_NO_UNIQUE_ADDRESS Hash _hash;
+	PLIB_NO_UNIQUE_ADDRESS KeyEqual _equal;
+
+};
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+LruCache<Key, Value, Hash, KeyEqual>::LruCache(
+	size_type capacity,
+	evict_callback on_evict,
+	const Hash& hash,
+	const KeyEqual& equal)
+: _capacity(std::clamp<size_type>(capacity, 1, size_type(1) << 31))
+, _on_evict(std::move(on_evict))
+, _hash(hash)
+, _equal(equal) {
+	_nodes.reset(new Node[_capacity]);
+	for (size_type i = 0; i + 1 < _capacity; ++i) {
+		_nodes[i].next = static_cast<std::uint32_t>(i + 1);
+	}
+	_free = 0;
+	const auto slots = std::bit_ceil(_capacity * 2);
+	_index.reset(new Slot[slots]);
+	_mask = slots - 1;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+Value* LruCache<Key, Value, Hash, KeyEqual>::get(const Key& key) {
+	const auto [pos, found] = probe(key, hash_of(key));
+	if (!found) {
+		++_stats.misses;
+		return nullptr;
+	}
+	++_stats.hits;
+	const auto n = _index[pos].node;
+	if (n != _head) {
+		unlink(n);
+		link_front(n);
+	}
+	return std::addressof(_nodes[n].value);
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+const Value* LruCache<Key, Value, Hash, KeyEqual>::peek(const Key& key) const {
+	const auto [pos, found] = probe(key, hash_of(key));
+	return found ? std::addressof(_nodes[_index[pos].node].value) : nullptr;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+template <typename K, typename V>
+bool LruCache<Key, Value, Hash, KeyEqual>::put(K&& key, V&& value) {
+	if constexpr (!std::is_same_v<std::remove_cvref_t<K>, Key>) {
+		// 异构键先构造一次Key，哈希、探测和落位都复用它
+		return put(Key(std::forward<K>(key)), std::forward<V>(value));
+	} else {
+		const auto hash = hash_of(key);
+		auto [pos, found] = probe(key, hash);
+		if (found) {
+			const auto n = _index[pos].node;
+			_nodes[n].value = std::forward<V>(value);
+			if (n != _head) {
+				unlink(n);
+				link_front(n);
+			}
+			return false;
+		}
+		if (_size == _capacity) {
+			// value可能引用即将被淘汰的节点(例如*peek(最久未使用的键))，先构造出来再淘汰
+			Value staged(std::forward<V>(value));
+			evict_lru();
+			// 回填可能挪动了探测链，重新找空槽位
+			pos = probe(key, hash).first;
+			emplace_at(pos, hash, std::forward<K>(key), std::move(staged));
+		} else {
+			emplace_at(pos, hash, std::forward<K>(key), std::forward<V>(value));
+		}
+		return true;
+	}
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+template <typename K, typename V>
+void LruCache<Key, Value, Hash, KeyEqual>::emplace_at(std::size_t pos, std::uint32_t hash, K&& key, V&& value) {
+	const auto n = _free;
+	auto& node = _nodes[n];
+	::new (static_cast<void*>(std::addressof(node.key))) Key(std::forward<K>(key));
+	try {
+		::new (static_cast<void*>(std::addressof(node.value))) Value(std::forward<V>(value));
+	} catch (...) {
+		node.key.~Key();
+		throw;
+	}
+	_free = node.next;
+	_index[pos] = Slot{ n, hash };
+	link_front(n);
+	++_size;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+bool LruCache<Key, Value, Hash, KeyEqual>::erase(const Key& key) {
+	const auto [pos, found] = probe(key, hash_of(key));
+	if (!found) {
+		return false;
+	}
+	const auto n = _index[pos].node;
+	unindex(pos);
+	unlink(n);
+	release(n);
+	return true;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+void LruCache<Key, Value, Hash, KeyEqual>::clear() {
+	destroy_all();
+	std::fill_n(_index.get(), _mask + 1, Slot());
+	for (size_type i = 0; i + 1 < _capacity; ++i) {
+		_nodes[i].next = static_cast<std::uint32_t>(i + 1);
+	}
+	_nodes[_capacity - 1].next = kNil;
+	_free = 0;
+	_head = _tail = kNil;
+	_size = 0;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+std::pair<std::size_t, bool> LruCache<Key, Value, Hash, KeyEqual>::probe(
+		const Key& key,
+		std::uint32_t hash) const {
+	for (std::size_t pos = hash & _mask;; pos = (pos + 1) & _mask) {
+		const auto slot = _index[pos];
+		if (slot.node == kNil) {
+			return { pos, false };
+		}
+		// 哈希相同才访问节点比较键，未命中的探测只读索引
+		if (slot.hash == hash && _equal(_nodes[slot.node].key, key)) {
+			return { pos, true };
+		}
+	}
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+std::size_t LruCache<Key, Value, Hash, KeyEqual>::slot_of(std::uint32_t n, std::uint32_t hash) const {
+	std::size_t pos = hash & _mask;
+	while (_index[pos].node != n) {
+		pos = (pos + 1) & _mask;
+	}
+	return pos;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+void LruCache<Key, Value, Hash, KeyEqual>::unindex(std::size_t pos) {
+	auto hole = pos;
+	for (auto next = (pos + 1) & _mask; _index[next].node != kNil; next = (next + 1) & _mask) {
+		// 条目的理想位置不在(hole, next]区间内时，挪到hole后仍然能从理想位置探测到
+		const std::size_t home = _index[next].hash & _mask;
+		if (((next - home) & _mask) >= ((next - hole) & _mask)) {
+			_index[hole] = _index[next];
+			hole = next;
+		}
+	}
+	_index[hole] = Slot();
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+void LruCache<Key, Value, Hash, KeyEqual>::unlink(std::uint32_t n) {
+	auto& node = _nodes[n];
+	if (node.prev != kNil) {
+		_nodes[node.prev].next = node.next;
+	} else {
+		_head = node.next;
+	}
+	if (node.next != kNil) {
+		_nodes[node.next].prev = node.prev;
+	} else {
+		_tail = node.prev;
+	}
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+void LruCache<Key, Value, Hash, KeyEqual>::link_front(std::uint32_t n) {
+	auto& node = _nodes[n];
+	node.prev = kNil;
+	node.next = _head;
+	if (_head != kNil) {
+		_nodes[_head].prev = n;
+	} else {
+		_tail = n;
+	}
+	_head = n;
+}
+
+// 析构键值并把节点还给空闲链表，调用前已经从索引和链表中摘除
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+void LruCache<Key, Value, Hash, KeyEqual>::release(std::uint32_t n) {
+	auto& node = _nodes[n];
+	node.value.~Value();
+	node.key.~Key();
+	node.next = _free;
+	_free = n;
+	--_size;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+void LruCache<Key, Value, Hash, KeyEqual>::evict_lru() {
+	const auto n = _tail;
+	if (_on_evict) {
+		_on_evict(_nodes[n].key, _nodes[n].value);
+	}
+	unindex(slot_of(n, hash_of(_nodes[n].key)));
+	unlink(n);
+	release(n);
+	++_stats.evictions;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+void LruCache<Key, Value, Hash, KeyEqual>::destroy_all() {
+	for (auto n = _head; n != kNil; n = _nodes[n].next) {
+		_nodes[n].value.~Value();
+		_nodes[n].key.~Key();
+	}
+}
+
 } // namespace plib::core::utils
 
 #endif // PLIB_CORE_UTILS_LRU_HPP
\ No newline at end of file
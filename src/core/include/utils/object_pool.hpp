@@ -7,28 +7,60 @@
 #include <vector>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <source_location>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "plib_macros.hpp"
+#include "memory/block_provider.hpp"
+#include "memory/heap_profiler.hpp"
+#include "memory/thread_cache.hpp"
 
 namespace plib::core::utils
 {
+   // 对象池达到块数上限时animate的行为
+   enum class PoolExhaustPolicy
+   {
+      THROW,      // 抛出std::bad_alloc
+      RETURN_NULL // 返回nullptr
+   };
+
    /**
     take from taskflow
     线程安全的对象池
 
     空闲链表：空闲的对象槽连接而成，每个槽的前sizeof(T*)储存了下一个空闲对象槽的地址
+
+    每个块按块大小S对齐分配，块头之后紧跟对象槽，回收时把对象地址低位清零即可找到所属块，
+    因此池化的类型不需要任何侵入式成员，也没有逐对象的额外开销
+
+    每个线程在每个池上有一个私有的弹匣(magazine)缓存空闲槽，配对的animate/recycle只读写弹匣，
+    不加锁也没有原子RMW；弹匣空/满时才批量地从本线程的本地堆装填/归还。
+    其他线程回收的对象压入所属块的远程空闲链表(无锁)，由块的所有者在装填时回收
+
+    内存占用：本地堆缩容时交给全局堆的空块，超出保留数量的直接释放；trim()释放所有空块，
+    保留的空块通过madvise归还物理页；set_max_blocks()限制块总数，达到上限后按PoolExhaustPolicy处理
     */
 
    /**
     * @param T: 对象类型
-    * @param S: 每个块的大小，默认64kb
+    * @param S: 每个块的大小(包括块头)，必须是2的幂，默认64kb
+    * @param M: 每个线程弹匣的槽位数
     */
-   template <typename T, size_t S = 65536>
+   template <typename T, size_t S = 65536, size_t M = 32>
    class ObjectPool
    {
-      // 每个对象槽的大小，确保能容纳下指针
-      constexpr static size_t SlotSize = (std::max)(sizeof(T *), sizeof(T));
+      // 对象槽的对齐，确保能存放下一个空闲槽的指针
+      constexpr static size_t SlotAlign = (std::max)(alignof(T), alignof(T *));
 
-      // 每个块能容纳的对象数
-      constexpr static size_t SlotNumPerBlock = S / SlotSize;
+      // 每个对象槽的大小，确保能容纳下指针
+      constexpr static size_t SlotSize = ((std::max)(sizeof(T *), sizeof(T)) + SlotAlign - 1) / SlotAlign * SlotAlign;
 
       // 每个块的桶的数量
       constexpr static size_t BinNumPerBlock = 4;
@@ -36,20 +68,12 @@ namespace plib::core::utils
       // 本地堆中的桶数量
       constexpr static size_t localBinNum = BinNumPerBlock + 1;
 
-      // 每个桶的对象槽数量
-      constexpr static size_t SlotNumPerBin = (SlotNumPerBlock + BinNumPerBlock - 1) / BinNumPerBlock;
-
-      // 每个桶的空闲对象槽数量
-      constexpr static size_t FreeSlotNumPerBin = SlotNumPerBin;
-
       // 缩容系数
       constexpr static size_t ShrinkFactor = 4;
 
       // 保证块大小必须为2的幂
       static_assert((S & (S - 1)) == 0, "Block size must be power of 2");
-
-      // 保证每个块至少容纳128个对象槽
-      static_assert(SlotNumPerBlock >= 128, "Per Block must be able to hold at least 128 slots");
+      static_assert(M >= 2, "Magazine must hold at least 2 slots");
 
       struct BlockList
       {
@@ -59,18 +83,30 @@ namespace plib::core::utils
 
       struct GlobalHeap
       {
-         std::mutex mutex; // 全局堆互斥锁
-         BlockList *head;  // 块链表表头
+         mutable std::mutex mutex; // 全局堆互斥锁
+         BlockList head;           // 块链表表头
+         size_t blockNum{0};       // 全局堆中的块数
+         size_t emptyNum{0};       // 其中作为空块保留的块数
       };
 
       struct LocalHeap
       {
-         std::mutex mutex;             // 本地对互斥锁
-         BlockList lists[localBinNum]; // localBinNum条块链表
-         size_t used{0};               // 已分配的对象数量
-         size_t total{0};              // 总对象数量
+         mutable std::mutex mutex;          // 本地堆互斥锁
+         BlockList lists[localBinNum];      // localBinNum条块链表
+         size_t used{0};                    // 已分配的对象数量(包括弹匣中的槽)
+         size_t total{0};                   // 总对象数量
+         std::atomic<bool> hasRemote{false}; // 是否有块收到了远程回收的对象
       };
 
+      // 线程私有缓存，只有所属线程读写弹匣，count用原子变量仅为了统计接口可以并发读取
+      struct ThreadCache
+      {
+         LocalHeap heap;
+         std::atomic<size_t> count{0}; // 弹匣中的槽数
+         T *slots[M];
+      };
+
+      // 块头，位于按S对齐的内存块起始处，对象槽紧随其后
       struct Block
       {
          std::atomic<LocalHeap *> heap; // 所属的本地堆，若为空则属于全局堆
@@ -78,15 +114,43 @@ namespace plib::core::utils
          size_t index;                  // 已分配对象槽索引
          size_t usedNum;                // 已分配的对象数量
          T *top;                        // 空闲链表表头
-         char data[S];                  // 块数据区
+         std::atomic<T *> remoteTop;    // 其他线程回收的对象链表
+         std::atomic<size_t> remoteNum; // 远程链表中的对象数量
+         std::atomic<size_t> remoteRefs; // 正在执行_remote_free的线程数，不为0时块不能释放
+         bool idle;                     // 作为空块计入全局堆的emptyNum(持有全局锁)
       };
 
+      // 块头占用的字节数(按对象槽对齐)
+      constexpr static size_t HeaderSize = (sizeof(Block) + SlotAlign - 1) / SlotAlign * SlotAlign;
+
+      // 每个块能容纳的对象数
+      constexpr static size_t SlotNumPerBlock = (S - HeaderSize) / SlotSize;
+
+      // 每个桶的对象槽数量
+      constexpr static size_t SlotNumPerBin = (SlotNumPerBlock + BinNumPerBlock - 1) / BinNumPerBlock;
+
+      // 保证每个块至少容纳128个对象槽
+      static_assert(SlotNumPerBlock >= 128, "Per Block must be able to hold at least 128 slots");
+
    public:
+      typedef T value_type;
+
       /**
-       * @brief 构造对象池
-       * @param thread_num 预期线程数量，实际可以比这个多
+       * @brief 构造对象池，每个访问过本池的线程各持有一个本地堆，堆数随实际线程数增长
+       * @param thread_num 预期线程数量，仅用于预留本地堆列表的容量，不限制也不决定本地堆数量
+       * @param loc 构造位置，开启PLIB_HEAP_PROFILING时作为统计点
        */
-      explicit ObjectPool(unsigned int thread_num = std::thread::hardware_concurrency());
+      explicit ObjectPool(unsigned int thread_num = std::thread::hardware_concurrency(),
+                          std::source_location loc = std::source_location::current());
+
+      /**
+       * @brief 构造对象池，块(S字节、按S对齐)从provider申请
+       * @param provider 块来源，例如memory::MmapBlockProvider，必须比池活得更久
+       * @param thread_num 预期线程数量，仅用于预留本地堆列表的容量
+       * @param loc 构造位置，开启PLIB_HEAP_PROFILING时作为统计点
+       */
+      explicit ObjectPool(memory::BlockProvider *provider, unsigned int thread_num = std::thread::hardware_concurrency(),
+                          std::source_location loc = std::source_location::current());
 
       /**
        * @brief 析构对象池,释放所有分配的内存
@@ -108,6 +172,22 @@ namespace plib::core::utils
        */
       void recycle(T *obj);
 
+      /**
+       * @brief 批量分配n个对象，每个都用args(按左值)构造
+       * 先取弹匣中的槽，不足的部分在一次本地堆加锁内取齐，而不是每个对象一次装填
+       * @param n 对象数
+       * @param out 输出数组，至少n个元素
+       * @return 构造成功的对象数；达到块数上限时按PoolExhaustPolicy处理，RETURN_NULL时可能小于n
+       */
+      template <typename... Args>
+      size_t animate_n(size_t n, T **out, const Args &...args);
+
+      /**
+       * @brief 批量回收n个对象
+       * 弹匣装满后剩余的槽在一次本地堆加锁内归还，其他线程分配的对象走远程空闲链表
+       */
+      void recycle_n(T *const *objs, size_t n);
+
       // 获取每个本地堆的bin数
       size_t num_bins_per_local_heap() const;
       // 获取每个bin的对象数
@@ -128,13 +208,94 @@ namespace plib::core::utils
       size_t num_heaps() const;
       // 获取空块阈值
       float emptiness_threshold() const;
+      // 获取每个线程弹匣的槽位数
+      size_t magazine_size() const;
+
+      /**
+       * @brief 把当前线程弹匣中的槽还给本地堆
+       */
+      void flush_local_cache();
+
+      /**
+       * @brief 释放所有完全空闲的块，最多保留keep个
+       * 保留的空块会通过madvise(MADV_DONTNEED)归还物理内存，地址空间仍归池所有。
+       * 其他线程弹匣中的槽所在的块不是空块，不会被释放
+       * @return 释放的块数
+       */
+      size_t trim(size_t keep);
+      // 按retained_blocks()保留空块
+      size_t trim();
+
+      // 全局堆最多保留的空块数，本地堆缩容时超出的空块直接释放
+      void set_retained_blocks(size_t n);
+      size_t retained_blocks() const;
+
+      // 块总数上限，0表示不限制
+      void set_max_blocks(size_t n);
+      size_t max_blocks() const;
+
+      // 达到块数上限时的处理方式，默认抛出std::bad_alloc
+      void set_exhaust_policy(PoolExhaustPolicy policy);
+      PoolExhaustPolicy exhaust_policy() const;
+
+      // 当前持有的块数
+      size_t num_blocks() const;
+      // 块来源
+      memory::BlockProvider *block_provider() const noexcept { return _provider; }
 
    private:
-      const size_t _headpMask;                                 // 用于线程哈希的掩码
-      GlobalHeap _globalHeap;                                  // 全局堆
-      std::vector<LocalHeap> _lheaps;                          // 线程局部堆
-      LocalHeap &_this_heap();                                 // 获取当前线程对应的局部堆(根据threadId哈希)
-      constexpr unsigned int _next_pow2(unsigned int n) const; // 获取大于等于n的最小2的幂
+      GlobalHeap _globalHeap;                               // 全局堆
+      const std::uint64_t _id;                              // 在线程缓存登记表中的id
+      memory::BlockProvider *const _provider;               // 块来源
+      mutable std::mutex _cachesMutex;                      // 保护_caches和_idleCaches
+      std::vector<std::unique_ptr<ThreadCache>> _caches;    // 所有线程缓存，池析构时释放
+      std::vector<ThreadCache *> _idleCaches;               // 线程已退出、可复用的缓存
+      std::atomic<size_t> _blockNum{0};                     // 块总数
+      std::atomic<size_t> _maxBlocks{0};                    // 块总数上限
+      std::atomic<size_t> _retainedBlocks{ShrinkFactor};    // 全局堆保留的块数
+      std::atomic<PoolExhaustPolicy> _exhaustPolicy{PoolExhaustPolicy::THROW};
+      PLIB_NO_UNIQUE_ADDRESS memory::HeapProbe _heapProbe;  // 分配统计(PLIB_HEAP_PROFILING)
+
+      // 获取当前线程在本池上的缓存，首次调用时创建
+      ThreadCache *_local();
+      ThreadCache *_local_slow();
+      // 线程退出时由登记表调用
+      static void _release_local(void *owner, void *cache);
+      void _retire(ThreadCache *cache);
+
+      // 达到块数上限且弹匣为空
+      P_NOTINLINE T *_exhausted() const;
+      // 块交给全局堆，空块超出保留数量时直接释放(持有全局锁，块已从原链表摘除)
+      void _release_to_global(Block *block);
+      // 块中没有存活对象，也没有远程回收者还在访问块头，可以释放或归还物理页
+      bool _reclaimable(const Block *block) const;
+      // 块从全局堆链表摘除(持有全局锁)
+      void _unlink_global(Block *block);
+      // 归还块中对象槽所在的物理页，块重置为未分配状态
+      void _decommit(Block *block);
+
+      // 弹匣为空时从本地堆装填一半
+      P_NOTINLINE void _refill(ThreadCache &cache);
+      // 弹匣满时把多于keep的槽还给本地堆
+      P_NOTINLINE void _drain(ThreadCache &cache, size_t keep);
+      // 本地堆比较富余时把最空闲的块迁移到全局堆，调用时持有本地堆的锁
+      void _shrink_locked(ThreadCache &cache);
+      // 在本地堆中分配一个槽，达到块数上限时返回nullptr(持有lh.mutex)
+      T *_allocate_from_heap(LocalHeap &lh);
+      // 把一个槽还给本地堆(持有lh.mutex)
+      void _return_to_heap(LocalHeap &lh, T *obj);
+      // 从全局堆取一个有空位的块，没有则返回nullptr(持有全局锁)
+      Block *_acquire_global_block();
+      // 块被移动到bin f之后调整所在链表
+      void _rebin(LocalHeap &lh, Block *block, size_t f);
+      // 把块的远程链表回收到块的空闲链表，返回回收的数量(调用者持有块所在堆的锁)
+      size_t _reclaim_remote(Block *block);
+      // 回收本地堆所有块的远程链表
+      void _reclaim_remote_all(LocalHeap &lh);
+      // 把对象压入块的远程链表
+      void _remote_free(Block *block, T *obj);
+      // 块中当前还在使用的对象数(持有块所在堆的锁)
+      size_t _live_in_block(const Block *block) const;
       // 计算成员在类中的偏移
       template <class P, class Q>
       constexpr size_t _offset_in_class(const Q P::*member) const;
@@ -149,6 +310,13 @@ namespace plib::core::utils
       constexpr Block *_block_of(BlockList *node);
       constexpr Block *_block_of(const BlockList *node) const;
 
+      // 通过对象地址获取所属Block：块按S对齐，清掉地址低位即是块头
+      static Block *_block_of_object(const T *obj) noexcept;
+
+      // 申请/释放一个按S对齐的块，达到块数上限时返回nullptr
+      Block *_new_block();
+      void _delete_block(Block *block);
+
       // 计算对象数对应的bin编号
       size_t _bin(size_t) const;
 
@@ -156,6 +324,8 @@ namespace plib::core::utils
       T *_allocate(Block *);
       // 回收一个对象到Block
       void _deallocate(Block *, T *);
+      // 把已析构对象的槽位还给所属Block
+      void _recycle_slot(T *);
       // 初始化链表头
       void _blocklist_init_head(BlockList *);
       // 在链表中插入节点
@@ -189,161 +359,415 @@ namespace plib::core::utils
       // 遍历链表所有Block
       template <typename C>
       void _for_each_block(BlockList *, C &&);
+      template <typename C>
+      void _for_each_block(const BlockList *, C &&) const;
+
+      // 遍历所有本地堆(持有各自的锁)和全局堆(持有全局锁)
+      template <typename L, typename G>
+      void _for_each_heap(L &&local, G &&global) const;
    };
 
-   template <typename T, size_t S>
-   ObjectPool<T, S>::ObjectPool(unsigned int thread_num)
-       : _headpMask(_next_pow2((thread_num + 1) << 1) - 1), _globalHeap{std::mutex(), nullptr}, _lheaps(_headpMask + 1)
+   template <typename T, size_t S, size_t M>
+   ObjectPool<T, S, M>::ObjectPool(unsigned int thread_num, std::source_location loc)
+       : ObjectPool(memory::default_block_provider(), thread_num, loc)
    {
-      // 初始化全局对和局部堆
+   }
+
+   template <typename T, size_t S, size_t M>
+   ObjectPool<T, S, M>::ObjectPool(memory::BlockProvider *provider, unsigned int thread_num, std::source_location loc)
+       : _globalHeap(), _id(memory::detail::ThreadCacheRegistry::instance().register_owner()), _provider(provider),
+         _heapProbe("ObjectPool", sizeof(T), loc)
+   {
+      // 初始化全局堆
       _blocklist_init_head(&_globalHeap.head);
-      for (auto &lh : _lheaps)
-         for (size_t i = 0; i < localBinNum; ++i)
-            _blocklist_init_head(&lh.lists[i]);
+      // 本地堆按线程首次访问时创建，thread_num只是容量提示
+      _caches.reserve(thread_num);
    }
 
-   template <typename T, size_t S>
-   ObjectPool<T, S>::~ObjectPool()
+   template <typename T, size_t S, size_t M>
+   ObjectPool<T, S, M>::~ObjectPool()
    {
+      // 注销后退出的线程不会再访问本池的缓存
+      memory::detail::ThreadCacheRegistry::instance().unregister_owner(_id);
+
       // 释放所有本地堆
-      for (auto &lh : _lheaps)
+      for (auto &cache : _caches)
       {
-         _for_each_block_safe(&lh.lists[localBinNum - 1], [this](Block *b)
-                              { delete b; });
+         for (size_t i = 0; i < localBinNum; ++i)
+            _for_each_block_safe(&cache->heap.lists[i], [this](Block *b)
+                                 { _delete_block(b); });
       }
 
       // 释放全局堆
       _for_each_block_safe(&_globalHeap.head, [this](Block *b)
-                           { delete b; });
+                           { _delete_block(b); });
+   }
+
+   template <typename T, size_t S, size_t M>
+   typename ObjectPool<T, S, M>::Block *ObjectPool<T, S, M>::_block_of_object(const T *obj) noexcept
+   {
+      return reinterpret_cast<Block *>(reinterpret_cast<std::uintptr_t>(obj) & ~static_cast<std::uintptr_t>(S - 1));
+   }
+
+   template <typename T, size_t S, size_t M>
+   typename ObjectPool<T, S, M>::Block *ObjectPool<T, S, M>::_new_block()
+   {
+      size_t max = _maxBlocks.load(std::memory_order_relaxed);
+      if (_blockNum.fetch_add(1, std::memory_order_relaxed) >= max && max != 0)
+      {
+         _blockNum.fetch_sub(1, std::memory_order_relaxed);
+         return nullptr;
+      }
+      void *mem;
+      try
+      {
+         mem = _provider->allocate(S, S);
+      }
+      catch (...)
+      {
+         _blockNum.fetch_sub(1, std::memory_order_relaxed);
+         throw;
+      }
+      Block *block = ::new (mem) Block();
+      block->heap = nullptr;
+      block->index = 0;
+      block->usedNum = 0;
+      block->top = nullptr;
+      block->remoteTop.store(nullptr, std::memory_order_relaxed);
+      block->remoteNum.store(0, std::memory_order_relaxed);
+      block->remoteRefs.store(0, std::memory_order_relaxed);
+      block->idle = false;
+      return block;
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_delete_block(Block *block)
+   {
+      block->~Block();
+      _provider->deallocate(static_cast<void *>(block), S, S);
+      _blockNum.fetch_sub(1, std::memory_order_relaxed);
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_decommit(Block *block)
+   {
+      assert(block->usedNum == 0);
+      // 空闲链表保存在对象槽中，归还物理页后槽内容变为0，只能从头重新分配
+      block->index = 0;
+      block->top = nullptr;
+#if defined(__linux__)
+      static const std::uintptr_t page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+      std::uintptr_t begin = (reinterpret_cast<std::uintptr_t>(block) + HeaderSize + page - 1) & ~(page - 1);
+      std::uintptr_t end = reinterpret_cast<std::uintptr_t>(block) + S;
+      if (begin < end)
+         madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+#endif
    }
 
-   template <typename T, size_t S>
-   size_t ObjectPool<T, S>::num_bins_per_local_heap() const
+   template <typename T, size_t S, size_t M>
+   bool ObjectPool<T, S, M>::_reclaimable(const Block *block) const
+   {
+      // 远程回收者先增加remoteRefs再入链，对象被回收到空闲链表后它可能还在读块头；
+      // usedNum为0时不会再有新的回收者，只需等已经在途的退出
+      return block->usedNum == 0 && block->remoteRefs.load() == 0;
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_unlink_global(Block *block)
+   {
+      _blocklist_del(&block->list_node);
+      --_globalHeap.blockNum;
+      if (block->idle)
+      {
+         block->idle = false;
+         --_globalHeap.emptyNum;
+      }
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_release_to_global(Block *block)
+   {
+      block->heap.store(nullptr);
+      if (_reclaimable(block))
+      {
+         if (_globalHeap.emptyNum >= _retainedBlocks.load(std::memory_order_relaxed))
+         {
+            // 先归还物理页，分配器缓存这块内存时也不会占用常驻内存
+            _decommit(block);
+            _delete_block(block);
+            return;
+         }
+         block->idle = true;
+         ++_globalHeap.emptyNum;
+      }
+      ++_globalHeap.blockNum;
+      if (block->usedNum == SlotNumPerBlock)
+         _blocklist_push_back(&block->list_node, &_globalHeap.head);
+      else
+         _blocklist_push_front(&block->list_node, &_globalHeap.head);
+   }
+
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::trim(size_t keep)
+   {
+      std::vector<Block *> empty;
+      {
+         std::lock_guard<std::mutex> lock(_cachesMutex);
+         for (auto &cache : _caches)
+         {
+            LocalHeap &lh = cache->heap;
+            std::lock_guard<std::mutex> heapLock(lh.mutex);
+            _reclaim_remote_all(lh);
+            // 空块没有存活对象，所属线程的无锁路径不会访问它，可以在这里摘除；
+            // 还有远程回收者在访问块头的留到下次
+            _for_each_block_safe(&lh.lists[0], [&](Block *b)
+                                 {
+                                    if (_reclaimable(b))
+                                    {
+                                       _blocklist_del(&b->list_node);
+                                       b->heap.store(nullptr);
+                                       lh.total -= SlotNumPerBlock;
+                                       empty.push_back(b);
+                                    } });
+         }
+      }
+      {
+         std::lock_guard<std::mutex> globalLock(_globalHeap.mutex);
+         _for_each_block_safe(&_globalHeap.head, [&](Block *b)
+                              {
+                                 _reclaim_remote(b);
+                                 if (_reclaimable(b))
+                                 {
+                                    _unlink_global(b);
+                                    empty.push_back(b);
+                                 } });
+         for (; keep > 0 && !empty.empty(); --keep)
+         {
+            Block *b = empty.back();
+            empty.pop_back();
+            _decommit(b);
+            b->idle = true;
+            ++_globalHeap.emptyNum;
+            _blocklist_push_front(&b->list_node, &_globalHeap.head);
+            ++_globalHeap.blockNum;
+         }
+      }
+      for (Block *b : empty)
+      {
+         _decommit(b);
+         _delete_block(b);
+      }
+      return empty.size();
+   }
+
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::trim()
+   {
+      return trim(retained_blocks());
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::set_retained_blocks(size_t n)
+   {
+      _retainedBlocks.store(n, std::memory_order_relaxed);
+   }
+
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::retained_blocks() const
+   {
+      return _retainedBlocks.load(std::memory_order_relaxed);
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::set_max_blocks(size_t n)
+   {
+      _maxBlocks.store(n, std::memory_order_relaxed);
+   }
+
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::max_blocks() const
+   {
+      return _maxBlocks.load(std::memory_order_relaxed);
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::set_exhaust_policy(PoolExhaustPolicy policy)
+   {
+      _exhaustPolicy.store(policy, std::memory_order_relaxed);
+   }
+
+   template <typename T, size_t S, size_t M>
+   PoolExhaustPolicy ObjectPool<T, S, M>::exhaust_policy() const
+   {
+      return _exhaustPolicy.load(std::memory_order_relaxed);
+   }
+
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::num_blocks() const
+   {
+      return _blockNum.load(std::memory_order_relaxed);
+   }
+
+   template <typename T, size_t S, size_t M>
+   T *ObjectPool<T, S, M>::_exhausted() const
+   {
+      if (_exhaustPolicy.load(std::memory_order_relaxed) == PoolExhaustPolicy::THROW)
+         throw std::bad_alloc();
+      return nullptr;
+   }
+
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::num_bins_per_local_heap() const
    {
       return localBinNum;
    }
 
-   template <typename T, size_t S>
-   size_t ObjectPool<T, S>::num_objects_per_bin() const
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::num_objects_per_bin() const
    {
       return SlotNumPerBin;
    }
 
-   template <typename T, size_t S>
-   size_t ObjectPool<T, S>::num_objects_per_block() const
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::num_objects_per_block() const
    {
       return SlotNumPerBlock;
    }
 
-   template <typename T, size_t S>
-   float ObjectPool<T, S>::emptiness_threshold() const
+   template <typename T, size_t S, size_t M>
+   float ObjectPool<T, S, M>::emptiness_threshold() const
    {
       return 1.0f / BinNumPerBlock;
    }
 
-   template <typename T, size_t S>
-   size_t ObjectPool<T, S>::num_global_heaps() const
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::num_global_heaps() const
    {
       return 1;
    }
 
-   template <typename T, size_t S>
-   size_t ObjectPool<T, S>::num_local_heaps() const
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::magazine_size() const
+   {
+      return M;
+   }
+
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::num_local_heaps() const
    {
-      return _lheaps.size();
+      std::lock_guard<std::mutex> lock(_cachesMutex);
+      return _caches.size();
    }
 
-   template <typename T, size_t S>
-   size_t ObjectPool<T, S>::num_heaps() const
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::num_heaps() const
    {
-      return _lheaps.size() + 1;
+      return num_local_heaps() + num_global_heaps();
    }
 
-   template <typename T, size_t S>
-   size_t ObjectPool<T, S>::capacity() const
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::capacity() const
    {
       size_t cap = 0;
-      for (auto p = _globalHeap.head->next; p != nullptr; p = p->next)
-         cap += SlotNumPerBlock;
-      for (const auto &lh : _lheaps)
-         cap += lh.total;
+      _for_each_heap([&](const ThreadCache &cache)
+                     { cap += cache.heap.total; },
+                     [&](const Block *)
+                     { cap += SlotNumPerBlock; });
       return cap;
    }
 
-   template <typename T, size_t S>
-   size_t ObjectPool<T, S>::num_available_objects() const
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::num_available_objects() const
    {
-      size_t avail = 0;
-      for (auto p = _globalHeap.head->next; p != nullptr; p = p->next)
-      {
-         avail += (SlotNumPerBlock - _block_of(p)->usedNum);
-      }
-      for (const auto &lh : _lheaps)
-         avail += (lh.total - lh.used);
-      return avail;
+      return capacity() - num_allocated_objects();
    }
 
-   template <typename T, size_t S>
-   size_t ObjectPool<T, S>::num_allocated_objects() const
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::num_allocated_objects() const
    {
+      // 弹匣中的槽和远程链表中的对象在块中仍计为已分配，需要扣除
       size_t used = 0;
-      for (auto p = _globalHeap.head->next; p != nullptr; p = p->next)
+      _for_each_heap([&](const ThreadCache &cache)
+                     {
+                        used += cache.heap.used - cache.count.load(std::memory_order_relaxed);
+                        for (size_t i = 0; i < localBinNum; ++i)
+                           _for_each_block(&cache.heap.lists[i], [&](const Block *b)
+                                           { used -= b->remoteNum.load(std::memory_order_relaxed); }); },
+                     [&](const Block *b)
+                     { used += _live_in_block(b); });
+      return used;
+   }
+
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::_live_in_block(const Block *block) const
+   {
+      return block->usedNum - block->remoteNum.load(std::memory_order_relaxed);
+   }
+
+   template <typename T, size_t S, size_t M>
+   template <typename L, typename G>
+   void ObjectPool<T, S, M>::_for_each_heap(L &&local, G &&global) const
+   {
       {
-         used += _block_of(p)->usedNum;
+         std::lock_guard<std::mutex> lock(_cachesMutex);
+         for (const auto &cache : _caches)
+         {
+            std::lock_guard<std::mutex> heapLock(cache->heap.mutex);
+            local(*cache);
+         }
       }
-      for (const auto &lh : _lheaps)
-         used += lh.used;
-      return used;
+      std::lock_guard<std::mutex> globalLock(_globalHeap.mutex);
+      _for_each_block(&_globalHeap.head, global);
    }
 
-   template <typename T, size_t S>
-   size_t ObjectPool<T, S>::_bin(size_t objNum) const
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::_bin(size_t objNum) const
    {
       return objNum == SlotNumPerBlock ? BinNumPerBlock : objNum / SlotNumPerBin;
    }
 
-   template <typename T, size_t S>
+   template <typename T, size_t S, size_t M>
    template <class P, class Q>
-   constexpr size_t ObjectPool<T, S>::_offset_in_class(const Q P::*member) const
+   constexpr size_t ObjectPool<T, S, M>::_offset_in_class(const Q P::*member) const
    {
       return reinterpret_cast<size_t>(&(reinterpret_cast<P *>(0)->*member));
    }
 
-   template <typename T, size_t S>
+   template <typename T, size_t S, size_t M>
    template <class P, class Q>
-   constexpr P *ObjectPool<T, S>::_parent_class_of(Q *member_ptr, const Q P::*member) const
+   constexpr P *ObjectPool<T, S, M>::_parent_class_of(Q *member_ptr, const Q P::*member) const
    {
       return reinterpret_cast<P *>(reinterpret_cast<char *>(member_ptr) - _offset_in_class(member));
    }
 
-   template <typename T, size_t S>
+   template <typename T, size_t S, size_t M>
    template <class P, class Q>
-   constexpr P *ObjectPool<T, S>::_parent_class_of(const Q *member_ptr, const Q P::*member) const
+   constexpr P *ObjectPool<T, S, M>::_parent_class_of(const Q *member_ptr, const Q P::*member) const
    {
-      return reinterpret_cast<P *>(reinterpret_cast<const char *>(member_ptr) - _offset_in_class(member));
+      return reinterpret_cast<P *>(const_cast<char *>(reinterpret_cast<const char *>(member_ptr)) - _offset_in_class(member));
    }
 
-   template <typename T, size_t S>
-   constexpr typename ObjectPool<T, S>::Block *ObjectPool<T, S>::_block_of(BlockList *node)
+   template <typename T, size_t S, size_t M>
+   constexpr typename ObjectPool<T, S, M>::Block *ObjectPool<T, S, M>::_block_of(BlockList *node)
    {
       return _parent_class_of(node, &Block::list_node);
    }
 
-   template <typename T, size_t S>
-   constexpr typename ObjectPool<T, S>::Block *ObjectPool<T, S>::_block_of(const BlockList *node) const
+   template <typename T, size_t S, size_t M>
+   constexpr typename ObjectPool<T, S, M>::Block *ObjectPool<T, S, M>::_block_of(const BlockList *node) const
    {
       return _parent_class_of(node, &Block::list_node);
    }
 
-   template <typename T, size_t S>
-   void ObjectPool<T, S>::_blocklist_init_head(BlockList *head)
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_blocklist_init_head(BlockList *head)
    {
       head->next = head;
       head->prev = head;
    }
 
-   template <typename T, size_t S>
-   void ObjectPool<T, S>::_blocklist_add_impl(BlockList *cur_node, BlockList *prev, BlockList *next)
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_blocklist_add_impl(BlockList *cur_node, BlockList *prev, BlockList *next)
    {
       next->prev = cur_node;
       cur_node->next = next;
@@ -351,35 +775,35 @@ namespace plib::core::utils
       prev->next = cur_node;
    }
 
-   template <typename T, size_t S>
-   void ObjectPool<T, S>::_blocklist_push_front(BlockList *cur_node, BlockList *head)
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_blocklist_push_front(BlockList *cur_node, BlockList *head)
    {
       _blocklist_add_impl(cur_node, head, head->next);
    }
 
-   template <typename T, size_t S>
-   void ObjectPool<T, S>::_blocklist_push_back(BlockList *cur_node, BlockList *head)
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_blocklist_push_back(BlockList *cur_node, BlockList *head)
    {
       _blocklist_add_impl(cur_node, head->prev, head);
    }
 
-   template <typename T, size_t S>
-   void ObjectPool<T, S>::_blocklist_del_impl(BlockList *prev, BlockList *next)
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_blocklist_del_impl(BlockList *prev, BlockList *next)
    {
       next->prev = prev;
       prev->next = next;
    }
 
-   template <typename T, size_t S>
-   void ObjectPool<T, S>::_blocklist_del(BlockList *node)
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_blocklist_del(BlockList *node)
    {
       _blocklist_del_impl(node->prev, node->next);
       node->next = nullptr;
       node->prev = nullptr;
    }
 
-   template <typename T, size_t S>
-   void ObjectPool<T, S>::_blocklist_replace(BlockList *old_node, BlockList *cur_node)
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_blocklist_replace(BlockList *old_node, BlockList *cur_node)
    {
       cur_node->next = old_node->next;
       cur_node->next->prev = cur_node;
@@ -389,70 +813,78 @@ namespace plib::core::utils
       old_node->prev = nullptr;
    }
 
-   template <typename T, size_t S>
-   void ObjectPool<T, S>::_blocklist_move_front(BlockList *cur_node, BlockList *head)
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_blocklist_move_front(BlockList *cur_node, BlockList *head)
    {
       _blocklist_del_impl(cur_node->prev, cur_node->next);
       _blocklist_push_front(cur_node, head);
    }
 
-   template <typename T, size_t S>
-   void ObjectPool<T, S>::_blocklist_move_back(BlockList *cur_node, BlockList *head)
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_blocklist_move_back(BlockList *cur_node, BlockList *head)
    {
       _blocklist_del_impl(cur_node->prev, cur_node->next);
       _blocklist_push_back(cur_node, head);
    }
 
-   template <typename T, size_t S>
-   bool ObjectPool<T, S>::_blocklist_is_first(const BlockList *cur_node, const BlockList *head)
+   template <typename T, size_t S, size_t M>
+   bool ObjectPool<T, S, M>::_blocklist_is_first(const BlockList *cur_node, const BlockList *head)
    {
       return cur_node->prev == head;
    }
 
-   template <typename T, size_t S>
-   bool ObjectPool<T, S>::_blocklist_is_last(const BlockList *cur_node, const BlockList *head)
+   template <typename T, size_t S, size_t M>
+   bool ObjectPool<T, S, M>::_blocklist_is_last(const BlockList *cur_node, const BlockList *head)
    {
       return cur_node->next == head;
    }
 
-   template <typename T, size_t S>
-   bool ObjectPool<T, S>::_blocklist_is_empty(const BlockList *head)
+   template <typename T, size_t S, size_t M>
+   bool ObjectPool<T, S, M>::_blocklist_is_empty(const BlockList *head)
    {
       return head->next == head;
    }
 
-   template <typename T, size_t S>
-   bool ObjectPool<T, S>::_blocklist_is_singular(const BlockList *head)
+   template <typename T, size_t S, size_t M>
+   bool ObjectPool<T, S, M>::_blocklist_is_singular(const BlockList *head)
    {
       return !_blocklist_is_empty(head) && (head->next == head->prev);
    }
 
-   template <typename T, size_t S>
+   template <typename T, size_t S, size_t M>
    template <typename F>
-   void ObjectPool<T, S>::_for_each_block_safe(BlockList *head, F &&func)
+   void ObjectPool<T, S, M>::_for_each_block_safe(BlockList *head, F &&func)
    {
-      Blocklist *p;
-      Blocklist *t;
+      BlockList *p;
+      BlockList *t;
       for (p = head->next, t = p->next; p != head; p = t, t = p->next)
-         c(_block_of(p));
+         func(_block_of(p));
    }
 
-   template <typename T, size_t S>
+   template <typename T, size_t S, size_t M>
    template <typename F>
-   void ObjectPool<T, S>::_for_each_block(BlockList *head, F &&func)
+   void ObjectPool<T, S, M>::_for_each_block(BlockList *head, F &&func)
    {
-      Blocklist *p;
+      BlockList *p;
       for (p = head->next; p != head; p = p->next)
-         c(_block_of(p));
+         func(_block_of(p));
    }
 
-   template <typename T, size_t S>
-   T *ObjectPool<T, S>::_allocate(Block *block)
+   template <typename T, size_t S, size_t M>
+   template <typename F>
+   void ObjectPool<T, S, M>::_for_each_block(const BlockList *head, F &&func) const
+   {
+      for (const BlockList *p = head->next; p != head; p = p->next)
+         func(_block_of(p));
+   }
+
+   template <typename T, size_t S, size_t M>
+   T *ObjectPool<T, S, M>::_allocate(Block *block)
    {
       if (block->top == nullptr)
       {
          // 如果空闲列表为空则直接从未分配区域分配
-         return reinterpret_cast<T *>(block->data + block->index++ * SlotSize);
+         return reinterpret_cast<T *>(reinterpret_cast<char *>(block) + HeaderSize + block->index++ * SlotSize);
       }
       else
       {
@@ -463,156 +895,474 @@ namespace plib::core::utils
       }
    }
 
-   template <typename T, size_t S>
-   void ObjectPool<T, S>::_deallocate(Block *block, T *obj)
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_deallocate(Block *block, T *obj)
    {
       // 将对象回收到空闲列表
       *reinterpret_cast<T **>(obj) = block->top;
       block->top = obj;
    }
 
-   template <typename T, size_t S>
+   template <typename T, size_t S, size_t M>
+   template <typename... Args>
+   T *ObjectPool<T, S, M>::animate(Args &&...args)
+   {
+      ThreadCache *cache = _local();
+      // 快速路径：弹匣只有本线程读写，不加锁也没有原子RMW
+      size_t n = cache->count.load(std::memory_order_relaxed);
+      if (n == 0)
+      {
+         _refill(*cache);
+         n = cache->count.load(std::memory_order_relaxed);
+         if (n == 0)
+            return _exhausted();
+      }
+      T *obj = cache->slots[--n];
+      cache->count.store(n, std::memory_order_relaxed);
+      try
+      {
+         new (obj) T(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+         _recycle_slot(obj);
+         throw;
+      }
+      _heapProbe.allocated(obj, sizeof(T));
+      return obj;
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::recycle(T *obj)
+   {
+      // 析构
+      obj->~T();
+      _heapProbe.freed(obj, sizeof(T));
+      _recycle_slot(obj);
+   }
+
+   template <typename T, size_t S, size_t M>
    template <typename... Args>
-   T *ObjectPool<T, S>::animate(Args &&...args)
+   size_t ObjectPool<T, S, M>::animate_n(size_t n, T **out, const Args &...args)
+   {
+      ThreadCache *cache = _local();
+      LocalHeap &lh = cache->heap;
+      size_t got = 0;
+      size_t c = cache->count.load(std::memory_order_relaxed);
+      while (got < n && c > 0)
+         out[got++] = cache->slots[--c];
+      cache->count.store(c, std::memory_order_relaxed);
+
+      if (got < n)
+      {
+         std::lock_guard<std::mutex> lock(lh.mutex);
+         if (lh.hasRemote.load(std::memory_order_relaxed) && lh.hasRemote.exchange(false, std::memory_order_acquire))
+            _reclaim_remote_all(lh);
+         try
+         {
+            for (; got < n; ++got)
+            {
+               T *obj = _allocate_from_heap(lh);
+               if (obj == nullptr)
+                  break;
+               out[got] = obj;
+            }
+         }
+         catch (...)
+         {
+            // 弹匣中取出的槽也属于本地堆，一并归还
+            while (got > 0)
+               _return_to_heap(lh, out[--got]);
+            throw;
+         }
+         if (got < n && _exhaustPolicy.load(std::memory_order_relaxed) == PoolExhaustPolicy::THROW)
+         {
+            while (got > 0)
+               _return_to_heap(lh, out[--got]);
+            throw std::bad_alloc();
+         }
+      }
+
+      size_t i = 0;
+      try
+      {
+         for (; i < got; ++i)
+            new (out[i]) T(args...);
+      }
+      catch (...)
+      {
+         for (size_t j = 0; j < i; ++j)
+            out[j]->~T();
+         for (size_t j = 0; j < got; ++j)
+            _recycle_slot(out[j]);
+         throw;
+      }
+      for (i = 0; i < got; ++i)
+         _heapProbe.allocated(out[i], sizeof(T));
+      return got;
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::recycle_n(T *const *objs, size_t n)
+   {
+      for (size_t i = 0; i < n; ++i)
+      {
+         objs[i]->~T();
+         _heapProbe.freed(objs[i], sizeof(T));
+      }
+
+      auto *cache = static_cast<ThreadCache *>(memory::detail::t_thread_caches.find(_id));
+      if (cache == nullptr)
+      {
+         // 本线程没有在本池上分配过，所有对象都是远程回收
+         for (size_t i = 0; i < n; ++i)
+            _remote_free(_block_of_object(objs[i]), objs[i]);
+         return;
+      }
+      LocalHeap &lh = cache->heap;
+      std::unique_lock<std::mutex> lock(lh.mutex, std::defer_lock);
+      size_t c = cache->count.load(std::memory_order_relaxed);
+      for (size_t i = 0; i < n; ++i)
+      {
+         T *obj = objs[i];
+         Block *block = _block_of_object(obj);
+         if (block->heap.load(std::memory_order_relaxed) != &lh)
+         {
+            _remote_free(block, obj);
+            continue;
+         }
+         if (c < M)
+         {
+            cache->slots[c++] = obj;
+            continue;
+         }
+         // 弹匣已满，剩下的对象在同一次加锁内直接还给本地堆
+         if (!lock.owns_lock())
+         {
+            lock.lock();
+            if (lh.hasRemote.load(std::memory_order_relaxed) && lh.hasRemote.exchange(false, std::memory_order_acquire))
+               _reclaim_remote_all(lh);
+         }
+         _return_to_heap(lh, obj);
+      }
+      cache->count.store(c, std::memory_order_relaxed);
+      if (lock.owns_lock())
+         _shrink_locked(*cache);
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::flush_local_cache()
+   {
+      _drain(*_local(), 0);
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_recycle_slot(T *obj)
+   {
+      // 获取对象所在的块
+      Block *block = _block_of_object(obj);
+      // 只回收不分配的线程不需要创建缓存
+      auto *cache = static_cast<ThreadCache *>(memory::detail::t_thread_caches.find(_id));
+      // 块只会被所属线程移入它的本地堆；其他线程(trim)只会移出空块，而obj还在块中，
+      // 所以这里读到的值对本线程而言是确定的
+      if (cache == nullptr || block->heap.load(std::memory_order_relaxed) != &cache->heap)
+      {
+         _remote_free(block, obj);
+         return;
+      }
+      size_t n = cache->count.load(std::memory_order_relaxed);
+      if (n == M)
+      {
+         _drain(*cache, M / 2);
+         n = cache->count.load(std::memory_order_relaxed);
+      }
+      cache->slots[n] = obj;
+      cache->count.store(n + 1, std::memory_order_relaxed);
+   }
+
+   template <typename T, size_t S, size_t M>
+   typename ObjectPool<T, S, M>::ThreadCache *ObjectPool<T, S, M>::_local()
+   {
+      void *cache = memory::detail::t_thread_caches.find(_id);
+      if (cache != nullptr)
+         return static_cast<ThreadCache *>(cache);
+      return _local_slow();
+   }
+
+   template <typename T, size_t S, size_t M>
+   typename ObjectPool<T, S, M>::ThreadCache *ObjectPool<T, S, M>::_local_slow()
+   {
+      ThreadCache *cache;
+      {
+         std::lock_guard<std::mutex> lock(_cachesMutex);
+         if (!_idleCaches.empty())
+         {
+            // 复用已退出线程留下的缓存，其本地堆已经清空
+            cache = _idleCaches.back();
+            _idleCaches.pop_back();
+         }
+         else
+         {
+            _caches.push_back(std::make_unique<ThreadCache>());
+            cache = _caches.back().get();
+            for (size_t i = 0; i < localBinNum; ++i)
+               _blocklist_init_head(&cache->heap.lists[i]);
+         }
+      }
+      memory::detail::t_thread_caches.add({_id, this, cache, &ObjectPool::_release_local});
+      return cache;
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_release_local(void *owner, void *cache)
+   {
+      static_cast<ObjectPool *>(owner)->_retire(static_cast<ThreadCache *>(cache));
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_retire(ThreadCache *cache)
+   {
+      LocalHeap &lh = cache->heap;
+      {
+         std::lock_guard<std::mutex> localLock(lh.mutex);
+         size_t n = cache->count.load(std::memory_order_relaxed);
+         while (n > 0)
+            _return_to_heap(lh, cache->slots[--n]);
+         cache->count.store(0, std::memory_order_relaxed);
+         lh.hasRemote.store(false, std::memory_order_relaxed);
+         _reclaim_remote_all(lh);
+
+         // 所有块交给全局堆，有空位的放在前面，超出保留数量的空块直接释放
+         std::lock_guard<std::mutex> globalLock(_globalHeap.mutex);
+         for (size_t i = 0; i < localBinNum; ++i)
+         {
+            _for_each_block_safe(&lh.lists[i], [this](Block *b)
+                                 {
+                                    _blocklist_del(&b->list_node);
+                                    _release_to_global(b); });
+         }
+         lh.used = 0;
+         lh.total = 0;
+      }
+      std::lock_guard<std::mutex> lock(_cachesMutex);
+      _idleCaches.push_back(cache);
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_refill(ThreadCache &cache)
+   {
+      LocalHeap &lh = cache.heap;
+      std::lock_guard<std::mutex> lock(lh.mutex);
+      if (lh.hasRemote.load(std::memory_order_relaxed) && lh.hasRemote.exchange(false, std::memory_order_acquire))
+         _reclaim_remote_all(lh);
+      // 每装一个就更新计数，分配新块抛出异常时已装入的槽不会丢失
+      for (size_t n = cache.count.load(std::memory_order_relaxed); n < M / 2; ++n)
+      {
+         T *obj = _allocate_from_heap(lh);
+         if (obj == nullptr)
+            break;
+         cache.slots[n] = obj;
+         cache.count.store(n + 1, std::memory_order_relaxed);
+      }
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_drain(ThreadCache &cache, size_t keep)
+   {
+      LocalHeap &lh = cache.heap;
+      std::lock_guard<std::mutex> lock(lh.mutex);
+      if (lh.hasRemote.load(std::memory_order_relaxed) && lh.hasRemote.exchange(false, std::memory_order_acquire))
+         _reclaim_remote_all(lh);
+      size_t n = cache.count.load(std::memory_order_relaxed);
+      while (n > keep)
+         _return_to_heap(lh, cache.slots[--n]);
+      cache.count.store(n, std::memory_order_relaxed);
+      _shrink_locked(cache);
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_shrink_locked(ThreadCache &cache)
+   {
+      LocalHeap &lh = cache.heap;
+      size_t n = cache.count.load(std::memory_order_relaxed);
+      // 批量回收之后可能有多个空闲块，循环直到本地堆不再富余
+      while ((lh.used + ShrinkFactor * SlotNumPerBlock < lh.total) &&
+             (lh.used < ((BinNumPerBlock - 1) * lh.total) / BinNumPerBlock))
+      {
+         bool moved = false;
+         // 如果本地堆比较富余，那么将最空闲的块迁移到全局堆中
+         for (size_t i = 0; i < BinNumPerBlock; ++i)
+         {
+            if (!_blocklist_is_empty(&lh.lists[i]))
+            {
+               Block *b = _block_of(lh.lists[i].next);
+               // 弹匣中属于该块的槽先还给块，迁移后本地堆的计数才准确
+               for (size_t j = 0; j < n;)
+               {
+                  if (_block_of_object(cache.slots[j]) == b)
+                  {
+                     _return_to_heap(lh, cache.slots[j]);
+                     cache.slots[j] = cache.slots[--n];
+                  }
+                  else
+                  {
+                     ++j;
+                  }
+               }
+               cache.count.store(n, std::memory_order_relaxed);
+               assert(lh.used >= b->usedNum && lh.total >= SlotNumPerBlock);
+               lh.used -= b->usedNum;
+               lh.total -= SlotNumPerBlock;
+               _blocklist_del(&b->list_node);
+               std::lock_guard<std::mutex> globalLock(_globalHeap.mutex);
+               _release_to_global(b);
+               moved = true;
+               break;
+            }
+         }
+         if (!moved)
+            break;
+      }
+   }
+
+   template <typename T, size_t S, size_t M>
+   T *ObjectPool<T, S, M>::_allocate_from_heap(LocalHeap &lh)
    {
-      // 获取当线程对应的局部堆
-      LocalHeap &lh = _this_heap();
       Block *block{nullptr};
-      lh.mutex.lock();
       // 从最满的桶往下找有空位的块
       int f = static_cast<int>(BinNumPerBlock - 1);
       for (; f >= 0; --f)
       {
          if (!_blocklist_is_empty(&lh.lists[f]))
          {
-            block = _block_of(lh.lists[f]->next);
+            block = _block_of(lh.lists[f].next);
             break;
          }
       }
 
       if (f == -1)
       {
-         _globalHeap.mutex.lock();
-         // 在局部堆中没有找到可用的块，则从全局对中获取一个Block放到局部堆中
-         if (!_blocklist_is_empty(_globalHeap.head))
+         // 在局部堆中没有找到可用的块，则从全局堆中获取一个Block放到局部堆中
          {
-            block = _block_of(_globalHeap.head.next);
-            assert(block->usedNum < SlotNumPerBlock && block->heap == nullptr);
-            f = static_cast<int>(_bin(block->usedNum + 1));
-            block->heap = &lh;
-            _globalHeap.mutex.unlock();
-            lh.used += block->usedNum;
-            lh.total += SlotNumPerBlock;
+            std::lock_guard<std::mutex> globalLock(_globalHeap.mutex);
+            block = _acquire_global_block();
+            if (block != nullptr)
+            {
+               // 先发布新的所属堆再回收远程链表，与_remote_free中的顺序配对
+               block->heap.store(&lh);
+               _reclaim_remote(block);
+            }
          }
          // 全局堆中也没有可用块，新分配一个Block
-         else
+         if (block == nullptr)
          {
-            _globalHeap.mutex.unlock();
-            f = 0;
-            block = new Block();
-            block->heap = &lh;
-            block->index = 0;
-            block->usedNum = 0;
-            block->top = nullptr;
-            _blocklist_push_front(&block->list_node, lh.lists[f]);
-            lh.total += SlotNumPerBlock;
+            block = _new_block();
+            if (block == nullptr)
+               return nullptr;
+            block->heap.store(&lh);
          }
+         lh.used += block->usedNum;
+         lh.total += SlotNumPerBlock;
+         f = static_cast<int>(_bin(block->usedNum));
+         _blocklist_push_front(&block->list_node, &lh.lists[f]);
       }
       ++lh.used;
       ++block->usedNum;
       T *obj = _allocate(block);
-      int b = static_cast<int>(_bin(block->usedNum));
-      if (b != f)
-         _blocklist_move_front(&block->list_node, &lh.lists[b]);
-      lh.mutex.unlock();
-      new (obj) T(std::forward<Args>(args)...);
-      obj->_object_pool_block = block;
+      _rebin(lh, block, static_cast<size_t>(f));
       return obj;
    }
 
-   template <typename T, size_t S>
-   void ObjectPool<T, S>::recycle(T *obj)
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_return_to_heap(LocalHeap &lh, T *obj)
    {
-      // 获取对象所在的块
-      Block *block = obj->_object_pool_block;
-      // 析构
-      obj->~T();
-      // 由于block可能迁移到其他堆，需要循环重试
-      bool sync = false;
-      do
+      Block *block = _block_of_object(obj);
+      size_t f = _bin(block->usedNum);
+      _deallocate(block, obj);
+      block->usedNum = block->usedNum - 1;
+      lh.used = lh.used - 1;
+      _rebin(lh, block, f);
+   }
+
+   template <typename T, size_t S, size_t M>
+   typename ObjectPool<T, S, M>::Block *ObjectPool<T, S, M>::_acquire_global_block()
+   {
+      // 有空位的块在前，满块在后；满块可能因远程回收而重新有了空位
+      for (BlockList *p = _globalHeap.head.next; p != &_globalHeap.head; p = p->next)
       {
-         LocalHeap *lh = block->heap.load(std::memory_order_acquire);
-         // 对象所在块全局堆
-         if (lh == nullptr)
+         Block *b = _block_of(p);
+         _reclaim_remote(b);
+         if (b->usedNum < SlotNumPerBlock)
          {
-            std::lock_guard<std::mutex> globalLock(_globalHeap.mutex);
-            if (block->heap == lh)
-            {
-               sync = true;
-               _deallocate(block, obj);
-               block->usedNum = block->usedNum - 1;
-            }
-         }
-         else
-         {
-            std::lock_guard<std::mutex> localLock(lh->mutex);
-            if (block->heap == lh)
-            {
-               sync = true;
-               size_t f = _bin(block->usedNum);
-               _deallocate(block, obj);
-               block->usedNum = block->usedNum - 1;
-               lh->used = lh->used - 1;
-               size_t b = _bin(block->usedNum);
-               if (b != f)
-                  _blocklist_move_front(&block->list_node, &lh->lists[b]);
-               if ((lh->used + ShrinkFactor * SlotNumPerBlock < lh->total) &&
-                   (lh->used < ((BinNumPerBlock - 1) * lh->total) / BinNumPerBlock))
-               {
-                  // 如果本地堆比较富余，那么将最空闲的块迁移到全局堆中
-                  for (size_t i = 0; i < BinNumPerBlock; ++i)
-                  {
-                     if (!_blocklist_is_empty(&lh.lists[i]))
-                     {
-                        Block *b = _block_of(lh.lists[i]->next);
-                        assert(lh->used > b->usedNum && lh->total >= SlotNumPerBlock);
-                        lh->used -= b->usedNum;
-                        lh->total -= SlotNumPerBlock;
-                        b->heap = nullptr;
-                        std::lock_guard<std::mutex> globalLock(_globalHeap.mutex);
-                        _blocklist_move_front()(&b->list_node, &_globalHeap.head);
-                        break;
-                     }
-                  }
-               }
-            }
+            _unlink_global(b);
+            return b;
          }
-      } while (!sync);
+      }
+      return nullptr;
    }
-   // 获取当前线程对应的本地堆
-   template <typename T, size_t S>
-   typename ObjectPool<T, S>::LocalHeap &ObjectPool<T, S>::_this_heap()
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_rebin(LocalHeap &lh, Block *block, size_t f)
    {
-      // 不用thread_local，避免池多次创建销毁导致TLS悬挂
-      // 用线程id哈希选本地堆
-      return _lheaps[std::hash<std::thread::id>()(std::this_thread::get_id()) & _headpMask];
+      size_t b = _bin(block->usedNum);
+      if (b != f)
+         _blocklist_move_front(&block->list_node, &lh.lists[b]);
    }
 
-   // 计算大于等于n的最小2的幂
-   template <typename T, size_t S>
-   constexpr unsigned ObjectPool<T, S>::_next_pow2(unsigned n) const
+   template <typename T, size_t S, size_t M>
+   size_t ObjectPool<T, S, M>::_reclaim_remote(Block *block)
    {
-
-      if (n == 0)
-         return 1;
-      n--;
-      n |= n >> 1;
-      n |= n >> 2;
-      n |= n >> 4;
-      n |= n >> 8;
-      n |= n >> 16;
-      n++;
+      if (block->remoteTop.load() == nullptr)
+         return 0;
+      T *obj = block->remoteTop.exchange(nullptr);
+      size_t n = 0;
+      while (obj != nullptr)
+      {
+         T *next = *reinterpret_cast<T **>(obj);
+         _deallocate(block, obj);
+         obj = next;
+         ++n;
+      }
+      block->usedNum -= n;
+      block->remoteNum.fetch_sub(n, std::memory_order_relaxed);
       return n;
    }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_reclaim_remote_all(LocalHeap &lh)
+   {
+      // 回收后块只会移到编号更小的桶，按桶号递增遍历不会漏掉块
+      for (size_t i = 0; i < localBinNum; ++i)
+      {
+         _for_each_block_safe(&lh.lists[i], [&](Block *b)
+                              {
+                                 size_t f = _bin(b->usedNum);
+                                 size_t n = _reclaim_remote(b);
+                                 if (n != 0)
+                                 {
+                                    lh.used -= n;
+                                    _rebin(lh, b, f);
+                                 } });
+      }
+   }
+
+   template <typename T, size_t S, size_t M>
+   void ObjectPool<T, S, M>::_remote_free(Block *block, T *obj)
+   {
+      // 入链之后对象可能立刻被回收，块随之变空；在退出前钉住块，trim和_release_to_global不会释放它
+      block->remoteRefs.fetch_add(1);
+      // 先计数再入链，统计时远程数量不会小于链表长度
+      block->remoteNum.fetch_add(1, std::memory_order_relaxed);
+      T *top = block->remoteTop.load(std::memory_order_relaxed);
+      do
+      {
+         *reinterpret_cast<T **>(obj) = top;
+      } while (!block->remoteTop.compare_exchange_weak(top, obj, std::memory_order_seq_cst, std::memory_order_relaxed));
+      // 入链之后再读所属堆：要么所有者接管块时能回收到这个对象，要么这里能看到新的所属堆
+      LocalHeap *owner = block->heap.load();
+      if (owner != nullptr)
+         owner->hasRemote.store(true, std::memory_order_release);
+      block->remoteRefs.fetch_sub(1, std::memory_order_release);
+   }
 }
-#endif
\ No newline at end of file
+#endif // PLIB_CORE_UTILS_OBJECT_POOL_HPP
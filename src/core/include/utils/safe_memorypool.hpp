@@ -1,5 +1,8 @@
-#ifndef __MEMORY_POOL_H__
-#define __MEMORY_POOL_H__
+#ifndef PLIB_CORE_UTILS_SAFE_MEMORYPOOL_HPP_
+#define PLIB_CORE_UTILS_SAFE_MEMORYPOOL_HPP_
+
+// 新代码请使用 memory/concurrent_memorypool.hpp 中的 plib::core::memory::ConcurrentMemoryPool，
+// 它的分配/释放走线程私有缓存，不会在这里的自旋锁上争用
 
 #include <climits>
 #include <cstddef>
@@ -10,6 +13,9 @@
 #include <iostream>
 #include <thread>
 #include <cassert>
+#include <new>
+#include "plib_macros.hpp"
+#include "memory/block_provider.hpp"
 
 // Simulate a kernel level spin lock.
 template <class T>
@@ -25,7 +31,7 @@ public:
     {
         while (lock_obj.test_and_set(std::memory_order_acquire))
         {
-            asm volatile("pause\n" : : : "memory");
+            CPU_PAUSE();
         }
     }
     void unlock()
@@ -49,6 +55,8 @@ public:
 
     // Constructor / destructor
     MemoryPool() noexcept;
+    // 内存块从provider申请，provider必须比池活得更久
+    explicit MemoryPool(plib::core::memory::BlockProvider *provider) noexcept;
     ~MemoryPool() noexcept;
     MemoryPool(MemoryPool &&memoryPool) noexcept;
 
@@ -99,8 +107,13 @@ private:
     {
         char *buffer = nullptr;
         allocated_block_t *next = nullptr;
+        plib::core::memory::BlockProvider *provider = nullptr;
 
-        ~allocated_block_t() { operator delete(buffer); }
+        ~allocated_block_t()
+        {
+            if (buffer != nullptr)
+                provider->deallocate(buffer, block_size * sizeof(slot_t), alignof(slot_t));
+        }
     };
 
     // Private variables
@@ -108,6 +121,7 @@ private:
     uint64_t m_max_size = 0;
     slot_t *m_last_slot = nullptr;
     allocated_block_t *m_allocated_block_head = nullptr;
+    plib::core::memory::BlockProvider *m_provider = plib::core::memory::default_block_provider();
     std::atomic<slot_head_t> m_free;
     std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
     std::chrono::system_clock::time_point m_last_allocate_block_time{std::chrono::system_clock::now()};
@@ -132,6 +146,9 @@ MemoryPool<T, block_size>::pad_pointer(data_pointer p, size_type align) const no
 template <typename T, std::size_t block_size>
 MemoryPool<T, block_size>::MemoryPool() noexcept {}
 
+template <typename T, std::size_t block_size>
+MemoryPool<T, block_size>::MemoryPool(plib::core::memory::BlockProvider *provider) noexcept : m_provider(provider) {}
+
 template <typename T, std::size_t block_size>
 MemoryPool<T, block_size>::~MemoryPool() noexcept
 {
@@ -147,7 +164,7 @@ MemoryPool<T, block_size>::~MemoryPool() noexcept
 
 template <typename T, std::size_t block_size>
 MemoryPool<T, block_size>::MemoryPool(MemoryPool &&mp) noexcept : m_max_size(mp.m_max_size), m_last_slot(nullptr), m_free(mp.m_free),
-                                                                  m_lock(mp.m_lock), m_allocated_block_head(nullptr)
+                                                                  m_lock(mp.m_lock), m_allocated_block_head(nullptr), m_provider(mp.m_provider)
 {
 
     std::swap(m_last_slot, mp.m_last_slot);
@@ -166,6 +183,7 @@ MemoryPool<T, block_size>::operator=(MemoryPool &&mp)
 
     m_allocated_block_head = mp.m_allocated_block_head;
     mp.m_allocated_block_head = nullptr;
+    m_provider = mp.m_provider;
 
     m_max_size = mp.m_max_size;
     mp.m_max_size = 0;
@@ -290,9 +308,10 @@ MemoryPool<T, block_size>::allocate_block()
 
     allocated_block_t *new_block = new allocated_block_t();
     new_block->next = m_allocated_block_head;
+    new_block->provider = m_provider;
     m_allocated_block_head = new_block;
 
-    new_block->buffer = reinterpret_cast<char *>(operator new(block_size * sizeof(slot_t)));
+    new_block->buffer = reinterpret_cast<char *>(m_provider->allocate(block_size * sizeof(slot_t), alignof(slot_t)));
 
     // Pad block body to satisfy the alignment requirements for elements
     char *body = new_block->buffer + sizeof(slot_t *);
@@ -333,4 +352,4 @@ MemoryPool<T, block_size>::allocate_block()
 
     return true;
 }
-#endif
\ No newline at end of file
+#endif // PLIB_CORE_UTILS_SAFE_MEMORYPOOL_HPP_
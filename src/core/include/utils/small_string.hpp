@@ -0,0 +1,395 @@
+/**
+ * @Author: running-code-pp 3320996652@qq.com
+ * @Date: 2026-10-21 19:12:08
+ * @LastEditors: running-code-pp 3320996652@qq.com
+ * @LastEditTime: 2026-10-21 19:12:08
+ * @FilePath: \plib\src\core\include\utils\small_string.hpp
+ * @Description: 内联容量可配置的短字符串，存储直接复用SmallVector<char>的内联缓冲和增长策略
+ * @Copyright: Copyright (c) 2026 by ${git_name}, All Rights Reserved.
+ */
+#ifndef PLIB_CORE_UTILS_SMALL_STRING_HPP_
+#define PLIB_CORE_UTILS_SMALL_STRING_HPP_
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "utils/small_vector.hpp"
+
+namespace plib::core::utils
+{
+    /**
+     * @brief: 不超过N个字符时完全放在对象内部，超过后按SmallVector的方式(容量翻倍)转到堆上
+     * libstdc++的std::string只能内联15个字符，日志字段、配置键、JSON成员名大多在32字节以内，
+     * 用small_string<32>可以省掉这些热路径上的堆分配。
+     * 始终以'\0'结尾，c_str()可以直接交给C接口;可以隐式转换为std::string_view。
+     * 堆缓冲区默认走malloc/realloc，也可以传入std::pmr::memory_resource。
+     */
+    template <unsigned N = 32>
+    class small_string
+    {
+    public:
+        using traits_type = std::char_traits<char>;
+        using value_type = char;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = char &;
+        using const_reference = const char &;
+        using pointer = char *;
+        using const_pointer = const char *;
+        using iterator = char *;
+        using const_iterator = const char *;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        static constexpr size_type npos = std::string_view::npos;
+        // 不分配堆内存时能容纳的最大字符数
+        static constexpr size_type inline_capacity = N;
+
+        small_string() { _buf.push_back('\0'); }
+        explicit small_string(std::pmr::memory_resource *resource) : _buf(resource) { _buf.push_back('\0'); }
+        small_string(const char *s) : small_string(std::string_view(s)) {}
+        explicit small_string(std::string_view sv) : small_string() { append(sv); }
+        small_string(std::string_view sv, std::pmr::memory_resource *resource) : small_string(resource) { append(sv); }
+        small_string(size_type count, char ch) : small_string() { append(count, ch); }
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        small_string(InputIt first, InputIt last) : small_string()
+        {
+            append(first, last);
+        }
+        small_string(std::initializer_list<char> list) : small_string(list.begin(), list.end()) {}
+
+        small_string(const small_string &other) = default;
+        small_string(small_string &&other) noexcept : _buf(std::move(other._buf))
+        {
+            other.reset_terminator();
+        }
+        template <unsigned M>
+        explicit small_string(const small_string<M> &other) : small_string(std::string_view(other))
+        {
+        }
+
+        small_string &operator=(const small_string &other)
+        {
+            _buf = other._buf;
+            return *this;
+        }
+        // memory_resource相同时直接接管缓冲区或在已有容量内拷贝，不会分配;
+        // 不同时要逐字节拷贝，只有需要扩容且分配失败时才会因noexcept终止程序
+        small_string &operator=(small_string &&other) noexcept
+        {
+            if (this != &other)
+            {
+                _buf = std::move(other._buf);
+                other.reset_terminator();
+            }
+            return *this;
+        }
+        small_string &operator=(std::string_view sv) { return assign(sv); }
+        small_string &operator=(const char *s) { return assign(std::string_view(s)); }
+        small_string &operator=(char ch) { return assign(1, ch); }
+
+        small_string &assign(std::string_view sv)
+        {
+            // sv可能指向自身，先按长度截断再追加会读到已失效的内容，单独处理
+            if (sv.data() >= data() && sv.data() <= data() + size())
+            {
+                const auto offset = static_cast<size_type>(sv.data() - data());
+                std::memmove(data(), data() + offset, sv.size());
+                set_length(sv.size());
+                return *this;
+            }
+            set_length(0);
+            return append(sv);
+        }
+        small_string &assign(size_type count, char ch)
+        {
+            set_length(0);
+            return append(count, ch);
+        }
+
+        // 迭代器
+        iterator begin() noexcept { return _buf.begin(); }
+        const_iterator begin() const noexcept { return _buf.begin(); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        iterator end() noexcept { return _buf.end() - 1; }
+        const_iterator end() const noexcept { return _buf.end() - 1; }
+        const_iterator cend() const noexcept { return end(); }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+        // 容量
+        size_type size() const noexcept { return _buf.size() - 1; }
+        size_type length() const noexcept { return size(); }
+        bool empty() const noexcept { return size() == 0; }
+        size_type capacity() const noexcept { return _buf.capacity() - 1; }
+        size_type max_size() const noexcept { return _buf.max_size() - 1; }
+        // 字符串仍放在对象内部的缓冲中
+        bool is_inline() const noexcept { return _buf.capacity() == N + 1; }
+        void reserve(size_type count) { _buf.reserve(count + 1); }
+        void shrink_to_fit() noexcept {}
+        std::pmr::memory_resource *get_resource() const noexcept { return _buf.get_resource(); }
+
+        // 元素访问
+        reference operator[](size_type pos) noexcept { return _buf[pos]; }
+        const_reference operator[](size_type pos) const noexcept { return _buf[pos]; }
+        reference at(size_type pos)
+        {
+            check_pos(pos, "small_string::at");
+            return _buf[pos];
+        }
+        const_reference at(size_type pos) const
+        {
+            check_pos(pos, "small_string::at");
+            return _buf[pos];
+        }
+        reference front() noexcept { return _buf[0]; }
+        const_reference front() const noexcept { return _buf[0]; }
+        reference back() noexcept { return _buf[size() - 1]; }
+        const_reference back() const noexcept { return _buf[size() - 1]; }
+        char *data() noexcept { return _buf.data(); }
+        const char *data() const noexcept { return _buf.data(); }
+        const char *c_str() const noexcept { return _buf.data(); }
+
+        operator std::string_view() const noexcept { return std::string_view(data(), size()); }
+        std::string_view view() const noexcept { return std::string_view(data(), size()); }
+        std::string str() const { return std::string(data(), size()); }
+
+        // 修改
+        void clear() noexcept { set_length(0); }
+
+        void push_back(char ch)
+        {
+            const size_type n = size();
+            reserve_for(n + 1);
+            data()[n] = ch;
+            set_length(n + 1);
+        }
+        void pop_back() noexcept { set_length(size() - 1); }
+
+        small_string &append(std::string_view sv)
+        {
+            const size_type n = size();
+            // sv可能指向自身，扩容前记下偏移
+            const char *src = sv.data();
+            const bool aliased = src >= data() && src <= data() + n;
+            const auto offset = aliased ? static_cast<size_type>(src - data()) : 0;
+            reserve_for(n + sv.size());
+            std::memcpy(data() + n, aliased ? data() + offset : src, sv.size());
+            set_length(n + sv.size());
+            return *this;
+        }
+        small_string &append(const char *s, size_type count) { return append(std::string_view(s, count)); }
+        small_string &append(size_type count, char ch)
+        {
+            const size_type n = size();
+            reserve_for(n + count);
+            std::memset(data() + n, ch, count);
+            set_length(n + count);
+            return *this;
+        }
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+        small_string &append(InputIt first, InputIt last)
+        {
+            using category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr (std::contiguous_iterator<InputIt> && std::is_same_v<std::iter_value_t<InputIt>, char>)
+            {
+                // 连续区间交给string_view版本，由它处理指向自身的情况
+                return append(std::string_view(std::to_address(first), static_cast<size_type>(last - first)));
+            }
+            else if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>)
+            {
+                const size_type n = size();
+                const auto count = static_cast<size_type>(std::distance(first, last));
+                if (n + count > capacity())
+                {
+                    // 迭代器可能指向自身，原地扩容会使其失效，在新缓冲区里拼好再接管
+                    small_string grown(get_resource());
+                    grown.reserve_for(n + count);
+                    std::memcpy(grown.data(), data(), n);
+                    std::copy(first, last, grown.data() + n);
+                    grown.set_length(n + count);
+                    return *this = std::move(grown);
+                }
+                set_length(static_cast<size_type>(std::copy(first, last, data() + n) - data()));
+            }
+            else
+            {
+                for (; first != last; ++first)
+                    push_back(*first);
+            }
+            return *this;
+        }
+
+        small_string &operator+=(std::string_view sv) { return append(sv); }
+        small_string &operator+=(const char *s) { return append(std::string_view(s)); }
+        small_string &operator+=(char ch)
+        {
+            push_back(ch);
+            return *this;
+        }
+
+        small_string &insert(size_type pos, std::string_view sv)
+        {
+            check_pos(pos, "small_string::insert");
+            if (sv.data() >= data() && sv.data() <= data() + size())
+            {
+                // 插入自身的一部分时先拷贝出来
+                const small_string copy(sv);
+                return insert(pos, copy.view());
+            }
+            const size_type n = size();
+            reserve_for(n + sv.size());
+            std::memmove(data() + pos + sv.size(), data() + pos, n - pos);
+            std::memcpy(data() + pos, sv.data(), sv.size());
+            set_length(n + sv.size());
+            return *this;
+        }
+        small_string &erase(size_type pos = 0, size_type count = npos)
+        {
+            check_pos(pos, "small_string::erase");
+            count = std::min(count, size() - pos);
+            std::memmove(data() + pos, data() + pos + count, size() - pos - count);
+            set_length(size() - count);
+            return *this;
+        }
+        iterator erase(const_iterator it)
+        {
+            const auto pos = static_cast<size_type>(it - begin());
+            erase(pos, 1);
+            return begin() + pos;
+        }
+        small_string &replace(size_type pos, size_type count, std::string_view sv)
+        {
+            check_pos(pos, "small_string::replace");
+            count = std::min(count, size() - pos);
+            if (sv.data() >= data() && sv.data() <= data() + size())
+            {
+                const small_string copy(sv);
+                return replace(pos, count, copy.view());
+            }
+            const size_type n = size();
+            const size_type tail = n - pos - count;
+            reserve_for(n - count + sv.size());
+            std::memmove(data() + pos + sv.size(), data() + pos + count, tail);
+            std::memcpy(data() + pos, sv.data(), sv.size());
+            set_length(n - count + sv.size());
+            return *this;
+        }
+
+        void resize(size_type count, char ch = '\0')
+        {
+            const size_type n = size();
+            if (count > n)
+            {
+                append(count - n, ch);
+                return;
+            }
+            set_length(count);
+        }
+
+        void swap(small_string &other) { _buf.swap(other._buf); }
+
+        // 查找与比较都委托给std::string_view
+        small_string substr(size_type pos = 0, size_type count = npos) const
+        {
+            check_pos(pos, "small_string::substr");
+            return small_string(view().substr(pos, count));
+        }
+        size_type find(std::string_view sv, size_type pos = 0) const noexcept { return view().find(sv, pos); }
+        size_type find(char ch, size_type pos = 0) const noexcept { return view().find(ch, pos); }
+        size_type rfind(std::string_view sv, size_type pos = npos) const noexcept { return view().rfind(sv, pos); }
+        size_type rfind(char ch, size_type pos = npos) const noexcept { return view().rfind(ch, pos); }
+        size_type find_first_of(std::string_view sv, size_type pos = 0) const noexcept { return view().find_first_of(sv, pos); }
+        size_type find_last_of(std::string_view sv, size_type pos = npos) const noexcept { return view().find_last_of(sv, pos); }
+        size_type find_first_not_of(std::string_view sv, size_type pos = 0) const noexcept { return view().find_first_not_of(sv, pos); }
+        size_type find_last_not_of(std::string_view sv, size_type pos = npos) const noexcept { return view().find_last_not_of(sv, pos); }
+        bool starts_with(std::string_view sv) const noexcept { return view().starts_with(sv); }
+        bool ends_with(std::string_view sv) const noexcept { return view().ends_with(sv); }
+        bool contains(std::string_view sv) const noexcept { return view().find(sv) != npos; }
+        int compare(std::string_view sv) const noexcept { return view().compare(sv); }
+
+        friend bool operator==(const small_string &a, const small_string &b) noexcept { return a.view() == b.view(); }
+        friend bool operator==(const small_string &a, std::string_view b) noexcept { return a.view() == b; }
+        friend bool operator==(const small_string &a, const char *b) noexcept { return a.view() == b; }
+        friend std::strong_ordering operator<=>(const small_string &a, const small_string &b) noexcept { return a.view() <=> b.view(); }
+        friend std::strong_ordering operator<=>(const small_string &a, std::string_view b) noexcept { return a.view() <=> b; }
+        friend std::strong_ordering operator<=>(const small_string &a, const char *b) noexcept { return a.view() <=> std::string_view(b); }
+
+        friend small_string operator+(const small_string &a, std::string_view b)
+        {
+            small_string result;
+            result.reserve(a.size() + b.size());
+            result.append(a.view()).append(b);
+            return result;
+        }
+        friend small_string operator+(small_string &&a, std::string_view b)
+        {
+            a.append(b);
+            return std::move(a);
+        }
+
+        friend std::ostream &operator<<(std::ostream &os, const small_string &s)
+        {
+            return os << s.view();
+        }
+
+    private:
+        // 保证能放下count个字符和结尾的'\0'
+        void reserve_for(size_type count) { _buf.reserve(count + 1); }
+
+        // 调整长度并补上结尾的'\0'，调用前容量必须足够
+        void set_length(size_type count) noexcept
+        {
+            _buf.set_size(count + 1);
+            _buf[count] = '\0';
+        }
+
+        // 被移走后SmallVector是空的，补回结尾的'\0'
+        void reset_terminator() noexcept
+        {
+            if (_buf.empty())
+                _buf.push_back('\0');
+        }
+
+        void check_pos(size_type pos, const char *what) const
+        {
+            if (pos > size())
+                throw std::out_of_range(what);
+        }
+
+        SmallVector<char, N + 1> _buf;
+    };
+
+    template <unsigned N>
+    inline void swap(small_string<N> &a, small_string<N> &b)
+    {
+        a.swap(b);
+    }
+} // namespace plib::core::utils
+
+namespace std
+{
+    // 与std::string_view的哈希一致，可以在透明哈希表中混用
+    template <unsigned N>
+    struct hash<plib::core::utils::small_string<N>>
+    {
+        size_t operator()(const plib::core::utils::small_string<N> &s) const noexcept
+        {
+            return hash<string_view>()(s.view());
+        }
+    };
+} // namespace std
+
+#endif // PLIB_CORE_UTILS_SMALL_STRING_HPP_
@@ -11,11 +11,15 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <memory_resource>
+#include "plib_macros.hpp"
+#include "type_traits.hpp"
 namespace plib::core::utils
 {
 
@@ -60,6 +64,8 @@ namespace plib::core::utils
     {
     protected:
         void *BeginX, *EndX, *CapacityX;
+        // 堆上缓冲区的来源，nullptr表示malloc/free(例如传入memory::ArenaResource把溢出部分放进Arena)
+        std::pmr::memory_resource *Resource = nullptr;
 
     protected:
         SmallVectorBase(void *FirstEl, size_t Size)
@@ -67,6 +73,21 @@ namespace plib::core::utils
         {
         }
 
+        void *allocate_bytes(size_t Bytes)
+        {
+            if (Resource != nullptr)
+                return Resource->allocate(Bytes, alignof(std::max_align_t));
+            return std::malloc(Bytes);
+        }
+
+        void deallocate_bytes(void *P, size_t Bytes)
+        {
+            if (Resource != nullptr)
+                Resource->deallocate(P, Bytes, alignof(std::max_align_t));
+            else
+                std::free(P);
+        }
+
         /// 这是grow()方法的实现，仅适用于POD类型数据，且放在类外以减少代码重复。
         void grow_pod(void *FirstEl, size_t MinSizeInBytes, size_t TSize)
         {
@@ -78,13 +99,16 @@ namespace plib::core::utils
             }
 
             void *NewElts;
-            if (BeginX == FirstEl)
+            if (BeginX == FirstEl || Resource != nullptr)
             {
-                NewElts = malloc(NewCapacityInBytes);
+                // memory_resource没有realloc，统一走分配+拷贝
+                NewElts = allocate_bytes(NewCapacityInBytes);
 
                 // Copy the elements over.  No need to run dtors on PODs.
 
                 memcpy(NewElts, this->BeginX, CurSizeBytes);
+                if (BeginX != FirstEl)
+                    deallocate_bytes(this->BeginX, capacity_in_bytes());
             }
             else
             {
@@ -112,6 +136,9 @@ namespace plib::core::utils
         }
 
         bool empty() const { return BeginX == EndX; }
+
+        /// 堆缓冲区的memory_resource，nullptr表示malloc/free
+        std::pmr::memory_resource *get_resource() const { return Resource; }
     };
 
     /**
@@ -299,7 +326,7 @@ namespace plib::core::utils
     public:
         void push_back(const T &Elt)
         {
-            if (TF_UNLIKELY(this->EndX >= this->CapacityX))
+            P_UNLIKELY if (this->EndX >= this->CapacityX)
                 this->grow();
             ::new ((void *)this->end()) T(Elt);
             this->setEnd(this->end() + 1);
@@ -307,7 +334,7 @@ namespace plib::core::utils
 
         void push_back(T &&Elt)
         {
-            if (TF_UNLIKELY(this->EndX >= this->CapacityX))
+            P_UNLIKELY if (this->EndX >= this->CapacityX)
                 this->grow();
             ::new ((void *)this->end()) T(::std::move(Elt));
             this->setEnd(this->end() + 1);
@@ -332,17 +359,26 @@ namespace plib::core::utils
         size_t NewCapacity = size_t(detail::NextCapacity(CurCapacity + 2));
         if (NewCapacity < MinSize)
             NewCapacity = MinSize;
-        T *NewElts = static_cast<T *>(std::malloc(NewCapacity * sizeof(T)));
+        T *NewElts = static_cast<T *>(this->allocate_bytes(NewCapacity * sizeof(T)));
 
-        // Move the elements over.
-        this->uninitialized_move(this->begin(), this->end(), NewElts);
+        if constexpr (type::is_trivially_relocatable_v<T>)
+        {
+            // 可平凡重定位的类型直接按字节搬过去，旧位置不再析构
+            if (CurSize != 0)
+                memcpy((void *)NewElts, (const void *)this->begin(), CurSize * sizeof(T));
+        }
+        else
+        {
+            // Move the elements over.
+            this->uninitialized_move(this->begin(), this->end(), NewElts);
 
-        // Destroy the original elements.
-        destroy_range(this->begin(), this->end());
+            // Destroy the original elements.
+            destroy_range(this->begin(), this->end());
+        }
 
         // If this wasn't grown from the inline copy, deallocate the old space.
         if (!this->isSmall())
-            std::free(this->begin());
+            this->deallocate_bytes(this->begin(), CurCapacity * sizeof(T));
 
         this->setEnd(NewElts + CurSize);
         this->BeginX = NewElts;
@@ -405,7 +441,7 @@ namespace plib::core::utils
     public:
         void push_back(const T &Elt)
         {
-            if (TF_UNLIKELY(this->EndX >= this->CapacityX))
+            P_UNLIKELY if (this->EndX >= this->CapacityX)
                 this->grow();
             memcpy(this->end(), &Elt, sizeof(T));
             this->setEnd(this->end() + 1);
@@ -427,6 +463,29 @@ namespace plib::core::utils
 
         SmallVectorImpl(const SmallVectorImpl &) = delete;
 
+        /// POD已经走memcpy分支，这里只标记需要按字节搬移的非POD类型
+        static constexpr bool Relocatable = !IsPod<T>::value && type::is_trivially_relocatable_v<T>;
+
+        /// 把[I, end())按字节整体后移Num个位置，再由Construct(I, Num)构造空出来的位置
+        /// Construct抛异常时把尾部搬回原处，vector保持插入前的状态
+        template <typename Fn>
+        T *insert_relocated(T *I, size_t Num, Fn &&Construct)
+        {
+            T *OldEnd = this->end();
+            memmove((void *)(I + Num), (const void *)I, (OldEnd - I) * sizeof(T));
+            try
+            {
+                Construct(I, Num);
+            }
+            catch (...)
+            {
+                memmove((void *)I, (const void *)(I + Num), (OldEnd - I) * sizeof(T));
+                throw;
+            }
+            this->setEnd(OldEnd + Num);
+            return I;
+        }
+
     public:
         typedef typename SuperClass::iterator iterator;
         typedef typename SuperClass::const_iterator const_iterator;
@@ -447,7 +506,7 @@ namespace plib::core::utils
 
             // If this wasn't grown from the inline copy, deallocate the old space.
             if (!this->isSmall())
-                std::free(this->begin());
+                this->deallocate_bytes(this->begin(), this->capacity_in_bytes());
         }
 
         void clear()
@@ -559,6 +618,13 @@ namespace plib::core::utils
             // assert(I < this->end() && "Erasing at past-the-end iterator.");
 
             iterator N = I;
+            if constexpr (Relocatable)
+            {
+                I->~T();
+                memmove((void *)I, (const void *)(I + 1), (this->end() - I - 1) * sizeof(T));
+                this->setEnd(this->end() - 1);
+                return (N);
+            }
             // Shift all elts down one.
             std::move(I + 1, this->end(), I);
             // Drop the last elt.
@@ -577,6 +643,13 @@ namespace plib::core::utils
             // assert(E <= this->end() && "Trying to erase past the end.");
 
             iterator N = S;
+            if constexpr (Relocatable)
+            {
+                this->destroy_range(S, E);
+                memmove((void *)S, (const void *)E, (this->end() - E) * sizeof(T));
+                this->setEnd(this->end() - (E - S));
+                return (N);
+            }
             // Shift all elts down.
             iterator I = std::move(E, this->end(), S);
             // Drop the last elts.
@@ -603,6 +676,15 @@ namespace plib::core::utils
                 I = this->begin() + EltNo;
             }
 
+            if constexpr (Relocatable)
+            {
+                // 先移动到旁边的缓冲区：Elt可能就在尾部，后移之后地址会变
+                alignas(T) unsigned char Slot[sizeof(T)];
+                ::new ((void *)Slot) T(::std::move(Elt));
+                return insert_relocated(I, 1, [&](T *Dest, size_t)
+                                        { memcpy((void *)Dest, Slot, sizeof(T)); });
+            }
+
             ::new ((void *)this->end()) T(::std::move(this->back()));
             // Push everything else over.
             std::move_backward(I, this->end() - 1, this->end());
@@ -635,6 +717,13 @@ namespace plib::core::utils
                 this->grow();
                 I = this->begin() + EltNo;
             }
+            if constexpr (Relocatable)
+            {
+                alignas(T) unsigned char Slot[sizeof(T)];
+                ::new ((void *)Slot) T(Elt);
+                return insert_relocated(I, 1, [&](T *Dest, size_t)
+                                        { memcpy((void *)Dest, Slot, sizeof(T)); });
+            }
             ::new ((void *)this->end()) T(std::move(this->back()));
             // Push everything else over.
             std::move_backward(I, this->end() - 1, this->end());
@@ -670,6 +759,16 @@ namespace plib::core::utils
             // Uninvalidate the iterator.
             I = this->begin() + InsertElt;
 
+            if constexpr (Relocatable)
+            {
+                // Elt在被后移的尾部时跟着一起后移
+                const T *EltPtr = &Elt;
+                if (I <= EltPtr && EltPtr < this->end())
+                    EltPtr += NumToInsert;
+                return insert_relocated(I, NumToInsert, [&](T *Dest, size_t Num)
+                                        { std::uninitialized_fill_n(Dest, Num, *EltPtr); });
+            }
+
             // If there are more elements between the insertion point and the end of the
             // range than there are being inserted, we can use a simple approach to
             // insertion.  Since we already reserved space, we know that this won't
@@ -727,6 +826,12 @@ namespace plib::core::utils
             // Uninvalidate the iterator.
             I = this->begin() + InsertElt;
 
+            if constexpr (Relocatable)
+            {
+                return insert_relocated(I, NumToInsert, [&](T *Dest, size_t)
+                                        { std::uninitialized_copy(From, To, Dest); });
+            }
+
             // If there are more elements between the insertion point and the end of the
             // range than there are being inserted, we can use a simple approach to
             // insertion.  Since we already reserved space, we know that this won't
@@ -774,7 +879,7 @@ namespace plib::core::utils
         template <typename... ArgTypes>
         void emplace_back(ArgTypes &&...Args)
         {
-            if (TF_UNLIKELY(this->EndX >= this->CapacityX))
+            P_UNLIKELY if (this->EndX >= this->CapacityX)
                 this->grow();
             ::new ((void *)this->end()) T(std::forward<ArgTypes>(Args)...);
             this->setEnd(this->end() + 1);
@@ -823,8 +928,9 @@ namespace plib::core::utils
         if (this == &RHS)
             return;
 
-        // We can only avoid copying elements if neither vector is small.
-        if (!this->isSmall() && !RHS.isSmall())
+        // We can only avoid copying elements if neither vector is small
+        // and both buffers come from the same memory resource.
+        if (!this->isSmall() && !RHS.isSmall() && this->Resource == RHS.Resource)
         {
             std::swap(this->BeginX, RHS.BeginX);
             std::swap(this->EndX, RHS.EndX);
@@ -924,12 +1030,13 @@ namespace plib::core::utils
         if (this == &RHS)
             return *this;
 
-        // If the RHS isn't small, clear this vector and then steal its buffer.
-        if (!RHS.isSmall())
+        // If the RHS isn't small and shares our memory resource, clear this vector
+        // and then steal its buffer.
+        if (!RHS.isSmall() && this->Resource == RHS.Resource)
         {
             this->destroy_range(this->begin(), this->end());
             if (!this->isSmall())
-                std::free(this->begin());
+                this->deallocate_bytes(this->begin(), this->capacity_in_bytes());
             this->BeginX = RHS.BeginX;
             this->EndX = RHS.EndX;
             this->CapacityX = RHS.CapacityX;
@@ -1046,6 +1153,15 @@ namespace plib::core::utils
         {
         }
 
+        /**
+        @brief constructs an empty vector whose heap buffer comes from @c R
+               (e.g. a memory::ArenaResource); the inline buffer is unaffected
+        */
+        explicit SmallVector(std::pmr::memory_resource *R) : SmallVectorImpl<T>(N)
+        {
+            this->Resource = R;
+        }
+
         /**
         @brief constructs a vector with @c Size copies of elements with value @c value
         */
@@ -1079,6 +1195,15 @@ namespace plib::core::utils
             this->assign(IL);
         }
 
+        /**
+        @brief constructs a vector with the contents of @c IL, heap buffer from @c R
+        */
+        SmallVector(std::initializer_list<T> IL, std::pmr::memory_resource *R) : SmallVectorImpl<T>(N)
+        {
+            this->Resource = R;
+            this->assign(IL);
+        }
+
         /**
         @brief constructs the vector with the copy of the contents of @c RHS
         */
@@ -1093,6 +1218,8 @@ namespace plib::core::utils
         */
         SmallVector(SmallVector &&RHS) : SmallVectorImpl<T>(N)
         {
+            // 与std::pmr容器一致，移动构造沿用源对象的memory_resource
+            this->Resource = RHS.Resource;
             if (!RHS.empty())
                 SmallVectorImpl<T>::operator=(::std::move(RHS));
         }
@@ -1120,6 +1247,7 @@ namespace plib::core::utils
         */
         SmallVector(SmallVectorImpl<T> &&RHS) : SmallVectorImpl<T>(N)
         {
+            this->Resource = RHS.get_resource();
             if (!RHS.empty())
                 SmallVectorImpl<T>::operator=(::std::move(RHS));
         }
@@ -1148,24 +1276,22 @@ namespace plib::core::utils
     {
         return X.capacity_in_bytes();
     }
-    namespace std
+    // 放在容器所在命名空间，通过ADL被`using std::swap; swap(a, b);`找到
+    /// Implement swap in terms of SmallVector swap.
+    template <typename T>
+    inline void
+    swap(SmallVectorImpl<T> &LHS, SmallVectorImpl<T> &RHS)
     {
-        /// Implement std::swap in terms of SmallVector swap.
-        template <typename T>
-        inline void
-        swap(SmallVectorImpl<T> &LHS, SmallVectorImpl<T> &RHS)
-        {
-            LHS.swap(RHS);
-        }
+        LHS.swap(RHS);
+    }
 
-        /// Implement std::swap in terms of SmallVector swap.
-        template <typename T, unsigned N>
-        inline void
-        swap(SmallVector<T, N> &LHS, SmallVector<T, N> &RHS)
-        {
-            LHS.swap(RHS);
-        }
-    } // end of namespace std ----------------------------------------------------
+    /// Implement swap in terms of SmallVector swap.
+    template <typename T, unsigned N>
+    inline void
+    swap(SmallVector<T, N> &LHS, SmallVector<T, N> &RHS)
+    {
+        LHS.swap(RHS);
+    }
 
 } // namespace plib::core::utils
 
@@ -1,20 +1,23 @@
 #ifndef _core_utils_string_util_hpp_
 #define _core_utils_string_util_hpp_
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <string_view>
 #include <string>
 namespace plib::core::utils
 {
-	const char *const whitespaceDelimiters = " \t\n\r\f\v";
+	inline constexpr const char *whitespaceDelimiters = " \t\n\r\f\v";
 #ifdef _WIN32
-	const char *const endl = "\r\n";
+	inline constexpr const char *endl = "\r\n";
 #else
-	const char *const endl = "\n";
+	inline constexpr const char *endl = "\n";
 #endif
-	[[nodiscard]] constexpr size_t size(char c) noexcept
+	[[nodiscard]] constexpr size_t size(char) noexcept
 	{
 		return 1;
 	}
-	[[nodiscard]] constexpr size_t size(wchar_t w) noexcept
+	[[nodiscard]] constexpr size_t size(wchar_t) noexcept
 	{
 		return 1;
 	}
@@ -49,7 +52,7 @@ namespace plib::core::utils
 		return copy;
 	}
 
-	[[nodiscard]] constexpr std::string toLower(const std::string &str) noexcept
+	[[nodiscard]] inline std::string toLower(const std::string &str) noexcept
 	{
 		std::string copy = str;
 		std::transform(copy.begin(), copy.end(), copy.begin(), [](const char c)
@@ -71,7 +74,7 @@ namespace plib::core::utils
 		return copy;
 	}
 
-	void replace(std::string &str, const std::string &a, const std::string &b) noexcept
+	inline void replace(std::string &str, const std::string &a, const std::string &b) noexcept
 	{
 		if (!a.empty())
 		{
@@ -84,29 +87,29 @@ namespace plib::core::utils
 		}
 	}
 
-	void toLower(std::string &str) noexcept
+	inline void toLower(std::string &str) noexcept
 	{
 		std::transform(str.begin(), str.end(), str.begin(), [](const char c)
 					   { return static_cast<char>(std::tolower(c)); });
 	}
 
-	void trim(std::string &str) noexcept
+	inline void trim(std::string &str) noexcept
 	{
 		str.erase(str.find_last_not_of(whitespaceDelimiters) + 1);
 		str.erase(0, str.find_first_not_of(whitespaceDelimiters));
 	}
 
-	void ltrim(std::string &str) noexcept
+	inline void ltrim(std::string &str) noexcept
 	{
 		str.erase(str.find_last_not_of(whitespaceDelimiters) + 1);
 	}
 
-	void rtrim(std::string &str) noexcept
+	inline void rtrim(std::string &str) noexcept
 	{
 		str.erase(0, str.find_first_not_of(whitespaceDelimiters));
 	}
 
-	namespace
+	namespace detail
 	{
 		template <typename T, typename... Args>
 		T concat_imp(Args &&...args)
@@ -135,30 +138,36 @@ namespace plib::core::utils
 
 			return res;
 		}
-	} // inline namespace impl
-	template <typename... Args>
-	[[nodiscard]] std::string concat(Args &&...args)
+	} // namespace detail
+
+	/**
+	 * @brief: 拼接任意个字符串/字符，先算总长度一次性reserve
+	 * String可以换成utils::small_string<N>，结果不超过N个字符时整个过程没有堆分配
+	 */
+	template <typename String = std::string, typename... Args>
+	[[nodiscard]] String concat(Args &&...args)
 	{
-		return concat_imp<std::string>(std::forward<Args>(args)...);
+		return detail::concat_imp<String>(std::forward<Args>(args)...);
 	}
 
 	template <typename... Args>
 	[[nodiscard]] std::wstring wconcat(Args &&...args)
 	{
-		return concat_imp<std::wstring>(std::forward<Args>(args)...);
+		return detail::concat_imp<std::wstring>(std::forward<Args>(args)...);
 	}
-	template <typename T>
-	[[nodiscard]] std::string join(T first, T last, std::string_view seq)
+	// 同concat，String可以换成utils::small_string<N>
+	template <typename String = std::string, typename T>
+	[[nodiscard]] String join(T first, T last, std::string_view seq)
 	{
-		return join_imp<std::string>(first, last, seq);
+		return detail::join_imp<String>(first, last, seq);
 	}
 	template <typename T>
 	[[nodiscard]] std::wstring join(T first, T last, const std::wstring &seq)
 	{
-		return join_imp<std::wstring>(first, last, seq);
+		return detail::join_imp<std::wstring>(first, last, seq);
 	}
 
-	[[nodiscard]] bool isNumeric(const std::string &str)
+	[[nodiscard]] inline bool isNumeric(const std::string &str)
 	{
 		if (str.empty())
 		{
@@ -166,7 +175,7 @@ namespace plib::core::utils
 		}
 		const char *p = str.c_str();
 		char *end = nullptr;
-		double result = std::strtod(p, &end);
+		std::strtod(p, &end);
 		return end != p && *end == '\0';
 	}
 } // namespace plib::core::utils
@@ -34,6 +34,7 @@
 #include <chrono>
 #include "utils/cpu_affinity.hpp"
 #include "type/threadsafe_queue.hpp"
+#include "concurrent/blocking_queue.hpp"
 #include "plib_macros.hpp"
 
 namespace plib::core::utils
@@ -67,12 +68,21 @@ namespace plib::core::utils
         }
     };
 
+    // 按位组合的选项，例如ThreadPool<option_t::PRIORITY | option_t::LOCKFREE>
     enum option_t : std::uint8_t
     {
-        NONE,
-        PRIORITY
+        NONE = 0,
+        PRIORITY = 1 << 0,
+        // 使用无锁阻塞队列(concurrent::BlockingQueue)及其等待/唤醒机制;
+        // 与PRIORITY同时指定时以PRIORITY为准，仍使用加锁的优先级队列
+        LOCKFREE = 1 << 1
     };
 
+    constexpr option_t operator|(option_t lhs, option_t rhs) noexcept
+    {
+        return static_cast<option_t>(static_cast<std::uint8_t>(lhs) | static_cast<std::uint8_t>(rhs));
+    }
+
     namespace detail
     {
         // 普通模式的工作函数
@@ -214,6 +224,9 @@ namespace plib::core::utils
     {
         // 编译器计算是否开启优先级支持
         static constexpr bool priority_enabled = (opt & option_t::PRIORITY) != 0;
+        static constexpr bool lockfree_enabled = (opt & option_t::LOCKFREE) != 0;
+        // 开启优先级时忽略其余选项，工作函数按PRIORITY特化
+        static constexpr option_t worker_opt = priority_enabled ? option_t::PRIORITY : opt;
 
     public:
         /**
@@ -254,7 +267,8 @@ namespace plib::core::utils
 
     public:
         std::vector<std::conditional_t<priority_enabled, plib::core::type::ThreadSafePriorityQueue<TaskItem>,
-                                       plib::core::type::ThreadSafeQueue<TASK>>>
+                                       std::conditional_t<lockfree_enabled, plib::core::concurrent::BlockingQueue<TASK>,
+                                                          plib::core::type::ThreadSafeQueue<TASK>>>>
             _task_queues;
     };
 
@@ -291,7 +305,7 @@ namespace plib::core::utils
         for (int i = 0; i < _thread_num; ++i)
         {
             _threads.emplace_back([this, i]()
-                                  { detail::WorkerImpl<opt>::work(this, i); });
+                                  { detail::WorkerImpl<worker_opt>::work(this, i); });
         }
 
         if (_cpu_binding)
@@ -304,8 +318,13 @@ namespace plib::core::utils
     template <option_t opt>
     ThreadPool<opt>::~ThreadPool()
     {
-        // jthread会自动join
         stop();
+        // 必须在_task_queues析构之前join，jthread成员的自动join发生在队列销毁之后
+        for (auto &thread : _threads)
+        {
+            if (thread.joinable())
+                thread.join();
+        }
     }
 
     // 启用优先级时的实现
@@ -0,0 +1,853 @@
+#include <gtest/gtest.h>
+#include "concurrent/blocking_queue.hpp"
+#include "concurrent/concurrent_cache.hpp"
+#include "concurrent/concurrent_hash_map.hpp"
+#include "concurrent/epoch.hpp"
+#include "concurrent/eventcount.hpp"
+#include "concurrent/hazard_pointer.hpp"
+#include "concurrent/lockfree_queue.hpp"
+#include "concurrent/lockfree_stack.hpp"
+#include "concurrent/parking_lot.hpp"
+#include "concurrent/rcu.hpp"
+#include "concurrent/spinlock.hpp"
+#include "concurrent/thread.hpp"
+#include "utils/thread_pool.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace plib::core::concurrent
+{
+    namespace
+    {
+        // 析构时计数，用来确认对象确实被回收
+        struct Tracked
+        {
+            explicit Tracked(std::atomic<int> &counter) : counter(counter) {}
+            ~Tracked() { counter.fetch_add(1, std::memory_order_relaxed); }
+            std::atomic<int> &counter;
+        };
+    }
+
+    // 锁的默认构造函数不是explicit，可以拷贝列表初始化，也可以作为聚合成员值初始化
+    TEST(SpinlockTest, CopyListInitialization)
+    {
+        struct Holder
+        {
+            int x;
+            Spinlock spin;
+            FairSpinLock fair;
+            UnfairSpinlock unfair;
+        };
+        Holder holder = {1, {}, {}, {}};
+        std::array<Spinlock, 4> locks = {};
+        Spinlock single = {};
+        static_assert(std::is_nothrow_default_constructible_v<Spinlock>);
+        static_assert(std::is_nothrow_default_constructible_v<FairSpinLock>);
+        static_assert(std::is_nothrow_default_constructible_v<UnfairSpinlock>);
+        static_assert(!std::is_convertible_v<std::source_location, Spinlock>);
+
+        holder.spin.lock();
+        holder.spin.unlock();
+        holder.fair.unlock(holder.fair.lock());
+        {
+            std::lock_guard<UnfairSpinlock> guard(holder.unfair);
+        }
+        for (auto &lock : locks)
+        {
+            std::lock_guard<Spinlock> guard(lock);
+        }
+        std::lock_guard<Spinlock> guard(single);
+        EXPECT_EQ(holder.x, 1);
+    }
+
+    // 测试 retire 之后对象最终被释放
+    TEST(EpochDomainTest, RetireAndReclaim)
+    {
+        std::atomic<int> destroyed{0};
+        EpochDomain domain(4);
+        for (int i = 0; i < 10; ++i)
+            domain.retire(new Tracked(destroyed));
+        domain.synchronize();
+        EXPECT_EQ(destroyed.load(), 10);
+        EXPECT_EQ(domain.pending(), 0u);
+    }
+
+    // 测试临界区内的读者会阻止回收
+    TEST(EpochDomainTest, ActiveReaderBlocksReclaim)
+    {
+        std::atomic<int> destroyed{0};
+        EpochDomain domain(1);
+        std::atomic<bool> pinned{false}, done{false};
+        std::thread reader([&]
+                           {
+            auto guard = domain.pin();
+            pinned = true;
+            while (!done)
+                std::this_thread::yield(); });
+        while (!pinned)
+            std::this_thread::yield();
+
+        domain.retire(new Tracked(destroyed));
+        domain.reclaim();
+        domain.reclaim();
+        EXPECT_EQ(destroyed.load(), 0);
+
+        done = true;
+        reader.join();
+        domain.synchronize();
+        EXPECT_EQ(destroyed.load(), 1);
+    }
+
+    // 测试嵌套临界区
+    TEST(EpochDomainTest, NestedCriticalSection)
+    {
+        EpochDomain domain;
+        domain.enter();
+        {
+            auto guard = domain.pin();
+            EXPECT_TRUE(domain.in_critical_section());
+        }
+        EXPECT_TRUE(domain.in_critical_section());
+        domain.leave();
+        EXPECT_FALSE(domain.in_critical_section());
+    }
+
+    // 测试线程退出时留在本地缓冲的对象不会泄漏
+    TEST(EpochDomainTest, ThreadExitHandsOverRetired)
+    {
+        std::atomic<int> destroyed{0};
+        EpochDomain domain(1024);
+        std::thread([&]
+                    { domain.retire(new Tracked(destroyed)); })
+            .join();
+        domain.synchronize();
+        EXPECT_EQ(destroyed.load(), 1);
+    }
+
+    // 测试在线程池上执行回收
+    TEST(EpochDomainTest, ReclaimOnThreadPool)
+    {
+        std::atomic<int> destroyed{0};
+        utils::ThreadPool<> pool(1);
+        {
+            EpochDomain domain(2);
+            domain.reclaim_on(pool);
+            for (int i = 0; i < 64; ++i)
+                domain.retire(new Tracked(destroyed));
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (destroyed.load() < 64 && std::chrono::steady_clock::now() < deadline)
+            {
+                domain.try_advance();
+                domain.flush();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            EXPECT_EQ(destroyed.load(), 64);
+        }
+    }
+
+    // 测试 RcuCell 的读写
+    TEST(RcuCellTest, LoadStoreUpdate)
+    {
+        EpochDomain domain;
+        RcuCell<std::map<std::string, int>> cell({{"a", 1}}, domain);
+        {
+            auto snapshot = cell.load();
+            EXPECT_EQ(snapshot->at("a"), 1);
+            cell.update([](auto &m)
+                        { m["b"] = 2; });
+            // 旧快照不受更新影响
+            EXPECT_EQ(snapshot->count("b"), 0u);
+        }
+        EXPECT_EQ(cell.read([](const auto &m)
+                            { return m.at("b"); }),
+                  2);
+        cell.store({{"c", 3}});
+        EXPECT_EQ(cell.load()->size(), 1u);
+        domain.synchronize();
+    }
+
+    // 并发读写：读者看到的快照必须始终自洽
+    TEST(RcuCellTest, ConcurrentReadersSeeConsistentSnapshots)
+    {
+        EpochDomain domain(8);
+        RcuCell<std::vector<int>> cell(std::vector<int>(64, 0), domain);
+        std::atomic<bool> stop{false};
+        std::atomic<int> bad{0};
+
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t)
+        {
+            readers.emplace_back([&]
+                                 {
+                while (!stop.load(std::memory_order_relaxed)) {
+                    auto snapshot = cell.load();
+                    const int first = (*snapshot)[0];
+                    for (int v : *snapshot)
+                        if (v != first)
+                            bad.fetch_add(1);
+                } });
+        }
+        for (int i = 1; i <= 2000; ++i)
+        {
+            cell.update([i](auto &v)
+                        { std::fill(v.begin(), v.end(), i); });
+        }
+        stop = true;
+        for (auto &r : readers)
+            r.join();
+        EXPECT_EQ(bad.load(), 0);
+        EXPECT_EQ(cell.load()->front(), 2000);
+        domain.synchronize();
+    }
+    // 测试被风险指针保护的对象不会被回收
+    TEST(HazardPointerTest, ProtectedObjectSurvivesScan)
+    {
+        std::atomic<int> destroyed{0};
+        HazardPointerDomain domain(1);
+        std::atomic<Tracked *> src{new Tracked(destroyed)};
+        {
+            auto hp = domain.make_hazard_pointer();
+            Tracked *p = hp.protect(src);
+            src.store(nullptr);
+            domain.retire(p);
+            domain.scan();
+            EXPECT_EQ(destroyed.load(), 0);
+            EXPECT_EQ(domain.pending(), 1u);
+        }
+        domain.scan();
+        EXPECT_EQ(destroyed.load(), 1);
+        EXPECT_EQ(domain.pending(), 0u);
+    }
+
+    // 测试每个线程持有的风险指针数量上限
+    TEST(HazardPointerTest, SlotLimit)
+    {
+        HazardPointerDomain domain;
+        std::vector<HazardPointerDomain::HazardPointer> hps;
+        EXPECT_THROW(
+            {
+                for (int i = 0; i < 64; ++i)
+                    hps.push_back(domain.make_hazard_pointer());
+            },
+            std::length_error);
+        hps.clear();
+        // 释放后槽位可以再次使用
+        EXPECT_NO_THROW(domain.make_hazard_pointer());
+    }
+
+    // 测试线程退出时未能回收的对象转交给域，之后仍会被释放
+    TEST(HazardPointerTest, ThreadExitOrphans)
+    {
+        std::atomic<int> destroyed{0};
+        HazardPointerDomain domain(1024);
+        std::atomic<Tracked *> src{new Tracked(destroyed)};
+        auto hp = domain.make_hazard_pointer();
+        Tracked *p = hp.protect(src);
+        std::thread([&]
+                    { domain.retire(src.exchange(nullptr)); })
+            .join();
+        EXPECT_EQ(destroyed.load(), 0);
+        (void)p;
+        hp.reset_protection();
+        domain.scan();
+        EXPECT_EQ(destroyed.load(), 1);
+    }
+
+    // 不显式scan时，遗留对象也会在retire攒够阈值后被并入并释放
+    TEST(HazardPointerTest, RetireAdoptsOrphans)
+    {
+        std::atomic<int> orphan_destroyed{0};
+        std::atomic<int> destroyed{0};
+        HazardPointerDomain domain(8);
+        std::atomic<Tracked *> src{new Tracked(orphan_destroyed)};
+        {
+            auto hp = domain.make_hazard_pointer();
+            hp.protect(src);
+            std::thread([&]
+                        { domain.retire(src.exchange(nullptr)); })
+                .join();
+        }
+        EXPECT_EQ(orphan_destroyed.load(), 0);
+        for (int i = 0; i < 1000; ++i)
+            domain.retire(new Tracked(destroyed));
+        EXPECT_EQ(orphan_destroyed.load(), 1);
+        EXPECT_LT(domain.pending(), 1000u);
+    }
+
+    // 多生产者多消费者压力测试：每个值恰好被取出一次
+    template <typename Container>
+    void mpmc_stress(Container &container, int producers, int consumers, int per_producer)
+    {
+        const int total = producers * per_producer;
+        std::vector<std::atomic<int>> seen(total);
+        std::atomic<int> consumed{0};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]
+                                 {
+                for (int i = 0; i < per_producer; ++i)
+                    container.push(std::make_unique<int>(p * per_producer + i)); });
+        }
+        for (int c = 0; c < consumers; ++c)
+        {
+            threads.emplace_back([&]
+                                 {
+                while (consumed.load(std::memory_order_relaxed) < total) {
+                    if (auto v = container.pop()) {
+                        seen[**v].fetch_add(1, std::memory_order_relaxed);
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        std::this_thread::yield();
+                    }
+                } });
+        }
+        for (auto &t : threads)
+            t.join();
+        EXPECT_TRUE(container.empty());
+        for (int i = 0; i < total; ++i)
+            ASSERT_EQ(seen[i].load(), 1) << "value " << i;
+    }
+
+    TEST(LockFreeStackTest, PushPopOrder)
+    {
+        LockFreeStack<int> stack;
+        EXPECT_FALSE(stack.pop().has_value());
+        for (int i = 0; i < 3; ++i)
+            stack.push(i);
+        int v = -1;
+        EXPECT_TRUE(stack.try_pop(v));
+        EXPECT_EQ(v, 2);
+        EXPECT_EQ(*stack.pop(), 1);
+        EXPECT_EQ(*stack.pop(), 0);
+        EXPECT_TRUE(stack.empty());
+    }
+
+    TEST(LockFreeStackTest, MultiProducerMultiConsumer)
+    {
+        HazardPointerDomain domain(16);
+        LockFreeStack<std::unique_ptr<int>> stack(domain);
+        mpmc_stress(stack, 4, 4, 20000);
+    }
+
+    TEST(LockFreeQueueTest, PushPopOrder)
+    {
+        LockFreeQueue<std::string> queue;
+        EXPECT_TRUE(queue.empty());
+        queue.push("a");
+        queue.emplace(2, 'b');
+        std::string v;
+        EXPECT_TRUE(queue.try_pop(v));
+        EXPECT_EQ(v, "a");
+        EXPECT_EQ(*queue.pop(), "bb");
+        EXPECT_FALSE(queue.pop().has_value());
+        // 析构时队列中残留的元素也会被释放
+        queue.push("left");
+    }
+
+    TEST(LockFreeQueueTest, MultiProducerMultiConsumer)
+    {
+        HazardPointerDomain domain(16);
+        LockFreeQueue<std::unique_ptr<int>> queue(domain);
+        mpmc_stress(queue, 4, 4, 20000);
+    }
+
+    // 单生产者单消费者下保持FIFO顺序
+    TEST(LockFreeQueueTest, FifoPerProducer)
+    {
+        LockFreeQueue<int> queue;
+        constexpr int kCount = 50000;
+        std::thread producer([&]
+                             {
+            for (int i = 0; i < kCount; ++i)
+                queue.push(i); });
+        int expected = 0;
+        while (expected < kCount)
+        {
+            if (auto v = queue.pop())
+            {
+                ASSERT_EQ(*v, expected);
+                ++expected;
+            }
+        }
+        producer.join();
+    }
+    // 事件计数器：消费者在无数据时睡眠，生产者notify后被唤醒
+    TEST(EventCountTest, WakesWaiter)
+    {
+        EventCount ec;
+        std::atomic<int> value{0};
+        std::thread waiter([&]
+                           { ec.await([&]
+                                      { return value.load() != 0; }); });
+        while (ec.waiters() == 0)
+            std::this_thread::yield();
+        value = 1;
+        ec.notify();
+        waiter.join();
+        EXPECT_EQ(ec.waiters(), 0u);
+    }
+
+    TEST(EventCountTest, CancelAndTimeout)
+    {
+        EventCount ec;
+        auto key = ec.prepare_wait();
+        EXPECT_EQ(ec.waiters(), 1u);
+        ec.cancel_wait();
+        EXPECT_EQ(ec.waiters(), 0u);
+
+        key = ec.prepare_wait();
+        EXPECT_FALSE(ec.commit_wait_for(key, std::chrono::milliseconds(5)));
+        EXPECT_EQ(ec.waiters(), 0u);
+
+        // prepare之后的notify会让commit_wait立即返回
+        key = ec.prepare_wait();
+        ec.notify();
+        EXPECT_TRUE(ec.commit_wait_for(key, std::chrono::seconds(5)));
+    }
+
+    TEST(ParkingLotTest, ParkAndUnpark)
+    {
+        auto &lot = ParkingLot::global();
+        int token = 0;
+        std::atomic<bool> ready{false};
+        EXPECT_FALSE(lot.park(&token, []
+                              { return false; }));
+        EXPECT_FALSE(lot.unpark_one(&token));
+
+        std::vector<std::thread> threads;
+        std::atomic<int> parked{0}, woken{0};
+        for (int i = 0; i < 3; ++i)
+        {
+            threads.emplace_back([&]
+                                 {
+                if (lot.park(&token, [&] { parked.fetch_add(1); return !ready.load(); }))
+                    woken.fetch_add(1); });
+        }
+        while (parked.load() < 3)
+            std::this_thread::yield();
+        // validate在桶锁内执行，parked计数到齐后所有线程都已登记
+        ready = true;
+        std::size_t total = 0;
+        while (total < 3)
+            total += lot.unpark_all(&token);
+        for (auto &t : threads)
+            t.join();
+        EXPECT_EQ(woken.load(), 3);
+    }
+
+    TEST(ParkingLotTest, ParkForTimesOut)
+    {
+        int token = 0;
+        auto begin = std::chrono::steady_clock::now();
+        EXPECT_FALSE(ParkingLot::global().park_for(&token, []
+                                                   { return true; },
+                                                   std::chrono::milliseconds(10)));
+        EXPECT_GE(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(10));
+        EXPECT_FALSE(ParkingLot::global().unpark_one(&token));
+    }
+
+    TEST(BlockingQueueTest, ProducersConsumersAndStop)
+    {
+        BlockingQueue<int> queue;
+        constexpr int kPerProducer = 5000;
+        std::atomic<long> sum{0};
+        std::atomic<int> received{0};
+        std::vector<std::thread> consumers;
+        for (int c = 0; c < 3; ++c)
+        {
+            consumers.emplace_back([&]
+                                   {
+                for (;;) {
+                    int v = -1;
+                    queue.pop(v);
+                    if (v < 0)
+                        return; // 被stop唤醒
+                    sum.fetch_add(v);
+                    received.fetch_add(1);
+                } });
+        }
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 2; ++p)
+        {
+            producers.emplace_back([&]
+                                   {
+                for (int i = 1; i <= kPerProducer; ++i)
+                    queue.push(int(i)); });
+        }
+        for (auto &p : producers)
+            p.join();
+        while (received.load() < 2 * kPerProducer)
+            std::this_thread::yield();
+        queue.stop();
+        for (auto &c : consumers)
+            c.join();
+        EXPECT_EQ(sum.load(), 2L * kPerProducer * (kPerProducer + 1) / 2);
+        EXPECT_EQ(queue.size(), 0u);
+    }
+
+    // 线程池使用无锁阻塞队列
+    TEST(BlockingQueueTest, ThreadPoolAdoption)
+    {
+        std::atomic<int> done{0};
+        {
+            utils::ThreadPool<utils::option_t::LOCKFREE> pool(2);
+            for (int i = 0; i < 100; ++i)
+                pool.execute([&]
+                             { done.fetch_add(1); },
+                             i % 2);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (done.load() < 100 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+        }
+        EXPECT_EQ(done.load(), 100);
+
+        // 同时指定PRIORITY和LOCKFREE时按优先级队列工作
+        static_assert((utils::option_t::PRIORITY | utils::option_t::LOCKFREE) == 3);
+        std::atomic<int> prioritized{0};
+        {
+            utils::ThreadPool<utils::option_t::PRIORITY | utils::option_t::LOCKFREE> pool(2);
+            for (int i = 0; i < 100; ++i)
+                pool.execute([&]
+                             { prioritized.fetch_add(1); },
+                             i % 2 ? utils::priority_t::high : utils::priority_t::low);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (prioritized.load() < 100 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+        }
+        EXPECT_EQ(prioritized.load(), 100);
+    }
+
+    TEST(ConcurrentHashMapTest, BasicOperations)
+    {
+        EpochDomain domain;
+        {
+            ConcurrentHashMap<int, std::string> map(4, domain);
+            EXPECT_EQ(map.shard_count(), 4u);
+            for (int i = 0; i < 1000; ++i)
+                EXPECT_TRUE(map.insert_or_assign(i, std::to_string(i)));
+            EXPECT_EQ(map.size(), 1000u);
+            EXPECT_FALSE(map.insert_or_assign(7, std::string("seven")));
+            EXPECT_EQ(map.find(7).value(), "seven");
+            EXPECT_FALSE(map.find(1000).has_value());
+
+            EXPECT_FALSE(map.try_emplace(8, "x"));
+            EXPECT_EQ(map.find(8).value(), "8");
+            std::size_t length = 0;
+            EXPECT_TRUE(map.visit(999, [&](const std::string &v)
+                                  { length = v.size(); }));
+            EXPECT_EQ(length, 3u);
+
+            for (int i = 0; i < 1000; i += 2)
+                EXPECT_TRUE(map.erase(i));
+            EXPECT_FALSE(map.erase(0));
+            EXPECT_EQ(map.size(), 500u);
+            EXPECT_FALSE(map.contains(10));
+            EXPECT_TRUE(map.contains(11));
+
+            // 删除留下的墓碑可以被复用，反复增删不会让表无限膨胀
+            for (int round = 0; round < 20; ++round)
+            {
+                for (int i = 0; i < 1000; i += 2)
+                    map.insert_or_assign(i, std::string("r"));
+                for (int i = 0; i < 1000; i += 2)
+                    map.erase(i);
+            }
+            EXPECT_EQ(map.size(), 500u);
+
+            int calls = 0;
+            EXPECT_EQ(map.compute_if_absent(11, [&]
+                                            { ++calls; return std::string("new"); }),
+                      "11");
+            EXPECT_EQ(map.compute_if_absent(12, [&]
+                                            { ++calls; return std::string("new"); }),
+                      "new");
+            EXPECT_EQ(calls, 1);
+
+            map.clear();
+            EXPECT_TRUE(map.empty());
+            EXPECT_FALSE(map.contains(11));
+        }
+        domain.synchronize();
+        EXPECT_EQ(domain.pending(), 0u);
+    }
+
+    // 读者与写者并发：读到的值必须是某次完整写入的结果
+    TEST(ConcurrentHashMapTest, ConcurrentReadersAndWriters)
+    {
+        constexpr int kKeys = 512;
+        ConcurrentHashMap<int, std::pair<int, int>> map(8);
+        for (int i = 0; i < kKeys; ++i)
+            map.insert_or_assign(i, std::make_pair(i, -i));
+
+        std::atomic<bool> stop{false};
+        std::atomic<int> torn{0};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r)
+        {
+            readers.emplace_back([&, r]
+                                 {
+                for (int i = r; !stop.load(std::memory_order_relaxed); ++i) {
+                    if (auto v = map.find(i % kKeys); v && v->first != -v->second)
+                        torn.fetch_add(1);
+                } });
+        }
+        std::vector<std::thread> writers;
+        for (int w = 0; w < 2; ++w)
+        {
+            writers.emplace_back([&, w]
+                                 {
+                for (int i = 0; i < 20000; ++i) {
+                    const int key = (i * 7 + w) % kKeys;
+                    if (i % 5 == 0)
+                        map.erase(key);
+                    else
+                        map.insert_or_assign(key, std::make_pair(i, -i));
+                } });
+        }
+        for (auto &w : writers)
+            w.join();
+        stop = true;
+        for (auto &r : readers)
+            r.join();
+        EXPECT_EQ(torn.load(), 0);
+        EXPECT_LE(map.size(), static_cast<std::size_t>(kKeys));
+    }
+
+    // 同一个键并发compute_if_absent时只构造一次
+    TEST(ConcurrentHashMapTest, ComputeIfAbsentRunsOnce)
+    {
+        ConcurrentHashMap<int, int> map;
+        std::atomic<int> calls{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&]
+                                 {
+                for (int k = 0; k < 100; ++k)
+                    map.compute_if_absent(k, [&] { calls.fetch_add(1); return k * 2; }); });
+        }
+        for (auto &t : threads)
+            t.join();
+        EXPECT_EQ(calls.load(), 100);
+        EXPECT_EQ(map.find(42).value(), 84);
+    }
+
+    // 在concurrent::thread_pool上并行遍历
+    TEST(ConcurrentHashMapTest, ParallelForEachOnThreadPool)
+    {
+        ConcurrentHashMap<int, int> map(16);
+        for (int i = 1; i <= 10000; ++i)
+            map.insert_or_assign(i, i);
+        light_thread_pool pool(3);
+        std::atomic<long> sum{0};
+        std::atomic<int> count{0};
+        map.for_each(pool, [&](const int &key, const int &value)
+                     {
+            sum.fetch_add(value, std::memory_order_relaxed);
+            count.fetch_add(key > 0, std::memory_order_relaxed); });
+        EXPECT_EQ(count.load(), 10000);
+        EXPECT_EQ(sum.load(), 10000L * 10001 / 2);
+
+        long serial = 0;
+        map.for_each([&](const int &, const int &value)
+                     { serial += value; });
+        EXPECT_EQ(serial, sum.load());
+    }
+
+    TEST(ConcurrentCacheTest, BasicOperations)
+    {
+        ConcurrentCache<int, std::string> cache(100, 1);
+        EXPECT_FALSE(cache.get(1).has_value());
+        EXPECT_TRUE(cache.put(1, "one"));
+        EXPECT_FALSE(cache.put(1, "uno"));
+        EXPECT_EQ(cache.get(1).value(), "uno");
+        EXPECT_TRUE(cache.contains(1));
+        EXPECT_TRUE(cache.erase(1));
+        EXPECT_FALSE(cache.erase(1));
+        EXPECT_FALSE(cache.contains(1));
+
+        for (int i = 0; i < 1000; ++i)
+            cache.put(i, std::to_string(i));
+        EXPECT_EQ(cache.size(), 100u);
+        const auto stats = cache.stats();
+        EXPECT_EQ(stats.hits, 1u);
+        EXPECT_EQ(stats.misses, 1u);
+        EXPECT_EQ(stats.evictions, 900u);
+        cache.clear();
+        EXPECT_EQ(cache.size(), 0u);
+        EXPECT_TRUE(cache.put(5, "five"));
+        EXPECT_EQ(cache.get(5).value(), "five");
+    }
+
+    // 分片数不超过容量，容量不能被分片取整抬高；各线程的读计数在stats()里汇总
+    TEST(ConcurrentCacheTest, ShardCountAndStats)
+    {
+        ConcurrentCache<int, int> small(10, 64);
+        EXPECT_EQ(small.shard_count(), 8u);
+        EXPECT_EQ(small.capacity(), 10u);
+        for (int i = 0; i < 1000; ++i)
+            small.put(i, i);
+        EXPECT_LE(small.size(), 10u);
+
+        ConcurrentCache<int, int> cache(1000, 4);
+        for (int i = 0; i < 100; ++i)
+            cache.put(i, i);
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t)
+        {
+            readers.emplace_back([&]
+                                 {
+                for (int i = 0; i < 200; ++i)
+                    cache.get(i); });
+        }
+        for (auto &r : readers)
+            r.join();
+        const auto stats = cache.stats();
+        EXPECT_EQ(stats.hits, 400u);
+        EXPECT_EQ(stats.misses, 400u);
+    }
+
+    // 过期的条目被读到时才删除
+    TEST(ConcurrentCacheTest, TtlExpiresLazily)
+    {
+        ConcurrentCache<int, int> cache(16, 1);
+        // TTL留足余量，负载高或开启sanitizer时put和get之间也可能隔上几毫秒
+        cache.put(1, 10, std::chrono::milliseconds(500));
+        cache.put(2, 20);
+        EXPECT_EQ(cache.get(1).value(), 10);
+        std::this_thread::sleep_for(std::chrono::milliseconds(600));
+        EXPECT_FALSE(cache.contains(1));
+        EXPECT_EQ(cache.size(), 2u);
+        EXPECT_FALSE(cache.get(1).has_value());
+        EXPECT_EQ(cache.size(), 1u);
+        EXPECT_EQ(cache.stats().expirations, 1u);
+        EXPECT_EQ(cache.get(2).value(), 20);
+    }
+
+    // 第n次拷贝时抛出的键，用来模拟拷贝std::string键时的bad_alloc
+    struct ThrowingKey
+    {
+        static inline int copies_left = -1; // 负数表示不抛出
+        int value;
+        explicit ThrowingKey(int v) : value(v) {}
+        ThrowingKey(const ThrowingKey &other) : value(other.value)
+        {
+            if (copies_left == 0)
+                throw std::bad_alloc();
+            if (copies_left > 0)
+                --copies_left;
+        }
+        bool operator==(const ThrowingKey &other) const { return value == other.value; }
+    };
+    struct ThrowingKeyHash
+    {
+        std::size_t operator()(const ThrowingKey &k) const { return std::hash<int>()(k.value); }
+    };
+
+    // 拷贝键抛出时不留下指向空节点的条目，之后的删除和插入照常工作
+    TEST(ConcurrentCacheTest, PutIsExceptionSafe)
+    {
+        ConcurrentCache<ThrowingKey, int, ThrowingKeyHash> cache(4, 1);
+        cache.put(ThrowingKey(0), 0);
+        for (int allowed = 0; allowed < 3; ++allowed)
+        {
+            ThrowingKey::copies_left = allowed;
+            bool threw = false;
+            try
+            {
+                cache.put(ThrowingKey(1), 1);
+            }
+            catch (const std::bad_alloc &)
+            {
+                threw = true;
+            }
+            ThrowingKey::copies_left = -1;
+            if (!threw)
+                break;
+            EXPECT_FALSE(cache.contains(ThrowingKey(1)));
+            EXPECT_FALSE(cache.erase(ThrowingKey(1)));
+            EXPECT_EQ(cache.size(), 1u);
+        }
+        // 拷贝次数足够时最后一轮会插入成功
+        cache.put(ThrowingKey(1), 1);
+        EXPECT_EQ(cache.get(ThrowingKey(1)).value(), 1);
+        for (int k = 2; k < 10; ++k)
+            cache.put(ThrowingKey(k), k);
+        EXPECT_LE(cache.size(), 4u);
+    }
+
+    // 热键被反复访问之后，一次性扫描大量新键也冲不掉它们
+    TEST(ConcurrentCacheTest, ScanResistance)
+    {
+        ConcurrentCache<int, int> cache(1000, 1);
+        for (int round = 0; round < 10; ++round)
+        {
+            for (int k = 0; k < 500; ++k)
+            {
+                if (!cache.get(k))
+                    cache.put(k, k);
+            }
+        }
+        cache.flush();
+        for (int k = 100000; k < 110000; ++k)
+        {
+            if (!cache.get(k))
+                cache.put(k, k);
+        }
+        int survivors = 0;
+        for (int k = 0; k < 500; ++k)
+            survivors += cache.contains(k);
+        EXPECT_GE(survivors, 490);
+        EXPECT_LE(cache.size(), 1000u);
+    }
+
+    TEST(ConcurrentCacheTest, ConcurrentReadersAndWriters)
+    {
+        constexpr int kKeys = 2048;
+        ConcurrentCache<int, std::pair<int, int>> cache(1024, 4);
+        std::atomic<bool> stop{false};
+        std::atomic<int> torn{0};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r)
+        {
+            readers.emplace_back([&, r]
+                                 {
+                for (int i = r; !stop.load(std::memory_order_relaxed); ++i) {
+                    if (auto v = cache.get((i * 31) % kKeys); v && v->first != -v->second)
+                        torn.fetch_add(1);
+                } });
+        }
+        std::vector<std::thread> writers;
+        for (int w = 0; w < 2; ++w)
+        {
+            writers.emplace_back([&, w]
+                                 {
+                for (int i = 0; i < 20000; ++i) {
+                    const int key = (i * 7 + w) % kKeys;
+                    if (i % 9 == 0)
+                        cache.erase(key);
+                    else
+                        cache.put(key, std::make_pair(i, -i), i % 3 == 0 ? std::chrono::microseconds(50) : std::chrono::microseconds(0));
+                } });
+        }
+        for (auto &w : writers)
+            w.join();
+        stop = true;
+        for (auto &r : readers)
+            r.join();
+        EXPECT_EQ(torn.load(), 0);
+        EXPECT_LE(cache.size(), 1024u);
+        const auto stats = cache.stats();
+        EXPECT_GT(stats.hits + stats.misses, 0u);
+    }
+} // namespace plib::core::concurrent
@@ -9,11 +9,24 @@
 #include "log/config.hpp"
 #include "type/flatmap.hpp"
 #include "type/flatset.hpp"
+#include "type/flat_soa_map.hpp"
+#include "type/frozen_flat_map.hpp"
+#include "type/flat_hash_map.hpp"
+#include "type/flat_hash_set.hpp"
+#include "type/orderedset.hpp"
 #include "utils/common_util.hpp"
 #include "utils/path_util.hpp"
 #include <string>
 #include <memory>
 #include <cmath>
+#include <algorithm>
+#include <memory_resource>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include "memory/memorypool.hpp"
 using namespace plib::core::memory;
 using namespace plib::core::config;
@@ -346,6 +359,235 @@ TEST(FlatMapTest, StructuredBindings)
 	}
 }
 
+TEST(FlatMapTest, BulkInsertMerge)
+{
+	using map_t = plib::core::type::flat_map<int, std::string>;
+	using pair_t = map_t::value_type;
+	map_t v = {{1, "a"}, {5, "b"}, {9, "c"}};
+	std::vector<pair_t> batch;
+	batch.emplace_back(7, "x");
+	batch.emplace_back(5, "y");
+	batch.emplace_back(3, "z");
+	batch.emplace_back(7, "w");
+
+	// 已有的键保留原值，批次内重复的键取第一个
+	v.insert(batch.begin(), batch.end());
+	ASSERT_EQ(v.size(), 5);
+	EXPECT_EQ(v.find(5)->second, "b");
+	EXPECT_EQ(v.find(7)->second, "x");
+	EXPECT_EQ(v.find(3)->second, "z");
+
+	// insert_or_assign覆盖已有的键，批次内重复的键取最后一个
+	v.insert_or_assign(batch.begin(), batch.end());
+	ASSERT_EQ(v.size(), 5);
+	EXPECT_EQ(v.find(5)->second, "y");
+	EXPECT_EQ(v.find(7)->second, "w");
+
+	int expected[] = {1, 3, 5, 7, 9};
+	int i = 0;
+	for (const auto &[key, value] : v)
+	{
+		EXPECT_EQ(key, expected[i++]);
+	}
+
+	// 范围构造同样是第一个出现的键生效
+	map_t u(batch.begin(), batch.end());
+	ASSERT_EQ(u.size(), 3);
+	EXPECT_EQ(u.find(7)->second, "x");
+}
+
+TEST(FlatMapTest, SortedUniqueConstruction)
+{
+	using map_t = plib::core::type::flat_map<int, int>;
+	std::vector<map_t::value_type> sorted;
+	for (int i = 0; i < 1000; ++i)
+	{
+		sorted.emplace_back(i * 2, i);
+	}
+	map_t v(plib::core::type::sorted_unique, sorted.begin(), sorted.end());
+	ASSERT_EQ(v.size(), 1000);
+	EXPECT_EQ(v.find(500)->second, 250);
+
+	// 有序批次与已有数据交错时只做一次归并
+	std::vector<map_t::value_type> odd;
+	for (int i = 0; i < 1000; ++i)
+	{
+		odd.emplace_back(i * 2 + 1, -i);
+	}
+	v.insert(plib::core::type::sorted_unique, odd.begin(), odd.end());
+	ASSERT_EQ(v.size(), 2000);
+	int key = 0;
+	for (const auto &[k, value] : v)
+	{
+		ASSERT_EQ(k, key++);
+	}
+
+	// 有序但带重复键的输入线性去重
+	std::vector<map_t::value_type> dup;
+	dup.emplace_back(1, 1);
+	dup.emplace_back(1, 2);
+	dup.emplace_back(2, 3);
+	map_t d(plib::core::type::sorted_equivalent, dup.begin(), dup.end());
+	ASSERT_EQ(d.size(), 2);
+	EXPECT_EQ(d.find(1)->second, 1);
+}
+
+TEST(FlatMapTest, MultiMapBulkInsertIsStable)
+{
+	using map_t = plib::core::type::flat_multi_map<int, int>;
+	map_t v = {{2, 0}, {1, 0}, {2, 1}};
+	v.insert({{2, 2}, {0, 0}, {2, 3}, {3, 0}});
+	ASSERT_EQ(v.size(), 7);
+	EXPECT_EQ(v.count(2), 4);
+	// 等价键中原有元素在前，新元素保持输入顺序
+	int expected = 0;
+	for (const auto &[key, value] : v)
+	{
+		if (key == 2)
+		{
+			EXPECT_EQ(value, expected++);
+		}
+	}
+	EXPECT_EQ(v.front().first, 0);
+	EXPECT_EQ(v.back().first, 3);
+}
+
+TEST(FlatSoaMapTest, LookupAndInsert)
+{
+	plib::core::type::flat_soa_map<int, std::string> v;
+	v.emplace(5, "b");
+	v.emplace(0, "a");
+	v.insert({2, "e"});
+	v[4] = "d";
+	ASSERT_EQ(v.size(), 4);
+	EXPECT_FALSE(v.emplace(5, "x").second);
+	EXPECT_FALSE(v.insert_or_assign(2, "c").second);
+	EXPECT_EQ(v.find(2)->second, "c");
+	EXPECT_EQ(v.find(3), v.end());
+
+	// 键数组保持有序，迭代器返回代理引用
+	std::vector<int> keys = {0, 2, 4, 5};
+	ASSERT_EQ(v.keys(), keys);
+	for (auto [key, value] : v)
+	{
+		value += "!";
+	}
+	EXPECT_EQ(v.values().front(), "a!");
+
+	EXPECT_EQ(v.take(4).value(), "d!");
+	EXPECT_TRUE(v.remove(0));
+	EXPECT_FALSE(v.contains(0));
+	ASSERT_EQ(v.size(), 2);
+	EXPECT_EQ(v.begin()->first, 2);
+}
+
+TEST(FlatSoaMapTest, IntegerSearchMatchesLowerBound)
+{
+	// 覆盖无分支二分和窗口内计数的各种边界长度
+	for (int n : {0, 1, 3, 15, 16, 17, 33, 1000})
+	{
+		std::vector<std::pair<int, int>> items;
+		for (int i = 0; i < n; ++i)
+		{
+			items.emplace_back(i * 3 - n, i);
+		}
+		plib::core::type::flat_soa_map<int, int> v(plib::core::type::sorted_unique, items.begin(), items.end());
+		for (int key = -n - 2; key < 2 * n + 2; ++key)
+		{
+			auto expected = std::lower_bound(v.keys().begin(), v.keys().end(), key) - v.keys().begin();
+			ASSERT_EQ(v.lower_bound(key) - v.begin(), expected) << n << " " << key;
+			ASSERT_EQ(v.contains(key), (key + n) % 3 == 0 && key >= -n && key < 2 * n);
+		}
+	}
+}
+
+TEST(FlatSoaMapTest, BulkInsertMerge)
+{
+	plib::core::type::flat_soa_map<int, std::string> v = {{9, "c"}, {1, "a"}, {5, "b"}, {1, "z"}};
+	ASSERT_EQ(v.size(), 3);
+	EXPECT_EQ(v.find(1)->second, "a");
+
+	std::vector<std::pair<int, std::string>> batch = {{7, "x"}, {5, "y"}, {3, "z"}, {7, "w"}};
+	v.insert(batch.begin(), batch.end());
+	EXPECT_EQ(v.find(5)->second, "b");
+	EXPECT_EQ(v.find(7)->second, "x");
+	v.insert_or_assign(batch.begin(), batch.end());
+	EXPECT_EQ(v.find(5)->second, "y");
+	EXPECT_EQ(v.find(7)->second, "w");
+	std::vector<int> keys = {1, 3, 5, 7, 9};
+	EXPECT_EQ(v.keys(), keys);
+	std::vector<std::string> values = {"a", "z", "y", "w", "c"};
+	EXPECT_EQ(v.values(), values);
+}
+
+TEST(FrozenFlatMapTest, LookupsMatchFlatMap)
+{
+	// 覆盖空表、满二叉树和非满二叉树
+	for (int n : {0, 1, 2, 7, 8, 100, 1023, 5000})
+	{
+		plib::core::type::flat_map<int, int> source;
+		for (int i = 0; i < n; ++i)
+		{
+			source.emplace(i * 2, i);
+		}
+		plib::core::type::frozen_flat_map<int, int> v(source);
+		ASSERT_EQ(v.size(), static_cast<std::size_t>(n));
+		for (int key = -1; key <= 2 * n; ++key)
+		{
+			auto it = v.find(key);
+			if (key >= 0 && key % 2 == 0 && key < 2 * n)
+			{
+				ASSERT_NE(it, v.end()) << n << " " << key;
+				ASSERT_EQ(it->second, key / 2);
+				ASSERT_EQ(*v.get(key), key / 2);
+			}
+			else
+			{
+				ASSERT_EQ(it, v.end()) << n << " " << key;
+				ASSERT_EQ(v.get(key), nullptr);
+			}
+			auto lower = v.lower_bound(key);
+			auto upper = v.upper_bound(key);
+			auto expectedLower = (key < 0) ? 0 : (key + 1) / 2;
+			auto expectedUpper = (key < 0) ? 0 : key / 2 + 1;
+			ASSERT_EQ(lower == v.end() ? n : lower->first / 2, std::min(expectedLower, n));
+			ASSERT_EQ(upper == v.end() ? n : upper->first / 2, std::min(expectedUpper, n));
+		}
+
+		// 按键的顺序正反遍历
+		int expected = 0;
+		for (const auto &[key, value] : v)
+		{
+			ASSERT_EQ(key, expected * 2);
+			ASSERT_EQ(value, expected);
+			++expected;
+		}
+		ASSERT_EQ(expected, n);
+		for (auto it = v.end(); it != v.begin();)
+		{
+			--it;
+			ASSERT_EQ((--expected) * 2, it->first);
+		}
+	}
+}
+
+TEST(FrozenFlatMapTest, BuildFromRanges)
+{
+	plib::core::type::frozen_flat_map<int, std::string> v = {{5, "b"}, {1, "a"}, {5, "x"}, {9, "c"}};
+	ASSERT_EQ(v.size(), 3);
+	EXPECT_EQ(v.find(5)->second, "b");
+
+	plib::core::type::flat_map<int, std::unique_ptr<int>> owners;
+	owners.emplace(1, std::make_unique<int>(10));
+	owners.emplace(2, std::make_unique<int>(20));
+	plib::core::type::frozen_flat_map<int, std::unique_ptr<int>> moved(std::move(owners));
+	EXPECT_EQ(**moved.get(2), 20);
+
+	plib::core::type::flat_soa_map<int, int> soa = {{3, 30}, {4, 40}};
+	plib::core::type::frozen_flat_map<int, int> fromSoa(soa);
+	EXPECT_EQ(fromSoa.find(4)->second, 40);
+}
+
 // flat_set tests
 TEST(FlatSetTest, ShouldKeepItemsSorted)
 {
@@ -405,6 +647,337 @@ TEST(FlatSetTest, CustomComparators)
 	checkSorted();
 }
 
+TEST(FlatSetTest, MergeIsLinear)
+{
+	plib::core::type::flat_set<int> v = {1, 4, 9};
+	v.merge({7, 4, 2, 7, 10});
+	ASSERT_EQ(v.size(), 6);
+	std::vector<int> expected = {1, 2, 4, 7, 9, 10};
+	ASSERT_TRUE(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+	plib::core::type::flat_multi_set<int> m = {3, 1};
+	m.merge({3, 2, 1});
+	std::vector<int> all = {1, 1, 2, 3, 3};
+	ASSERT_TRUE(std::equal(m.begin(), m.end(), all.begin(), all.end()));
+
+	std::vector<int> sorted = {0, 5, 6};
+	plib::core::type::flat_set<int> s(plib::core::type::sorted_unique, sorted.begin(), sorted.end());
+	s.merge(plib::core::type::sorted_unique, all.begin(), all.end());
+	std::vector<int> merged = {0, 1, 2, 3, 5, 6};
+	ASSERT_TRUE(std::equal(s.begin(), s.end(), merged.begin(), merged.end()));
+}
+
+// 键值可平凡重定位时中间插入/删除走memmove，元素既不能丢也不能被析构两次
+TEST(FlatMapTest, RelocatableValues)
+{
+	static_assert(plib::core::type::is_trivially_relocatable_v<
+		plib::core::type::flat_multi_map_pair_type<int, std::unique_ptr<int>>>);
+	static_assert(!plib::core::type::is_trivially_relocatable_v<
+		plib::core::type::flat_multi_map_pair_type<int, std::set<int>>>);
+
+	plib::core::type::flat_map<int, std::unique_ptr<int>> v;
+	std::mt19937 rng(3);
+	std::set<int> expected;
+	for (int i = 0; i < 2000; ++i)
+	{
+		const int key = static_cast<int>(rng() % 1000);
+		if (rng() % 4 == 0)
+		{
+			ASSERT_EQ(v.remove(key), expected.erase(key) == 1);
+		}
+		else if (v.try_emplace(key, std::make_unique<int>(key)).second)
+		{
+			expected.insert(key);
+		}
+	}
+	ASSERT_EQ(v.size(), expected.size());
+	ASSERT_TRUE(std::equal(v.begin(), v.end(), expected.begin(), expected.end(),
+		[](const auto &pair, int key) { return pair.first == key && *pair.second == key; }));
+	auto first = v.begin() + 10;
+	v.erase(first, first + 50);
+	ASSERT_EQ(v.size(), expected.size() - 50);
+
+	auto shared = std::make_shared<int>(0);
+	plib::core::type::flat_multi_set<std::shared_ptr<int>> s;
+	for (int i = 0; i < 100; ++i)
+		s.insert(i % 2 == 0 ? shared : std::make_shared<int>(i));
+	ASSERT_EQ(shared.use_count(), 51);
+	s.removeAll(shared);
+	ASSERT_EQ(shared.use_count(), 1);
+	ASSERT_EQ(s.size(), 50);
+}
+
+// flat_hash_map tests
+TEST(FlatHashMapTest, MatchesUnorderedMap)
+{
+	plib::core::type::flat_hash_map<std::uint64_t, int> v;
+	std::unordered_map<std::uint64_t, int> expected;
+	std::mt19937_64 rng(1);
+	// 插入与删除交替进行，删除会留下墓碑，触发原容量重建
+	for (int i = 0; i < 200000; ++i)
+	{
+		const auto key = rng() % 20000;
+		if (rng() % 3 == 0)
+		{
+			ASSERT_EQ(v.erase(key), expected.erase(key));
+		}
+		else
+		{
+			ASSERT_EQ(v.insert_or_assign(key, i).second, expected.insert_or_assign(key, i).second);
+		}
+	}
+	ASSERT_EQ(v.size(), expected.size());
+	for (const auto &[key, value] : expected)
+	{
+		auto it = v.find(key);
+		ASSERT_NE(it, v.end());
+		ASSERT_EQ(it->second, value);
+	}
+	std::size_t visited = 0;
+	for (const auto &[key, value] : v)
+	{
+		ASSERT_EQ(expected.at(key), value);
+		++visited;
+	}
+	ASSERT_EQ(visited, expected.size());
+	EXPECT_LE(v.load_factor(), v.max_load_factor());
+
+	// 边遍历边删除
+	for (auto it = v.begin(); it != v.end();)
+	{
+		it = (it->first % 2 == 0) ? v.erase(it) : ++it;
+	}
+	for (const auto &[key, value] : v)
+	{
+		ASSERT_EQ(key % 2, 1u);
+	}
+	v.clear();
+	EXPECT_TRUE(v.empty());
+	EXPECT_EQ(v.find(1), v.end());
+}
+
+TEST(FlatHashMapTest, AccessorsAndCopies)
+{
+	plib::core::type::flat_hash_map<std::string, std::unique_ptr<int>> owners;
+	owners.reserve(100);
+	const auto capacity = owners.capacity();
+	for (int i = 0; i < 100; ++i)
+	{
+		owners.try_emplace(std::to_string(i), std::make_unique<int>(i));
+	}
+	EXPECT_EQ(owners.capacity(), capacity);
+	EXPECT_FALSE(owners.try_emplace("5", std::make_unique<int>(-1)).second);
+	EXPECT_EQ(*owners.at("5"), 5);
+	EXPECT_THROW(owners.at("x"), std::out_of_range);
+
+	plib::core::type::flat_hash_map<int, std::string> a = {{1, "a"}, {2, "b"}};
+	a[3] = "c";
+	auto b = a;
+	EXPECT_EQ(a, b);
+	b[3] = "d";
+	EXPECT_NE(a, b);
+	auto c = std::move(b);
+	EXPECT_TRUE(b.empty());
+	EXPECT_EQ(c.at(3), "d");
+	c = a;
+	EXPECT_EQ(c, a);
+}
+
+TEST(FlatHashMapTest, HeterogeneousLookup)
+{
+	plib::core::type::flat_hash_map<std::string, int, plib::core::type::string_hash, std::equal_to<>> v;
+	v.emplace("alpha", 1);
+	v["beta"] = 2;
+	std::string_view key = "alpha";
+	EXPECT_EQ(v.find(key)->second, 1);
+	EXPECT_TRUE(v.contains("beta"));
+	EXPECT_EQ(v.erase(std::string_view("beta")), 1u);
+	EXPECT_FALSE(v.contains("beta"));
+}
+
+TEST(FlatHashMapTest, NodeMapKeepsReferences)
+{
+	plib::core::type::node_hash_map<int, std::string> v;
+	auto &first = v[0];
+	first = "zero";
+	const auto *address = &v.find(0)->second;
+	for (int i = 1; i < 10000; ++i)
+	{
+		v[i] = std::to_string(i);
+	}
+	EXPECT_EQ(&v.find(0)->second, address);
+	EXPECT_EQ(first, "zero");
+
+	plib::core::type::node_hash_set<std::string> s = {"a", "b"};
+	const auto *a = &*s.find("a");
+	for (int i = 0; i < 1000; ++i)
+	{
+		s.insert(std::to_string(i));
+	}
+	EXPECT_EQ(&*s.find("a"), a);
+}
+
+TEST(FlatHashMapTest, SetWithAllocator)
+{
+	std::pmr::monotonic_buffer_resource arena;
+	plib::core::type::pmr::flat_hash_set<int> v(&arena);
+	for (int i = 0; i < 1000; ++i)
+	{
+		v.insert(i % 500);
+	}
+	EXPECT_EQ(v.size(), 500u);
+	EXPECT_TRUE(v.contains(499));
+	EXPECT_FALSE(v.contains(500));
+	EXPECT_EQ(v.get_allocator().resource(), &arena);
+
+	plib::core::type::pmr::flat_hash_map<int, std::pmr::string> m(&arena);
+	m.try_emplace(1, "a long string that does not fit in the small buffer");
+	EXPECT_EQ(m.at(1).get_allocator().resource(), &arena);
+}
+
+// 元素本身是pair的集合不能被当成映射，整个pair都是键
+TEST(FlatHashMapTest, SetOfPairs)
+{
+	struct pair_hash
+	{
+		std::size_t operator()(const std::pair<int, int>& p) const noexcept
+		{
+			return std::hash<long long>()((static_cast<long long>(p.first) << 32) ^ static_cast<unsigned>(p.second));
+		}
+	};
+	plib::core::type::flat_hash_set<std::pair<int, int>, pair_hash> s;
+	plib::core::type::node_hash_set<std::pair<int, int>, pair_hash> n;
+	for (int i = 0; i < 1000; ++i)
+	{
+		s.insert({i % 10, i % 7});
+		n.emplace(i % 10, i % 7);
+	}
+	EXPECT_EQ(s.size(), 70u);
+	EXPECT_EQ(n.size(), 70u);
+	EXPECT_TRUE(s.contains({3, 4}));
+	EXPECT_FALSE(s.contains({3, 7}));
+	EXPECT_EQ(s.erase({3, 4}), 1u);
+	EXPECT_FALSE(s.contains({3, 4}));
+	EXPECT_TRUE(n.contains({9, 6}));
+}
+
+TEST(OrderedSetTest, MatchesStdSet)
+{
+	plib::core::type::OrderedSet<int> set;
+	std::set<int> expected;
+	std::mt19937 rng(11);
+	std::uniform_int_distribution<int> dist(0, 20000);
+	// 足够多的元素，让树长到三层并反复触发分裂、借位与合并
+	for (int round = 0; round < 3; ++round)
+	{
+		for (int i = 0; i < 40000; ++i)
+		{
+			const int v = dist(rng);
+			EXPECT_EQ(set.insert(v).second, expected.insert(v).second);
+		}
+		for (int i = 0; i < 40000; ++i)
+		{
+			const int v = dist(rng);
+			EXPECT_EQ(set.erase(v), expected.erase(v));
+		}
+		ASSERT_EQ(set.size(), expected.size());
+		EXPECT_TRUE(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+		EXPECT_TRUE(std::equal(set.rbegin(), set.rend(), expected.rbegin(), expected.rend()));
+		for (int probe = -1; probe <= 20001; probe += 7)
+		{
+			auto it = set.lower_bound(probe);
+			auto ref = expected.lower_bound(probe);
+			EXPECT_EQ(it == set.end(), ref == expected.end());
+			if (ref != expected.end())
+			{
+				EXPECT_EQ(*it, *ref);
+			}
+			EXPECT_EQ(set.contains(probe), expected.count(probe) == 1);
+		}
+	}
+	while (!expected.empty())
+	{
+		EXPECT_EQ(set.erase(*expected.begin()), 1u);
+		expected.erase(expected.begin());
+	}
+	EXPECT_TRUE(set.empty());
+	EXPECT_EQ(set.begin(), set.end());
+}
+
+template <typename Set>
+concept InsertsIntPair = requires(Set& set) { set.insert(1, 2); };
+
+TEST(OrderedSetTest, BulkLoadAndRangeQueries)
+{
+	// 迭代器区间重载只接受迭代器，不会抢走整数参数
+	static_assert(!std::is_constructible_v<plib::core::type::OrderedSet<int>, int, int>);
+	static_assert(!InsertsIntPair<plib::core::type::OrderedSet<int>>);
+	static_assert(std::is_constructible_v<plib::core::type::OrderedSet<int>, const int*, const int*>);
+
+	std::vector<int> sorted;
+	for (int i = 0; i < 100000; ++i)
+	{
+		sorted.push_back(i * 2);
+	}
+	plib::core::type::OrderedSet<int> set(plib::core::type::sorted_unique, sorted.begin(), sorted.end());
+	EXPECT_EQ(set.size(), sorted.size());
+	EXPECT_EQ(set.first(), 0);
+	EXPECT_EQ(set.last(), 199998);
+	EXPECT_EQ(set.values(), sorted);
+
+	int count = 0;
+	for (int v : set.range(1001, 2001))
+	{
+		EXPECT_EQ(v, 1002 + count * 2);
+		++count;
+	}
+	EXPECT_EQ(count, 500);
+	EXPECT_TRUE(set.range(10, 10).empty());
+	EXPECT_EQ(*set.upper_bound(10), 12);
+	EXPECT_EQ(set.upper_bound(199998), set.end());
+	auto [lo, hi] = set.equal_range(40);
+	EXPECT_EQ(std::distance(lo, hi), 1);
+
+	// 批量构建后的树可以继续正常插入删除
+	set.insert(1);
+	EXPECT_EQ(*std::next(set.begin()), 1);
+	auto it = set.erase(set.find(1));
+	EXPECT_EQ(*it, 2);
+	it = set.erase(set.lower_bound(1000), set.lower_bound(3000));
+	EXPECT_EQ(*it, 3000);
+	EXPECT_EQ(set.size(), sorted.size() - 1000);
+
+	// 乱序输入会先排序去重
+	plib::core::type::OrderedSet<std::string> words{"pear", "apple", "fig", "apple"};
+	EXPECT_EQ(words.values(), (std::vector<std::string>{"apple", "fig", "pear"}));
+}
+
+TEST(OrderedSetTest, CopyMoveAndAllocator)
+{
+	plib::core::type::OrderedSet<int, std::greater<>> set;
+	for (int i = 0; i < 5000; ++i)
+	{
+		set.insert(i);
+	}
+	EXPECT_EQ(set.first(), 4999);
+
+	auto copy = set;
+	EXPECT_EQ(copy, set);
+	auto moved = std::move(copy);
+	EXPECT_TRUE(copy.empty());
+	EXPECT_EQ(moved.size(), 5000u);
+	moved.erase(moved.begin(), moved.end());
+	EXPECT_TRUE(moved.empty());
+
+	std::pmr::monotonic_buffer_resource arena;
+	plib::core::type::pmr::OrderedSet<int> pooled(&arena);
+	pooled.insert({3, 1, 2});
+	const std::vector<int> more{5, 4, 3};
+	pooled.insert(more.begin(), more.end());
+	EXPECT_EQ(pooled.values(), (std::vector<int>{1, 2, 3, 4, 5}));
+	EXPECT_EQ(pooled.get_allocator().resource(), &arena);
+}
+
 TEST(LoggerTest, BasicLogToFile)
 {
 	// 假设 Logger 支持设置日志文件
@@ -507,6 +1080,28 @@ TEST(MemoryPoolTest, MultipleAllocationAndDeletion)
 	pool.deleteElement(reuse);
 }
 
+// 测试 MemoryPool 的批量分配与批量释放
+TEST(MemoryPoolTest, BulkAllocateAndDeallocate)
+{
+	MemoryPool<int> pool;
+	const std::size_t count = 5000; // 跨越多个 4KB 块
+	std::vector<int *> ptrs(count);
+	pool.allocate_bulk(count, ptrs.data());
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		pool.construct(ptrs[i], static_cast<int>(i));
+	}
+	EXPECT_EQ(std::set<int *>(ptrs.begin(), ptrs.end()).size(), count);
+	EXPECT_EQ(*ptrs[count - 1], static_cast<int>(count - 1));
+
+	// 批量释放后按原顺序取回
+	pool.deallocate_bulk(ptrs.data(), count);
+	std::vector<int *> again(count);
+	pool.allocate_bulk(count, again.data());
+	EXPECT_EQ(again, ptrs);
+	pool.deallocate_bulk(again.data(), count);
+}
+
 int main(int argc, char **argv)
 {
 	::testing::InitGoogleTest(&argc, argv);
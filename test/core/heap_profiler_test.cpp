@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include "memory/concurrent_memorypool.hpp"
+#include "memory/heap_profiler.hpp"
+#include "memory/memorypool.hpp"
+#include "memory/slab_allocator.hpp"
+#include "utils/object_pool.hpp"
+
+#include <cstdint>
+#include <list>
+#include <source_location>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace plib::core::memory
+{
+    namespace
+    {
+        HeapStatsSnapshot find_site(const std::string &name, const std::source_location &loc, std::size_t object_size)
+        {
+            for (const auto &s : HeapProfiler::instance().snapshot())
+                if (s.name == name && s.line == loc.line() && s.object_size == object_size)
+                    return s;
+            ADD_FAILURE() << "heap site not found: " << name << " line " << loc.line();
+            return {};
+        }
+
+        struct Payload
+        {
+            std::uint64_t data[8];
+        };
+
+        // 每个用例使用默认设置并从干净的计数开始
+        class HeapProfilerTest : public ::testing::Test
+        {
+        protected:
+            void SetUp() override
+            {
+                auto &profiler = HeapProfiler::instance();
+                profiler.set_enabled(true);
+                profiler.set_sample_interval(HeapProfiler::kDefaultSampleInterval);
+                profiler.set_sample_capacity(HeapProfiler::kDefaultSampleCapacity);
+                profiler.reset();
+            }
+
+            void TearDown() override { SetUp(); }
+        };
+    }
+
+    // 节点容器通过rebind出的分配器分配，统计仍归到用户构造池的位置
+    TEST_F(HeapProfilerTest, ReboundAllocatorKeepsSite)
+    {
+        auto loc = std::source_location::current();
+        MemoryPool<Payload> pool(loc);
+        static_assert(std::is_nothrow_constructible_v<MemoryPool<int>, const MemoryPool<Payload> &>);
+        {
+            std::list<Payload, MemoryPool<Payload>> list(pool);
+            for (int i = 0; i < 5; ++i)
+                list.emplace_back();
+        }
+        bool found = false;
+        for (const auto &s : HeapProfiler::instance().snapshot())
+        {
+            EXPECT_FALSE(s.name == "MemoryPool" && s.file.find("memorypool.hpp") != std::string::npos);
+            if (s.name == "MemoryPool" && s.line == loc.line() && s.object_size > sizeof(Payload))
+            {
+                found = true;
+                EXPECT_EQ(s.allocs, 5u);
+                EXPECT_EQ(s.frees, 5u);
+            }
+        }
+        EXPECT_TRUE(found);
+    }
+
+    // 存活/峰值字节数与分配/释放次数
+    TEST_F(HeapProfilerTest, LiveAndPeakPerPool)
+    {
+        auto loc = std::source_location::current();
+        utils::ObjectPool<Payload> pool(1, loc);
+        std::vector<Payload *> objs;
+        for (int i = 0; i < 10; ++i)
+            objs.push_back(pool.animate());
+        for (int i = 0; i < 4; ++i)
+            pool.recycle(objs[i]);
+
+        auto s = find_site("ObjectPool", loc, sizeof(Payload));
+        EXPECT_EQ(s.allocs, 10u);
+        EXPECT_EQ(s.frees, 4u);
+        EXPECT_EQ(s.live_bytes, static_cast<std::int64_t>(6 * sizeof(Payload)));
+        EXPECT_EQ(s.peak_bytes, static_cast<std::int64_t>(10 * sizeof(Payload)));
+        EXPECT_EQ(s.alloc_bytes, 10 * sizeof(Payload));
+        EXPECT_GT(s.allocs_per_sec, 0.0);
+
+        // 批量接口同样计数
+        Payload *more[6];
+        ASSERT_EQ(pool.animate_n(6, more), 6u);
+        pool.recycle_n(more, 6);
+        pool.recycle_n(objs.data() + 4, 6);
+        s = find_site("ObjectPool", loc, sizeof(Payload));
+        EXPECT_EQ(s.allocs, 16u);
+        EXPECT_EQ(s.frees, 16u);
+        EXPECT_EQ(s.live_bytes, 0);
+        EXPECT_EQ(s.peak_bytes, static_cast<std::int64_t>(12 * sizeof(Payload)));
+    }
+
+    // MemoryPool与ConcurrentMemoryPool，多线程下计数不丢失
+    TEST_F(HeapProfilerTest, FixedSizePools)
+    {
+        auto loc = std::source_location::current();
+        MemoryPool<Payload> pool(loc);
+        Payload *bulk[20];
+        pool.allocate_bulk(20, bulk);
+        pool.deallocate(bulk[0]);
+        pool.deallocate_bulk(bulk + 1, 9);
+        auto s = find_site("MemoryPool", loc, sizeof(Payload));
+        EXPECT_EQ(s.allocs, 20u);
+        EXPECT_EQ(s.frees, 10u);
+        EXPECT_EQ(s.live_bytes, static_cast<std::int64_t>(10 * sizeof(Payload)));
+        pool.deallocate_bulk(bulk + 10, 10);
+
+        ConcurrentMemoryPool<Payload> shared(loc);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t)
+        {
+            workers.emplace_back([&]
+                                 {
+                for (int i = 0; i < 1000; ++i)
+                    shared.deleteElement(shared.newElement()); });
+        }
+        for (auto &w : workers)
+            w.join();
+        s = find_site("ConcurrentMemoryPool", loc, sizeof(Payload));
+        EXPECT_EQ(s.allocs, 4000u);
+        EXPECT_EQ(s.frees, 4000u);
+        EXPECT_EQ(s.live_bytes, 0);
+        EXPECT_GE(s.peak_bytes, static_cast<std::int64_t>(sizeof(Payload)));
+    }
+
+    // slab按级别统计，大对象单独一个统计点
+    TEST_F(HeapProfilerTest, SlabSizeClasses)
+    {
+        auto loc = std::source_location::current();
+        SlabHeap heap(loc);
+        void *a = heap.allocate(20, 8);
+        void *b = heap.allocate(24, 8);
+        void *big = heap.allocate(100 * 1024);
+        auto small = find_site("SlabHeap", loc, 24);
+        EXPECT_EQ(small.allocs, 2u);
+        EXPECT_EQ(small.live_bytes, 48);
+        auto large = find_site("SlabHeap", loc, 0);
+        EXPECT_EQ(large.allocs, 1u);
+        EXPECT_EQ(large.live_bytes, 100 * 1024);
+        heap.deallocate(a, 20, 8);
+        heap.deallocate(b, 24, 8);
+        heap.deallocate(big, 100 * 1024);
+        EXPECT_EQ(find_site("SlabHeap", loc, 24).live_bytes, 0);
+        EXPECT_EQ(find_site("SlabHeap", loc, 0).live_bytes, 0);
+    }
+
+    // 运行时关闭计数后不再记录
+    TEST_F(HeapProfilerTest, RuntimeDisable)
+    {
+        auto loc = std::source_location::current();
+        MemoryPool<Payload> pool(loc);
+        HeapProfiler::instance().set_enabled(false);
+        pool.deleteElement(pool.newElement());
+        HeapProfiler::instance().set_enabled(true);
+        pool.deleteElement(pool.newElement());
+        auto s = find_site("MemoryPool", loc, sizeof(Payload));
+        EXPECT_EQ(s.allocs, 1u);
+        EXPECT_EQ(s.frees, 1u);
+
+        HeapProfiler::instance().reset();
+        EXPECT_EQ(find_site("MemoryPool", loc, sizeof(Payload)).allocs, 0u);
+        EXPECT_NE(HeapProfiler::instance().report_text().find("MemoryPool"), std::string::npos);
+    }
+
+    // 采样记录调用栈与存活状态，导出pprof和折叠栈文本
+    TEST_F(HeapProfilerTest, SamplingAndReports)
+    {
+        auto &profiler = HeapProfiler::instance();
+        // 间隔远小于对象大小，几乎每次分配都会被采到
+        profiler.set_sample_interval(8);
+        auto loc = std::source_location::current();
+        MemoryPool<Payload> pool(loc);
+        std::vector<Payload *> objs;
+        for (int i = 0; i < 200; ++i)
+            objs.push_back(pool.newElement());
+        for (int i = 0; i < 100; ++i)
+            pool.deleteElement(objs[i]);
+
+        auto samples = profiler.samples();
+        ASSERT_GT(samples.size(), 150u);
+        std::size_t live = 0;
+        for (const auto &s : samples)
+        {
+            EXPECT_EQ(s.bytes, sizeof(Payload));
+            EXPECT_EQ(s.site->name, "MemoryPool");
+            EXPECT_GT(s.depth, 0u);
+            live += s.live ? 1 : 0;
+        }
+        EXPECT_GT(live, 50u);
+        EXPECT_LE(live, 100u);
+
+        auto pprof = profiler.report_pprof();
+        EXPECT_EQ(pprof.rfind("heap profile: ", 0), 0u);
+        EXPECT_NE(pprof.find("@ heap_v2/8\n"), std::string::npos);
+        EXPECT_NE(pprof.find("MAPPED_LIBRARIES:"), std::string::npos);
+
+        // 每行是 栈 空格 字节数
+        std::istringstream folded(profiler.report_folded());
+        std::string line;
+        int lines = 0;
+        while (std::getline(folded, line))
+        {
+            ++lines;
+            auto space = line.rfind(' ');
+            ASSERT_NE(space, std::string::npos);
+            EXPECT_NE(line.find(";[MemoryPool]"), std::string::npos);
+            EXPECT_GT(std::stoull(line.substr(space + 1)), 0u);
+        }
+        EXPECT_GT(lines, 0);
+
+        // 环形缓冲区满了之后覆盖最早的记录
+        profiler.set_sample_capacity(16);
+        for (int i = 100; i < 200; ++i)
+            pool.deleteElement(objs[i]);
+        for (int i = 0; i < 100; ++i)
+            objs[i] = pool.newElement();
+        EXPECT_EQ(profiler.samples().size(), 16u);
+        for (int i = 0; i < 100; ++i)
+            pool.deleteElement(objs[i]);
+        for (const auto &s : profiler.samples())
+            EXPECT_FALSE(s.live);
+    }
+} // namespace plib::core::memory
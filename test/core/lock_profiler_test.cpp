@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "concurrent/rwlock.hpp"
+#include "concurrent/spinlock.hpp"
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace plib::core::concurrent
+{
+    namespace
+    {
+        LockStatsSnapshot find_site(const std::string &name)
+        {
+            for (const auto &s : LockProfiler::instance().snapshot())
+                if (s.name == name)
+                    return s;
+            ADD_FAILURE() << "lock site not found: " << name;
+            return {};
+        }
+
+        template <typename Lock>
+        void hammer(Lock &lock, int threads, int iterations, long &counter)
+        {
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&]
+                                     {
+                    for (int i = 0; i < iterations; ++i) {
+                        std::lock_guard<Lock> guard(lock);
+                        ++counter;
+                    } });
+            }
+            for (auto &w : workers)
+                w.join();
+        }
+    }
+
+    // 单线程下所有获取都是无竞争的
+    TEST(LockProfilerTest, UncontendedAcquisitions)
+    {
+        Spinlock lock("test.uncontended");
+        for (int i = 0; i < 100; ++i)
+        {
+            lock.lock();
+            lock.unlock();
+        }
+        auto s = find_site("test.uncontended");
+        EXPECT_EQ(s.acquisitions, 100u);
+        EXPECT_EQ(s.contended, 0u);
+        EXPECT_EQ(s.wait_cycles, 0u);
+    }
+
+    // 多线程争用同一把锁时记录竞争次数与等待时间
+    TEST(LockProfilerTest, ContendedSpinlocks)
+    {
+        constexpr int kThreads = 2, kIters = 5000;
+        long counter = 0;
+        Spinlock spin("test.spin");
+        hammer(spin, kThreads, kIters, counter);
+        FairSpinLock fair("test.fair");
+        hammer(fair, kThreads, kIters, counter);
+        UnfairSpinlock unfair("test.unfair");
+        hammer(unfair, kThreads, kIters, counter);
+        EXPECT_EQ(counter, 3L * kThreads * kIters);
+
+        for (const char *name : {"test.spin", "test.fair", "test.unfair"})
+        {
+            auto s = find_site(name);
+            EXPECT_EQ(s.acquisitions, static_cast<std::uint64_t>(kThreads * kIters)) << name;
+            EXPECT_LE(s.contended, s.acquisitions) << name;
+            if (s.contended > 0)
+            {
+                EXPECT_GT(s.wait_cycles, 0u) << name;
+            }
+        }
+    }
+
+    // 同名的多个实例归到同一个统计点，未命名时按构造位置归类
+    TEST(LockProfilerTest, SiteAttribution)
+    {
+        Spinlock a("test.shared"), b("test.shared");
+        a.lock();
+        a.unlock();
+        b.lock();
+        b.unlock();
+        EXPECT_EQ(find_site("test.shared").acquisitions, 2u);
+
+        Spinlock anonymous(std::source_location::current());
+        anonymous.lock();
+        anonymous.unlock();
+        bool found = false;
+        for (const auto &s : LockProfiler::instance().snapshot())
+            found |= s.name.find("lock_profiler_test.cpp:") != std::string::npos && s.acquisitions == 1;
+        EXPECT_TRUE(found);
+
+        // 默认构造(包括聚合中值初始化的成员)归到"<unnamed>"
+        struct Holder
+        {
+            int x;
+            FairSpinLock lock;
+        };
+        Holder holder = {1, {}};
+        holder.lock.lock();
+        holder.lock.unlock();
+        EXPECT_GE(find_site("<unnamed>").acquisitions, 1u);
+    }
+
+    TEST(LockProfilerTest, LockedRWAndReports)
+    {
+        LockedRW<int> value(0, "test.rw");
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t)
+        {
+            workers.emplace_back([&, t]
+                                 {
+                for (int i = 0; i < 1000; ++i) {
+                    if (t == 0)
+                        value.access_write([](int &v) { ++v; });
+                    else
+                        value.access_read([](const int &v) { return v; });
+                } });
+        }
+        for (auto &w : workers)
+            w.join();
+        EXPECT_EQ(value.access_read([](const int &v)
+                                    { return v; }),
+                  1000);
+        EXPECT_EQ(find_site("test.rw").acquisitions, 4001u);
+
+        auto text = LockProfiler::instance().report_text();
+        EXPECT_NE(text.find("test.rw"), std::string::npos);
+        auto json = LockProfiler::instance().report_json();
+        EXPECT_EQ(json.front(), '[');
+        EXPECT_NE(json.find("\"name\":\"test.rw\""), std::string::npos);
+
+        LockProfiler::instance().reset();
+        EXPECT_EQ(find_site("test.rw").acquisitions, 0u);
+    }
+} // namespace plib::core::concurrent
@@ -0,0 +1,582 @@
+#include <gtest/gtest.h>
+#include "memory/arena.hpp"
+#include "memory/block_provider.hpp"
+#include "memory/concurrent_memorypool.hpp"
+#include "memory/memorypool.hpp"
+#include "memory/pool_ptr.hpp"
+#include "memory/slab_allocator.hpp"
+#include "type/flatmap.hpp"
+#include "type/flatset.hpp"
+#include "utils/object_pool.hpp"
+#include "utils/small_vector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace plib::core::memory
+{
+    // 测试 ConcurrentMemoryPool 的基本分配、构造与复用
+    TEST(ConcurrentMemoryPoolTest, BasicAllocationAndReuse)
+    {
+        ConcurrentMemoryPool<std::string, 4096, 8> pool;
+        std::string *a = pool.newElement("hello");
+        ASSERT_NE(a, nullptr);
+        EXPECT_EQ(*a, "hello");
+        pool.deleteElement(a);
+
+        // 刚释放的槽位在本线程的弹匣顶部，下一次分配会复用它
+        std::string *b = pool.newElement("world");
+        EXPECT_EQ(a, b);
+        pool.deleteElement(b);
+        EXPECT_EQ(pool.block_count(), 1u);
+    }
+
+    // 测试分配出的地址互不重叠且满足对齐
+    TEST(ConcurrentMemoryPoolTest, DistinctAlignedSlots)
+    {
+        struct alignas(32) Wide
+        {
+            char data[40];
+        };
+        ConcurrentMemoryPool<Wide, 4096, 4> pool;
+        std::set<Wide *> seen;
+        std::vector<Wide *> ptrs;
+        for (int i = 0; i < 1000; ++i)
+        {
+            Wide *p = pool.allocate();
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % alignof(Wide), 0u);
+            EXPECT_TRUE(seen.insert(p).second);
+            ptrs.push_back(p);
+        }
+        EXPECT_GE(pool.capacity(), 1000u);
+        for (auto *p : ptrs)
+            pool.deallocate(p);
+        // 全部归还后再次分配不需要新的内存块
+        auto blocks = pool.block_count();
+        for (int i = 0; i < 1000; ++i)
+            ptrs[i] = pool.allocate();
+        EXPECT_EQ(pool.block_count(), blocks);
+        for (auto *p : ptrs)
+            pool.deallocate(p);
+    }
+
+    // 生产者线程分配、消费者线程释放，模拟跨线程传递的消息对象
+    TEST(ConcurrentMemoryPoolTest, CrossThreadFree)
+    {
+        ConcurrentMemoryPool<std::uint64_t, 4096, 16> pool;
+        constexpr int kPerThread = 20000;
+        std::vector<std::vector<std::uint64_t *>> handoff(4);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t)
+        {
+            producers.emplace_back([&, t]
+                                   {
+                for (int i = 0; i < kPerThread; ++i)
+                    handoff[t].push_back(pool.newElement(std::uint64_t(t) << 32 | i)); });
+        }
+        for (auto &p : producers)
+            p.join();
+
+        std::atomic<int> bad{0};
+        std::vector<std::thread> consumers;
+        for (int t = 0; t < 4; ++t)
+        {
+            consumers.emplace_back([&, t]
+                                   {
+                // 释放别的线程分配的对象，再自己分配一轮，检查数据没有被破坏
+                auto &mine = handoff[(t + 1) % 4];
+                for (int i = 0; i < kPerThread; ++i) {
+                    if (*mine[i] != (std::uint64_t((t + 1) % 4) << 32 | i))
+                        bad.fetch_add(1);
+                    pool.deleteElement(mine[i]);
+                }
+                std::vector<std::uint64_t *> again;
+                for (int i = 0; i < kPerThread; ++i)
+                    again.push_back(pool.newElement(std::uint64_t(i)));
+                for (int i = 0; i < kPerThread; ++i) {
+                    if (*again[i] != std::uint64_t(i))
+                        bad.fetch_add(1);
+                    pool.deleteElement(again[i]);
+                } });
+        }
+        for (auto &c : consumers)
+            c.join();
+        EXPECT_EQ(bad.load(), 0);
+        // 线程退出时缓存被归还，总容量不会超过峰值占用太多
+        EXPECT_LE(pool.capacity(), 4u * kPerThread + 4 * 4096);
+    }
+
+    // 多线程同时分配释放，检查没有槽位被重复分配
+    TEST(ConcurrentMemoryPoolTest, ConcurrentChurn)
+    {
+        ConcurrentMemoryPool<std::atomic<int>, 4096, 8> pool;
+        std::atomic<int> bad{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&]
+                                 {
+                std::vector<std::atomic<int> *> held;
+                for (int round = 0; round < 200; ++round) {
+                    for (int i = 0; i < 64; ++i) {
+                        auto *p = pool.newElement(0);
+                        // 若同一槽位同时被两个线程持有，计数会超过1
+                        if (p->fetch_add(1) != 0)
+                            bad.fetch_add(1);
+                        held.push_back(p);
+                    }
+                    for (auto *p : held) {
+                        p->fetch_sub(1);
+                        pool.deleteElement(p);
+                    }
+                    held.clear();
+                } });
+        }
+        for (auto &t : threads)
+            t.join();
+        EXPECT_EQ(bad.load(), 0);
+    }
+
+    // 尺寸分级单调、覆盖8B~32KB且满足对齐
+    TEST(SlabAllocatorTest, SizeClasses)
+    {
+        using C = SlabSizeClasses;
+        for (std::size_t c = 1; c < C::kCount; ++c)
+        {
+            EXPECT_GT(C::size_of(c), C::size_of(c - 1));
+            EXPECT_LE(C::size_of(c) * 4, C::size_of(c - 1) * 5 + 32);
+        }
+        for (std::size_t bytes = 1; bytes <= C::kMaxSize; ++bytes)
+        {
+            std::size_t c = C::classify(bytes, 8);
+            ASSERT_LT(c, C::kCount);
+            EXPECT_GE(C::size_of(c), bytes);
+            EXPECT_TRUE(c == 0 || C::size_of(c - 1) < bytes);
+        }
+        for (std::size_t align = 16; align <= 4096; align <<= 1)
+            EXPECT_EQ(C::size_of(C::classify(24, align)) % align, 0u);
+        EXPECT_EQ(C::classify(C::kMaxSize + 1, 8), C::kLarge);
+        EXPECT_EQ(C::classify(64, 8192), C::kLarge);
+    }
+
+    // 各种大小混合分配，内容互不干扰，释放后复用而不再申请span
+    TEST(SlabAllocatorTest, MixedSizesRoundTrip)
+    {
+        SlabHeap heap;
+        struct Alloc
+        {
+            unsigned char *p;
+            std::size_t bytes;
+            std::size_t align;
+        };
+        std::vector<Alloc> allocs;
+        const std::size_t sizes[] = {1, 8, 13, 24, 100, 129, 500, 1024, 4000, 9000, 32768, 40000};
+        const std::size_t aligns[] = {1, 8, 16, 64};
+        for (int round = 0; round < 20; ++round)
+            for (std::size_t bytes : sizes)
+                for (std::size_t align : aligns)
+                {
+                    auto *p = static_cast<unsigned char *>(heap.allocate(bytes, align));
+                    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % align, 0u);
+                    std::memset(p, static_cast<int>(allocs.size() & 0xff), bytes);
+                    allocs.push_back({p, bytes, align});
+                }
+        for (std::size_t i = 0; i < allocs.size(); ++i)
+        {
+            const auto &a = allocs[i];
+            EXPECT_EQ(a.p[0], static_cast<unsigned char>(i & 0xff));
+            EXPECT_EQ(a.p[a.bytes - 1], static_cast<unsigned char>(i & 0xff));
+        }
+        for (auto &a : allocs)
+            heap.deallocate(a.p, a.bytes, a.align);
+        auto spans = heap.span_count();
+        for (auto &a : allocs)
+            a.p = static_cast<unsigned char *>(heap.allocate(a.bytes, a.align));
+        EXPECT_EQ(heap.span_count(), spans);
+        for (auto &a : allocs)
+            heap.deallocate(a.p, a.bytes, a.align);
+    }
+
+    // 作为pmr资源和标准分配器供容器使用
+    TEST(SlabAllocatorTest, ContainerAdapters)
+    {
+        SlabHeap heap;
+        SlabMemoryResource resource(heap);
+        {
+            std::pmr::vector<std::pmr::string> names(&resource);
+            for (int i = 0; i < 1000; ++i)
+                names.emplace_back("request-handler-name-" + std::to_string(i));
+            EXPECT_EQ(names[999], "request-handler-name-999");
+            std::pmr::unordered_map<int, int> index(&resource);
+            for (int i = 0; i < 1000; ++i)
+                index[i] = i * 2;
+            EXPECT_EQ(index[500], 1000);
+        }
+        EXPECT_GT(heap.span_count(), 0u);
+        EXPECT_TRUE(resource.is_equal(SlabMemoryResource(heap)));
+        EXPECT_FALSE(resource.is_equal(*std::pmr::new_delete_resource()));
+
+        std::vector<int, SlabAllocator<int>> v{SlabAllocator<int>(heap)};
+        for (int i = 0; i < 10000; ++i)
+            v.push_back(i);
+        EXPECT_EQ(v[9999], 9999);
+        std::map<int, std::string, std::less<int>, SlabAllocator<std::pair<const int, std::string>>> m;
+        for (int i = 0; i < 100; ++i)
+            m.emplace(i, std::to_string(i));
+        EXPECT_EQ(m.at(42), "42");
+        EXPECT_TRUE(SlabAllocator<int>(heap) == SlabAllocator<double>(heap));
+        EXPECT_FALSE(SlabAllocator<int>(heap) == SlabAllocator<int>());
+    }
+
+    // 跨线程释放：对象回到释放线程的缓存，线程退出时归还中心链表
+    TEST(SlabAllocatorTest, CrossThreadFree)
+    {
+        SlabHeap heap;
+        constexpr int kPerThread = 5000;
+        std::vector<std::vector<std::uint64_t *>> handoff(2);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t)
+        {
+            threads.emplace_back([&, t]
+                                 {
+                for (int i = 0; i < kPerThread; ++i) {
+                    auto *p = static_cast<std::uint64_t *>(heap.allocate(8 + (i % 64) * 8, 8));
+                    *p = std::uint64_t(t) << 32 | i;
+                    handoff[t].push_back(p);
+                } });
+        }
+        for (auto &th : threads)
+            th.join();
+        threads.clear();
+        std::atomic<int> bad{0};
+        for (int t = 0; t < 2; ++t)
+        {
+            threads.emplace_back([&, t]
+                                 {
+                int owner = (t + 1) % 2;
+                auto &mine = handoff[owner];
+                for (int i = 0; i < kPerThread; ++i) {
+                    if (*mine[i] != (std::uint64_t(owner) << 32 | i))
+                        bad.fetch_add(1);
+                    heap.deallocate(mine[i], 8 + (i % 64) * 8, 8);
+                } });
+        }
+        for (auto &th : threads)
+            th.join();
+        EXPECT_EQ(bad.load(), 0);
+    }
+    // 测试 Arena 的对齐、超大分配以及reset保留块
+    TEST(ArenaTest, BumpAlignAndReset)
+    {
+        Arena arena(1024);
+        auto *a = static_cast<char *>(arena.allocate(3, 1));
+        auto *b = arena.allocate(8, 64);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(b) % 64, 0u);
+        EXPECT_NE(static_cast<void *>(a), b);
+        EXPECT_EQ(arena.chunk_count(), 1u);
+
+        // 超过块大小的分配单独占一个块
+        void *big = arena.allocate(4096);
+        ASSERT_NE(big, nullptr);
+        std::memset(big, 0xab, 4096);
+        EXPECT_EQ(arena.chunk_count(), 2u);
+        const std::size_t reserved = arena.bytes_reserved();
+
+        arena.reset();
+        EXPECT_EQ(arena.bytes_allocated(), 0u);
+        EXPECT_EQ(arena.chunk_count(), 2u);
+        EXPECT_EQ(arena.bytes_reserved(), reserved);
+        // reset后从第一个块重新开始分配，不再向上游申请
+        EXPECT_EQ(arena.allocate(3, 1), static_cast<void *>(a));
+        arena.allocate(4096);
+        EXPECT_EQ(arena.chunk_count(), 2u);
+
+        // 大到会让地址回绕的请求不能走快路径
+        EXPECT_THROW(arena.allocate(std::numeric_limits<std::size_t>::max() - 8, 1), std::bad_alloc);
+        EXPECT_EQ(arena.chunk_count(), 2u);
+
+        arena.release();
+        EXPECT_EQ(arena.chunk_count(), 0u);
+        EXPECT_EQ(arena.bytes_reserved(), 0u);
+    }
+
+    // 测试登记的析构函数按构造的逆序执行
+    TEST(ArenaTest, DestructorsRunInReverseOrder)
+    {
+        std::vector<int> order;
+        struct Tracked
+        {
+            std::vector<int> *order;
+            int id;
+            ~Tracked() { order->push_back(id); }
+        };
+        {
+            Arena arena(256);
+            for (int i = 0; i < 100; ++i)
+                arena.create<Tracked>(&order, i);
+            // 平凡析构的类型不登记
+            EXPECT_EQ(*arena.create<int>(7), 7);
+            arena.reset();
+            ASSERT_EQ(order.size(), 100u);
+            EXPECT_EQ(order.front(), 99);
+            EXPECT_EQ(order.back(), 0);
+
+            order.clear();
+            arena.create<Tracked>(&order, 1000);
+        }
+        // Arena析构时同样执行
+        EXPECT_EQ(order, std::vector<int>{1000});
+    }
+
+    // 测试 ArenaResource / ArenaAllocator 接入标准容器和plib容器
+    TEST(ArenaTest, ContainerIntegration)
+    {
+        Arena arena;
+        ArenaResource resource(arena);
+        {
+            std::pmr::vector<std::pmr::string> names(&resource);
+            for (int i = 0; i < 32; ++i)
+                names.emplace_back(std::string(40, static_cast<char>('a' + i % 26)));
+            EXPECT_EQ(names[27], std::pmr::string(40, 'b'));
+
+            std::vector<int, ArenaAllocator<int>> ints{ArenaAllocator<int>(arena)};
+            for (int i = 0; i < 1000; ++i)
+                ints.push_back(i);
+            EXPECT_EQ(ints[999], 999);
+
+            plib::core::utils::SmallVector<std::string, 4> sv(&resource);
+            for (int i = 0; i < 64; ++i)
+                sv.push_back(std::to_string(i));
+            EXPECT_EQ(sv.get_resource(), &resource);
+            EXPECT_EQ(sv[63], "63");
+            plib::core::utils::SmallVector<std::string, 4> moved(std::move(sv));
+            EXPECT_EQ(moved.get_resource(), &resource);
+            EXPECT_EQ(moved.size(), 64u);
+            // 不同资源之间的移动赋值逐个移动元素，而不是偷走缓冲区
+            plib::core::utils::SmallVector<std::string, 4> heap;
+            heap = std::move(moved);
+            EXPECT_EQ(heap.get_resource(), nullptr);
+            EXPECT_EQ(heap[10], "10");
+
+            // POD元素走grow_pod，使用资源时以分配+拷贝代替realloc
+            plib::core::utils::SmallVector<int, 2> pods(&resource);
+            for (int i = 0; i < 100; ++i)
+                pods.push_back(i);
+            EXPECT_EQ(pods[99], 99);
+
+            plib::core::type::pmr::flat_map<int, std::string> map(&resource);
+            for (int i = 100; i > 0; --i)
+                map.emplace(i, std::to_string(i));
+            EXPECT_EQ(map.size(), 100u);
+            EXPECT_EQ(map.begin()->first, 1);
+            EXPECT_EQ(map.get_allocator().resource(), &resource);
+
+            plib::core::type::pmr::flat_set<int> set({5, 3, 5, 1}, &resource);
+            EXPECT_EQ(set.size(), 3u);
+            EXPECT_EQ(*set.begin(), 1);
+
+            plib::core::type::flat_set<int, std::less<>, ArenaAllocator<int>> typed{ArenaAllocator<int>(arena)};
+            typed.insert(2);
+            typed.insert(1);
+            EXPECT_EQ(*typed.begin(), 1);
+        }
+        EXPECT_GT(arena.bytes_allocated(), 0u);
+        arena.reset();
+        EXPECT_EQ(arena.bytes_allocated(), 0u);
+    }
+    // 测试 MmapBlockProvider 的对齐、小块复用和大块单独映射
+    TEST(BlockProviderTest, MmapAlignmentAndReuse)
+    {
+        MmapBlockProvider provider;
+        std::vector<void *> blocks;
+        for (int i = 0; i < 40; ++i)
+        {
+            void *b = provider.allocate(65536, 65536);
+            ASSERT_EQ(reinterpret_cast<std::uintptr_t>(b) % 65536, 0u);
+            std::memset(b, i, 65536);
+            blocks.push_back(b);
+        }
+        // 40个64KB块需要两个2MB区域
+        EXPECT_EQ(provider.mapped_bytes(), 2 * MmapBlockProvider::kHugePageSize);
+
+        void *last = blocks.back();
+        provider.deallocate(last, 65536, 65536);
+        EXPECT_EQ(provider.allocate(65536, 65536), last);
+
+        void *big = provider.allocate(3 * 1024 * 1024, 64);
+        std::memset(big, 0xcd, 3 * 1024 * 1024);
+        EXPECT_EQ(provider.mapped_bytes(), 4 * MmapBlockProvider::kHugePageSize);
+        provider.deallocate(big, 3 * 1024 * 1024, 64);
+        EXPECT_EQ(provider.mapped_bytes(), 2 * MmapBlockProvider::kHugePageSize);
+        for (void *b : blocks)
+            provider.deallocate(b, 65536, 65536);
+    }
+
+    // 测试作为通用pmr上游时，小于FreeNode或对齐不足的块归还后不会踩到相邻块
+    TEST(BlockProviderTest, TinyBlocksAreNotCorrupted)
+    {
+        MmapBlockProvider provider;
+        std::vector<unsigned char *> blocks;
+        for (int i = 0; i < 16; ++i)
+        {
+            auto *b = static_cast<unsigned char *>(provider.allocate(2, 1));
+            ASSERT_NE(b, nullptr);
+            b[0] = b[1] = static_cast<unsigned char>(i);
+            blocks.push_back(b);
+        }
+        for (int i = 0; i < 16; i += 2)
+            provider.deallocate(blocks[i], 2, 1);
+        for (int i = 1; i < 16; i += 2)
+        {
+            EXPECT_EQ(blocks[i][0], i);
+            EXPECT_EQ(blocks[i][1], i);
+        }
+        // 归还的块按相同规则复用
+        EXPECT_EQ(provider.allocate(2, 1), blocks[14]);
+        std::pmr::vector<char> v(&provider);
+        v.assign(3, 'x');
+        EXPECT_EQ(std::string(v.begin(), v.end()), "xxx");
+    }
+
+    // 测试显式大页不可用时退回普通映射，预取选项不影响使用
+    TEST(BlockProviderTest, HugetlbFallbackAndPopulate)
+    {
+        MmapBlockProvider::Options options;
+        options.huge_pages = HugePagePolicy::EXPLICIT;
+        options.populate = true;
+        MmapBlockProvider provider(options);
+        auto *p = static_cast<std::uint64_t *>(provider.allocate(4096, 64));
+        p[0] = 42;
+        EXPECT_EQ(provider.hugetlb_mappings() + provider.hugetlb_fallbacks(), 1u);
+        provider.deallocate(p, 4096, 64);
+
+        options.huge_pages = HugePagePolicy::NONE;
+        MmapBlockProvider plain(options);
+        void *q = plain.allocate(1024, 16);
+        EXPECT_EQ(plain.transparent_mappings(), 0u);
+        plain.deallocate(q, 1024, 16);
+    }
+
+    // 测试各内存池通过块来源申请内存
+    TEST(BlockProviderTest, PoolsUseProvider)
+    {
+        MmapBlockProvider provider;
+        {
+            MemoryPool<std::uint64_t> pool(&provider);
+            EXPECT_EQ(pool.block_provider(), &provider);
+            std::vector<std::uint64_t *> v;
+            for (std::uint64_t i = 0; i < 2000; ++i)
+                v.push_back(pool.newElement(i));
+            EXPECT_EQ(*v[1999], 1999u);
+            for (auto *p : v)
+                pool.deleteElement(p);
+
+            // 作为分配器：默认构造和rebind转换都不抛出，转换沿用块来源
+            static_assert(std::is_nothrow_default_constructible_v<MemoryPool<int>>);
+            static_assert(std::is_nothrow_constructible_v<MemoryPool<int>, const MemoryPool<std::uint64_t> &>);
+            MemoryPool<int> defaulted = {};
+            EXPECT_EQ(defaulted.block_provider(), default_block_provider());
+            MemoryPool<int> rebound(pool);
+            EXPECT_EQ(rebound.block_provider(), &provider);
+        }
+        {
+            ConcurrentMemoryPool<std::string, 4096, 8> pool(&provider);
+            std::string *s = pool.newElement("pooled");
+            EXPECT_EQ(*s, "pooled");
+            pool.deleteElement(s);
+        }
+        {
+            utils::ObjectPool<std::string> pool(&provider, 1);
+            std::vector<std::string *> v;
+            for (int i = 0; i < 5000; ++i)
+                v.push_back(pool.animate(std::to_string(i)));
+            EXPECT_EQ(*v[4999], "4999");
+            EXPECT_GT(provider.mapped_bytes(), 0u);
+            for (auto *p : v)
+                pool.recycle(p);
+        }
+    }
+    utils::ObjectPool<std::string> g_string_pool(1);
+
+    // 测试 pool_unique_ptr 在析构时把对象还给池，删除器足够紧凑
+    TEST(PoolPtrTest, UniquePtrReturnsToPool)
+    {
+        static_assert(sizeof(pool_unique_ptr<std::string, utils::ObjectPool<std::string>>) == 2 * sizeof(void *));
+        static_assert(sizeof(static_pool_unique_ptr<std::string, g_string_pool>) == sizeof(void *));
+
+        utils::ObjectPool<std::string> pool(1);
+        {
+            auto p = make_pool_unique(pool, "unique");
+            EXPECT_EQ(*p, "unique");
+            EXPECT_EQ(pool.num_allocated_objects(), 1u);
+        }
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+
+        MemoryPool<std::string> mp;
+        std::string *raw;
+        {
+            auto p = make_pool_unique(mp, 8, 'x');
+            raw = p.get();
+            EXPECT_EQ(*p, "xxxxxxxx");
+        }
+        // 槽位已回到空闲链表
+        EXPECT_EQ(mp.allocate(), raw);
+        mp.deallocate(raw);
+
+        {
+            auto p = make_static_pool_unique<g_string_pool>("static");
+            EXPECT_EQ(*p, "static");
+        }
+        EXPECT_EQ(g_string_pool.num_allocated_objects(), 0u);
+    }
+
+    // 测试 pool_shared_ptr 的计数与对象同槽，最后一个持有者释放时归还
+    TEST(PoolPtrTest, SharedPtrSingleSlot)
+    {
+        static_assert(sizeof(pool_shared_ptr<std::string>) == sizeof(void *));
+        static_assert(sizeof(pool_shared_header) <= 16);
+
+        utils::ObjectPool<pool_shared_box<std::string>> pool(2);
+        {
+            auto a = allocate_pool_shared(pool, "shared");
+            EXPECT_EQ(*a, "shared");
+            EXPECT_EQ(a.use_count(), 1u);
+            auto b = a;
+            EXPECT_EQ(a.use_count(), 2u);
+            EXPECT_EQ(a, b);
+            pool_shared_ptr<std::string> c = std::move(b);
+            EXPECT_FALSE(b);
+            EXPECT_EQ(c.use_count(), 2u);
+            a.reset();
+            EXPECT_EQ(pool.num_allocated_objects(), 1u);
+        }
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+
+        // 跨线程共享，最后的释放可能发生在任意线程
+        std::vector<pool_shared_ptr<std::string>> items;
+        for (int i = 0; i < 1000; ++i)
+            items.push_back(allocate_pool_shared<std::string>(pool, std::to_string(i)));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([copy = items]() mutable
+                                 { copy.clear(); });
+        items.clear();
+        for (auto &th : threads)
+            th.join();
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+
+        MemoryPool<pool_shared_box<int>> mp;
+        auto x = allocate_pool_shared(mp, 42);
+        auto y = x;
+        EXPECT_EQ(*y, 42);
+    }
+} // namespace plib::core::memory
@@ -1,7 +1,23 @@
 #include <gtest/gtest.h>
 #include "utils/lru.hpp"
+#include "utils/object_pool.hpp"
+#include "utils/small_string.hpp"
+#include "utils/small_vector.hpp"
+#include "utils/string_util.hpp"
+#include "type/stringstream.hpp"
 
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
 namespace plib::core::utils
@@ -309,4 +325,574 @@ namespace plib::core::utils
         EXPECT_EQ(lru.take_lowest().value, 30);
         EXPECT_EQ(lru.take_lowest().value, 10);
     }
+
+    // 满了淘汰最久未使用的条目，get会刷新顺序，peek不会
+    TEST(LruCacheTest, GetPutEvict)
+    {
+        std::vector<std::pair<int, std::string>> evicted;
+        LruCache<int, std::string> cache(3, [&](const int &key, std::string &value)
+                                         { evicted.emplace_back(key, value); });
+        EXPECT_TRUE(cache.put(1, "one"));
+        EXPECT_TRUE(cache.put(2, "two"));
+        EXPECT_TRUE(cache.put(3, "three"));
+        ASSERT_NE(cache.get(1), nullptr);
+        EXPECT_EQ(*cache.peek(2), "two");
+        EXPECT_TRUE(cache.put(4, "four"));
+        EXPECT_FALSE(cache.contains(2));
+        EXPECT_FALSE(cache.put(3, "THREE"));
+        EXPECT_TRUE(cache.put(5, "five"));
+        ASSERT_EQ(evicted.size(), 2u);
+        EXPECT_EQ(evicted[0], std::make_pair(2, std::string("two")));
+        EXPECT_EQ(evicted[1], std::make_pair(1, std::string("one")));
+
+        std::vector<int> order;
+        cache.for_each([&](const int &key, const std::string &)
+                       { order.push_back(key); });
+        EXPECT_EQ(order, (std::vector<int>{5, 3, 4}));
+        EXPECT_EQ(*cache.get(3), "THREE");
+        EXPECT_EQ(cache.get(1), nullptr);
+
+        const auto stats = cache.stats();
+        EXPECT_EQ(stats.hits, 2u);
+        EXPECT_EQ(stats.misses, 1u);
+        EXPECT_EQ(stats.evictions, 2u);
+
+        EXPECT_TRUE(cache.erase(4));
+        EXPECT_FALSE(cache.erase(4));
+        EXPECT_EQ(cache.size(), 2u);
+        cache.clear();
+        EXPECT_TRUE(cache.empty());
+        EXPECT_TRUE(cache.put(6, "six"));
+        EXPECT_EQ(*cache.get(6), "six");
+    }
+
+    // 随机操作与std::list+std::map模型对照，冲突很多的哈希覆盖回填删除的各种情况
+    TEST(LruCacheTest, MatchesReferenceModel)
+    {
+        struct BadHash
+        {
+            std::size_t operator()(int key) const { return static_cast<std::size_t>(key % 7); }
+        };
+        LruCache<int, int, BadHash> cache(64);
+        std::list<std::pair<int, int>> model;
+        std::map<int, std::list<std::pair<int, int>>::iterator> where;
+        std::mt19937 rng(11);
+        for (int i = 0; i < 50000; ++i)
+        {
+            const int key = static_cast<int>(rng() % 200);
+            const auto op = rng() % 4;
+            auto it = where.find(key);
+            if (op == 0)
+            {
+                ASSERT_EQ(cache.erase(key), it != where.end());
+                if (it != where.end())
+                {
+                    model.erase(it->second);
+                    where.erase(it);
+                }
+            }
+            else if (op == 1)
+            {
+                auto *value = cache.get(key);
+                ASSERT_EQ(value != nullptr, it != where.end());
+                if (value != nullptr)
+                {
+                    ASSERT_EQ(*value, it->second->second);
+                    model.splice(model.begin(), model, it->second);
+                }
+            }
+            else
+            {
+                ASSERT_EQ(cache.put(key, i), it == where.end());
+                if (it != where.end())
+                {
+                    it->second->second = i;
+                    model.splice(model.begin(), model, it->second);
+                }
+                else
+                {
+                    if (model.size() == cache.capacity())
+                    {
+                        where.erase(model.back().first);
+                        model.pop_back();
+                    }
+                    model.emplace_front(key, i);
+                    where[key] = model.begin();
+                }
+            }
+            ASSERT_EQ(cache.size(), model.size());
+        }
+        std::vector<std::pair<int, int>> actual;
+        cache.for_each([&](const int &key, const int &value)
+                       { actual.emplace_back(key, value); });
+        EXPECT_TRUE(std::equal(actual.begin(), actual.end(), model.begin(), model.end()));
+    }
+
+    // 淘汰、覆盖、删除、清空和析构都要正确释放键值
+    TEST(LruCacheTest, DestroysEntries)
+    {
+        auto shared = std::make_shared<int>(1);
+        {
+            LruCache<std::string, std::shared_ptr<int>> cache(4);
+            for (int i = 0; i < 10; ++i)
+                cache.put(std::string(40, static_cast<char>('a' + i)), shared);
+            EXPECT_EQ(shared.use_count(), 5);
+            cache.put(std::string(40, 'j'), std::make_shared<int>(2));
+            EXPECT_EQ(shared.use_count(), 4);
+            cache.erase(std::string(40, 'i'));
+            EXPECT_EQ(shared.use_count(), 3);
+            cache.clear();
+            EXPECT_EQ(shared.use_count(), 1);
+            cache.put(std::string(40, 'x'), shared);
+            EXPECT_EQ(shared.use_count(), 2);
+        }
+        EXPECT_EQ(shared.use_count(), 1);
+    }
+
+    // 新值引用的正是将被淘汰的条目，淘汰前要先把它构造出来
+    TEST(LruCacheTest, PutValueAliasingEvictedEntry)
+    {
+        LruCache<int, std::string> cache(2);
+        cache.put(1, std::string(64, 'a'));
+        cache.put(2, std::string(64, 'b'));
+        EXPECT_TRUE(cache.put(3, *cache.peek(1)));
+        EXPECT_FALSE(cache.contains(1));
+        EXPECT_EQ(*cache.peek(3), std::string(64, 'a'));
+        EXPECT_EQ(*cache.peek(2), std::string(64, 'b'));
+    }
+
+    // 记录从int转换次数的键
+    struct ConvertedKey
+    {
+        static inline int conversions = 0;
+        int value;
+        ConvertedKey(int v) : value(v) { ++conversions; }
+        bool operator==(const ConvertedKey &) const = default;
+    };
+    struct ConvertedKeyHash
+    {
+        std::size_t operator()(const ConvertedKey &k) const { return std::hash<int>()(k.value); }
+    };
+
+    // 异构键只转换一次
+    TEST(LruCacheTest, HeterogeneousPutConvertsOnce)
+    {
+        LruCache<ConvertedKey, int, ConvertedKeyHash> cache(2);
+        ConvertedKey::conversions = 0;
+        EXPECT_TRUE(cache.put(1, 10));
+        EXPECT_EQ(ConvertedKey::conversions, 1);
+        EXPECT_FALSE(cache.put(1, 11));
+        EXPECT_EQ(ConvertedKey::conversions, 2);
+        EXPECT_EQ(*cache.peek(ConvertedKey(1)), 11);
+
+        LruCache<std::string, int> strings(2);
+        EXPECT_TRUE(strings.put("abc", 1));
+        EXPECT_EQ(*strings.peek("abc"), 1);
+    }
+
+    // 40字节的第三方结构体，不带任何侵入式成员
+    struct PlainMessage
+    {
+        std::uint64_t id;
+        double values[4];
+    };
+
+    // 测试对象池可以池化任意类型，且没有逐对象开销
+    TEST(ObjectPoolTest, NonIntrusiveTypes)
+    {
+        static_assert(sizeof(PlainMessage) == 40);
+        ObjectPool<PlainMessage> pool(1);
+        // 64KB的块减去块头后，40字节的对象槽数量
+        EXPECT_GE(pool.num_objects_per_block(), (65536 - 128) / sizeof(PlainMessage));
+
+        std::set<PlainMessage *> seen;
+        std::vector<PlainMessage *> objs;
+        for (std::uint64_t i = 0; i < 5000; ++i)
+        {
+            auto *m = pool.animate(PlainMessage{i, {1.0, 2.0, 3.0, 4.0}});
+            EXPECT_TRUE(seen.insert(m).second);
+            objs.push_back(m);
+        }
+        EXPECT_EQ(pool.num_allocated_objects(), 5000u);
+        for (std::uint64_t i = 0; i < objs.size(); ++i)
+            EXPECT_EQ(objs[i]->id, i);
+        for (auto *m : objs)
+            pool.recycle(m);
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+
+        ObjectPool<std::string> strings(1);
+        auto *s = strings.animate("pooled std::string");
+        EXPECT_EQ(*s, "pooled std::string");
+        strings.recycle(s);
+    }
+
+    // 多线程分配、跨线程回收
+    TEST(ObjectPoolTest, ConcurrentAnimateRecycle)
+    {
+        ObjectPool<PlainMessage> pool(4);
+        constexpr int kPerThread = 20000;
+        std::vector<std::vector<PlainMessage *>> made(4);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t]
+                                 {
+                for (int i = 0; i < kPerThread; ++i)
+                    made[t].push_back(pool.animate(PlainMessage{std::uint64_t(t * kPerThread + i), {}})); });
+        }
+        for (auto &th : threads)
+            th.join();
+        threads.clear();
+        EXPECT_EQ(pool.num_allocated_objects(), 4u * kPerThread);
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t]
+                                 {
+                for (auto *m : made[(t + 1) % 4])
+                    pool.recycle(m); });
+        }
+        for (auto &th : threads)
+            th.join();
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+    }
+
+    // 同线程的分配/回收只经过弹匣，刚回收的槽会被立即复用
+    TEST(ObjectPoolTest, MagazineReuse)
+    {
+        ObjectPool<PlainMessage> pool(1);
+        auto *a = pool.animate(PlainMessage{1, {}});
+        pool.recycle(a);
+        auto *b = pool.animate(PlainMessage{2, {}});
+        EXPECT_EQ(a, b);
+        EXPECT_EQ(pool.num_local_heaps(), 1u);
+
+        std::vector<PlainMessage *> objs;
+        for (std::uint64_t i = 0; i < 10 * pool.magazine_size(); ++i)
+            objs.push_back(pool.animate(PlainMessage{i, {}}));
+        for (auto *m : objs)
+            pool.recycle(m);
+        pool.recycle(b);
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+        pool.flush_local_cache();
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+        EXPECT_EQ(pool.num_available_objects(), pool.capacity());
+    }
+
+    // 其他线程回收的对象进入远程链表，所有者再次分配时回收复用，不会扩容
+    TEST(ObjectPoolTest, RemoteFreeReclaimed)
+    {
+        ObjectPool<PlainMessage> pool(2);
+        std::vector<PlainMessage *> objs;
+        const size_t n = 3 * pool.num_objects_per_block();
+        for (size_t i = 0; i < n; ++i)
+            objs.push_back(pool.animate(PlainMessage{i, {}}));
+        const size_t cap = pool.capacity();
+
+        std::thread([&]
+                    {
+            for (auto *m : objs)
+                pool.recycle(m); })
+            .join();
+        // 只做回收的线程不创建本地堆
+        EXPECT_EQ(pool.num_local_heaps(), 1u);
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+
+        objs.clear();
+        for (size_t i = 0; i < n; ++i)
+            objs.push_back(pool.animate(PlainMessage{i, {}}));
+        EXPECT_EQ(pool.capacity(), cap);
+        EXPECT_EQ(pool.num_allocated_objects(), n);
+        for (auto *m : objs)
+            pool.recycle(m);
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+    }
+
+    // 线程退出后其本地堆的块交还全局堆，缓存被新线程复用
+    TEST(ObjectPoolTest, ThreadExitReturnsBlocks)
+    {
+        ObjectPool<PlainMessage> pool(2);
+        PlainMessage *kept = nullptr;
+        std::thread([&]
+                    {
+            for (int i = 0; i < 1000; ++i)
+                pool.recycle(pool.animate(PlainMessage{}));
+            kept = pool.animate(PlainMessage{42, {}}); })
+            .join();
+        EXPECT_EQ(pool.num_local_heaps(), 1u);
+        EXPECT_EQ(pool.num_allocated_objects(), 1u);
+        std::thread([&]
+                    {
+            pool.recycle(kept);
+            auto *m = pool.animate(PlainMessage{});
+            pool.recycle(m); })
+            .join();
+        EXPECT_EQ(pool.num_local_heaps(), 1u);
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+    }
+
+    // 峰值过后trim释放空块，保留的空块归还物理页后仍可正常分配
+    TEST(ObjectPoolTest, TrimReleasesEmptyBlocks)
+    {
+        ObjectPool<PlainMessage> pool(1);
+        std::vector<PlainMessage *> objs;
+        const size_t n = 8 * pool.num_objects_per_block();
+        for (size_t i = 0; i < n; ++i)
+            objs.push_back(pool.animate(PlainMessage{i, {}}));
+        EXPECT_GE(pool.num_blocks(), 8u);
+        for (auto *m : objs)
+            pool.recycle(m);
+        pool.flush_local_cache();
+        // 缩容时超出保留数量的空块已经释放
+        EXPECT_LE(pool.num_blocks(), 2 * pool.retained_blocks() + 2);
+
+        pool.trim(1);
+        EXPECT_EQ(pool.num_blocks(), 1u);
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+
+        objs.clear();
+        for (size_t i = 0; i < 2 * pool.num_objects_per_block(); ++i)
+            objs.push_back(pool.animate(PlainMessage{i, {1.0, 2.0, 3.0, 4.0}}));
+        std::set<PlainMessage *> seen(objs.begin(), objs.end());
+        EXPECT_EQ(seen.size(), objs.size());
+        for (size_t i = 0; i < objs.size(); ++i)
+            EXPECT_EQ(objs[i]->id, i);
+        for (auto *m : objs)
+            pool.recycle(m);
+        pool.flush_local_cache();
+        EXPECT_GE(pool.trim(0), 1u);
+        EXPECT_EQ(pool.num_blocks(), 0u);
+        EXPECT_EQ(pool.capacity(), 0u);
+    }
+
+    // 远程回收与trim并发：回收者入链后块可能立刻变空，trim不能在它退出前释放块
+    TEST(ObjectPoolTest, TrimRacesRemoteFree)
+    {
+        ObjectPool<PlainMessage> pool(2);
+        pool.set_retained_blocks(0);
+        std::atomic<bool> done{false};
+        std::thread trimmer([&]
+                            {
+            while (!done.load(std::memory_order_relaxed))
+                pool.trim(0); });
+        for (int round = 0; round < 200; ++round)
+        {
+            std::vector<PlainMessage *> objs;
+            for (size_t i = 0; i < pool.num_objects_per_block(); ++i)
+                objs.push_back(pool.animate(PlainMessage{i, {}}));
+            pool.flush_local_cache();
+            std::thread([&]
+                        {
+                for (auto *m : objs)
+                    pool.recycle(m); })
+                .join();
+        }
+        done = true;
+        trimmer.join();
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+    }
+
+    // 达到块数上限后按策略返回nullptr或抛出异常
+    TEST(ObjectPoolTest, HardCapPolicy)
+    {
+        ObjectPool<PlainMessage> pool(1);
+        pool.set_max_blocks(1);
+        pool.set_exhaust_policy(PoolExhaustPolicy::RETURN_NULL);
+        std::vector<PlainMessage *> objs;
+        while (auto *m = pool.animate(PlainMessage{}))
+            objs.push_back(m);
+        EXPECT_EQ(objs.size(), pool.num_objects_per_block());
+        EXPECT_EQ(pool.num_blocks(), 1u);
+
+        pool.set_exhaust_policy(PoolExhaustPolicy::THROW);
+        EXPECT_THROW(pool.animate(PlainMessage{}), std::bad_alloc);
+
+        // 归还一个后又可以分配
+        pool.recycle(objs.back());
+        objs.back() = pool.animate(PlainMessage{});
+        EXPECT_NE(objs.back(), nullptr);
+        for (auto *m : objs)
+            pool.recycle(m);
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+    }
+
+    // 测试批量分配/回收：对象各不相同，数量统计准确，跨线程批量回收走远程链表
+    TEST(ObjectPoolTest, BulkAnimateRecycle)
+    {
+        ObjectPool<std::string> pool(2);
+        const size_t n = 3 * pool.num_objects_per_block() + 7;
+        std::vector<std::string *> objs(n);
+        EXPECT_EQ(pool.animate_n(n, objs.data(), "bulk"), n);
+        EXPECT_EQ(std::set<std::string *>(objs.begin(), objs.end()).size(), n);
+        EXPECT_EQ(*objs[n - 1], "bulk");
+        EXPECT_EQ(pool.num_allocated_objects(), n);
+
+        pool.recycle_n(objs.data(), n / 2);
+        EXPECT_EQ(pool.num_allocated_objects(), n - n / 2);
+        std::thread([&]
+                    { pool.recycle_n(objs.data() + n / 2, n - n / 2); })
+            .join();
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+
+        // 再次批量分配复用已有的块
+        const size_t blocks = pool.num_blocks();
+        EXPECT_EQ(pool.animate_n(n, objs.data(), "again"), n);
+        EXPECT_EQ(pool.num_blocks(), blocks);
+        pool.recycle_n(objs.data(), n);
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+    }
+
+    // 测试批量分配在达到块数上限时的两种策略
+    TEST(ObjectPoolTest, BulkAnimateHardCap)
+    {
+        ObjectPool<PlainMessage> pool(1);
+        pool.set_max_blocks(1);
+        const size_t per = pool.num_objects_per_block();
+        std::vector<PlainMessage *> objs(per + 10);
+        EXPECT_THROW(pool.animate_n(per + 10, objs.data(), PlainMessage{}), std::bad_alloc);
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+
+        pool.set_exhaust_policy(PoolExhaustPolicy::RETURN_NULL);
+        EXPECT_EQ(pool.animate_n(per + 10, objs.data(), PlainMessage{}), per);
+        pool.recycle_n(objs.data(), per);
+        EXPECT_EQ(pool.num_allocated_objects(), 0u);
+    }
+
+    // 测试短字符串留在对象内部，超过内联容量后转到堆上
+    TEST(SmallStringTest, InlineAndGrowth)
+    {
+        small_string<16> s("config.key");
+        EXPECT_TRUE(s.is_inline());
+        EXPECT_EQ(s.size(), 10u);
+        EXPECT_EQ(s, "config.key");
+        EXPECT_EQ(std::strlen(s.c_str()), 10u);
+
+        s += ".with.a.longer.suffix";
+        EXPECT_FALSE(s.is_inline());
+        EXPECT_EQ(s.view(), "config.key.with.a.longer.suffix");
+        EXPECT_EQ(s.c_str()[s.size()], '\0');
+
+        // 容器扩容时按移动而不是拷贝处理
+        static_assert(std::is_nothrow_move_constructible_v<small_string<16>>);
+        static_assert(std::is_nothrow_move_assignable_v<small_string<16>>);
+        // 拷贝和移动都保持结尾的'\0'
+        auto copy = s;
+        auto moved = std::move(s);
+        EXPECT_EQ(copy, moved);
+        EXPECT_TRUE(s.empty());
+        EXPECT_STREQ(s.c_str(), "");
+        s = "short";
+        EXPECT_EQ(s.str(), "short");
+
+        // 溢出部分可以放进memory_resource
+        std::pmr::monotonic_buffer_resource arena;
+        small_string<8> pooled(&arena);
+        pooled.append(std::string_view("abcdefghijklmnop"));
+        EXPECT_EQ(pooled.get_resource(), &arena);
+        EXPECT_EQ(pooled, "abcdefghijklmnop");
+    }
+
+    TEST(SmallStringTest, ModifiersAndLookup)
+    {
+        small_string<8> s("hello world");
+        EXPECT_EQ(s.find("world"), 6u);
+        EXPECT_TRUE(s.starts_with("hello"));
+        s.replace(0, 5, "goodbye");
+        EXPECT_EQ(s, "goodbye world");
+        s.insert(7, ",");
+        EXPECT_EQ(s, "goodbye, world");
+        s.erase(7, 1);
+        EXPECT_EQ(s.substr(8), "world");
+        // 追加自身的一部分
+        s.append(s.view().substr(0, 4));
+        EXPECT_EQ(s, "goodbye worldgood");
+        // 迭代器指向自身且需要扩容
+        s.append(s.begin(), s.begin() + 7);
+        EXPECT_EQ(s, "goodbye worldgoodgoodbye");
+        s.append(s.rbegin(), s.rbegin() + 4);
+        EXPECT_EQ(s, "goodbye worldgoodgoodbyeeybd");
+        s.erase(17);
+        s.assign(s.view().substr(8, 5));
+        EXPECT_EQ(s, "world");
+        s.resize(7, '!');
+        EXPECT_EQ(s, "world!!");
+        EXPECT_THROW(s.at(8), std::out_of_range);
+
+        EXPECT_LT(small_string<4>("abc"), small_string<4>("abd"));
+        std::unordered_set<small_string<>> keys{"a", "b"};
+        EXPECT_EQ(keys.count(small_string<>("b")), 1u);
+        std::map<small_string<>, int, std::less<>> lookup{{"key", 1}};
+        EXPECT_EQ(lookup.find(std::string_view("key"))->second, 1);
+    }
+
+    // concat/join/StringStream可以直接产出small_string
+    TEST(SmallStringTest, ConcatJoinAndStringStream)
+    {
+        const std::string app = "plib";
+        auto field = concat<small_string<32>>("app=", app, ':', std::string_view("core"));
+        EXPECT_TRUE(field.is_inline());
+        EXPECT_EQ(field, "app=plib:core");
+        EXPECT_EQ(concat("a", app, 'b'), "aplibb");
+
+        const std::vector<std::string> parts{"x", "y", "z"};
+        auto joined = join<small_string<16>>(parts.begin(), parts.end(), ", ");
+        EXPECT_EQ(joined, "x, y, z");
+        EXPECT_EQ(join(parts.begin(), parts.end(), "-"), "x-y-z");
+
+        type::StringStream ss;
+        ss << "n=" << 42 << ' ' << 3.14159265 << ' ' << true << ' ' << std::vector<int>{1, 2}
+           << ' ' << std::make_pair(1, field);
+        EXPECT_EQ(ss.view(), "n=42 3.14159 true [1,2] (1, app=plib:core)");
+        std::ostringstream expected;
+        expected << 1e-7 << ' ' << 123456789.0 << ' ' << -0.5f << ' ' << static_cast<const void *>(&ss);
+        type::StringStream same;
+        same << 1e-7 << ' ' << 123456789.0 << ' ' << -0.5f << ' ' << static_cast<const void *>(&ss);
+        EXPECT_EQ(same.str(), expected.str());
+        auto taken = ss.take();
+        EXPECT_TRUE(taken.is_inline());
+        EXPECT_TRUE(ss.view().empty());
+    }
+
+    // 可平凡重定位的元素扩容、插入、删除都按字节搬移，引用计数不应多也不应少
+    TEST(SmallVectorTest, RelocatableElements)
+    {
+        static_assert(type::is_trivially_relocatable_v<std::shared_ptr<int>>);
+        static_assert(type::is_trivially_relocatable_v<std::unique_ptr<int>>);
+        static_assert(!type::is_trivially_relocatable_v<small_string<8>>);
+
+        auto shared = std::make_shared<int>(7);
+        {
+            SmallVector<std::shared_ptr<int>, 2> v;
+            for (int i = 0; i < 10; ++i)
+                v.push_back(shared);
+            EXPECT_EQ(shared.use_count(), 11);
+
+            v.insert(v.begin() + 3, std::make_shared<int>(1));
+            v.insert(v.begin(), v.back());
+            v.insert(v.begin() + 5, 3, v[4]);
+            EXPECT_EQ(v.size(), 15u);
+            EXPECT_EQ(shared.use_count(), 12);
+            EXPECT_EQ(*v[4], 1);
+            EXPECT_EQ(v[4].use_count(), 4);
+
+            v.erase(v.begin() + 4);
+            v.erase(v.begin(), v.begin() + 2);
+            EXPECT_EQ(v.size(), 12u);
+            EXPECT_EQ(v[2].use_count(), 3);
+            EXPECT_EQ(shared.use_count(), 10);
+
+            const std::vector<std::shared_ptr<int>> more(4, shared);
+            v.insert(v.begin() + 1, more.begin(), more.end());
+            EXPECT_EQ(shared.use_count(), 18);
+        }
+        EXPECT_EQ(shared.use_count(), 1);
+
+        SmallVector<std::unique_ptr<int>, 2> owned;
+        for (int i = 0; i < 8; ++i)
+            owned.insert(owned.begin(), std::make_unique<int>(i));
+        owned.erase(owned.begin() + 2, owned.begin() + 5);
+        std::vector<int> values;
+        for (const auto &p : owned)
+            values.push_back(*p);
+        EXPECT_EQ(values, (std::vector<int>{7, 6, 2, 1, 0}));
+    }
 }